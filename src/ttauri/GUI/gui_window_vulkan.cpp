@@ -343,6 +343,10 @@ void gui_window_vulkan::render(hires_utc_clock::time_point displayTimePoint)
             return sum | item;
         }));
 
+    // Add the glyphs that were rasterized in the background to the atlas, so that
+    // the widgets do not need to rasterize them while drawing.
+    vulkan_device().SDFPipeline->uploadRasterizedGlyphs();
+
     // Update the widgets before the pipelines need their vertices.
     // We unset modified before, so that modification requests are captured.
     auto drawContext = draw_context(
@@ -6,6 +6,7 @@
 #include "pipeline_SDF_device_shared.hpp"
 #include "gui_device_vulkan.hpp"
 #include "../text/shaped_text.hpp"
+#include "../text/font_book.hpp"
 #include "../pixel_map.hpp"
 #include "../URL.hpp"
 #include "../memory.hpp"
@@ -20,10 +21,24 @@ namespace tt::pipeline_SDF {
 
 using namespace std;
 
-device_shared::device_shared(gui_device_vulkan const &device) : device(device)
+device_shared::device_shared(gui_device_vulkan const &device) :
+    device(device), glyphs_in_atlas(i32x4{atlasImageWidth, atlasImageHeight}, atlasMaximumNrImages), rasterizer(drawfontSize, drawBorder)
 {
     buildShaders();
     buildAtlas();
+
+    // Printable ASCII and Latin-1 is used by almost all user interfaces, so rasterize
+    // these glyphs before the first frame needs them.
+    if (font_book::global) {
+        auto code_points = std::u32string{};
+        for (char32_t c = 0x21; c != 0x7f; ++c) {
+            code_points += c;
+        }
+        for (char32_t c = 0xa1; c != 0x100; ++c) {
+            code_points += c;
+        }
+        prepareAtlas(font_book::global->find_font("sans-serif", font_weight::Regular, false), code_points);
+    }
 }
 
 device_shared::~device_shared() {}
@@ -36,39 +51,29 @@ void device_shared::destroy(gui_device_vulkan *vulkanDevice)
     teardownAtlas(vulkanDevice);
 }
 
-[[nodiscard]] atlas_rect device_shared::allocateRect(f32x4 drawExtent) noexcept
+[[nodiscard]] atlas_rect device_shared::allocateRect(font_glyph_ids const &glyph, f32x4 drawExtent) noexcept
 {
-    auto imageWidth = narrow_cast<int>(std::ceil(drawExtent.width()));
-    auto imageHeight = narrow_cast<int>(std::ceil(drawExtent.height()));
-
-    if (atlasAllocationPosition.y() + imageHeight > atlasImageHeight) {
-        atlasAllocationPosition.x() = 0;
-        atlasAllocationPosition.y() = 0;
-        atlasAllocationPosition.z() = atlasAllocationPosition.z() + 1;
-
-        if (atlasAllocationPosition.z() >= atlasMaximumNrImages) {
-            tt_log_fatal("pipeline_SDF atlas overflow, too many glyphs in use.");
-        }
+    ttlet location = glyphs_in_atlas.insert(glyph, i32x4{ceil(drawExtent)}, [&drawExtent](i32x4 position) {
+        return atlas_rect{position, drawExtent};
+    });
 
-        if (atlasAllocationPosition.z() >= size(atlasTextures)) {
-            addAtlasImage();
-        }
+    if (location == nullptr) {
+        tt_log_fatal("pipeline_SDF atlas overflow, too many glyphs in use.");
     }
 
-    if (atlasAllocationPosition.x() + imageWidth > atlasImageWidth) {
-        atlasAllocationPosition.x() = 0;
-        atlasAllocationPosition.y() = atlasAllocationPosition.y() + atlasAllocationMaxHeight;
+    while (std::ssize(atlasTextures) < glyphs_in_atlas.allocator().nr_pages()) {
+        addAtlasImage();
     }
 
-    auto r = atlas_rect{atlasAllocationPosition, drawExtent};
-
-    atlasAllocationPosition.x() = atlasAllocationPosition.x() + imageWidth;
-    atlasAllocationMaxHeight = std::max(atlasAllocationMaxHeight, imageHeight);
-
-    return r;
+    return *location;
 }
 
 void device_shared::uploadStagingPixmapToAtlas(atlas_rect location)
+{
+    uploadStagingPixmapToAtlas(std::vector{std::pair{i32x4{}, location}});
+}
+
+void device_shared::uploadStagingPixmapToAtlas(std::vector<std::pair<i32x4, atlas_rect>> const &regions)
 {
     // Flush the given image, included the border.
     device.flushAllocation(
@@ -78,22 +83,72 @@ void device_shared::uploadStagingPixmapToAtlas(atlas_rect location)
 
     array<vector<vk::ImageCopy>, atlasMaximumNrImages> regionsToCopyPerAtlasTexture;
 
-    auto regionsToCopy = std::vector{vk::ImageCopy{
-        {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
-        {0, 0, 0},
-        {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
-        {narrow_cast<int32_t>(location.atlasPosition.x()), narrow_cast<int32_t>(location.atlasPosition.y()), 0},
-        {narrow_cast<uint32_t>(location.atlasExtent.x()), narrow_cast<uint32_t>(location.atlasExtent.y()), 1}}};
-
-    auto &atlasTexture = atlasTextures.at(location.atlasPosition.z());
-    atlasTexture.transitionLayout(device, vk::Format::eR8Snorm, vk::ImageLayout::eTransferDstOptimal);
-
-    device.copyImage(
-        stagingTexture.image,
-        vk::ImageLayout::eTransferSrcOptimal,
-        atlasTexture.image,
-        vk::ImageLayout::eTransferDstOptimal,
-        std::move(regionsToCopy));
+    for (ttlet &[position, location] : regions) {
+        regionsToCopyPerAtlasTexture.at(location.atlasPosition.z()).push_back(vk::ImageCopy{
+            {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+            {narrow_cast<int32_t>(position.x()), narrow_cast<int32_t>(position.y()), 0},
+            {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+            {narrow_cast<int32_t>(location.atlasPosition.x()), narrow_cast<int32_t>(location.atlasPosition.y()), 0},
+            {narrow_cast<uint32_t>(location.atlasExtent.x()), narrow_cast<uint32_t>(location.atlasExtent.y()), 1}});
+    }
+
+    for (ssize_t i = 0; i != std::ssize(atlasTextures); ++i) {
+        auto &regionsToCopy = regionsToCopyPerAtlasTexture.at(i);
+        if (regionsToCopy.empty()) {
+            continue;
+        }
+
+        auto &atlasTexture = atlasTextures.at(i);
+        atlasTexture.transitionLayout(device, vk::Format::eR8Snorm, vk::ImageLayout::eTransferDstOptimal);
+
+        device.copyImage(
+            stagingTexture.image,
+            vk::ImageLayout::eTransferSrcOptimal,
+            atlasTexture.image,
+            vk::ImageLayout::eTransferDstOptimal,
+            std::move(regionsToCopy));
+    }
+}
+
+bool device_shared::uploadRasterizedGlyphs()
+{
+    auto atlas_was_updated = false;
+
+    glyphs_in_atlas.next_frame();
+
+    // Evicted glyphs may be rasterized again in the background when they are needed.
+    // Glyphs that were added to the atlas again after their eviction are not included.
+    for (ttlet &glyph : glyphs_in_atlas.take_evicted()) {
+        rasterizer.forget(glyph);
+    }
+
+    // The glyphs on a fragmented page are rasterized again to be packed on other pages.
+    for (ttlet &glyph : glyphs_in_atlas.defragment()) {
+        rasterizer.forget(glyph);
+        rasterizer.queue(glyph);
+    }
+
+    while (true) {
+        prepareStagingPixmapForDrawing();
+        ttlet tiles = rasterizer.pack_finished(stagingTexture.pixel_map);
+        if (tiles.empty()) {
+            break;
+        }
+
+        auto regions = std::vector<std::pair<i32x4, atlas_rect>>{};
+        regions.reserve(tiles.size());
+        for (ttlet &tile : tiles) {
+            regions.emplace_back(tile.position, allocateRect(tile.glyphs, tile.draw_extent));
+        }
+
+        uploadStagingPixmapToAtlas(regions);
+        atlas_was_updated = true;
+    }
+
+    if (atlas_was_updated) {
+        prepareAtlasForRendering();
+    }
+    return atlas_was_updated;
 }
 
 void device_shared::prepareStagingPixmapForDrawing()
@@ -108,46 +163,26 @@ void device_shared::prepareAtlasForRendering()
     }
 }
 
-/** Prepare the atlas for drawing a text.
- *
- *  +---------------------+
- *  |     draw border     |
- *  |  +---------------+  |
- *  |  | render border |  |
- *  |  |  +---------+  |  |
- *  |  |  |  glyph  |  |  |
- *  |  |  | bounding|  |  |
- *  |  |  |   box   |  |  |
- *  |  |  +---------+  |  |
- *  |  |               |  |
- *  |  +---------------+  |
- *  |                     |
- *  O---------------------+
- */
-atlas_rect device_shared::addGlyphToAtlas(font_glyph_ids glyph) noexcept
+void device_shared::prepareAtlas(shaped_text const &text) noexcept
 {
-    ttlet[glyphPath, glyphBoundingBox] = glyph.getPathAndBoundingBox();
-
-    ttlet drawScale = scale2{drawfontSize, drawfontSize};
-    ttlet scaledBoundingBox = drawScale * glyphBoundingBox;
-
-    // We will draw the font at a fixed size into the texture. And we need a border for the texture to
-    // allow proper bi-linear interpolation on the edges.
+    rasterizer.queue(text);
+}
 
-    // Determine the size of the image in the atlas.
-    // This is the bounding box sized to the fixed font size and a border
-    ttlet drawOffset = f32x4{drawBorder, drawBorder} - scaledBoundingBox.offset();
-    ttlet drawExtent = scaledBoundingBox.extent() + 2.0f * f32x4{drawBorder, drawBorder};
-    ttlet drawTranslate = translate2{drawOffset};
+void device_shared::prepareAtlas(font_id font_id, std::u32string_view code_points) noexcept
+{
+    rasterizer.queue(font_id, code_points);
+}
 
-    // Transform the path to the scale of the fixed font size and drawing the bounding box inside the image.
-    ttlet drawPath = (drawTranslate * drawScale) * glyphPath;
+atlas_rect device_shared::addGlyphToAtlas(font_glyph_ids glyph) noexcept
+{
+    // The glyph is only rasterized here when it was not yet rasterized in the background.
+    ttlet glyph_image = rasterizer.take(glyph);
 
-    // Draw glyphs into staging buffer of the atlas and upload it to the correct position in the atlas.
+    // Copy the glyph into staging buffer of the atlas and upload it to the correct position in the atlas.
     prepareStagingPixmapForDrawing();
-    auto atlas_rect = allocateRect(drawExtent);
+    auto atlas_rect = allocateRect(glyph, glyph_image.draw_extent);
     auto pixmap = stagingTexture.pixel_map.submap(iaarect{i32x4::point(), atlas_rect.atlasExtent});
-    fill(pixmap, drawPath);
+    copy(glyph_image.image, pixmap);
     uploadStagingPixmapToAtlas(atlas_rect);
 
     return atlas_rect;
@@ -155,14 +190,10 @@ atlas_rect device_shared::addGlyphToAtlas(font_glyph_ids glyph) noexcept
 
 std::pair<atlas_rect, bool> device_shared::getGlyphFromAtlas(font_glyph_ids glyph) noexcept
 {
-    ttlet i = glyphs_in_atlas.find(glyph);
-    if (i != glyphs_in_atlas.cend()) {
-        return {i->second, false};
-
+    if (ttlet location = glyphs_in_atlas.find(glyph)) {
+        return {*location, false};
     } else {
-        ttlet aarect = addGlyphToAtlas(glyph);
-        glyphs_in_atlas.emplace(glyph, aarect);
-        return {aarect, true};
+        return {addGlyphToAtlas(glyph), true};
     }
 }
 
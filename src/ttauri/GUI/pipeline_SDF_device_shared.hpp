@@ -8,6 +8,8 @@
 #include "pipeline_SDF_atlas_rect.hpp"
 #include "pipeline_SDF_specialization_constants.hpp"
 #include "../text/font_glyph_ids.hpp"
+#include "../text/glyph_rasterizer.hpp"
+#include "../atlas_cache.hpp"
 #include "../required.hpp"
 #include "../logger.hpp"
 #include "../vspan.hpp"
@@ -43,8 +45,10 @@ struct device_shared final {
     static_assert(atlasImageWidth == atlasImageHeight, "needed for fwidth(textureCoord)");
 
     static constexpr int atlasMaximumNrImages = 16; // 16 * 512 characters, of 64x64 pixels.
-    static constexpr int stagingImageWidth = 128; // maximum size of character that can be uploaded is 128x128
-    static constexpr int stagingImageHeight = 128;
+    // Maximum size of character that can be uploaded is 256x256.
+    // Glyphs rasterized in the background are packed together in the staging image and uploaded at once.
+    static constexpr int stagingImageWidth = 256;
+    static constexpr int stagingImageHeight = 256;
 
     static constexpr float atlasTextureCoordinateMultiplier = 1.0f / atlasImageWidth;
     static constexpr float drawfontSize = 28.0f;
@@ -61,7 +65,10 @@ struct device_shared final {
     vk::SpecializationInfo fragmentShaderSpecializationInfo;
     std::vector<vk::PipelineShaderStageCreateInfo> shaderStages;
 
-    std::unordered_map<font_glyph_ids, atlas_rect> glyphs_in_atlas;
+    /** The glyphs in the atlas.
+     * Glyphs that were not used recently are evicted when the atlas is full.
+     */
+    atlas_cache<font_glyph_ids, atlas_rect> glyphs_in_atlas;
     texture_map stagingTexture;
     std::vector<texture_map> atlasTextures;
 
@@ -69,9 +76,9 @@ struct device_shared final {
     vk::Sampler atlasSampler;
     vk::DescriptorImageInfo atlasSamplerDescriptorImageInfo;
 
-    i32x4 atlasAllocationPosition = {};
-    /// During allocation on a row, we keep track of the tallest glyph.
-    int atlasAllocationMaxHeight = 0;
+    /** Rasterizes glyphs on worker threads before they are added to the atlas.
+     */
+    glyph_rasterizer rasterizer;
 
     device_shared(gui_device_vulkan const &device);
     ~device_shared();
@@ -87,10 +94,11 @@ struct device_shared final {
      */
     void destroy(gui_device_vulkan *vulkanDevice);
 
-    /** Allocate an glyph in the atlas.
-     * This may allocate an atlas texture, up to atlasMaximumNrImages.
+    /** Allocate a glyph in the atlas.
+     * This may allocate an atlas texture, up to atlasMaximumNrImages, or evict glyphs
+     * that were not used in the current frame.
      */
-    [[nodiscard]] atlas_rect allocateRect(f32x4 drawExtent) noexcept;
+    [[nodiscard]] atlas_rect allocateRect(font_glyph_ids const &glyph, f32x4 drawExtent) noexcept;
 
     void drawInCommandBuffer(vk::CommandBuffer &commandBuffer);
 
@@ -99,6 +107,19 @@ struct device_shared final {
      */
     void uploadStagingPixmapToAtlas(atlas_rect location);
 
+    /** Upload multiple images from the staging pixmap to the atlas.
+     *
+     * @param regions The position of an image in the staging pixmap, and its location in the atlas.
+     */
+    void uploadStagingPixmapToAtlas(std::vector<std::pair<i32x4, atlas_rect>> const &regions);
+
+    /** Add the glyphs that were rasterized in the background to the atlas.
+     * This should be called before the vertices of a frame are placed.
+     *
+     * @return True if glyphs were added to the atlas.
+     */
+    bool uploadRasterizedGlyphs();
+
     /** This will transition the staging texture to 'general' for writing by the CPU.
      */
     void prepareStagingPixmapForDrawing();
@@ -108,9 +129,19 @@ struct device_shared final {
     void prepareAtlasForRendering();
 
     /** Prepare the atlas for drawing a text.
+     * The glyphs of the text are rasterized in the background and added to the
+     * atlas by `uploadRasterizedGlyphs()`.
      */
     void prepareAtlas(shaped_text const &text) noexcept;
 
+    /** Prepare the atlas for drawing the given code points.
+     * The glyphs are rasterized in the background and added to the atlas by `uploadRasterizedGlyphs()`.
+     *
+     * @param font_id The font to find the glyphs in, including its fallback fonts.
+     * @param code_points The code points to find the glyphs for.
+     */
+    void prepareAtlas(font_id font_id, std::u32string_view code_points) noexcept;
+
     /** Get the bounding box, including draw border of a glyph.
      */
     static aarect getBoundingBox(font_glyph_ids const &glyphs) noexcept;
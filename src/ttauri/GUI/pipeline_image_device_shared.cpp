@@ -18,7 +18,7 @@ namespace tt::pipeline_image {
 using namespace std;
 
 device_shared::device_shared(gui_device_vulkan const &device) :
-    device(device)
+    device(device), atlasAllocator(i32x4{atlasImageWidth, atlasImageHeight}, atlasMaximumNrImages)
 {
     buildShaders();
     buildAtlas();
@@ -37,22 +37,29 @@ void device_shared::destroy(gui_device_vulkan *vulkanDevice)
 
 std::vector<Page> device_shared::allocatePages(int const nrPages) noexcept
 {
-    while (nrPages > atlasFreePages.size()) {
-        addAtlasImage();
-    }
-
     auto pages = std::vector<Page>();
+    pages.reserve(nrPages);
     for (int i = 0; i < nrPages; i++) {
-        ttlet page = atlasFreePages.back();
-        pages.push_back(page);
-        atlasFreePages.pop_back();
+        ttlet position = atlasAllocator.allocate(i32x4{Page::widthIncludingBorder, Page::heightIncludingBorder});
+        if (!position) {
+            tt_log_fatal("pipeline_image atlas overflow, too many images in use.");
+        }
+        pages.emplace_back(*position);
+    }
+
+    while (std::ssize(atlasTextures) < atlasAllocator.nr_pages()) {
+        addAtlasImage();
     }
     return pages;
 }
 
 void device_shared::freePages(std::vector<Page> const &pages) noexcept
 {
-    atlasFreePages.insert(atlasFreePages.end(), pages.begin(), pages.end());
+    for (ttlet &page : pages) {
+        if (!page.isFullyTransparent()) {
+            atlasAllocator.free(page.position, i32x4{Page::widthIncludingBorder, Page::heightIncludingBorder});
+        }
+    }
 }
 
 Image device_shared::makeImage(const i32x4 extent) noexcept
@@ -176,8 +183,6 @@ void device_shared::teardownShaders(gui_device_vulkan *vulkanDevice)
 
 void device_shared::addAtlasImage()
 {
-    ttlet currentImageIndex = std::ssize(atlasTextures);
-
     // Create atlas image
     vk::ImageCreateInfo const imageCreateInfo = {
         vk::ImageCreateFlags(),
@@ -215,12 +220,6 @@ void device_shared::addAtlasImage()
 
     atlasTextures.push_back({ atlasImage, atlasImageAllocation, atlasImageView });
  
-    // Add pages for this image to free list.
-    ttlet pageOffset = currentImageIndex * atlasNrPagesPerImage;
-    for (int i = 0; i < atlasNrPagesPerImage; i++) {
-            atlasFreePages.push_back({pageOffset + i});
-    }
-
     // Build image descriptor info.
     for (int i = 0; i < std::ssize(atlasDescriptorImageInfos); i++) {
         // Point the descriptors to each imageView,
@@ -7,6 +7,7 @@
 #include "pipeline_image_texture_map.hpp"
 #include "pipeline_image_page.hpp"
 #include "../required.hpp"
+#include "../atlas_allocator.hpp"
 #include "../color/sfloat_rgba16.hpp"
 #include <vma/vk_mem_alloc.h>
 #include <vulkan/vulkan.hpp>
@@ -44,7 +45,9 @@ struct device_shared final {
     vk::Sampler atlasSampler;
     vk::DescriptorImageInfo atlasSamplerDescriptorImageInfo;
 
-    std::vector<Page> atlasFreePages;
+    /** Allocates the pages in the atlas textures.
+     */
+    atlas_allocator atlasAllocator;
 
     device_shared(gui_device_vulkan const &device);
     ~device_shared();
@@ -64,16 +67,10 @@ struct device_shared final {
      * \return x, y pixel coordinate in an atlasTexture and z the atlasTextureIndex.
      */
     static i32x4 getAtlasPositionFromPage(Page page) noexcept {
-        ttlet imageIndex = page.nr / atlasNrPagesPerImage;
-        ttlet pageNrInsideImage = page.nr % atlasNrPagesPerImage;
-
-        ttlet pageY = pageNrInsideImage / atlasNrVerticalPages;
-        ttlet pageX = pageNrInsideImage % atlasNrVerticalPages;
-
-        ttlet x = pageX * Page::widthIncludingBorder + Page::border;
-        ttlet y = pageY * Page::heightIncludingBorder + Page::border;
+        ttlet x = page.position.x() + Page::border;
+        ttlet y = page.position.y() + Page::border;
 
-        return i32x4{narrow_cast<int>(x), narrow_cast<int>(y), narrow_cast<int>(imageIndex), 1};
+        return i32x4{x, y, page.position.z(), 1};
     }
 
     /** Allocate pages from the atlas.
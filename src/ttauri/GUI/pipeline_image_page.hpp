@@ -5,7 +5,7 @@
 #pragma once
 
 #include "../required.hpp"
-#include <limits>
+#include "../numeric_array.hpp"
 
 namespace tt::pipeline_image {
 
@@ -16,15 +16,18 @@ struct Page {
     static constexpr int widthIncludingBorder = width + 2 * border;
     static constexpr int heightIncludingBorder = height + 2 * border;
 
-    ssize_t nr;
+    /** The position of the page including its border in the atlas.
+     * z is the index of the atlas texture.
+     */
+    i32x4 position;
 
-    Page(ssize_t nr) : nr(nr) {}
+    Page(i32x4 position) : position(position) {}
 
     /*! Create a transparent page.
      */
-    Page() : nr(std::numeric_limits<ssize_t>::max()) {}
+    Page() : position(i32x4{0, 0, -1}) {}
 
-    bool isFullyTransparent() const noexcept { return nr == std::numeric_limits<ssize_t>::max(); }
+    bool isFullyTransparent() const noexcept { return position.z() < 0; }
 };
 
 }
@@ -141,6 +141,13 @@ void application::init_text()
     elusive_icons_font_id = font_book::global->register_font(URL("resource:elusiveicons-webfont.ttf"));
     ttauri_icons_font_id = font_book::global->register_font(URL("resource:ttauri_icons.ttf"));
 
+    // Printable ASCII is used by almost all user interfaces, load these glyphs before text is shaped.
+    auto printable_ascii = std::u32string{};
+    for (char32_t c = 0x20; c != 0x7f; ++c) {
+        printable_ascii += c;
+    }
+    font_book::global->prewarm(font_book::global->find_font("sans-serif", font_weight::Regular, false), printable_ascii);
+
     language::set_preferred_languages(language::read_os_preferred_languages());
 }
 
@@ -0,0 +1,210 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "atlas_allocator.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace tt {
+
+atlas_allocator::atlas_allocator(i32x4 page_extent, ssize_t max_nr_pages) noexcept :
+    _page_extent(page_extent), _max_nr_pages(max_nr_pages)
+{
+    tt_axiom(page_extent.x() > 0 && page_extent.y() > 0);
+    tt_axiom(max_nr_pages > 0);
+}
+
+[[nodiscard]] float atlas_allocator::occupancy(ssize_t page_nr) const noexcept
+{
+    ttlet page_area = static_cast<float>(_page_extent.x()) * static_cast<float>(_page_extent.y());
+    return static_cast<float>(statistics(page_nr).used_area) / page_area;
+}
+
+[[nodiscard]] std::optional<i32x4> atlas_allocator::allocate(i32x4 extent) noexcept
+{
+    tt_axiom(extent.x() > 0 && extent.y() > 0);
+
+    if (extent.x() > _page_extent.x() || extent.y() > _page_extent.y()) {
+        return {};
+    }
+
+    for (ssize_t page_nr = 0; page_nr != nr_pages(); ++page_nr) {
+        if (auto position = allocate(page_nr, extent)) {
+            return position;
+        }
+    }
+
+    if (nr_pages() < _max_nr_pages) {
+        add_page();
+        return allocate(nr_pages() - 1, extent);
+    }
+
+    return {};
+}
+
+void atlas_allocator::free(i32x4 position, i32x4 extent) noexcept
+{
+    ttlet page_nr = static_cast<ssize_t>(position.z());
+    tt_axiom(page_nr >= 0 && page_nr < nr_pages());
+    auto &page = _pages[page_nr];
+
+    tt_axiom(page.statistics.nr_allocations > 0);
+    --page.statistics.nr_allocations;
+    page.statistics.used_area -= extent.x() * extent.y();
+
+    if (page.statistics.nr_allocations == 0) {
+        // Reclaim the complete page, including the space wasted below the skyline.
+        clear(page_nr);
+    } else {
+        page.free_rectangles.emplace_back(position.x(), position.y(), extent.x(), extent.y());
+    }
+}
+
+void atlas_allocator::clear(ssize_t page_nr) noexcept
+{
+    tt_axiom(page_nr >= 0 && page_nr < nr_pages());
+    auto &page = _pages[page_nr];
+
+    page.skyline.clear();
+    page.skyline.push_back({0, 0, _page_extent.x()});
+    page.free_rectangles.clear();
+    page.statistics = {};
+}
+
+void atlas_allocator::add_page() noexcept
+{
+    _pages.emplace_back();
+    clear(nr_pages() - 1);
+}
+
+[[nodiscard]] std::optional<i32x4> atlas_allocator::allocate(ssize_t page_nr, i32x4 extent) noexcept
+{
+    auto &page = _pages[page_nr];
+
+    auto position = allocate_free_rectangle(page, extent);
+    if (!position) {
+        position = allocate_skyline(page, extent);
+    }
+
+    if (position) {
+        ++page.statistics.nr_allocations;
+        page.statistics.used_area += extent.x() * extent.y();
+        position->z() = narrow_cast<int>(page_nr);
+    }
+    return position;
+}
+
+[[nodiscard]] std::optional<i32x4> atlas_allocator::allocate_free_rectangle(page_type &page, i32x4 extent) noexcept
+{
+    // Find the smallest free rectangle in which the new rectangle fits.
+    auto best = page.free_rectangles.end();
+    auto best_area = std::numeric_limits<int>::max();
+    for (auto i = page.free_rectangles.begin(); i != page.free_rectangles.end(); ++i) {
+        ttlet area = i->width() * i->height();
+        if (i->width() >= extent.x() && i->height() >= extent.y() && area < best_area) {
+            best = i;
+            best_area = area;
+        }
+    }
+
+    if (best == page.free_rectangles.end()) {
+        return {};
+    }
+
+    ttlet free_rectangle = *best;
+    page.free_rectangles.erase(best);
+
+    // Split the remaining space in a rectangle to the right and a rectangle above
+    // the new rectangle.
+    ttlet right_width = free_rectangle.width() - extent.x();
+    ttlet top_height = free_rectangle.height() - extent.y();
+    if (right_width > 0) {
+        page.free_rectangles.emplace_back(free_rectangle.x() + extent.x(), free_rectangle.y(), right_width, extent.y());
+    }
+    if (top_height > 0) {
+        page.free_rectangles.emplace_back(free_rectangle.x(), free_rectangle.y() + extent.y(), free_rectangle.width(), top_height);
+    }
+
+    return i32x4{free_rectangle.x(), free_rectangle.y()};
+}
+
+[[nodiscard]] std::optional<i32x4> atlas_allocator::allocate_skyline(page_type &page, i32x4 extent) noexcept
+{
+    ttlet width = extent.x();
+    ttlet height = extent.y();
+    auto &skyline = page.skyline;
+
+    // Find the position where the top of the rectangle is lowest, and on a tie where
+    // the least space is wasted below the rectangle.
+    auto best_index = skyline.size();
+    auto best_y = 0;
+    auto best_top = std::numeric_limits<int>::max();
+    auto best_waste = std::numeric_limits<int>::max();
+    for (size_t i = 0; i != skyline.size(); ++i) {
+        ttlet x = skyline[i].x;
+        if (x + width > _page_extent.x()) {
+            break;
+        }
+
+        // The rectangle rests on the highest segment below it.
+        auto y = 0;
+        for (auto j = i; j != skyline.size() && skyline[j].x < x + width; ++j) {
+            y = std::max(y, skyline[j].y);
+        }
+
+        ttlet top = y + height;
+        if (top > _page_extent.y() || top > best_top) {
+            continue;
+        }
+
+        auto waste = 0;
+        for (auto j = i; j != skyline.size() && skyline[j].x < x + width; ++j) {
+            ttlet covered_width = std::min(skyline[j].x + skyline[j].width, x + width) - skyline[j].x;
+            waste += (y - skyline[j].y) * covered_width;
+        }
+
+        if (top < best_top || waste < best_waste) {
+            best_index = i;
+            best_y = y;
+            best_top = top;
+            best_waste = waste;
+        }
+    }
+
+    if (best_index == skyline.size()) {
+        return {};
+    }
+
+    ttlet x = skyline[best_index].x;
+
+    // Replace the segments below the rectangle with a single segment on top of the rectangle.
+    auto first = skyline.begin() + best_index;
+    auto last = first;
+    while (last != skyline.end() && last->x + last->width <= x + width) {
+        ++last;
+    }
+    if (last != skyline.end() && last->x < x + width) {
+        // Shorten the segment that is partially below the rectangle.
+        ttlet shrink = x + width - last->x;
+        last->x += shrink;
+        last->width -= shrink;
+    }
+    first = skyline.erase(first, last);
+    first = skyline.insert(first, segment_type{x, best_top, width});
+
+    // Merge with neighbouring segments of the same height.
+    if (first + 1 != skyline.end() && (first + 1)->y == first->y) {
+        first->width += (first + 1)->width;
+        skyline.erase(first + 1);
+    }
+    if (first != skyline.begin() && (first - 1)->y == first->y) {
+        (first - 1)->width += first->width;
+        skyline.erase(first);
+    }
+
+    page.statistics.reserved_area += width * height + best_waste;
+    return i32x4{x, best_y};
+}
+
+} // namespace tt
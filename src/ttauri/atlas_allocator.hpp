@@ -0,0 +1,121 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "numeric_array.hpp"
+#include "aarect.hpp"
+#include <vector>
+#include <optional>
+
+namespace tt {
+
+/** Allocates rectangles in the pages of a texture atlas.
+ *
+ * Rectangles are placed on a skyline, the top edge of the rectangles already
+ * allocated on a page. A new rectangle is placed where its top will be lowest,
+ * with the least space wasted below it.
+ *
+ * Freed rectangles are reused for new rectangles that fit inside them. When the last
+ * rectangle of a page is freed the complete page is reclaimed.
+ */
+class atlas_allocator {
+public:
+    struct page_statistics {
+        /** The number of allocated rectangles on the page.
+         */
+        ssize_t nr_allocations = 0;
+
+        /** The area in pixels of the allocated rectangles.
+         */
+        ssize_t used_area = 0;
+
+        /** The area in pixels below the skyline.
+         * This includes the space of freed rectangles and space wasted below rectangles.
+         */
+        ssize_t reserved_area = 0;
+    };
+
+    /** Create an atlas allocator.
+     *
+     * @param page_extent The width and height of each page.
+     * @param max_nr_pages The maximum number of pages; pages are added when needed.
+     */
+    atlas_allocator(i32x4 page_extent, ssize_t max_nr_pages) noexcept;
+
+    [[nodiscard]] i32x4 page_extent() const noexcept
+    {
+        return _page_extent;
+    }
+
+    [[nodiscard]] ssize_t nr_pages() const noexcept
+    {
+        return std::ssize(_pages);
+    }
+
+    [[nodiscard]] ssize_t max_nr_pages() const noexcept
+    {
+        return _max_nr_pages;
+    }
+
+    [[nodiscard]] page_statistics const &statistics(ssize_t page_nr) const noexcept
+    {
+        tt_axiom(page_nr >= 0 && page_nr < nr_pages());
+        return _pages[page_nr].statistics;
+    }
+
+    /** The fraction of the page covered by allocated rectangles.
+     */
+    [[nodiscard]] float occupancy(ssize_t page_nr) const noexcept;
+
+    /** Allocate a rectangle.
+     *
+     * @param extent The width and height of the rectangle.
+     * @return The x, y position of the left-bottom corner and the page number as z,
+     *         or empty when there is no room in any of the pages.
+     */
+    [[nodiscard]] std::optional<i32x4> allocate(i32x4 extent) noexcept;
+
+    /** Free a rectangle.
+     *
+     * @param position The position returned by `allocate()`.
+     * @param extent The extent passed to `allocate()`.
+     */
+    void free(i32x4 position, i32x4 extent) noexcept;
+
+    /** Free all the rectangles of a page.
+     */
+    void clear(ssize_t page_nr) noexcept;
+
+private:
+    /** A horizontal segment of the skyline.
+     */
+    struct segment_type {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct page_type {
+        /** The skyline from left to right, covering the full width of the page.
+         */
+        std::vector<segment_type> skyline;
+
+        std::vector<iaarect> free_rectangles;
+
+        page_statistics statistics;
+    };
+
+    i32x4 _page_extent;
+    ssize_t _max_nr_pages;
+    std::vector<page_type> _pages;
+
+    void add_page() noexcept;
+    [[nodiscard]] std::optional<i32x4> allocate(ssize_t page_nr, i32x4 extent) noexcept;
+    [[nodiscard]] std::optional<i32x4> allocate_free_rectangle(page_type &page, i32x4 extent) noexcept;
+    [[nodiscard]] std::optional<i32x4> allocate_skyline(page_type &page, i32x4 extent) noexcept;
+};
+
+} // namespace tt
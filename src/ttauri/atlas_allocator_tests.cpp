@@ -0,0 +1,201 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/atlas_allocator.hpp"
+#include "ttauri/atlas_cache.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+
+using namespace std;
+using namespace tt;
+
+[[nodiscard]] static bool overlaps(i32x4 lhs_position, i32x4 lhs_extent, i32x4 rhs_position, i32x4 rhs_extent) noexcept
+{
+    if (lhs_position.z() != rhs_position.z()) {
+        return false;
+    }
+    ttlet separate_x = lhs_position.x() >= rhs_position.x() + rhs_extent.x() || rhs_position.x() >= lhs_position.x() + lhs_extent.x();
+    ttlet separate_y = lhs_position.y() >= rhs_position.y() + rhs_extent.y() || rhs_position.y() >= lhs_position.y() + lhs_extent.y();
+    return !(separate_x || separate_y);
+}
+
+TEST(atlas_allocator, grid)
+{
+    // Equal sized rectangles should be packed without any waste.
+    auto allocator = atlas_allocator(i32x4{64, 64}, 2);
+
+    for (int i = 0; i != 32; ++i) {
+        ttlet position = allocator.allocate(i32x4{16, 16});
+        ASSERT_TRUE(position);
+        ASSERT_EQ(position->z(), i / 16);
+    }
+    ASSERT_FALSE(allocator.allocate(i32x4{16, 16}));
+
+    ASSERT_EQ(allocator.nr_pages(), 2);
+    ASSERT_EQ(allocator.statistics(0).nr_allocations, 16);
+    ASSERT_EQ(allocator.statistics(0).used_area, 64 * 64);
+    ASSERT_EQ(allocator.statistics(0).reserved_area, 64 * 64);
+    ASSERT_EQ(allocator.occupancy(0), 1.0f);
+}
+
+TEST(atlas_allocator, reuse)
+{
+    auto allocator = atlas_allocator(i32x4{64, 64}, 1);
+
+    auto positions = std::vector<i32x4>{};
+    for (int i = 0; i != 16; ++i) {
+        positions.push_back(*allocator.allocate(i32x4{16, 16}));
+    }
+    ASSERT_FALSE(allocator.allocate(i32x4{16, 16}));
+
+    // A freed rectangle is reused for a rectangle that fits inside it.
+    allocator.free(positions[5], i32x4{16, 16});
+    ASSERT_EQ(allocator.statistics(0).nr_allocations, 15);
+    ASSERT_FALSE(allocator.allocate(i32x4{17, 16}));
+
+    ttlet small1 = allocator.allocate(i32x4{8, 16});
+    ttlet small2 = allocator.allocate(i32x4{8, 16});
+    ASSERT_TRUE(small1);
+    ASSERT_TRUE(small2);
+    ASSERT_FALSE(overlaps(*small1, i32x4{8, 16}, *small2, i32x4{8, 16}));
+    ASSERT_FALSE(allocator.allocate(i32x4{8, 16}));
+
+    // When all rectangles are freed the page is reclaimed.
+    allocator.free(*small1, i32x4{8, 16});
+    allocator.free(*small2, i32x4{8, 16});
+    for (int i = 0; i != 16; ++i) {
+        if (i != 5) {
+            allocator.free(positions[i], i32x4{16, 16});
+        }
+    }
+    ASSERT_EQ(allocator.statistics(0).nr_allocations, 0);
+    ASSERT_EQ(allocator.statistics(0).reserved_area, 0);
+    ASSERT_TRUE(allocator.allocate(i32x4{64, 64}));
+}
+
+TEST(atlas_allocator, random)
+{
+    auto allocator = atlas_allocator(i32x4{256, 256}, 4);
+    auto engine = std::mt19937{42};
+    auto size_dist = std::uniform_int_distribution<int>{4, 48};
+
+    struct allocation {
+        i32x4 position;
+        i32x4 extent;
+    };
+    auto allocations = std::vector<allocation>{};
+
+    for (int i = 0; i != 2000; ++i) {
+        if (!allocations.empty() && engine() % 3 == 0) {
+            ttlet index = engine() % allocations.size();
+            allocator.free(allocations[index].position, allocations[index].extent);
+            allocations.erase(allocations.begin() + index);
+            continue;
+        }
+
+        ttlet extent = i32x4{size_dist(engine), size_dist(engine)};
+        ttlet position = allocator.allocate(extent);
+        if (!position) {
+            continue;
+        }
+
+        ASSERT_GE(position->x(), 0);
+        ASSERT_GE(position->y(), 0);
+        ASSERT_LE(position->x() + extent.x(), 256);
+        ASSERT_LE(position->y() + extent.y(), 256);
+        for (ttlet &other : allocations) {
+            ASSERT_FALSE(overlaps(*position, extent, other.position, other.extent));
+        }
+        allocations.push_back({*position, extent});
+    }
+
+    for (ssize_t page_nr = 0; page_nr != allocator.nr_pages(); ++page_nr) {
+        ttlet &statistics = allocator.statistics(page_nr);
+        ASSERT_LE(statistics.used_area, statistics.reserved_area);
+        ASSERT_LE(statistics.reserved_area, 256 * 256);
+    }
+}
+
+TEST(atlas_cache, evict_least_recently_used)
+{
+    auto cache = atlas_cache<int, i32x4>(i32x4{64, 64}, 1);
+
+    for (int i = 0; i != 16; ++i) {
+        ASSERT_NE(cache.insert(i, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    }
+
+    // Use all items except 3 and 7 in the next frame.
+    cache.next_frame();
+    for (int i = 0; i != 16; ++i) {
+        if (i != 3 && i != 7) {
+            ASSERT_NE(cache.find(i), nullptr);
+        }
+    }
+
+    // Item 3 or 7 is evicted, not an item used in this frame.
+    ASSERT_NE(cache.insert(16, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    ttlet evicted = cache.take_evicted();
+    ASSERT_EQ(evicted.size(), 1);
+    ASSERT_TRUE(evicted[0] == 3 || evicted[0] == 7);
+    ASSERT_EQ(cache.find(evicted[0]), nullptr);
+
+    ASSERT_NE(cache.insert(17, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    ASSERT_EQ(cache.take_evicted().size(), 1);
+
+    // All items are used in this frame, nothing can be evicted.
+    ASSERT_EQ(cache.insert(18, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    ASSERT_EQ(cache.size(), 16);
+}
+
+TEST(atlas_cache, evict_and_insert_again)
+{
+    auto cache = atlas_cache<int, i32x4>(i32x4{64, 64}, 1);
+
+    for (int i = 0; i != 16; ++i) {
+        ASSERT_NE(cache.insert(i, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    }
+
+    // Item 0 is the only item that was not used in this frame, and is evicted.
+    cache.next_frame();
+    for (int i = 1; i != 16; ++i) {
+        ASSERT_NE(cache.find(i), nullptr);
+    }
+    ASSERT_NE(cache.insert(16, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    ASSERT_EQ(cache.find(0), nullptr);
+
+    // Item 0 is needed again in the same frame, in the space of item 16.
+    cache.erase(16);
+    ASSERT_NE(cache.insert(0, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+
+    // The item is in the cache, so it must not be reported as evicted.
+    ASSERT_TRUE(cache.take_evicted().empty());
+    ASSERT_NE(cache.find(0), nullptr);
+}
+
+TEST(atlas_cache, defragment)
+{
+    auto cache = atlas_cache<int, i32x4>(i32x4{64, 64}, 2);
+
+    for (int i = 0; i != 32; ++i) {
+        ASSERT_NE(cache.insert(i, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    }
+
+    // Leave two items on the second page.
+    for (int i = 16; i != 30; ++i) {
+        cache.erase(i);
+    }
+    ttlet removed = cache.defragment();
+    ASSERT_EQ(removed.size(), 2);
+
+    // The second page is empty again, and the two items can be inserted again.
+    ASSERT_EQ(cache.allocator().statistics(1).nr_allocations, 0);
+    ASSERT_EQ(cache.size(), 16);
+    for (int i = 30; i != 32; ++i) {
+        ASSERT_NE(cache.insert(i, i32x4{16, 16}, [](i32x4 position) { return position; }), nullptr);
+    }
+
+    // Nothing to defragment.
+    ASSERT_TRUE(cache.defragment().empty());
+}
@@ -0,0 +1,210 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "atlas_allocator.hpp"
+#include "counters.hpp"
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+namespace tt {
+
+/** A cache of items stored in a texture atlas.
+ *
+ * When the atlas is full, the least recently used items are evicted. Items that were
+ * used during the current frame are never evicted, since their vertices may already
+ * have been placed.
+ *
+ * @tparam Key The key to find an item.
+ * @tparam T The value stored with an item, for example the texture coordinates.
+ */
+template<typename Key, typename T>
+class atlas_cache {
+public:
+    using key_type = Key;
+    using value_type = T;
+
+    /** Create an atlas cache.
+     *
+     * @param page_extent The width and height of each page of the atlas.
+     * @param max_nr_pages The maximum number of pages of the atlas.
+     */
+    atlas_cache(i32x4 page_extent, ssize_t max_nr_pages) noexcept : _allocator(page_extent, max_nr_pages) {}
+
+    [[nodiscard]] atlas_allocator const &allocator() const noexcept
+    {
+        return _allocator;
+    }
+
+    [[nodiscard]] ssize_t size() const noexcept
+    {
+        return std::ssize(_items);
+    }
+
+    /** Start a new frame.
+     * Items that were used in the previous frames may be evicted from now on.
+     */
+    void next_frame() noexcept
+    {
+        ++_frame;
+    }
+
+    /** Find an item and mark it as used in the current frame.
+     *
+     * @return The value of the item, or nullptr if the item is not in the cache.
+     */
+    [[nodiscard]] value_type const *find(key_type const &key) noexcept
+    {
+        ttlet i = _items.find(key);
+        if (i == _items.end()) {
+            return nullptr;
+        }
+
+        i->second.last_used = _frame;
+        return &i->second.value;
+    }
+
+    /** Allocate space for an item in the atlas and insert it.
+     * When there is no space, least recently used items are evicted until it fits.
+     *
+     * @param key The key of the item, which must not be in the cache.
+     * @param extent The width and height of the item in the atlas.
+     * @param make_value A function to make the value from the position of the item in the atlas.
+     * @return The value of the inserted item, or nullptr if there is no space in the atlas.
+     */
+    template<typename MakeValue>
+    [[nodiscard]] value_type const *insert(key_type const &key, i32x4 extent, MakeValue &&make_value) noexcept
+    {
+        tt_axiom(!_items.contains(key));
+
+        auto position = _allocator.allocate(extent);
+        if (!position) {
+            position = evict_and_allocate(extent);
+        }
+        if (!position) {
+            return nullptr;
+        }
+
+        // An item that is inserted again after it was evicted is no longer reported as evicted.
+        if (!_evicted.empty()) {
+            std::erase(_evicted, key);
+        }
+
+        ttlet [i, inserted] = _items.emplace(
+            key, item_type{std::forward<MakeValue>(make_value)(*position), *position, extent, _frame});
+        return &i->second.value;
+    }
+
+    /** Remove an item.
+     */
+    void erase(key_type const &key) noexcept
+    {
+        ttlet i = _items.find(key);
+        if (i != _items.end()) {
+            _allocator.free(i->second.position, i->second.extent);
+            _items.erase(i);
+        }
+    }
+
+    /** Take the keys of the items that were evicted to make space for new items.
+     * Items that were inserted again after they were evicted are not included.
+     */
+    [[nodiscard]] std::vector<key_type> take_evicted() noexcept
+    {
+        return std::exchange(_evicted, {});
+    }
+
+    /** Clear the page with the lowest occupancy, when the atlas is full and fragmented.
+     *
+     * The atlas is fragmented when all pages are in use, and a page has a low occupancy
+     * but its skyline reserves most of its space. The items on this page are removed, so
+     * that the complete page can be reused. Since the items may have been used in the
+     * current frame, this should be called before any vertices of a frame are placed.
+     *
+     * @param threshold The occupancy below which a page is fragmented.
+     * @return The keys of the removed items, which the caller may insert again.
+     */
+    [[nodiscard]] std::vector<key_type> defragment(float threshold = 0.25f) noexcept
+    {
+        if (_allocator.nr_pages() < _allocator.max_nr_pages()) {
+            return {};
+        }
+
+        ttlet page_area = _allocator.page_extent().x() * _allocator.page_extent().y();
+
+        auto page_nr = ssize_t{-1};
+        auto lowest_occupancy = threshold;
+        for (ssize_t i = 0; i != _allocator.nr_pages(); ++i) {
+            ttlet occupancy = _allocator.occupancy(i);
+            ttlet reserved = _allocator.statistics(i).reserved_area;
+            if (occupancy < lowest_occupancy && reserved > page_area - page_area / 4) {
+                page_nr = i;
+                lowest_occupancy = occupancy;
+            }
+        }
+
+        auto r = std::vector<key_type>{};
+        if (page_nr < 0) {
+            return r;
+        }
+
+        for (auto i = _items.begin(); i != _items.end();) {
+            if (i->second.position.z() == page_nr) {
+                r.push_back(i->first);
+                i = _items.erase(i);
+            } else {
+                ++i;
+            }
+        }
+        _allocator.clear(page_nr);
+
+        increment_counter<"atlas_defragment">();
+        return r;
+    }
+
+private:
+    struct item_type {
+        value_type value;
+        i32x4 position;
+        i32x4 extent;
+        uint64_t last_used;
+    };
+
+    atlas_allocator _allocator;
+    std::unordered_map<key_type, item_type> _items;
+    std::vector<key_type> _evicted;
+    uint64_t _frame = 0;
+
+    [[nodiscard]] std::optional<i32x4> evict_and_allocate(i32x4 extent) noexcept
+    {
+        using iterator = typename std::unordered_map<key_type, item_type>::iterator;
+
+        auto candidates = std::vector<iterator>{};
+        for (auto i = _items.begin(); i != _items.end(); ++i) {
+            if (i->second.last_used != _frame) {
+                candidates.push_back(i);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](ttlet &lhs, ttlet &rhs) {
+            return lhs->second.last_used < rhs->second.last_used;
+        });
+
+        for (ttlet i : candidates) {
+            _allocator.free(i->second.position, i->second.extent);
+            _evicted.push_back(i->first);
+            _items.erase(i);
+            increment_counter<"atlas_evict">();
+
+            if (auto position = _allocator.allocate(extent)) {
+                return position;
+            }
+        }
+        return {};
+    }
+};
+
+} // namespace tt
@@ -405,7 +405,7 @@ static void bad_pixels_horizontally(pixel_map<sdf_r8> &image) noexcept
 }
 
 
-void fill(pixel_map<sdf_r8> &image, std::vector<bezier_curve> const &curves) noexcept
+void fill_reference(pixel_map<sdf_r8> &image, std::vector<bezier_curve> const &curves) noexcept
 {
     for (int row_nr = 0; row_nr != image.height(); ++row_nr) {
         auto row = image.at(row_nr);
@@ -432,4 +432,173 @@ void fill(pixel_map<sdf_r8> &image, std::vector<bezier_curve> const &curves) noe
     }
 }
 
+/** The maximum distance in pixels between a curve and the line segments it is flattened into.
+ * This is less than the precision of a sdf_r8 pixel.
+ */
+constexpr float sdf_flatness_tolerance = 0.01f;
+
+/** Flatten a curve into line segments for calculating a signed distance field.
+ */
+static void flatten_for_sdf(bezier_curve const &curve, std::vector<bezier_curve> &r, int depth = 0) noexcept
+{
+    // The maximum distance between a curve and the line between its end points.
+    float deviation = 0.0f;
+    switch (curve.type) {
+    case bezier_curve::Type::Linear: r.push_back(curve); return;
+    case bezier_curve::Type::Quadratic:
+        deviation = 0.25f *
+            std::hypot(curve.P1.x() - 2.0f * curve.C1.x() + curve.P2.x(), curve.P1.y() - 2.0f * curve.C1.y() + curve.P2.y());
+        break;
+    case bezier_curve::Type::Cubic:
+        deviation = 0.75f *
+            std::max(
+                std::hypot(curve.P1.x() - 2.0f * curve.C1.x() + curve.C2.x(), curve.P1.y() - 2.0f * curve.C1.y() + curve.C2.y()),
+                std::hypot(curve.C1.x() - 2.0f * curve.C2.x() + curve.P2.x(), curve.C1.y() - 2.0f * curve.C2.y() + curve.P2.y()));
+        break;
+    default: tt_no_default();
+    }
+
+    // Each split divides the deviation by four, the depth limit protects against NaN.
+    if (deviation <= sdf_flatness_tolerance || depth == 16) {
+        r.emplace_back(curve.P1, curve.P2);
+    } else {
+        ttlet[a, b] = curve.split(0.5f);
+        flatten_for_sdf(a, r, depth + 1);
+        flatten_for_sdf(b, r, depth + 1);
+    }
+}
+
+/** Find the spans inside the glyph at a row of pixels.
+ * The row is sampled slightly above the pixels, so that horizontal edges and anchor
+ * points exactly on the row do not confuse the even-odd rule. This may only flip the sign
+ * of pixels closer to the contour than the precision of a sdf_r8.
+ */
+[[nodiscard]] static std::optional<std::vector<std::pair<float, float>>>
+get_sdf_spans_at_y(std::vector<bezier_curve> const &curves, float y) noexcept
+{
+    constexpr float epsilon = 1.0f / 128.0f;
+
+    if (auto spans = getFillSpansAtY(curves, y + epsilon)) {
+        return spans;
+    } else {
+        return getFillSpansAtY(curves, y - epsilon);
+    }
+}
+
+void fill(pixel_map<sdf_r8> &image, std::vector<bezier_curve> const &curves) noexcept
+{
+    using block_type = f32x8;
+    constexpr ssize_t block_size = 8;
+    constexpr float max_distance = sdf_r8::max_distance;
+    constexpr float square_max_distance = max_distance * max_distance;
+
+    ttlet width = image.width();
+    ttlet height = image.height();
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    auto lines = std::vector<bezier_curve>{};
+    for (ttlet &curve : curves) {
+        flatten_for_sdf(curve, lines);
+    }
+
+    // The rows of pixels which are within max_distance of a line.
+    ttlet line_rows = [&](bezier_curve const &line) {
+        ttlet first = static_cast<ssize_t>(std::ceil(std::min(line.P1.y(), line.P2.y()) - max_distance));
+        ttlet last = static_cast<ssize_t>(std::floor(std::max(line.P1.y(), line.P2.y()) + max_distance)) + 1;
+        return std::pair{std::clamp(first, ssize_t{0}, height), std::clamp(last, ssize_t{0}, height)};
+    };
+
+    // Bucket the lines by row; the lines near row `y` are `bucket[bucket_offsets[y]]` up to `bucket[bucket_offsets[y + 1]]`.
+    auto bucket_offsets = std::vector<ssize_t>(height + 1, 0);
+    for (ttlet &line : lines) {
+        ttlet[first_row, last_row] = line_rows(line);
+        for (auto row_nr = first_row; row_nr < last_row; ++row_nr) {
+            ++bucket_offsets[row_nr + 1];
+        }
+    }
+    for (ssize_t row_nr = 0; row_nr != height; ++row_nr) {
+        bucket_offsets[row_nr + 1] += bucket_offsets[row_nr];
+    }
+    auto bucket = std::vector<bezier_curve const *>(bucket_offsets.back(), nullptr);
+    {
+        auto bucket_ends = bucket_offsets;
+        for (ttlet &line : lines) {
+            ttlet[first_row, last_row] = line_rows(line);
+            for (auto row_nr = first_row; row_nr < last_row; ++row_nr) {
+                bucket[bucket_ends[row_nr]++] = &line;
+            }
+        }
+    }
+
+    ttlet nr_blocks = (width + block_size - 1) / block_size;
+    auto square_distances = std::vector<block_type>(nr_blocks);
+
+    auto block_x = block_type{};
+    for (ssize_t i = 0; i != block_size; ++i) {
+        block_x[i] = static_cast<float>(i);
+    }
+
+    for (ssize_t row_nr = 0; row_nr != height; ++row_nr) {
+        auto row = image[row_nr];
+        ttlet y = static_cast<float>(row_nr);
+
+        ttlet spans = get_sdf_spans_at_y(curves, y);
+        if (!spans) {
+            // The row could not be solved, calculate the distance and sign from each curve.
+            for (ssize_t column_nr = 0; column_nr != width; ++column_nr) {
+                row[column_nr] = generate_sdf_r8_pixel(point2(static_cast<float>(column_nr), y), curves);
+            }
+            continue;
+        }
+
+        // Only the pixels within max_distance of a line are calculated, the rest stay at max_distance.
+        std::fill(square_distances.begin(), square_distances.end(), block_type::broadcast(square_max_distance));
+        for (auto i = bucket_offsets[row_nr]; i != bucket_offsets[row_nr + 1]; ++i) {
+            ttlet &line = *bucket[i];
+
+            ttlet dx = line.P2.x() - line.P1.x();
+            ttlet dy = line.P2.y() - line.P1.y();
+            ttlet square_length = dx * dx + dy * dy;
+            if (square_length == 0.0f) {
+                continue;
+            }
+            ttlet rcp_square_length = 1.0f / square_length;
+
+            ttlet first_x = std::min(line.P1.x(), line.P2.x()) - max_distance;
+            ttlet last_x = std::max(line.P1.x(), line.P2.x()) + max_distance;
+            ttlet first_block = std::clamp(static_cast<ssize_t>(std::floor(first_x)) / block_size, ssize_t{0}, nr_blocks);
+            ttlet last_block = std::clamp(static_cast<ssize_t>(std::ceil(last_x)) / block_size + 1, ssize_t{0}, nr_blocks);
+
+            // The vector from the start of the line to the pixels.
+            ttlet py = block_type::broadcast(y - line.P1.y());
+            auto px = block_x + (static_cast<float>(first_block * block_size) - line.P1.x());
+
+            for (auto block_nr = first_block; block_nr < last_block; ++block_nr, px = px + static_cast<float>(block_size)) {
+                ttlet t = clamp((px * dx + py * dy) * rcp_square_length, block_type::broadcast(0.0f), block_type::broadcast(1.0f));
+                ttlet nx = px - t * dx;
+                ttlet ny = py - t * dy;
+
+                auto &square_distance = square_distances[block_nr];
+                square_distance = min(square_distance, nx * nx + ny * ny);
+            }
+        }
+
+        // Pixels inside the glyph have a positive distance.
+        auto span_it = spans->cbegin();
+        ttlet span_end = spans->cend();
+        for (ssize_t column_nr = 0; column_nr != width; ++column_nr) {
+            ttlet x = static_cast<float>(column_nr);
+            while (span_it != span_end && span_it->second < x) {
+                ++span_it;
+            }
+            ttlet inside = span_it != span_end && span_it->first <= x;
+
+            ttlet distance = std::sqrt(square_distances[column_nr / block_size][column_nr % block_size]);
+            row[column_nr] = inside ? distance : -distance;
+        }
+    }
+}
+
 }
@@ -353,9 +353,22 @@ makeContourFromPoints(std::vector<bezier_point>::const_iterator first, std::vect
 void fill(pixel_map<uint8_t> &image, std::vector<bezier_curve> const &curves) noexcept;
 
 /** Fill a signed distance field image from the given contour.
+ * The curves are flattened into line segments, and for each row of pixels only the
+ * segments within `sdf_r8::max_distance` are used. Whether a pixel is inside the
+ * contour is determined by the even-odd rule on the row.
+ *
  * @param image An signed-distance-field which show distance toward the closest curve
  * @param curves All curves of path, in no particular order.
  */
 void fill(pixel_map<sdf_r8> &image, std::vector<bezier_curve> const &curves) noexcept;
 
+/** Fill a signed distance field image from the given contour.
+ * The distance from each pixel to every curve is calculated, after which pixels with the
+ * wrong sign are repaired. This is much slower than `fill()` and is used to verify it.
+ *
+ * @param image An signed-distance-field which show distance toward the closest curve
+ * @param curves All curves of path, in no particular order.
+ */
+void fill_reference(pixel_map<sdf_r8> &image, std::vector<bezier_curve> const &curves) noexcept;
+
 } // namespace tt
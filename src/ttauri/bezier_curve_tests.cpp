@@ -3,10 +3,15 @@
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "ttauri/bezier_curve.hpp"
+#include "ttauri/graphic_path.hpp"
 #include "ttauri/polynomial_tests.hpp"
+#include "ttauri/text/font_book.hpp"
+#include "ttauri/URL.hpp"
 #include <gtest/gtest.h>
+#include <fmt/format.h>
 #include <iostream>
 #include <string>
+#include <chrono>
 
 using namespace std;
 using namespace tt;
@@ -17,3 +22,141 @@ TEST(bezier_cruve, solve_x_by_y) {
     ASSERT_RESULTS(bezier_curve(point2(2.0f,2.0f), point2(1.5f,2.0f), point2(1.0f,2.0f)).solveXByY(1.5f), tt::results3());
     ASSERT_RESULTS(bezier_curve(point2(1.0f,2.0f), point2(1.0f,1.5f), point2(1.0f,1.0f)).solveXByY(1.5f), tt::results3(1.0f));
 }
+
+/** Compare the signed distance field of `fill()` with `fill_reference()`.
+ * @return The number of pixels compared, and the number of pixels that differ more than the tolerance.
+ */
+static std::pair<ssize_t, ssize_t> compare_sdf(pixel_map<sdf_r8> const &image, pixel_map<sdf_r8> const &reference)
+{
+    // A tenth of a pixel, four steps of a sdf_r8.
+    constexpr float tolerance = 0.1f;
+
+    ssize_t nr_different = 0;
+    for (ssize_t y = 0; y != image.height(); ++y) {
+        for (ssize_t x = 0; x != image.width(); ++x) {
+            if (std::abs(static_cast<float>(image[y][x]) - static_cast<float>(reference[y][x])) > tolerance) {
+                ++nr_different;
+            }
+        }
+    }
+    return {image.width() * image.height(), nr_different};
+}
+
+TEST(bezier_curve, fill_sdf)
+{
+    // Clockwise contours, like the outer contours of a TrueType glyph.
+    auto path = graphic_path{};
+    path.moveTo(point2{5.0f, 5.0f});
+    path.lineTo(point2{5.0f, 25.0f});
+    path.quadraticCurveTo(point2{20.0f, 45.0f}, point2{35.0f, 25.0f});
+    path.lineTo(point2{35.0f, 5.0f});
+    path.closeContour();
+    path.moveTo(point2{38.0f, 5.0f});
+    path.lineTo(point2{38.0f, 35.0f});
+    path.lineTo(point2{44.0f, 35.0f});
+    path.lineTo(point2{44.0f, 5.0f});
+    path.closeContour();
+    ttlet curves = path.getBeziers();
+
+    auto image = pixel_map<sdf_r8>(48, 40);
+    auto reference = pixel_map<sdf_r8>(48, 40);
+    fill(image, curves);
+    fill_reference(reference, curves);
+
+    ttlet[nr_pixels, nr_different] = compare_sdf(image, reference);
+    ASSERT_EQ(nr_different, 0);
+
+    // Inside the bowl, outside the shapes, on the edge of the bowl, and inside the rectangle.
+    ASSERT_EQ(static_cast<float>(image[20][20]), sdf_r8::max_distance);
+    ASSERT_EQ(static_cast<float>(image[0][0]), -sdf_r8::max_distance);
+    ASSERT_NEAR(static_cast<float>(image[20][5]), 0.0f, 0.05f);
+    ASSERT_NEAR(static_cast<float>(image[20][39]), 1.0f, 0.05f);
+}
+
+/** Draw every glyph of a font into a signed distance field, in the same way as the glyph atlas.
+ */
+TEST(bezier_curve, fill_sdf_benchmark)
+{
+    // Same as the pipeline_SDF's drawfontSize.
+    constexpr float draw_font_size = 28.0f;
+    constexpr float draw_border = sdf_r8::max_distance;
+
+    font_book::global = std::make_unique<font_book>(std::vector<URL>{URL::urlFromSystemfontDirectory()});
+    ttlet font_id = font_book::global->find_font("sans-serif", font_weight::Regular, false);
+    ttlet &font = font_book::global->get_font(font_id);
+
+    auto glyph_ids = std::vector<glyph_id>{};
+    for (char32_t c = 0; c != 0x1'0000; ++c) {
+        if (ttlet id = font.find_glyph(c)) {
+            glyph_ids.push_back(id);
+        }
+    }
+    std::sort(glyph_ids.begin(), glyph_ids.end());
+    glyph_ids.erase(std::unique(glyph_ids.begin(), glyph_ids.end()), glyph_ids.end());
+
+    auto glyphs = std::vector<std::pair<std::vector<bezier_curve>, i32x4>>{};
+    for (ttlet id : glyph_ids) {
+        auto path = graphic_path{};
+        auto metrics = glyph_metrics{};
+        if (!font.loadGlyph(id, path) || !font.loadglyph_metrics(id, metrics)) {
+            continue;
+        }
+
+        // Skip glyphs with a contour of a single point, which can not be converted to curves.
+        ttlet is_degenerate = [&] {
+            for (ssize_t i = 0; i != path.numberOfContours(); ++i) {
+                if (path.endContour(i) - path.beginContour(i) < 2) {
+                    return true;
+                }
+            }
+            return false;
+        }();
+        if (is_degenerate) {
+            continue;
+        }
+
+        ttlet bounding_box = scale2{draw_font_size, draw_font_size} * metrics.boundingBox;
+        ttlet offset = f32x4{draw_border, draw_border} - bounding_box.offset();
+        ttlet extent = bounding_box.extent() + 2.0f * f32x4{draw_border, draw_border};
+        ttlet draw_path = (translate2{offset} * scale2{draw_font_size, draw_font_size}) * path;
+
+        glyphs.emplace_back(draw_path.getBeziers(), static_cast<i32x4>(ceil(extent)));
+    }
+
+    using duration = std::chrono::steady_clock::duration;
+    auto fill_duration = duration{};
+    auto reference_duration = duration{};
+    ssize_t total_nr_pixels = 0;
+    ssize_t total_nr_different = 0;
+    for (ttlet &[curves, extent] : glyphs) {
+        auto image = pixel_map<sdf_r8>(extent);
+        auto reference = pixel_map<sdf_r8>(extent);
+
+        ttlet t0 = std::chrono::steady_clock::now();
+        fill(image, curves);
+        ttlet t1 = std::chrono::steady_clock::now();
+        fill_reference(reference, curves);
+        ttlet t2 = std::chrono::steady_clock::now();
+
+        fill_duration += t1 - t0;
+        reference_duration += t2 - t1;
+
+        ttlet[nr_pixels, nr_different] = compare_sdf(image, reference);
+        total_nr_pixels += nr_pixels;
+        total_nr_different += nr_different;
+    }
+
+    font_book::global = {};
+
+    std::cout << fmt::format(
+        "SDF of {} glyphs, fill: {:.1f} ms, fill_reference: {:.1f} ms, {} of {} pixels differ\n",
+        std::ssize(glyphs),
+        std::chrono::duration<double, std::milli>(fill_duration).count(),
+        std::chrono::duration<double, std::milli>(reference_duration).count(),
+        total_nr_different,
+        total_nr_pixels);
+
+    // The reference implementation repairs the sign of pixels heuristically, and
+    // does not always succeed near sharp corners.
+    ASSERT_LE(total_nr_different, total_nr_pixels / 1000);
+}
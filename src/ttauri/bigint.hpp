@@ -11,6 +11,9 @@
 #include <fmt/format.h>
 #include <type_traits>
 #include <ostream>
+#include <array>
+#include <bit>
+#include <algorithm>
 
 namespace tt {
 
@@ -23,6 +26,328 @@ namespace tt {
 //template<typename T, int N, typename U>
 //constexpr bigint<T,N> bigint_reciprocal(U const &divider);
 
+namespace detail {
+
+/** Below this number of digits multiplication is done with the schoolbook algorithm.
+ * Above it, the Karatsuba algorithm is used. Tuned for 64-bit digits.
+ */
+constexpr int bigint_karatsuba_threshold = 32;
+
+/** Multiply digits with a single digit, and add the product to the result.
+ * r[0..n) += a[0..n) * b
+ *
+ * @return The carry digit.
+ */
+template<typename T>
+[[nodiscard]] T bigint_multiply_add_digit(T *r, T const *a, int n, T b) noexcept
+{
+#if TT_PROCESSOR == TT_CPU_X64 && defined(__BMI2__) && defined(__ADX__)
+    if constexpr (sizeof(T) == 8) {
+        // mulx does not touch the flags, so that the low halves of the products and the
+        // high halves of the previous products are added with two independent carry chains.
+        unsigned char carry_lo = 0;
+        unsigned char carry_hi = 0;
+        unsigned long long previous_hi = 0;
+        for (int i = 0; i != n; ++i) {
+            unsigned long long hi;
+            ttlet lo = _mulx_u64(a[i], b, &hi);
+
+            unsigned long long tmp;
+            carry_lo = _addcarryx_u64(carry_lo, r[i], lo, &tmp);
+            carry_hi = _addcarryx_u64(carry_hi, tmp, previous_hi, &tmp);
+            r[i] = tmp;
+            previous_hi = hi;
+        }
+        // The high half of a product is at most 2^64 - 2, so this can not overflow.
+        return static_cast<T>(previous_hi + carry_lo + carry_hi);
+    }
+#endif
+
+    T carry = 0;
+    for (int i = 0; i != n; ++i) {
+        std::tie(r[i], carry) = multiply_carry(a[i], b, carry, r[i]);
+    }
+    return carry;
+}
+
+/** Multiply digits with a single digit, and subtract the product from the result.
+ * r[0..n) -= a[0..n) * b
+ *
+ * @return The digit to subtract from r[n].
+ */
+template<typename T>
+[[nodiscard]] T bigint_multiply_subtract_digit(T *r, T const *a, int n, T b) noexcept
+{
+    T carry = 0;
+    for (int i = 0; i != n; ++i) {
+        ttlet [lo, hi] = multiply_carry(a[i], b, carry);
+        ttlet tmp = static_cast<T>(r[i] - lo);
+        carry = static_cast<T>(hi + (tmp > r[i] ? 1 : 0));
+        r[i] = tmp;
+    }
+    return carry;
+}
+
+/** r[0..n) = a[0..n) + b[0..n)
+ * @return The carry.
+ */
+template<typename T>
+T bigint_add_digits(T *r, T const *a, T const *b, int n) noexcept
+{
+    T carry = 0;
+    for (int i = 0; i != n; ++i) {
+        std::tie(r[i], carry) = add_carry(a[i], b[i], carry);
+    }
+    return carry;
+}
+
+/** r[0..n) = a[0..n) - b[0..n)
+ * @return The borrow.
+ */
+template<typename T>
+T bigint_subtract_digits(T *r, T const *a, T const *b, int n) noexcept
+{
+    T borrow = 0;
+    for (int i = 0; i != n; ++i) {
+        ttlet tmp = static_cast<T>(a[i] - b[i]);
+        ttlet tmp2 = static_cast<T>(tmp - borrow);
+        borrow = (tmp > a[i] ? 1 : 0) | (tmp2 > tmp ? 1 : 0);
+        r[i] = tmp2;
+    }
+    return borrow;
+}
+
+/** r[0..n) += carry
+ * @return The carry out of the top digit.
+ */
+template<typename T>
+T bigint_propagate_carry(T *r, int n, T carry) noexcept
+{
+    for (int i = 0; i != n && carry != 0; ++i) {
+        std::tie(r[i], carry) = add_carry(r[i], T{0}, carry);
+    }
+    return carry;
+}
+
+/** The number of scratch digits needed by `bigint_multiply_full()`.
+ */
+[[nodiscard]] constexpr int bigint_multiply_full_scratch_size(int n) noexcept
+{
+    if (n < bigint_karatsuba_threshold) {
+        return 0;
+    }
+    ttlet k = n - n / 2;
+    return 4 * k + 1 + bigint_multiply_full_scratch_size(k);
+}
+
+/** The full product of two numbers of equal size.
+ * r[0..2n) = a[0..n) * b[0..n)
+ *
+ * @param scratch Temporary digits, at least `bigint_multiply_full_scratch_size(n)`.
+ */
+template<typename T>
+void bigint_multiply_full(T *r, T const *a, T const *b, int n, T *scratch) noexcept
+{
+    if (n < bigint_karatsuba_threshold) {
+        std::fill_n(r, 2 * n, T{0});
+        for (int i = 0; i != n; ++i) {
+            r[i + n] = bigint_multiply_add_digit(r + i, a, n, b[i]);
+        }
+        return;
+    }
+
+    // Split the numbers in a low half of h digits and a high half of k digits.
+    // a * b = z2 * B^2h + z1 * B^h + z0, with z1 = (a0 + a1)(b0 + b1) - z2 - z0
+    ttlet h = n / 2;
+    ttlet k = n - h;
+
+    bigint_multiply_full(r, a, b, h, scratch);
+    bigint_multiply_full(r + 2 * h, a + h, b + h, k, scratch);
+
+    auto a_sum = scratch;
+    auto b_sum = a_sum + k;
+    auto z1 = b_sum + k;
+
+    auto a_carry = bigint_add_digits(a_sum, a + h, a, h);
+    std::copy_n(a + 2 * h, k - h, a_sum + h);
+    a_carry = bigint_propagate_carry(a_sum + h, k - h, a_carry);
+
+    auto b_carry = bigint_add_digits(b_sum, b + h, b, h);
+    std::copy_n(b + 2 * h, k - h, b_sum + h);
+    b_carry = bigint_propagate_carry(b_sum + h, k - h, b_carry);
+
+    // The sums may have overflowed into an extra digit; add the cross products of those carries.
+    bigint_multiply_full(z1, a_sum, b_sum, k, z1 + 2 * k + 1);
+    z1[2 * k] = a_carry & b_carry;
+    if (a_carry) {
+        z1[2 * k] += bigint_add_digits(z1 + k, z1 + k, b_sum, k);
+    }
+    if (b_carry) {
+        z1[2 * k] += bigint_add_digits(z1 + k, z1 + k, a_sum, k);
+    }
+
+    // z1 -= z0 + z2
+    auto borrow = bigint_subtract_digits(z1, z1, r, 2 * h);
+    for (int i = 2 * h; i != 2 * k + 1 && borrow != 0; ++i) {
+        borrow = z1[i]-- == 0 ? 1 : 0;
+    }
+    borrow = bigint_subtract_digits(z1, z1, r + 2 * h, 2 * k);
+    z1[2 * k] -= borrow;
+
+    ttlet carry = bigint_add_digits(r + h, r + h, z1, 2 * k + 1);
+    bigint_propagate_carry(r + h + 2 * k + 1, n - k - 1, carry);
+}
+
+/** The number of scratch digits needed by `bigint_multiply_low()`.
+ */
+[[nodiscard]] constexpr int bigint_multiply_low_scratch_size(int n) noexcept
+{
+    if (n < bigint_karatsuba_threshold) {
+        return 0;
+    }
+    ttlet h = n - n / 2;
+    ttlet k = n - h;
+    return std::max(2 * h + bigint_multiply_full_scratch_size(h), k + bigint_multiply_low_scratch_size(k));
+}
+
+/** The low half of the product of two numbers of equal size.
+ * r[0..n) = a[0..n) * b[0..n) mod B^n
+ *
+ * @param scratch Temporary digits, at least `bigint_multiply_low_scratch_size(n)`.
+ */
+template<typename T>
+void bigint_multiply_low(T *r, T const *a, T const *b, int n, T *scratch) noexcept
+{
+    if (n < bigint_karatsuba_threshold) {
+        std::fill_n(r, n, T{0});
+        for (int i = 0; i != n; ++i) {
+            [[maybe_unused]] ttlet carry = bigint_multiply_add_digit(r + i, a, n - i, b[i]);
+        }
+        return;
+    }
+
+    // Only the low k digits of the cross products a1 * b0 and a0 * b1 contribute.
+    ttlet h = n - n / 2;
+    ttlet k = n - h;
+
+    bigint_multiply_full(scratch, a, b, h, scratch + 2 * h);
+    std::copy_n(scratch, n, r);
+
+    bigint_multiply_low(scratch, a + h, b, k, scratch + k);
+    bigint_add_digits(r + h, r + h, scratch, k);
+    bigint_multiply_low(scratch, a, b + h, k, scratch + k);
+    bigint_add_digits(r + h, r + h, scratch, k);
+}
+
+/** Divide two numbers using Knuth's algorithm D.
+ * q[0..n) = u[0..n) / v[0..n)
+ * r[0..n) = u[0..n) % v[0..n)
+ *
+ * @param scratch Temporary digits, at least 2 * n + 1.
+ */
+template<typename T>
+void bigint_divide(T *q, T *r, T const *u, T const *v, int n, T *scratch) noexcept
+{
+    constexpr int bits_per_digit = sizeof(T) * 8;
+
+    auto nr_v_digits = n;
+    while (nr_v_digits > 0 && v[nr_v_digits - 1] == 0) {
+        --nr_v_digits;
+    }
+    tt_axiom(nr_v_digits > 0);
+
+    auto nr_u_digits = n;
+    while (nr_u_digits > 0 && u[nr_u_digits - 1] == 0) {
+        --nr_u_digits;
+    }
+
+    std::fill_n(q, n, T{0});
+    std::fill_n(r, n, T{0});
+
+    if (nr_u_digits < nr_v_digits) {
+        std::copy_n(u, n, r);
+        return;
+    }
+
+    if (nr_v_digits == 1) {
+        T remainder = 0;
+        for (int i = nr_u_digits - 1; i >= 0; --i) {
+            std::tie(q[i], remainder) = wide_divide(remainder, u[i], v[0]);
+        }
+        r[0] = remainder;
+        return;
+    }
+
+    // Normalize, so that the most significant bit of the divisor is set.
+    ttlet shift = std::countl_zero(v[nr_v_digits - 1]);
+    auto vn = scratch;
+    auto un = scratch + nr_v_digits;
+    if (shift == 0) {
+        std::copy_n(v, nr_v_digits, vn);
+        std::copy_n(u, nr_u_digits, un);
+        un[nr_u_digits] = 0;
+    } else {
+        for (int i = nr_v_digits - 1; i > 0; --i) {
+            vn[i] = static_cast<T>((v[i] << shift) | (v[i - 1] >> (bits_per_digit - shift)));
+        }
+        vn[0] = static_cast<T>(v[0] << shift);
+
+        un[nr_u_digits] = static_cast<T>(u[nr_u_digits - 1] >> (bits_per_digit - shift));
+        for (int i = nr_u_digits - 1; i > 0; --i) {
+            un[i] = static_cast<T>((u[i] << shift) | (u[i - 1] >> (bits_per_digit - shift)));
+        }
+        un[0] = static_cast<T>(u[0] << shift);
+    }
+
+    ttlet v_top = vn[nr_v_digits - 1];
+    ttlet v_next = vn[nr_v_digits - 2];
+    for (int j = nr_u_digits - nr_v_digits; j >= 0; --j) {
+        // Estimate the quotient digit from the top two digits of the remainder and the top digit of
+        // the divisor; after the correction with the next digit it is at most one too large.
+        T q_hat;
+        T r_hat;
+        bool r_hat_overflow = false;
+        if (un[j + nr_v_digits] >= v_top) {
+            q_hat = ~T{0};
+            std::tie(r_hat, r_hat_overflow) = add_carry(un[j + nr_v_digits - 1], v_top);
+        } else {
+            std::tie(q_hat, r_hat) = wide_divide(un[j + nr_v_digits], un[j + nr_v_digits - 1], v_top);
+        }
+
+        while (!r_hat_overflow) {
+            ttlet [product_lo, product_hi] = wide_multiply(q_hat, v_next);
+            if (product_hi < r_hat || (product_hi == r_hat && product_lo <= un[j + nr_v_digits - 2])) {
+                break;
+            }
+            --q_hat;
+            std::tie(r_hat, r_hat_overflow) = add_carry(r_hat, v_top);
+        }
+
+        ttlet borrow = bigint_multiply_subtract_digit(un + j, vn, nr_v_digits, q_hat);
+        ttlet top = un[j + nr_v_digits];
+        un[j + nr_v_digits] = top - borrow;
+        if (top < borrow) {
+            // The estimate was one too large, add the divisor back.
+            [[unlikely]] --q_hat;
+            un[j + nr_v_digits] += bigint_add_digits(un + j, un + j, vn, nr_v_digits);
+        }
+
+        q[j] = q_hat;
+    }
+
+    // Unnormalize the remainder.
+    if (shift == 0) {
+        std::copy_n(un, nr_v_digits, r);
+    } else {
+        for (int i = 0; i != nr_v_digits - 1; ++i) {
+            r[i] = static_cast<T>((un[i] >> shift) | (un[i + 1] << (bits_per_digit - shift)));
+        }
+        r[nr_v_digits - 1] = static_cast<T>(un[nr_v_digits - 1] >> shift);
+    }
+}
+
+} // namespace detail
+
 /*! High performance big integer implementation.
  * The bigint is a fixed width integer which will allow the compiler
  * to make aggressive optimizations, unrolling most loops and easy inlining.
@@ -283,31 +608,36 @@ struct bigint {
 
     friend void bigint_multiply(bigint &o, bigint const &lhs, bigint const &rhs) noexcept
     {
-        for (auto rhs_index = 0; rhs_index < N; rhs_index++) {
-            ttlet rhs_digit = rhs.digits[rhs_index];
+        // The truncated product skips half of the work of the schoolbook algorithm, so Karatsuba
+        // only pays off for twice the number of digits than for the full product.
+        if constexpr (N >= 2 * detail::bigint_karatsuba_threshold) {
+            bigint product;
+            std::array<T, detail::bigint_multiply_low_scratch_size(N)> scratch;
+            detail::bigint_multiply_low(product.digits.data(), lhs.digits.data(), rhs.digits.data(), N, scratch.data());
+            bigint_add(o, o, product);
 
-            T carry = 0;
-            for (auto lhs_index = 0; (lhs_index + rhs_index) < N; lhs_index++) {
-                ttlet lhs_digit = lhs.digits[lhs_index];
-
-                T result;
-                T accumulator = o.digits[rhs_index + lhs_index];
-                std::tie(result, carry) = multiply_carry(lhs_digit, rhs_digit, carry, accumulator);
-                o.digits[rhs_index + lhs_index] = result;
+        } else {
+            for (auto rhs_index = 0; rhs_index < N; rhs_index++) {
+                ttlet rhs_digit = rhs.digits[rhs_index];
+
+                T carry = 0;
+                for (auto lhs_index = 0; (lhs_index + rhs_index) < N; lhs_index++) {
+                    ttlet lhs_digit = lhs.digits[lhs_index];
+
+                    T result;
+                    T accumulator = o.digits[rhs_index + lhs_index];
+                    std::tie(result, carry) = multiply_carry(lhs_digit, rhs_digit, carry, accumulator);
+                    o.digits[rhs_index + lhs_index] = result;
+                }
             }
         }
     }
 
     friend void bigint_div(bigint &quotient, bigint &remainder, bigint const &lhs, bigint const &rhs) noexcept
     {
-        for (auto i = nr_bits - 1; i >= 0; i--) {
-            remainder <<= 1;
-            remainder |= lhs.get_bit(i);
-            if (remainder >= rhs) {
-                remainder -= rhs;
-                quotient.set_bit(i);
-            }
-        }
+        std::array<T, 2 * N + 1> scratch;
+        detail::bigint_divide(
+            quotient.digits.data(), remainder.digits.data(), lhs.digits.data(), rhs.digits.data(), N, scratch.data());
     }
 
     friend void bigint_div(bigint &r_quotient, bigint &r_remainder, bigint const &lhs, bigint const &rhs, bigint<T,2*N> const &rhs_reciprocal) noexcept
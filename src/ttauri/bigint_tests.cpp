@@ -3,10 +3,14 @@
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "ttauri/bigint.hpp"
+#include <fmt/format.h>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <string>
 #include <array>
+#include <random>
+#include <chrono>
+#include <utility>
 
 using namespace std;
 using namespace tt;
@@ -206,4 +210,181 @@ TEST(BigInt, Default) {
         ASSERT_EQ(t, u);
     }
 
-}
\ No newline at end of file
+}
+
+/** The original schoolbook multiplication, as a reference.
+ */
+template<typename T, int N>
+static bigint<T, N> reference_multiply(bigint<T, N> const &lhs, bigint<T, N> const &rhs) noexcept
+{
+    auto o = bigint<T, N>{0};
+    for (auto rhs_index = 0; rhs_index < N; rhs_index++) {
+        T carry = 0;
+        for (auto lhs_index = 0; (lhs_index + rhs_index) < N; lhs_index++) {
+            std::tie(o.digits[rhs_index + lhs_index], carry) =
+                multiply_carry(lhs.digits[lhs_index], rhs.digits[rhs_index], carry, o.digits[rhs_index + lhs_index]);
+        }
+    }
+    return o;
+}
+
+/** The original bit-serial long division, as a reference.
+ */
+template<typename T, int N>
+static std::pair<bigint<T, N>, bigint<T, N>> reference_div(bigint<T, N> const &lhs, bigint<T, N> const &rhs) noexcept
+{
+    auto quotient = bigint<T, N>{0};
+    auto remainder = bigint<T, N>{0};
+    for (auto i = bigint<T, N>::nr_bits - 1; i >= 0; i--) {
+        remainder <<= 1;
+        remainder |= lhs.get_bit(i);
+        if (remainder >= rhs) {
+            remainder -= rhs;
+            quotient.set_bit(i);
+        }
+    }
+    return {quotient, remainder};
+}
+
+/** A random number with a random number of significant digits.
+ */
+template<typename T, int N>
+static bigint<T, N> random_bigint(std::mt19937_64 &random, int nr_digits = N) noexcept
+{
+    auto r = bigint<T, N>{0};
+    for (int i = 0; i != nr_digits; ++i) {
+        r.digits[i] = static_cast<T>(random());
+    }
+    // Sometimes use digits with all bits set, or a small top digit, which exercise the corner cases.
+    switch (random() % 4) {
+    case 0: r.digits[nr_digits - 1] = static_cast<T>(~T{0}); break;
+    case 1: r.digits[nr_digits - 1] = static_cast<T>(random() % 4); break;
+    default:;
+    }
+    return r;
+}
+
+template<typename T, int N>
+static void test_multiply(std::mt19937_64 &random)
+{
+    for (int i = 0; i != 20; ++i) {
+        ttlet a = random_bigint<T, N>(random);
+        ttlet b = random_bigint<T, N>(random);
+        ASSERT_EQ(a * b, reference_multiply(a, b)) << "N=" << N;
+
+        // The full product, which passes through the high half of the Karatsuba recursion.
+        ttlet a2 = bigint<T, 2 * N>{a};
+        ttlet b2 = bigint<T, 2 * N>{b};
+        ASSERT_EQ(a2 * b2, reference_multiply(a2, b2)) << "N=" << N;
+    }
+}
+
+TEST(BigInt, MultiplyKaratsuba)
+{
+    auto random = std::mt19937_64{42};
+    test_multiply<uint64_t, 4>(random);
+    test_multiply<uint64_t, 31>(random);
+    test_multiply<uint64_t, 32>(random);
+    test_multiply<uint64_t, 33>(random);
+    test_multiply<uint64_t, 67>(random);
+    test_multiply<uint64_t, 128>(random);
+    test_multiply<uint32_t, 45>(random);
+    test_multiply<uint8_t, 40>(random);
+}
+
+template<typename T, int N>
+static void test_div(std::mt19937_64 &random, int nr_iterations)
+{
+    for (int i = 0; i != nr_iterations; ++i) {
+        ttlet lhs = random_bigint<T, N>(random, narrow_cast<int>(random() % N) + 1);
+        ttlet rhs = random_bigint<T, N>(random, narrow_cast<int>(random() % N) + 1);
+        if (rhs == 0) {
+            continue;
+        }
+
+        ttlet [quotient, remainder] = div(lhs, rhs);
+        ttlet [reference_quotient, reference_remainder] = reference_div(lhs, rhs);
+        ASSERT_EQ(quotient, reference_quotient) << "N=" << N;
+        ASSERT_EQ(remainder, reference_remainder) << "N=" << N;
+    }
+}
+
+TEST(BigInt, DivideKnuth)
+{
+    auto random = std::mt19937_64{42};
+    test_div<uint64_t, 2>(random, 1000);
+    test_div<uint64_t, 5>(random, 1000);
+    test_div<uint64_t, 16>(random, 200);
+    test_div<uint32_t, 7>(random, 1000);
+    // Small digits make the quotient estimate too large more often, exercising the add-back step.
+    test_div<uint8_t, 8>(random, 100000);
+    test_div<uint16_t, 6>(random, 10000);
+
+    // Dividend smaller than the divisor.
+    ASSERT_EQ(div(ubig128{5}, ubig128{"100000000000000000000"}), std::pair(ubig128{0}, ubig128{5}));
+    // Divisor with all bits set in the top digit, so that no normalization is needed.
+    ttlet max = ~ubig128{0};
+    ASSERT_EQ(div(max, max), std::pair(ubig128{1}, ubig128{0}));
+}
+
+template<int N>
+static void bigint_benchmark(std::mt19937_64 &random)
+{
+    using type = bigint<uint64_t, N>;
+    ttlet nr_iterations = std::max(1, 200'000 / (N * N));
+
+    auto values = std::vector<type>{};
+    auto divisors = std::vector<type>{};
+    for (int i = 0; i != 16; ++i) {
+        values.push_back(random_bigint<uint64_t, N>(random));
+        divisors.push_back(random_bigint<uint64_t, N>(random, std::max(1, N / 2)));
+    }
+
+    auto sink = type{0};
+    auto measure = [&](auto f) {
+        ttlet t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i != nr_iterations; ++i) {
+            for (int j = 0; j != 16; ++j) {
+                sink ^= f(values[j], values[(j + 1) % 16], divisors[j]);
+            }
+        }
+        ttlet t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / (nr_iterations * 16);
+    };
+
+    ttlet reference_multiply_time = measure([](auto const &a, auto const &b, auto const &) {
+        return reference_multiply(a, b);
+    });
+    ttlet multiply_time = measure([](auto const &a, auto const &b, auto const &) {
+        return a * b;
+    });
+
+    // The bit-serial reference is very slow, so it is only run for the smaller sizes.
+    ttlet reference_div_time = N <= 64 ? measure([](auto const &a, auto const &, auto const &d) {
+        return reference_div(a, d).first;
+    }) : 0.0;
+    ttlet div_time = measure([](auto const &a, auto const &, auto const &d) {
+        return a / d;
+    });
+
+    std::cout << fmt::format(
+        "bigint N={:3}: multiply {:9.0f} ns (schoolbook {:9.0f} ns), divide {:9.0f} ns (bit-serial {:9.0f} ns)\n",
+        N,
+        multiply_time,
+        reference_multiply_time,
+        div_time,
+        reference_div_time);
+    ASSERT_NE(sink, type{1});
+}
+
+TEST(BigInt, Benchmark)
+{
+    auto random = std::mt19937_64{42};
+    bigint_benchmark<4>(random);
+    bigint_benchmark<8>(random);
+    bigint_benchmark<16>(random);
+    bigint_benchmark<32>(random);
+    bigint_benchmark<64>(random);
+    bigint_benchmark<128>(random);
+    bigint_benchmark<256>(random);
+}
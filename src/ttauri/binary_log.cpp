@@ -0,0 +1,241 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "binary_log.hpp"
+#include "logger.hpp"
+#include "cpu_utc_clock.hpp"
+#include "exception.hpp"
+#include <fmt/core.h>
+#include <bit>
+#include <cstring>
+
+namespace tt {
+
+binary_log_writer::binary_log_writer() noexcept
+{
+    for (ttlet c : magic) {
+        write_byte(static_cast<uint8_t>(c));
+    }
+}
+
+void binary_log_writer::write_unsigned(uint64_t value) noexcept
+{
+    while (value >= 0x80) {
+        write_byte(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    write_byte(static_cast<uint8_t>(value));
+}
+
+void binary_log_writer::write_signed(int64_t value) noexcept
+{
+    // Zig-zag encoding, so that small negative numbers are also small.
+    write_unsigned((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void binary_log_writer::write_double(double value) noexcept
+{
+    auto u = std::bit_cast<uint64_t>(value);
+    for (int i = 0; i != 8; ++i) {
+        write_byte(static_cast<uint8_t>(u));
+        u >>= 8;
+    }
+}
+
+void binary_log_writer::write_string(std::string_view value) noexcept
+{
+    write_unsigned(value.size());
+    ttlet offset = _bytes.size();
+    _bytes.resize(offset + value.size());
+    std::memcpy(_bytes.data() + offset, value.data(), value.size());
+}
+
+void binary_log_writer::write_format(
+    uint32_t format_id,
+    log_level level,
+    char const *source_file,
+    int source_line,
+    char const *format,
+    std::initializer_list<binary_log_argument_type> argument_types) noexcept
+{
+    write_byte('F');
+    write_unsigned(format_id);
+    write_byte(static_cast<uint8_t>(level));
+    write_unsigned(narrow_cast<uint64_t>(source_line));
+    write_string(source_file);
+    write_string(format);
+    write_unsigned(argument_types.size());
+    for (ttlet type : argument_types) {
+        write_byte(static_cast<uint8_t>(type));
+    }
+
+    if (format_id >= _has_format.size()) {
+        _has_format.resize(format_id + 1);
+    }
+    _has_format[format_id] = true;
+}
+
+void binary_log_writer::write_message_header(uint32_t format_id, cpu_counter_clock::time_point timestamp) noexcept
+{
+    write_byte('M');
+    write_unsigned(format_id);
+    write_signed(cpu_utc_clock::convert(timestamp).time_since_epoch().count());
+}
+
+namespace {
+
+struct binary_log_format {
+    log_level level;
+    int source_line;
+    std::string source_file;
+    std::string format;
+    std::vector<binary_log_argument_type> argument_types;
+};
+
+class binary_log_reader {
+public:
+    binary_log_reader(std::span<std::byte const> bytes) noexcept : _bytes(bytes) {}
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _offset == _bytes.size();
+    }
+
+    [[nodiscard]] uint8_t read_byte()
+    {
+        if (empty()) {
+            throw parse_error("Binary log is truncated");
+        }
+        return static_cast<uint8_t>(_bytes[_offset++]);
+    }
+
+    [[nodiscard]] uint64_t read_unsigned()
+    {
+        uint64_t r = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            ttlet byte = read_byte();
+            r |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return r;
+            }
+        }
+        throw parse_error("Binary log has an integer which is too large");
+    }
+
+    [[nodiscard]] int64_t read_signed()
+    {
+        ttlet u = read_unsigned();
+        return static_cast<int64_t>((u >> 1) ^ (~(u & 1) + 1));
+    }
+
+    [[nodiscard]] double read_double()
+    {
+        uint64_t u = 0;
+        for (int i = 0; i != 8; ++i) {
+            u |= static_cast<uint64_t>(read_byte()) << (i * 8);
+        }
+        return std::bit_cast<double>(u);
+    }
+
+    [[nodiscard]] std::string read_string()
+    {
+        ttlet size = read_unsigned();
+        if (size > _bytes.size() - _offset) {
+            throw parse_error("Binary log is truncated");
+        }
+        auto r = std::string(reinterpret_cast<char const *>(_bytes.data() + _offset), size);
+        _offset += size;
+        return r;
+    }
+
+private:
+    std::span<std::byte const> _bytes;
+    size_t _offset = 0;
+};
+
+} // namespace
+
+[[nodiscard]] std::vector<std::string> decode_binary_log(std::span<std::byte const> bytes)
+{
+    auto reader = binary_log_reader{bytes};
+    for (ttlet c : binary_log_writer::magic) {
+        if (reader.read_byte() != static_cast<uint8_t>(c)) {
+            throw parse_error("Not a binary log");
+        }
+    }
+
+    auto formats = std::vector<binary_log_format>{};
+    auto r = std::vector<std::string>{};
+
+    while (!reader.empty()) {
+        ttlet record_type = reader.read_byte();
+        ttlet format_id = reader.read_unsigned();
+
+        if (record_type == 'F') {
+            auto format = binary_log_format{};
+            format.level = static_cast<log_level>(reader.read_byte());
+            format.source_line = narrow_cast<int>(reader.read_unsigned());
+            format.source_file = reader.read_string();
+            format.format = reader.read_string();
+            ttlet nr_arguments = reader.read_unsigned();
+            for (uint64_t i = 0; i != nr_arguments; ++i) {
+                format.argument_types.push_back(static_cast<binary_log_argument_type>(reader.read_byte()));
+            }
+
+            if (format_id >= formats.size()) {
+                formats.resize(format_id + 1);
+            }
+            formats[format_id] = std::move(format);
+
+        } else if (record_type == 'M') {
+            if (format_id >= formats.size() || formats[format_id].format.empty()) {
+                throw parse_error("Binary log message refers to an unknown format {}", format_id);
+            }
+            ttlet &format = formats[format_id];
+
+            ttlet timestamp = hires_utc_clock::time_point{hires_utc_clock::duration{reader.read_signed()}};
+
+            auto arguments = fmt::dynamic_format_arg_store<fmt::format_context>{};
+            for (ttlet type : format.argument_types) {
+                switch (type) {
+                case binary_log_argument_type::signed_integer: arguments.push_back(reader.read_signed()); break;
+                case binary_log_argument_type::unsigned_integer: arguments.push_back(reader.read_unsigned()); break;
+                case binary_log_argument_type::floating_point: arguments.push_back(reader.read_double()); break;
+                case binary_log_argument_type::boolean: arguments.push_back(reader.read_byte() != 0); break;
+                case binary_log_argument_type::character: arguments.push_back(static_cast<char>(reader.read_byte())); break;
+                case binary_log_argument_type::string: arguments.push_back(reader.read_string()); break;
+                default: throw parse_error("Binary log has an unknown argument type");
+                }
+            }
+
+            auto what = std::string{};
+            try {
+                what = fmt::vformat(format.format, arguments);
+            } catch (fmt::format_error const &) {
+                // The argument was formatted as a string, which does not accept the format specification.
+                what = fmt::format("{} <format error>", format.format);
+            }
+
+            ttlet timestring = format_iso8601(timestamp);
+            if (format.level == log_level::Trace || format.level == log_level::Counter) {
+                r.push_back(fmt::format("{} {:5} {}", timestring, to_const_string(format.level), what));
+            } else {
+                r.push_back(fmt::format(
+                    "{} {:5} {} ({}:{})",
+                    timestring,
+                    to_const_string(format.level),
+                    what,
+                    format.source_file,
+                    format.source_line));
+            }
+
+        } else {
+            throw parse_error("Binary log has an unknown record type");
+        }
+    }
+
+    return r;
+}
+
+} // namespace tt
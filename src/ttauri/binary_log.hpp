@@ -0,0 +1,180 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "cpu_counter_clock.hpp"
+#include <fmt/format.h>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <initializer_list>
+#include <type_traits>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace tt {
+
+enum class log_level : uint8_t;
+
+/** The type of an argument of a message in a binary log.
+ */
+enum class binary_log_argument_type : uint8_t {
+    signed_integer,
+    unsigned_integer,
+    floating_point,
+    boolean,
+    character,
+
+    /** A string, or a value of another type which has been formatted with "{}".
+     */
+    string
+};
+
+template<typename T>
+[[nodiscard]] constexpr binary_log_argument_type binary_log_argument_type_of() noexcept
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        return binary_log_argument_type::boolean;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return binary_log_argument_type::character;
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        return binary_log_argument_type::signed_integer;
+    } else if constexpr (std::is_integral_v<T>) {
+        return binary_log_argument_type::unsigned_integer;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return binary_log_argument_type::floating_point;
+    } else {
+        return binary_log_argument_type::string;
+    }
+}
+
+/** Writes log messages as compact binary records.
+ *
+ * Instead of formatting a message, a record holds the id of the format, the timestamp and
+ * the raw values of the arguments. The format string, source location and argument types
+ * of each format are written once, before the first record that uses it.
+ *
+ * The records are formatted to text offline with `decode_binary_log()`.
+ *
+ * Layout of the log, integers are LEB128 encoded unless noted otherwise:
+ *  - magic: "TTBLOG" 0x00 0x01
+ *  - format definition: 'F' id level line source-file format nr-arguments argument-type...
+ *  - message: 'M' id utc-timestamp-ns(zig-zag) argument...
+ *  - string: length bytes...
+ *  - floating point: 8 bytes IEEE-754 little endian.
+ */
+class binary_log_writer {
+public:
+    static constexpr std::string_view magic = std::string_view{"TTBLOG\0\1", 8};
+
+    binary_log_writer() noexcept;
+
+    /** Allocate an id for a format.
+     * Format ids are process wide, each log_message type allocates one id on first use.
+     */
+    [[nodiscard]] static uint32_t make_format_id() noexcept
+    {
+        return _next_format_id.fetch_add(1, std::memory_order::relaxed);
+    }
+
+    /** The bytes written since the last call to `clear()`.
+     */
+    [[nodiscard]] std::span<std::byte const> bytes() const noexcept
+    {
+        return _bytes;
+    }
+
+    void clear() noexcept
+    {
+        _bytes.clear();
+    }
+
+    /** Write a message.
+     * The definition of the format is written when this is the first message with this format.
+     */
+    template<typename... Values>
+    void write_message(
+        uint32_t format_id,
+        log_level level,
+        char const *source_file,
+        int source_line,
+        char const *format,
+        cpu_counter_clock::time_point timestamp,
+        Values const &...values) noexcept
+    {
+        if (format_id >= _has_format.size() || !_has_format[format_id]) {
+            write_format(format_id, level, source_file, source_line, format, {binary_log_argument_type_of<Values>()...});
+        }
+
+        write_message_header(format_id, timestamp);
+        (write_argument(values), ...);
+    }
+
+private:
+    static inline std::atomic<uint32_t> _next_format_id = 0;
+
+    std::vector<std::byte> _bytes;
+
+    /** The formats that have been written to this log.
+     */
+    std::vector<bool> _has_format;
+
+    void write_format(
+        uint32_t format_id,
+        log_level level,
+        char const *source_file,
+        int source_line,
+        char const *format,
+        std::initializer_list<binary_log_argument_type> argument_types) noexcept;
+
+    void write_message_header(uint32_t format_id, cpu_counter_clock::time_point timestamp) noexcept;
+
+    void write_byte(uint8_t value) noexcept
+    {
+        _bytes.push_back(static_cast<std::byte>(value));
+    }
+
+    void write_unsigned(uint64_t value) noexcept;
+    void write_signed(int64_t value) noexcept;
+    void write_double(double value) noexcept;
+    void write_string(std::string_view value) noexcept;
+
+    template<typename T>
+    void write_argument(T const &value) noexcept
+    {
+        constexpr auto type = binary_log_argument_type_of<T>();
+
+        if constexpr (type == binary_log_argument_type::boolean) {
+            write_byte(value ? 1 : 0);
+        } else if constexpr (type == binary_log_argument_type::character) {
+            write_byte(static_cast<uint8_t>(value));
+        } else if constexpr (type == binary_log_argument_type::signed_integer) {
+            write_signed(static_cast<int64_t>(value));
+        } else if constexpr (type == binary_log_argument_type::unsigned_integer) {
+            write_unsigned(static_cast<uint64_t>(value));
+        } else if constexpr (type == binary_log_argument_type::floating_point) {
+            write_double(static_cast<double>(value));
+        } else if constexpr (std::is_convertible_v<T const &, std::string_view>) {
+            write_string(std::string_view{value});
+        } else {
+            write_string(fmt::format("{}", value));
+        }
+    }
+};
+
+/** Format a binary log to text.
+ *
+ * Each message is formatted the same as the logger formats messages to text.
+ *
+ * @param bytes The contents of a binary log.
+ * @return The formatted messages.
+ * @throws parse_error When the log is corrupt.
+ */
+[[nodiscard]] std::vector<std::string> decode_binary_log(std::span<std::byte const> bytes);
+
+} // namespace tt
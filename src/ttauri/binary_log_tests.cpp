@@ -0,0 +1,107 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/binary_log.hpp"
+#include "ttauri/logger.hpp"
+#include "ttauri/exception.hpp"
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+
+using namespace std;
+using namespace tt;
+
+TEST(binary_log, round_trip)
+{
+    ttlet timestamp = cpu_counter_clock::now();
+
+    ttlet message1 =
+        log_message<log_level::Info, "foo.cpp", 42, "integers {} {} {:x}", int, int, unsigned int>(timestamp, 5, -3, 255u);
+    ttlet message2 = log_message<log_level::Warning, "bar.cpp", 7, "{:.2f} {} {} {}", double, bool, char, char const *>(
+        timestamp, 1.5, true, 'c', "literal");
+    ttlet message3 = log_message<log_level::Counter, "baz.cpp", 1, "{:>8} {}", std::string, long long>(
+        timestamp, std::string("right"), -1000000000000ll);
+
+    auto writer = binary_log_writer{};
+    message1.serialize(writer);
+    message2.serialize(writer);
+    message1.serialize(writer);
+    message3.serialize(writer);
+
+    ttlet bytes = std::vector<std::byte>(writer.bytes().begin(), writer.bytes().end());
+    ttlet lines = decode_binary_log(bytes);
+    ASSERT_EQ(lines.size(), 4);
+    ASSERT_EQ(lines[0], message1.format());
+    ASSERT_EQ(lines[1], message2.format());
+    ASSERT_EQ(lines[2], message1.format());
+    ASSERT_EQ(lines[3], message3.format());
+}
+
+TEST(binary_log, format_table_once)
+{
+    ttlet timestamp = cpu_counter_clock::now();
+    ttlet message =
+        log_message<log_level::Debug, "foo.cpp", 10, "a long format string that is written once {}", int>(timestamp, 1);
+
+    auto writer = binary_log_writer{};
+    message.serialize(writer);
+    ttlet first_size = writer.bytes().size();
+    writer.clear();
+    message.serialize(writer);
+    ttlet second_size = writer.bytes().size();
+
+    // The second record only contains the format id, the timestamp and the argument.
+    ASSERT_LT(second_size, 16);
+    ASSERT_GT(first_size, second_size + 40);
+}
+
+TEST(binary_log, corrupt)
+{
+    ttlet timestamp = cpu_counter_clock::now();
+    ttlet message = log_message<log_level::Info, "foo.cpp", 10, "{}", std::string>(timestamp, std::string("hello world"));
+
+    auto writer = binary_log_writer{};
+    message.serialize(writer);
+    auto bytes = std::vector<std::byte>(writer.bytes().begin(), writer.bytes().end());
+
+    bytes.pop_back();
+    ASSERT_THROW(static_cast<void>(decode_binary_log(bytes)), parse_error);
+
+    bytes[0] = std::byte{'X'};
+    ASSERT_THROW(static_cast<void>(decode_binary_log(bytes)), parse_error);
+}
+
+TEST(binary_log, benchmark)
+{
+    constexpr int nr_messages = 100000;
+    ttlet timestamp = cpu_counter_clock::now();
+    ttlet message = log_message<log_level::Debug, "foo.cpp", 10, "Message {} of {} with value {:.3f}", int, int, double>(
+        timestamp, 42, nr_messages, 3.1415);
+
+    ssize_t text_size = 0;
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i != nr_messages; ++i) {
+        text_size += std::ssize(message.format());
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+    auto writer = binary_log_writer{};
+    for (int i = 0; i != nr_messages; ++i) {
+        message.serialize(writer);
+    }
+    ttlet t2 = std::chrono::steady_clock::now();
+    ttlet binary_size = std::ssize(writer.bytes());
+
+    ttlet text_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet binary_duration = std::chrono::duration<double>(t2 - t1).count();
+
+    std::cout << fmt::format(
+        "text: {:.1f} ms {} bytes, binary: {:.1f} ms {} bytes\n",
+        text_duration * 1e3,
+        text_size,
+        binary_duration * 1e3,
+        binary_size);
+}
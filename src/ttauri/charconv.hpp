@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "float_conversion.hpp"
 #include <concepts>
 #include <charconv>
 
@@ -24,7 +25,7 @@ template<std::integral T>
     ttlet last = first + std::size(buffer);
 
     ttlet[new_last, ec] = std::to_chars(first, last, value);
-    tt_assert(ec != std::errc{});
+    tt_assert(ec == std::errc{});
 
     auto r = std::string{};
     std::copy(first, new_last, std::back_inserter(r));
@@ -45,8 +46,14 @@ template<std::floating_point T>
     ttlet first = buffer.data();
     ttlet last = first + std::size(buffer);
 
-    ttlet[new_last, ec] = std::to_chars(first, last, value, std::chars_format::general);
-    tt_assert(ec != std::errc{});
+    ttlet[new_last, ec] = [&] {
+        if constexpr (std::is_same_v<T, double>) {
+            return float_to_chars(first, last, value);
+        } else {
+            return std::to_chars(first, last, value, std::chars_format::general);
+        }
+    }();
+    tt_assert(ec == std::errc{});
 
     auto r = std::string{};
     std::copy(first, new_last, std::back_inserter(r));
@@ -77,4 +84,33 @@ template<std::integral T>
     return value;
 }
 
+/** Convert a string to a floating point number.
+ * This function bypasses std::locale
+ *
+ * @tparam T The floating point type.
+ * @param str The string is a floating point number.
+ * @return The floating point number converted from a string.
+ */
+template<std::floating_point T>
+[[nodiscard]] T from_string(std::string_view str)
+{
+    T value;
+
+    ttlet first = str.data();
+    ttlet last = first + std::ssize(str);
+
+    ttlet[new_last, ec] = [&] {
+        if constexpr (std::is_same_v<T, double>) {
+            return float_from_chars(first, last, value);
+        } else {
+            return std::from_chars(first, last, value);
+        }
+    }();
+    if (ec != std::errc{} || new_last != last) {
+        throw parse_error("Can not convert string to floating point");
+    }
+
+    return value;
+}
+
 } // namespace tt
@@ -34,9 +34,10 @@ constexpr auto BON8_code_eot           = uint8_t{0xff};
  * @param ptr [in,out] Pointer to start of byte-buffer. After the call
  *            ptr will point one beyond the message.
  * @param last Pointer one beyond the end of the message.
+ * @param arena The arena to allocate the message in, or nullptr to allocate on the heap.
  * @return The decoded message.
  */
-[[nodiscard]] datum decode_BON8(cbyteptr &ptr, cbyteptr last);
+[[nodiscard]] datum decode_BON8(cbyteptr &ptr, cbyteptr last, datum_arena *arena = nullptr);
 
 [[nodiscard]] bstring encode_BON8(datum const &value);
 
@@ -327,8 +328,8 @@ public:
      * @tparam T Type of the values.
      * @param items A vector of values.
      */
-    template<typename T>
-    void add(std::vector<T> const &items) {
+    template<typename T, typename Allocator>
+    void add(std::vector<T, Allocator> const &items) {
         open_string = false;
         if (std::ssize(items) == 0) {
             output += static_cast<std::byte>(BON8_code_array_empty);
@@ -470,36 +471,36 @@ void BON8_encoder::add(datum const &value) {
     }
 }
 
-[[nodiscard]] datum decode_BON8_array(cbyteptr &ptr, cbyteptr last)
+[[nodiscard]] datum decode_BON8_array(cbyteptr &ptr, cbyteptr last, datum_arena *arena)
 {
-    auto r = datum::vector{};
+    auto r = arena ? arena->make_vector() : datum::vector{};
 
     while (ptr != last) {
         if (*ptr == static_cast<std::byte>(BON8_code_eoc)) {
             ++ptr;
-            return datum{std::move(r)};
+            return arena ? arena->make(std::move(r)) : datum{std::move(r)};
 
         } else {
-            r.push_back(decode_BON8(ptr, last));
+            r.push_back(decode_BON8(ptr, last, arena));
         }
     }
     throw parse_error("Incomplete array at end of buffer");
 }
 
-[[nodiscard]] datum decode_BON8_object(cbyteptr &ptr, cbyteptr last)
+[[nodiscard]] datum decode_BON8_object(cbyteptr &ptr, cbyteptr last, datum_arena *arena)
 {
-    auto r = datum::map{};
+    auto r = arena ? arena->make_map() : datum::map{};
 
     while (ptr != last) {
         if (*ptr == static_cast<std::byte>(BON8_code_eoc)) {
             ++ptr;
-            return datum{std::move(r)};
+            return arena ? arena->make(std::move(r)) : datum{std::move(r)};
 
         } else {
-            auto key = decode_BON8(ptr, last);
+            auto key = decode_BON8(ptr, last, arena);
             tt_parse_check(key.is_string(), "Key in object is not a string");
 
-            auto value = decode_BON8(ptr, last);
+            auto value = decode_BON8(ptr, last, arena);
             r.emplace(std::move(key), std::move(value));
         }
     }
@@ -546,16 +547,20 @@ void BON8_encoder::add(datum const &value) {
     return datum{is_positive ? value : -value};
 }
 
-[[nodiscard]] datum decode_BON8(cbyteptr &ptr, cbyteptr last) {
+[[nodiscard]] datum decode_BON8(cbyteptr &ptr, cbyteptr last, datum_arena *arena) {
     std::string str;
 
+    ttlet make_string = [arena](std::string_view value) {
+        return arena ? arena->make(value) : datum{value};
+    };
+
     while (ptr != last) {
         ttlet c = static_cast<uint8_t>(*ptr);
 
         if (c == BON8_code_eot) {
             // End of string found, return the current string.
             ++ptr;
-            return datum{str};
+            return make_string(str);
 
         } else if (c <= 0x7f) {
             // ASCII character.
@@ -573,7 +578,7 @@ void BON8_encoder::add(datum const &value) {
 
             } else if (std::ssize(str) != 0) {
                 // Multibyte integer found, but first return the current string.
-                return datum{str};
+                return make_string(str);
 
             } else {
                 // Multibyte integer.
@@ -582,7 +587,7 @@ void BON8_encoder::add(datum const &value) {
 
         } else if (std::ssize(str) != 0) {
             // This must be a non-string type, but first return the current string.
-            return datum{str};
+            return make_string(str);
 
         // Everything below this, are non-string types.
         } else if (c <= 0xaf) {
@@ -641,11 +646,11 @@ void BON8_encoder::add(datum const &value) {
 
             case BON8_code_array:
                 ++ptr;
-                return decode_BON8_array(ptr, last);
+                return decode_BON8_array(ptr, last, arena);
 
             case BON8_code_object:
                 ++ptr;
-                return decode_BON8_object(ptr, last);
+                return decode_BON8_object(ptr, last, arena);
 
             default:
                 tt_no_default();
@@ -689,6 +694,20 @@ void BON8_encoder::add(datum const &value) {
     return detail::decode_BON8(ptr, last);
 }
 
+/** Decode BON8 message from buffer into an arena.
+ * The strings, vectors and maps of the message are allocated from the arena.
+ *
+ * @param buffer A buffer to a BON8 encoded message.
+ * @param arena The arena that owns the message, it must outlive the returned datum.
+ * @return The decoded message.
+ */
+[[nodiscard]] datum decode_BON8(std::span<const std::byte> buffer, datum_arena &arena)
+{
+    auto *ptr = buffer.data();
+    auto *last = ptr + buffer.size();
+    return detail::decode_BON8(ptr, last, &arena);
+}
+
 /** Encode a value to a BON8 message.
  * @param value The data to encode
  * @return The encoded message as a byte_string.
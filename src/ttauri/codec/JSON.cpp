@@ -9,6 +9,7 @@
 #include "../exception.hpp"
 #include "../error_info.hpp"
 #include "../indent.hpp"
+#include "../float_conversion.hpp"
 #include <vector>
 #include <optional>
 
@@ -17,14 +18,20 @@ namespace tt {
 struct parse_context_t {
     std::string_view::const_iterator text_begin;
 
+    /** The arena to allocate the document in, or nullptr to allocate on the heap.
+     */
+    datum_arena *arena = nullptr;
 };
 
+[[nodiscard]] static datum make_string_value(parse_context_t &context, std::string_view value)
+{
+    return context.arena ? context.arena->make(value) : datum{value};
+}
+
 [[nodiscard]] static parse_result<datum> parseValue(parse_context_t &context, token_iterator token);
 
 [[nodiscard]] static parse_result<datum> parseArray(parse_context_t &context, token_iterator token)
 {
-    auto array = datum{datum::vector{}};
-
     // Required '['
     if ((*token == tokenizer_name_t::Operator) && (*token == "[")) {
         token++; 
@@ -32,6 +39,8 @@ struct parse_context_t {
         return {};
     }
 
+    auto array = context.arena ? context.arena->make_vector() : datum::vector{};
+
     bool commaAfterValue = true;
     while (true) {
         // A ']' is required at end of configuration-items.
@@ -62,13 +71,11 @@ struct parse_context_t {
         }
     }
 
-    return {std::move(array), token};
+    return {context.arena ? context.arena->make(std::move(array)) : datum{std::move(array)}, token};
 }
 
 [[nodiscard]] static parse_result<datum> parseObject(parse_context_t &context, token_iterator token)
 {
-    auto object = datum{datum::map{}};
-
     // Required '{'
     if ((*token == tokenizer_name_t::Operator) && (*token == "{")) {
         token++; 
@@ -76,6 +83,8 @@ struct parse_context_t {
         return {};
     }
 
+    auto object = context.arena ? context.arena->make_map() : datum::map{};
+
     bool commaAfterValue = true;
     while (true) {
         // A '}' is required at end of configuration-items.
@@ -100,7 +109,7 @@ struct parse_context_t {
             }
 
             if (auto result = parseValue(context, token)) {
-                object[name] = *result;
+                object.insert_or_assign(make_string_value(context, name), *result);
                 token = result.next_token;
 
             } else {
@@ -121,14 +130,14 @@ struct parse_context_t {
         }
     }
 
-    return {std::move(object), token};
+    return {context.arena ? context.arena->make(std::move(object)) : datum{std::move(object)}, token};
 }
 
 [[nodiscard]] static parse_result<datum> parseValue(parse_context_t &context, token_iterator token)
 {
     switch (token->name) {
     case tokenizer_name_t::StringLiteral: {
-        auto value = datum{static_cast<std::string>(*token++)};
+        auto value = make_string_value(context, static_cast<std::string>(*token++));
         return {std::move(value), token};
         } break;
     case tokenizer_name_t::IntegerLiteral: {
@@ -164,7 +173,7 @@ struct parse_context_t {
     }
 }
 
-[[nodiscard]] datum parse_JSON(std::string_view text)
+[[nodiscard]] static datum parse_JSON(std::string_view text, datum_arena *arena)
 {
     token_vector tokens = parseTokens(text);
 
@@ -173,6 +182,7 @@ struct parse_context_t {
     tt_axiom(tokens.back() == tokenizer_name_t::End);
     parse_context_t context;
     context.text_begin = text.begin();
+    context.arena = arena;
 
     auto token = tokens.begin();
 
@@ -193,6 +203,16 @@ struct parse_context_t {
     return root;
 }
 
+[[nodiscard]] datum parse_JSON(std::string_view text)
+{
+    return parse_JSON(text, nullptr);
+}
+
+[[nodiscard]] datum parse_JSON(std::string_view text, datum_arena &arena)
+{
+    return parse_JSON(text, &arena);
+}
+
 [[nodiscard]] datum parse_JSON(URL const &url)
 {
     return parse_JSON(url.loadView()->string_view());
@@ -215,9 +235,12 @@ static void format_JSON_impl(datum const &value, std::string &result, tt::indent
         result += tt::to_string(static_cast<long long>(value));
         break;
 
-    case datum_type_t::Float:
-        result += tt::to_string(static_cast<double>(value));
-        break;
+    case datum_type_t::Float: {
+        // Format directly onto the result, without a temporary string.
+        char buffer[float_to_chars_max_size];
+        ttlet last = float_to_chars(buffer, buffer + float_to_chars_max_size, static_cast<double>(value)).ptr;
+        result.append(buffer, last);
+    } break;
 
     case datum_type_t::String:
     case datum_type_t::URL:
@@ -240,7 +263,7 @@ static void format_JSON_impl(datum const &value, std::string &result, tt::indent
         result += '[';
         result += '\n';
 
-        for (auto i = value.vector_begin(); i != value.vector_end(); i++, first_item = true) {
+        for (auto i = value.vector_begin(); i != value.vector_end(); i++, first_item = false) {
             if (!first_item) {
                 result += ',';
                 result += '\n';
@@ -260,7 +283,7 @@ static void format_JSON_impl(datum const &value, std::string &result, tt::indent
         result += '{';
         result += '\n';
 
-        for (auto i = value.map_begin(); i != value.map_end(); i++, first_item = true) {
+        for (auto i = value.map_begin(); i != value.map_end(); i++, first_item = false) {
             if (!first_item) {
                 result += ',';
                 result += '\n';
@@ -20,6 +20,15 @@ namespace tt {
  */
 [[nodiscard]] datum parse_JSON(std::string_view text);
 
+/** Parse a JSON string into an arena.
+ * The strings, vectors and maps of the document are allocated from the arena.
+ *
+ * @param text The text to parse.
+ * @param arena The arena that owns the document, it must outlive the returned datum.
+ * @return A datum representing the parsed object.
+ */
+[[nodiscard]] datum parse_JSON(std::string_view text, datum_arena &arena);
+
 /** Parse a JSON string.
  * @param file URL pointing to the file to parse.
  * @return A datum representing the parsed object.
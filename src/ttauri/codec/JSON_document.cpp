@@ -0,0 +1,590 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "JSON_document.hpp"
+#include "../exception.hpp"
+#include "../error_info.hpp"
+#include "../parse_location.hpp"
+#include "../float_conversion.hpp"
+#include <charconv>
+#include <cstring>
+
+namespace tt {
+
+/** Single pass JSON parser writing directly onto the tape of a JSON_document.
+ */
+class JSON_parser {
+public:
+    using tag_type = JSON_document::tag_type;
+
+    JSON_parser(JSON_document &document) noexcept :
+        _document(document),
+        _begin(document._text.data()),
+        _ptr(document._text.data()),
+        _end(document._text.data() + document._text.size())
+    {
+    }
+
+    void parse()
+    {
+        // On average a value uses more than 8 characters of text.
+        _document._tape.reserve(std::ssize(_document._text) / 4 + 2);
+
+        skip_whitespace();
+        parse_value(0);
+        skip_whitespace();
+        if (_ptr != _end) {
+            error("Unexpected text after JSON root value");
+        }
+    }
+
+private:
+    static constexpr int max_depth = 1000;
+
+    JSON_document &_document;
+    char const *_begin;
+    char const *_ptr;
+    char const *_end;
+
+    [[noreturn]] void error(char const *message) const
+    {
+        // Only calculate the line and column when an error is found.
+        int line = 1;
+        int column = 1;
+        for (auto it = _begin; it != _ptr; ++it) {
+            if (*it == '\n') {
+                ++line;
+                column = 1;
+            } else {
+                ++column;
+            }
+        }
+        tt_error_info().set<"parse_location">(parse_location{line, column});
+        throw parse_error(message);
+    }
+
+    void push(tag_type tag, uint64_t payload, uint64_t value)
+    {
+        tt_axiom(payload <= 0x00ff'ffff'ffff'ffff);
+        _document._tape.push_back((static_cast<uint64_t>(tag) << 56) | payload);
+        _document._tape.push_back(value);
+    }
+
+    void skip_whitespace()
+    {
+        while (_ptr != _end) {
+            ttlet c = *_ptr;
+            if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                ++_ptr;
+
+            } else if (c == '#' || (c == '/' && _ptr + 1 != _end && _ptr[1] == '/')) {
+                while (_ptr != _end && *_ptr != '\n') {
+                    ++_ptr;
+                }
+
+            } else if (c == '/' && _ptr + 1 != _end && _ptr[1] == '*') {
+                ttlet comment_start = _ptr;
+                _ptr += 2;
+                while (true) {
+                    if (_ptr + 1 >= _end) {
+                        _ptr = comment_start;
+                        error("Unexpected end of text in block comment");
+                    }
+                    if (_ptr[0] == '*' && _ptr[1] == '/') {
+                        _ptr += 2;
+                        break;
+                    }
+                    ++_ptr;
+                }
+
+            } else {
+                return;
+            }
+        }
+    }
+
+    void parse_value(int depth)
+    {
+        if (depth > max_depth) {
+            error("JSON values are nested too deep");
+        }
+        if (_ptr == _end) {
+            error("Unexpected end of text, expecting a JSON value");
+        }
+
+        switch (*_ptr) {
+        case '{': return parse_container(tag_type::map, '}', depth);
+        case '[': return parse_container(tag_type::vector, ']', depth);
+        case '"': return parse_string();
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9': return parse_number();
+        default: return parse_name();
+        }
+    }
+
+    void parse_container(tag_type tag, char close, int depth)
+    {
+        auto &tape = _document._tape;
+        ttlet start = std::ssize(tape);
+        push(tag, 0, 0);
+        ++_ptr;
+
+        uint64_t count = 0;
+        bool comma_after_value = true;
+        while (true) {
+            skip_whitespace();
+            if (_ptr == _end) {
+                error(tag == tag_type::map ? "Unexpected end of text in object" : "Unexpected end of text in array");
+            }
+
+            if (*_ptr == close) {
+                ++_ptr;
+                break;
+            }
+
+            if (!comma_after_value) {
+                error("Missing expected ','");
+            }
+
+            if (tag == tag_type::map) {
+                if (*_ptr != '"') {
+                    error("Expecting a string as the key of an object");
+                }
+                parse_string();
+
+                skip_whitespace();
+                if (_ptr == _end || *_ptr != ':') {
+                    error("Missing expected ':'");
+                }
+                ++_ptr;
+                skip_whitespace();
+            }
+
+            parse_value(depth + 1);
+            ++count;
+
+            skip_whitespace();
+            if (_ptr != _end && *_ptr == ',') {
+                ++_ptr;
+                comma_after_value = true;
+            } else {
+                comma_after_value = false;
+            }
+        }
+
+        tape[start] |= static_cast<uint64_t>(std::ssize(tape));
+        tape[start + 1] = count;
+    }
+
+    [[nodiscard]] uint32_t parse_hex4()
+    {
+        if (_end - _ptr < 4) {
+            error("Unexpected end of text in unicode escape sequence");
+        }
+
+        uint32_t value = 0;
+        for (int i = 0; i != 4; ++i) {
+            ttlet c = *_ptr++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value |= static_cast<uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value |= static_cast<uint32_t>(c - 'A' + 10);
+            } else {
+                error("Invalid hex digit in unicode escape sequence");
+            }
+        }
+        return value;
+    }
+
+    void append_unicode_escape(std::string &str)
+    {
+        auto code_point = parse_hex4();
+
+        if (code_point >= 0xd800 && code_point <= 0xdbff && _end - _ptr >= 2 && _ptr[0] == '\\' && _ptr[1] == 'u') {
+            ttlet high_surrogate = code_point;
+            _ptr += 2;
+            ttlet low_surrogate = parse_hex4();
+            if (low_surrogate < 0xdc00 || low_surrogate > 0xdfff) {
+                error("Expecting a low surrogate after a high surrogate in unicode escape sequence");
+            }
+            code_point = 0x10000 + ((high_surrogate - 0xd800) << 10) + (low_surrogate - 0xdc00);
+
+        } else if (code_point >= 0xd800 && code_point <= 0xdfff) {
+            // Unpaired surrogate.
+            code_point = 0xfffd;
+        }
+
+        if (code_point < 0x80) {
+            str += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            str += static_cast<char>(0xc0 | (code_point >> 6));
+            str += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else if (code_point < 0x10000) {
+            str += static_cast<char>(0xe0 | (code_point >> 12));
+            str += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            str += static_cast<char>(0x80 | (code_point & 0x3f));
+        } else {
+            str += static_cast<char>(0xf0 | (code_point >> 18));
+            str += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+            str += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            str += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+    }
+
+    void parse_string()
+    {
+        ttlet first = ++_ptr;
+
+        // Fast path, a string without escape sequences is referenced in the text.
+        while (_ptr != _end && *_ptr != '"' && *_ptr != '\\' && *_ptr != '\n') {
+            ++_ptr;
+        }
+
+        if (_ptr != _end && *_ptr == '"') {
+            push(tag_type::string, first - _begin, _ptr - first);
+            ++_ptr;
+            return;
+        }
+
+        auto &strings = _document._strings;
+        ttlet offset = std::ssize(strings);
+        strings.append(first, _ptr);
+
+        while (true) {
+            if (_ptr == _end) {
+                error("Unexpected end of text in string");
+            }
+
+            ttlet c = *_ptr++;
+            if (c == '"') {
+                break;
+
+            } else if (c == '\n') {
+                --_ptr;
+                error("Unexpected end of line in string");
+
+            } else if (c == '\\') {
+                if (_ptr == _end) {
+                    error("Unexpected end of text in string");
+                }
+                switch (*_ptr++) {
+                case '"': strings += '"'; break;
+                case '\\': strings += '\\'; break;
+                case '/': strings += '/'; break;
+                case 'b': strings += '\b'; break;
+                case 'f': strings += '\f'; break;
+                case 'n': strings += '\n'; break;
+                case 'r': strings += '\r'; break;
+                case 't': strings += '\t'; break;
+                case 'u': append_unicode_escape(strings); break;
+                default: --_ptr; error("Invalid escape sequence in string");
+                }
+
+            } else {
+                strings += c;
+            }
+        }
+
+        push(tag_type::escaped_string, offset, std::ssize(strings) - offset);
+    }
+
+    [[nodiscard]] bool is_digit() const noexcept
+    {
+        return _ptr != _end && *_ptr >= '0' && *_ptr <= '9';
+    }
+
+    void skip_digits()
+    {
+        if (!is_digit()) {
+            error("Expecting a digit in number");
+        }
+        do {
+            ++_ptr;
+        } while (is_digit());
+    }
+
+    void parse_number()
+    {
+        ttlet first = _ptr;
+        bool is_float = false;
+
+        if (*_ptr == '-') {
+            ++_ptr;
+        }
+        skip_digits();
+
+        if (_ptr != _end && *_ptr == '.') {
+            ++_ptr;
+            skip_digits();
+            is_float = true;
+        }
+
+        if (_ptr != _end && (*_ptr == 'e' || *_ptr == 'E')) {
+            ++_ptr;
+            if (_ptr != _end && (*_ptr == '+' || *_ptr == '-')) {
+                ++_ptr;
+            }
+            skip_digits();
+            is_float = true;
+        }
+
+        uint64_t value;
+        if (is_float) {
+            double f;
+            ttlet[last, ec] = float_from_chars(first, _ptr, f);
+            if (ec != std::errc{} || last != _ptr) {
+                _ptr = first;
+                error(ec == std::errc::result_out_of_range ? "Floating point number out of range" : "Invalid floating point number");
+            }
+            std::memcpy(&value, &f, sizeof(value));
+            push(tag_type::floating, 0, value);
+
+        } else {
+            long long i;
+            ttlet[last, ec] = std::from_chars(first, _ptr, i);
+            if (ec != std::errc{} || last != _ptr) {
+                _ptr = first;
+                error("Integer out of range");
+            }
+            std::memcpy(&value, &i, sizeof(value));
+            push(tag_type::integer, 0, value);
+        }
+    }
+
+    void parse_name()
+    {
+        ttlet first = _ptr;
+        while (_ptr != _end && ((*_ptr >= 'a' && *_ptr <= 'z') || (*_ptr >= 'A' && *_ptr <= 'Z'))) {
+            ++_ptr;
+        }
+
+        ttlet name = std::string_view(first, _ptr - first);
+        if (name == "true") {
+            push(tag_type::boolean_true, 0, 0);
+        } else if (name == "false") {
+            push(tag_type::boolean_false, 0, 0);
+        } else if (name == "null") {
+            push(tag_type::null, 0, 0);
+        } else {
+            _ptr = first;
+            error("Unexpected character, expecting a JSON value");
+        }
+    }
+};
+
+JSON_document::JSON_document(std::string_view text) : _view(), _text(text)
+{
+    JSON_parser(*this).parse();
+}
+
+JSON_document::JSON_document(URL const &url) : _view(url.loadView()), _text(_view->string_view())
+{
+    JSON_parser(*this).parse();
+}
+
+datum_type_t JSON_value::type() const noexcept
+{
+    switch (tag()) {
+    case tag_type::null: return datum_type_t::Null;
+    case tag_type::boolean_false:
+    case tag_type::boolean_true: return datum_type_t::Boolean;
+    case tag_type::integer: return datum_type_t::Integer;
+    case tag_type::floating: return datum_type_t::Float;
+    case tag_type::string:
+    case tag_type::escaped_string: return datum_type_t::String;
+    case tag_type::vector: return datum_type_t::Vector;
+    case tag_type::map: return datum_type_t::Map;
+    default: tt_no_default();
+    }
+}
+
+char const *JSON_value::type_name() const noexcept
+{
+    switch (tag()) {
+    case tag_type::null: return "Null";
+    case tag_type::boolean_false:
+    case tag_type::boolean_true: return "Boolean";
+    case tag_type::integer: return "Integer";
+    case tag_type::floating: return "Float";
+    case tag_type::string:
+    case tag_type::escaped_string: return "String";
+    case tag_type::vector: return "Vector";
+    case tag_type::map: return "Map";
+    default: tt_no_default();
+    }
+}
+
+JSON_value::operator bool() const noexcept
+{
+    switch (tag()) {
+    case tag_type::null: return false;
+    case tag_type::boolean_false: return false;
+    case tag_type::boolean_true: return true;
+    case tag_type::integer: return _document->value(_index) != 0;
+    case tag_type::floating: return static_cast<double>(*this) != 0.0;
+    case tag_type::string:
+    case tag_type::escaped_string:
+    case tag_type::vector:
+    case tag_type::map: return _document->value(_index) != 0;
+    default: tt_no_default();
+    }
+}
+
+JSON_value::operator long long() const
+{
+    switch (tag()) {
+    case tag_type::boolean_false: return 0;
+    case tag_type::boolean_true: return 1;
+    case tag_type::integer: {
+        long long r;
+        ttlet value = _document->value(_index);
+        std::memcpy(&r, &value, sizeof(r));
+        return r;
+    }
+    case tag_type::floating: return static_cast<long long>(static_cast<double>(*this));
+    default: throw operation_error("Value of type {} can not be converted to a signed long long", type_name());
+    }
+}
+
+JSON_value::operator double() const
+{
+    switch (tag()) {
+    case tag_type::integer: return static_cast<double>(static_cast<long long>(*this));
+    case tag_type::floating: {
+        double r;
+        ttlet value = _document->value(_index);
+        std::memcpy(&r, &value, sizeof(r));
+        return r;
+    }
+    default: throw operation_error("Value of type {} can not be converted to a double", type_name());
+    }
+}
+
+JSON_value::operator std::string_view() const
+{
+    ttlet offset = narrow_cast<size_t>(_document->payload(_index));
+    ttlet size = narrow_cast<size_t>(_document->value(_index));
+
+    switch (tag()) {
+    case tag_type::string: return _document->_text.substr(offset, size);
+    case tag_type::escaped_string: return std::string_view{_document->_strings}.substr(offset, size);
+    default: throw operation_error("Value of type {} can not be converted to a string", type_name());
+    }
+}
+
+size_t JSON_value::size() const
+{
+    switch (tag()) {
+    case tag_type::string:
+    case tag_type::escaped_string:
+    case tag_type::vector:
+    case tag_type::map: return narrow_cast<size_t>(_document->value(_index));
+    default: throw operation_error("Can't get size of value of type {}.", type_name());
+    }
+}
+
+JSON_value::const_iterator JSON_value::begin() const
+{
+    if (!is_vector() && !is_map()) {
+        throw operation_error("Can't iterate over value of type {}.", type_name());
+    }
+    return {_document, _index + 2, is_map()};
+}
+
+JSON_value::const_iterator JSON_value::end() const
+{
+    if (!is_vector() && !is_map()) {
+        throw operation_error("Can't iterate over value of type {}.", type_name());
+    }
+    return {_document, _document->next(_index), is_map()};
+}
+
+JSON_value JSON_value::operator[](ssize_t index) const
+{
+    if (!is_vector()) {
+        throw operation_error("Cannot index value of type {} with an integer", type_name());
+    }
+    if (index < 0 || index >= std::ssize(*this)) {
+        throw operation_error("Index {} out of range to access value in vector of size {}", index, size());
+    }
+
+    auto it = begin();
+    std::advance(it, index);
+    return *it;
+}
+
+ssize_t JSON_value::find(std::string_view key) const noexcept
+{
+    if (!is_map()) {
+        return -1;
+    }
+
+    for (auto it = begin(), last = end(); it != last; ++it) {
+        if (it.key() == key) {
+            return (*it)._index;
+        }
+    }
+    return -1;
+}
+
+JSON_value JSON_value::operator[](std::string_view key) const
+{
+    if (!is_map()) {
+        throw operation_error("Cannot index value of type {} with a string", type_name());
+    }
+
+    ttlet index = find(key);
+    if (index < 0) {
+        throw operation_error("Could not find key '{}' in map", key);
+    }
+    return {_document, index};
+}
+
+bool JSON_value::contains(std::string_view key) const noexcept
+{
+    return find(key) >= 0;
+}
+
+datum JSON_value::to_datum() const
+{
+    switch (tag()) {
+    case tag_type::null: return datum{datum::null{}};
+    case tag_type::boolean_false: return datum{false};
+    case tag_type::boolean_true: return datum{true};
+    case tag_type::integer: return datum{static_cast<long long>(*this)};
+    case tag_type::floating: return datum{static_cast<double>(*this)};
+    case tag_type::string:
+    case tag_type::escaped_string: return datum{static_cast<std::string>(*this)};
+    case tag_type::vector: {
+        auto r = datum::vector{};
+        r.reserve(size());
+        for (ttlet item : *this) {
+            r.push_back(item.to_datum());
+        }
+        return datum{std::move(r)};
+    }
+    case tag_type::map: {
+        auto r = datum::map{};
+        for (auto it = begin(), last = end(); it != last; ++it) {
+            r[datum{std::string{it.key()}}] = (*it).to_datum();
+        }
+        return datum{std::move(r)};
+    }
+    default: tt_no_default();
+    }
+}
+
+} // namespace tt
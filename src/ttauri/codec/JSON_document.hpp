@@ -0,0 +1,286 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "../required.hpp"
+#include "../datum.hpp"
+#include "../URL.hpp"
+#include "../resource_view.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <iterator>
+
+namespace tt {
+
+class JSON_value;
+
+/** A parsed JSON document.
+ *
+ * The JSON text is parsed in a single pass into a flat tape of 64 bit words.
+ * Strings without escape sequences are not copied; they are referenced as
+ * `std::string_view` into the original text. The text must therefore outlive
+ * the document, unless the document was loaded from a URL, in which case the
+ * document keeps the resource view alive.
+ *
+ * The parser accepts the same dialect as `parse_JSON()`: trailing commas,
+ * line comments starting with `//` or `#`, and block comments are allowed.
+ */
+class JSON_document {
+public:
+    /** Parse JSON text.
+     *
+     * @param text The JSON text, which must outlive the document.
+     * @throw parse_error on invalid JSON.
+     */
+    explicit JSON_document(std::string_view text);
+
+    /** Load and parse a JSON file.
+     *
+     * @param url The location of the JSON file.
+     * @throw parse_error on invalid JSON.
+     */
+    explicit JSON_document(URL const &url);
+
+    JSON_document(JSON_document const &) = delete;
+    JSON_document(JSON_document &&) noexcept = default;
+    JSON_document &operator=(JSON_document const &) = delete;
+    JSON_document &operator=(JSON_document &&) noexcept = default;
+
+    /** The top level value of the document.
+     */
+    [[nodiscard]] JSON_value root() const noexcept;
+
+private:
+    /** The type of a value on the tape.
+     *
+     * Each value takes two words on the tape. The first word holds the tag
+     * in the top 8 bits and a 56 bit payload, the second word holds the value:
+     *  - null, true, false: no payload, no value.
+     *  - integer: the value is a two's complement 64 bit integer.
+     *  - floating: the value is the bit pattern of a double.
+     *  - string: the payload is the offset in the text, the value is the length.
+     *  - escaped_string: the payload is the offset in `_strings`, the value is the length.
+     *  - vector, map: the payload is the index on the tape after the last child,
+     *    the value is the number of children. The children of a map are
+     *    alternating a string key and a value.
+     */
+    enum class tag_type : uint8_t { null, boolean_false, boolean_true, integer, floating, string, escaped_string, vector, map };
+
+    /** Keeps the text alive when the document was loaded from a URL.
+     */
+    std::unique_ptr<resource_view> _view;
+    std::string_view _text;
+
+    std::vector<uint64_t> _tape;
+
+    /** Storage for strings which contained escape sequences.
+     */
+    std::string _strings;
+
+    [[nodiscard]] tag_type tag(ssize_t index) const noexcept
+    {
+        return static_cast<tag_type>(_tape[index] >> 56);
+    }
+
+    [[nodiscard]] uint64_t payload(ssize_t index) const noexcept
+    {
+        return _tape[index] & 0x00ff'ffff'ffff'ffff;
+    }
+
+    [[nodiscard]] uint64_t value(ssize_t index) const noexcept
+    {
+        return _tape[index + 1];
+    }
+
+    /** The index of the value after the value at `index`, skipping over its children.
+     */
+    [[nodiscard]] ssize_t next(ssize_t index) const noexcept
+    {
+        ttlet t = tag(index);
+        if (t == tag_type::vector || t == tag_type::map) {
+            return narrow_cast<ssize_t>(payload(index));
+        } else {
+            return index + 2;
+        }
+    }
+
+    friend class JSON_value;
+    friend class JSON_parser;
+};
+
+/** A read-only view of a value in a `JSON_document`.
+ *
+ * The interface follows `datum`, so that code reading configuration can be
+ * written the same way for both. Indexing a vector or a map is a linear
+ * search through its children. A view is valid as long as its document is
+ * neither moved nor destroyed.
+ */
+class JSON_value {
+public:
+    /** Iterator over the children of a vector or map.
+     * For a map the iterator dereferences to the value, and `key()` returns the name.
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = JSON_value;
+        using difference_type = ssize_t;
+        using reference = JSON_value;
+        using pointer = void;
+
+        const_iterator() noexcept = default;
+        const_iterator(JSON_document const *document, ssize_t index, bool is_map) noexcept :
+            _document(document), _index(index), _is_map(is_map)
+        {
+        }
+
+        [[nodiscard]] JSON_value operator*() const noexcept
+        {
+            return {_document, _is_map ? _index + 2 : _index};
+        }
+
+        [[nodiscard]] std::string_view key() const noexcept
+        {
+            tt_axiom(_is_map);
+            return static_cast<std::string_view>(JSON_value{_document, _index});
+        }
+
+        const_iterator &operator++() noexcept
+        {
+            _index = _document->next(_is_map ? _index + 2 : _index);
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept
+        {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        [[nodiscard]] friend bool operator==(const_iterator const &lhs, const_iterator const &rhs) noexcept
+        {
+            return lhs._index == rhs._index;
+        }
+
+    private:
+        JSON_document const *_document = nullptr;
+        ssize_t _index = 0;
+        bool _is_map = false;
+    };
+
+    JSON_value(JSON_document const *document, ssize_t index) noexcept : _document(document), _index(index)
+    {
+        tt_axiom(_document != nullptr);
+    }
+
+    [[nodiscard]] datum_type_t type() const noexcept;
+    [[nodiscard]] char const *type_name() const noexcept;
+
+    [[nodiscard]] bool is_null() const noexcept
+    {
+        return tag() == tag_type::null;
+    }
+
+    [[nodiscard]] bool is_bool() const noexcept
+    {
+        return tag() == tag_type::boolean_false || tag() == tag_type::boolean_true;
+    }
+
+    [[nodiscard]] bool is_integer() const noexcept
+    {
+        return tag() == tag_type::integer;
+    }
+
+    [[nodiscard]] bool is_float() const noexcept
+    {
+        return tag() == tag_type::floating;
+    }
+
+    [[nodiscard]] bool is_numeric() const noexcept
+    {
+        return is_integer() || is_float();
+    }
+
+    [[nodiscard]] bool is_string() const noexcept
+    {
+        return tag() == tag_type::string || tag() == tag_type::escaped_string;
+    }
+
+    [[nodiscard]] bool is_vector() const noexcept
+    {
+        return tag() == tag_type::vector;
+    }
+
+    [[nodiscard]] bool is_map() const noexcept
+    {
+        return tag() == tag_type::map;
+    }
+
+    explicit operator bool() const noexcept;
+    explicit operator long long() const;
+    explicit operator double() const;
+    explicit operator std::string_view() const;
+
+    explicit operator int() const
+    {
+        return narrow_cast<int>(static_cast<long long>(*this));
+    }
+
+    explicit operator float() const
+    {
+        return static_cast<float>(static_cast<double>(*this));
+    }
+
+    explicit operator std::string() const
+    {
+        return std::string{static_cast<std::string_view>(*this)};
+    }
+
+    /** The number of characters in a string, or the number of children of a vector or map.
+     */
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] const_iterator begin() const;
+    [[nodiscard]] const_iterator end() const;
+
+    /** Get an item from a vector.
+     */
+    [[nodiscard]] JSON_value operator[](ssize_t index) const;
+
+    /** Get the value from a map.
+     */
+    [[nodiscard]] JSON_value operator[](std::string_view key) const;
+
+    [[nodiscard]] bool contains(std::string_view key) const noexcept;
+
+    /** Copy the value and all its children into a datum.
+     */
+    [[nodiscard]] datum to_datum() const;
+
+private:
+    using tag_type = JSON_document::tag_type;
+
+    JSON_document const *_document;
+    ssize_t _index;
+
+    [[nodiscard]] tag_type tag() const noexcept
+    {
+        return _document->tag(_index);
+    }
+
+    /** Find the index of the value for a key, or -1.
+     */
+    [[nodiscard]] ssize_t find(std::string_view key) const noexcept;
+};
+
+inline JSON_value JSON_document::root() const noexcept
+{
+    return {this, 0};
+}
+
+} // namespace tt
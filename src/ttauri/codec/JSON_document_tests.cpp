@@ -0,0 +1,114 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/codec/JSON_document.hpp"
+#include "ttauri/codec/JSON.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <fmt/format.h>
+
+using namespace std;
+using namespace tt;
+
+TEST(JSONDocument, CompareWithParseJSON) {
+    constexpr auto text = std::string_view{
+        "// comment\n"
+        "{\n"
+        "    \"integer\": 42,\n"
+        "    \"float\": -1.5,\n"
+        "    \"string\": \"bar\",\n"
+        "    \"escaped\": \"a\\\"b\\\\c\\n\",\n"
+        "    \"true\": true, \"false\": false, \"null\": null,\n"
+        "    \"vector\": [1, [2, 3], {},],\n"
+        "    \"map\": {\"a\": {\"b\": [1, 2]}}, # comment\n"
+        "}\n"};
+
+    ttlet document = JSON_document(text);
+    ASSERT_EQ(document.root().to_datum(), parse_JSON(text));
+}
+
+TEST(JSONDocument, Views) {
+    constexpr auto text = std::string_view{"{\"foo\": [42, 43.5, \"bar\", \"b\\tz\"], \"baz\": {\"qux\": true}}"};
+
+    ttlet document = JSON_document(text);
+    ttlet root = document.root();
+    ASSERT_TRUE(root.is_map());
+    ASSERT_EQ(root.size(), 2);
+    ASSERT_TRUE(root.contains("foo"));
+    ASSERT_FALSE(root.contains("bar"));
+
+    ttlet foo = root["foo"];
+    ASSERT_TRUE(foo.is_vector());
+    ASSERT_EQ(foo.size(), 4);
+    ASSERT_EQ(static_cast<long long>(foo[0]), 42);
+    ASSERT_EQ(static_cast<double>(foo[1]), 43.5);
+    ASSERT_EQ(static_cast<std::string_view>(foo[3]), "b\tz");
+
+    // Strings without escape sequences point directly into the text.
+    ttlet bar = static_cast<std::string_view>(foo[2]);
+    ASSERT_EQ(bar, "bar");
+    ASSERT_TRUE(bar.data() >= text.data() && bar.data() < text.data() + text.size());
+
+    ASSERT_TRUE(static_cast<bool>(root["baz"]["qux"]));
+
+    ssize_t count = 0;
+    for (auto it = root.begin(); it != root.end(); ++it) {
+        ASSERT_TRUE(it.key() == "foo" || it.key() == "baz");
+        ++count;
+    }
+    ASSERT_EQ(count, 2);
+}
+
+TEST(JSONDocument, Errors) {
+    ASSERT_THROW(JSON_document("{\"foo\" 42}"), parse_error);
+    ASSERT_THROW(JSON_document("{\"foo\": 42 \"bar\": 43}"), parse_error);
+    ASSERT_THROW(JSON_document("[1, 2"), parse_error);
+    ASSERT_THROW(JSON_document("[nul]"), parse_error);
+    ASSERT_THROW(JSON_document("{} {}"), parse_error);
+    ASSERT_THROW(JSON_document("[99999999999999999999]"), parse_error);
+    ASSERT_THROW(JSON_document("[1e999]"), parse_error);
+    ASSERT_THROW(JSON_document("[1.5e]"), parse_error);
+}
+
+/** Create a large JSON text, similar to a theme file.
+ */
+[[nodiscard]] static std::string make_large_JSON()
+{
+    auto r = std::string{"{\n"};
+    for (int i = 0; i != 20'000; ++i) {
+        r += fmt::format(
+            "    \"item-{}\": {{\"name\": \"item {}\", \"color\": [{}, {}, {}], \"size\": {}.5, \"visible\": true}},\n",
+            i,
+            i,
+            i % 256,
+            (i * 7) % 256,
+            (i * 13) % 256,
+            i);
+    }
+    r += "}\n";
+    return r;
+}
+
+TEST(JSONDocument, Benchmark) {
+    ttlet text = make_large_JSON();
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    ttlet datum_root = parse_JSON(text);
+    ttlet t1 = std::chrono::steady_clock::now();
+    ttlet document = JSON_document(text);
+    ttlet t2 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(datum_root.size(), document.root().size());
+
+    ttlet size = static_cast<double>(std::ssize(text));
+    ttlet datum_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet document_duration = std::chrono::duration<double>(t2 - t1).count();
+
+    std::cout << fmt::format(
+        "parse_JSON: {:.1f} MByte/s, JSON_document: {:.1f} MByte/s\n",
+        size / datum_duration / 1e6,
+        size / document_duration / 1e6);
+}
@@ -27,6 +27,16 @@ TEST(JSON, ParseFloat) {
     ASSERT_EQ(parse_JSON("{\"foo\": 42.0}"), expected);
 }
 
+TEST(JSON, FormatFloat) {
+    ASSERT_EQ(format_JSON(datum{0.1}), "0.1\n");
+    ASSERT_EQ(format_JSON(datum{-1.5e300}), "-1.5e+300\n");
+
+    // The shortest representation round-trips exactly.
+    auto expected = datum::map{};
+    expected["foo"] = datum::vector{0.1 + 0.2, 1.0 / 3.0, 5e-324, 1.7976931348623157e308};
+    ASSERT_EQ(parse_JSON(format_JSON(expected)), expected);
+}
+
 TEST(JSON, ParseString) {
     auto expected = datum::map{};
     expected["foo"] = "bar";
@@ -92,4 +102,15 @@ TEST(JSON, ParseTwoItemObject) {
     expected["foo"]["baz"] = 43;
     ASSERT_EQ(parse_JSON("{\"foo\": {\"bar\": 42, \"baz\": 43}}"), expected);
     ASSERT_EQ(parse_JSON("{\"foo\": {\"bar\": 42, \"baz\": 43,}}"), expected);
-}
\ No newline at end of file
+}
+
+TEST(JSON, ParseArena) {
+    ttlet text = "{\"a long key\": [1, 2.5, \"a long string\", {\"foo\": null}], \"bar\": true, \"bar\": false}";
+    ttlet expected = parse_JSON(text);
+
+    auto arena = datum_arena{};
+    ttlet document = parse_JSON(text, arena);
+    ASSERT_EQ(document, expected);
+    ASSERT_EQ(document["bar"], false);
+    ASSERT_EQ(format_JSON(document), format_JSON(expected));
+}
@@ -0,0 +1,639 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "deflate.hpp"
+#include "../huffman.hpp"
+#include "../endian.hpp"
+#include <array>
+#include <vector>
+#include <bit>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+namespace tt {
+
+/** Parameters of the match finder for each compression level.
+ */
+struct deflate_config {
+    /** When the previous match is at least this long, search less deep.
+     */
+    int good_length;
+
+    /** Lazy matching: do not search for a better match when the previous match is at least this long.
+     * Greedy matching: only insert the positions inside a match in the hash table when the match is at most this long.
+     */
+    int max_lazy;
+
+    /** Stop searching when a match of at least this length is found.
+     */
+    int nice_length;
+
+    /** Maximum number of hash-chain entries to check.
+     */
+    int max_chain;
+
+    bool lazy;
+};
+
+constexpr auto deflate_configs = std::array<deflate_config, 10>{{
+    {0, 0, 0, 0, false},
+    {4, 4, 8, 4, false},
+    {4, 5, 16, 8, false},
+    {4, 6, 32, 32, false},
+    {4, 4, 16, 16, true},
+    {8, 16, 32, 32, true},
+    {8, 16, 128, 128, true},
+    {8, 32, 128, 256, true},
+    {32, 128, 258, 1024, true},
+    {32, 258, 258, 4096, true},
+}};
+
+constexpr auto deflate_length_extra = std::array<int, 29>{0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+constexpr auto deflate_distance_extra =
+    std::array<int, 30>{0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/** The order in which the code lengths of the code length alphabet are stored.
+ */
+constexpr auto deflate_code_length_order = std::array{16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+[[nodiscard]] static int deflate_length_symbol(int length) noexcept
+{
+    tt_axiom(length >= 3 && length <= 258);
+    ttlet l = length - 3;
+    if (l < 8) {
+        return 257 + l;
+    } else if (l == 255) {
+        return 285;
+    } else {
+        ttlet nr_bits = static_cast<int>(std::bit_width(static_cast<unsigned int>(l))) - 1;
+        return 257 + 4 * (nr_bits - 1) + ((l >> (nr_bits - 2)) & 3);
+    }
+}
+
+[[nodiscard]] static int deflate_distance_symbol(int distance) noexcept
+{
+    tt_axiom(distance >= 1 && distance <= 32768);
+    ttlet d = distance - 1;
+    if (d < 4) {
+        return d;
+    } else {
+        ttlet nr_bits = static_cast<int>(std::bit_width(static_cast<unsigned int>(d))) - 1;
+        return 2 * nr_bits + ((d >> (nr_bits - 1)) & 1);
+    }
+}
+
+/** Bit writer for deflate streams.
+ * Bits are written LSB first, 32 bits at a time.
+ */
+class deflate_bit_writer {
+public:
+    deflate_bit_writer(bstring &output) noexcept : _output(output) {}
+
+    tt_force_inline void put(uint32_t value, int nr_bits) noexcept
+    {
+        tt_axiom(nr_bits <= 32);
+        _buffer |= static_cast<uint64_t>(value) << _nr_bits;
+        _nr_bits += nr_bits;
+        if (_nr_bits >= 32) {
+            ttlet tmp = native_to_little(static_cast<uint32_t>(_buffer));
+            _output.append(reinterpret_cast<std::byte const *>(&tmp), sizeof(tmp));
+            _buffer >>= 32;
+            _nr_bits -= 32;
+        }
+    }
+
+    /** Write all bits, including a partial byte padded with zeros.
+     */
+    void align_to_byte() noexcept
+    {
+        while (_nr_bits > 0) {
+            _output.push_back(static_cast<std::byte>(_buffer & 0xff));
+            _buffer >>= 8;
+            _nr_bits -= 8;
+        }
+        _buffer = 0;
+        _nr_bits = 0;
+    }
+
+    /** Write bytes directly, the writer must be aligned to a byte.
+     */
+    void append(std::byte const *bytes, ssize_t size) noexcept
+    {
+        tt_axiom(_nr_bits == 0);
+        _output.append(bytes, size);
+    }
+
+private:
+    bstring &_output;
+    uint64_t _buffer = 0;
+    int _nr_bits = 0;
+};
+
+/** A huffman code for encoding.
+ * The codes are bit reversed so that they can be written LSB first.
+ */
+struct deflate_code {
+    std::vector<int> lengths;
+    std::vector<uint16_t> codes;
+
+    deflate_code(std::vector<int> lengths_) noexcept : lengths(std::move(lengths_)), codes(lengths.size())
+    {
+        ttlet canonical_codes = huffman_codes_from_lengths(lengths);
+        for (ssize_t symbol = 0; symbol != std::ssize(lengths); ++symbol) {
+            auto code = canonical_codes[symbol];
+            auto reversed = 0;
+            for (int i = 0; i != lengths[symbol]; ++i) {
+                reversed = (reversed << 1) | (code & 1);
+                code >>= 1;
+            }
+            codes[symbol] = static_cast<uint16_t>(reversed);
+        }
+    }
+
+    tt_force_inline void put(deflate_bit_writer &writer, int symbol) const noexcept
+    {
+        tt_axiom(lengths[symbol] != 0);
+        writer.put(codes[symbol], lengths[symbol]);
+    }
+
+    /** The number of bits needed to encode symbols with the given frequencies.
+     */
+    [[nodiscard]] int64_t cost(std::span<int const> frequencies) const noexcept
+    {
+        int64_t r = 0;
+        for (ssize_t symbol = 0; symbol != std::ssize(frequencies); ++symbol) {
+            r += static_cast<int64_t>(frequencies[symbol]) * lengths[symbol];
+        }
+        return r;
+    }
+};
+
+static deflate_code const &deflate_fixed_literal_code() noexcept
+{
+    static ttlet code = []() {
+        auto lengths = std::vector<int>(288, 0);
+        std::fill(lengths.begin(), lengths.begin() + 144, 8);
+        std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+        std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+        std::fill(lengths.begin() + 280, lengths.end(), 8);
+        return deflate_code(std::move(lengths));
+    }();
+    return code;
+}
+
+static deflate_code const &deflate_fixed_distance_code() noexcept
+{
+    static ttlet code = deflate_code(std::vector<int>(30, 5));
+    return code;
+}
+
+/** Make sure at least two symbols are used, so that the huffman code is complete.
+ */
+static void deflate_fix_frequencies(std::span<int> frequencies) noexcept
+{
+    auto nr_used = std::count_if(frequencies.begin(), frequencies.end(), [](ttlet x) {
+        return x != 0;
+    });
+
+    for (ssize_t symbol = 0; nr_used < 2 && symbol != std::ssize(frequencies); ++symbol) {
+        if (frequencies[symbol] == 0) {
+            frequencies[symbol] = 1;
+            ++nr_used;
+        }
+    }
+}
+
+class deflate_encoder {
+public:
+    deflate_encoder(std::span<std::byte const> bytes, int level) noexcept :
+        _bytes(bytes),
+        _config(deflate_configs[level]),
+        _writer(_output),
+        _head(hash_size, -1),
+        _prev(window_size, -1)
+    {
+        _tokens.reserve(max_nr_tokens);
+    }
+
+    [[nodiscard]] bstring compress() noexcept
+    {
+        if (_config.max_chain == 0) {
+            put_stored_block(0, std::ssize(_bytes), true);
+        } else if (_config.lazy) {
+            compress_lazy();
+        } else {
+            compress_greedy();
+        }
+
+        _writer.align_to_byte();
+        return std::move(_output);
+    }
+
+private:
+    /** A literal (distance is zero) or a length/distance pair.
+     */
+    struct token_type {
+        uint16_t length;
+        uint16_t distance;
+    };
+
+    static constexpr int hash_bits = 15;
+    static constexpr ssize_t hash_size = ssize_t{1} << hash_bits;
+    static constexpr ssize_t window_size = 0x8000;
+    static constexpr ssize_t window_mask = window_size - 1;
+    static constexpr int min_match = 3;
+    static constexpr int max_match = 258;
+    static constexpr ssize_t max_nr_tokens = 0x4000;
+
+    /** A match of length 3 with a larger distance is more expensive than 3 literals.
+     */
+    static constexpr int too_far = 4096;
+
+    std::span<std::byte const> _bytes;
+    deflate_config _config;
+    bstring _output;
+    deflate_bit_writer _writer;
+
+    std::vector<int32_t> _head;
+    std::vector<int32_t> _prev;
+
+    std::vector<token_type> _tokens;
+    std::array<int, 286> _literal_frequencies = {};
+    std::array<int, 30> _distance_frequencies = {};
+
+    /** The position in the input of the first byte of the current block.
+     */
+    ssize_t _block_start = 0;
+
+    /** The position in the input of the first byte not yet covered by a token.
+     */
+    ssize_t _token_end = 0;
+
+    [[nodiscard]] tt_force_inline uint32_t hash(ssize_t position) const noexcept
+    {
+        ttlet p = reinterpret_cast<uint8_t const *>(_bytes.data() + position);
+        ttlet value = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+        return (value * 2654435761U) >> (32 - hash_bits);
+    }
+
+    tt_force_inline void insert(ssize_t position) noexcept
+    {
+        if (position + min_match <= std::ssize(_bytes)) {
+            ttlet h = hash(position);
+            _prev[position & window_mask] = _head[h];
+            _head[h] = static_cast<int32_t>(position);
+        }
+    }
+
+    [[nodiscard]] tt_force_inline ssize_t match_length(ssize_t candidate, ssize_t position, ssize_t max_length) const noexcept
+    {
+        ttlet a = _bytes.data() + candidate;
+        ttlet b = _bytes.data() + position;
+
+        ssize_t i = 0;
+        for (; i + 8 <= max_length; i += 8) {
+            uint64_t a_value;
+            uint64_t b_value;
+            std::memcpy(&a_value, a + i, sizeof(a_value));
+            std::memcpy(&b_value, b + i, sizeof(b_value));
+            if (ttlet diff = little_to_native(a_value) ^ little_to_native(b_value)) {
+                return i + std::countr_zero(diff) / 8;
+            }
+        }
+        while (i < max_length && a[i] == b[i]) {
+            ++i;
+        }
+        return i;
+    }
+
+    /** Find the longest match in the hash-chain for the current position.
+     *
+     * @param position The position in the input to find a match for.
+     * @param prev_length The match must be longer than this.
+     * @return Length and distance of the match, the length is zero if no better match was found.
+     */
+    [[nodiscard]] std::pair<int, int> find_match(ssize_t position, ssize_t prev_length) const noexcept
+    {
+        ttlet max_length = std::min(ssize_t{max_match}, std::ssize(_bytes) - position);
+        auto best_length = std::max(prev_length, ssize_t{min_match - 1});
+        ssize_t best_distance = 0;
+        if (best_length >= max_length) {
+            return {0, 0};
+        }
+
+        auto chain = prev_length >= _config.good_length ? _config.max_chain >> 2 : _config.max_chain;
+        auto candidate = static_cast<ssize_t>(_head[hash(position)]);
+
+        ttlet data = _bytes.data();
+        while (candidate >= 0 && position - candidate <= window_size && chain-- > 0) {
+            if (data[candidate + best_length] == data[position + best_length] && data[candidate] == data[position]) {
+                ttlet length = match_length(candidate, position, max_length);
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = position - candidate;
+                    if (length >= _config.nice_length || length == max_length) {
+                        break;
+                    }
+                }
+            }
+
+            // Entries older than the window may have been overwritten with newer positions.
+            ttlet next = static_cast<ssize_t>(_prev[candidate & window_mask]);
+            if (next >= candidate) {
+                break;
+            }
+            candidate = next;
+        }
+
+        if (best_distance == 0 || (best_length == min_match && best_distance > too_far)) {
+            return {0, 0};
+        } else {
+            return {static_cast<int>(best_length), static_cast<int>(best_distance)};
+        }
+    }
+
+    void compress_greedy() noexcept
+    {
+        ttlet size = std::ssize(_bytes);
+
+        ssize_t position = 0;
+        while (position < size) {
+            ttlet[length, distance] = find_match(position, 0);
+            insert(position);
+
+            if (length != 0) {
+                put_match(length, distance);
+                if (length <= _config.max_lazy) {
+                    for (auto p = position + 1; p != position + length; ++p) {
+                        insert(p);
+                    }
+                }
+                position += length;
+
+            } else {
+                put_literal(position);
+                ++position;
+            }
+        }
+
+        flush_block(true);
+    }
+
+    void compress_lazy() noexcept
+    {
+        ttlet size = std::ssize(_bytes);
+
+        // A match found at the previous position, which may be replaced by a longer match at this position.
+        auto prev_length = 0;
+        auto prev_distance = 0;
+
+        // The byte at the previous position has not been emitted yet.
+        auto pending = false;
+
+        ssize_t position = 0;
+        while (position < size) {
+            auto length = 0;
+            auto distance = 0;
+            if (prev_length < _config.max_lazy) {
+                std::tie(length, distance) = find_match(position, prev_length);
+            }
+            insert(position);
+
+            if (prev_length != 0 && length == 0) {
+                // The match at the previous position is better.
+                put_match(prev_length, prev_distance);
+                ttlet end = position - 1 + prev_length;
+                for (auto p = position + 1; p < end; ++p) {
+                    insert(p);
+                }
+                position = end;
+                prev_length = 0;
+                pending = false;
+
+            } else {
+                if (pending) {
+                    put_literal(position - 1);
+                }
+                pending = true;
+                prev_length = length;
+                prev_distance = distance;
+                ++position;
+            }
+        }
+
+        if (pending) {
+            put_literal(size - 1);
+        }
+
+        flush_block(true);
+    }
+
+    tt_force_inline void put_literal(ssize_t position) noexcept
+    {
+        ttlet value = static_cast<uint8_t>(_bytes[position]);
+        _tokens.push_back({value, 0});
+        ++_literal_frequencies[value];
+        ++_token_end;
+
+        if (std::ssize(_tokens) == max_nr_tokens) {
+            flush_block(false);
+        }
+    }
+
+    tt_force_inline void put_match(int length, int distance) noexcept
+    {
+        _tokens.push_back({static_cast<uint16_t>(length), static_cast<uint16_t>(distance)});
+        ++_literal_frequencies[deflate_length_symbol(length)];
+        ++_distance_frequencies[deflate_distance_symbol(distance)];
+        _token_end += length;
+
+        if (std::ssize(_tokens) == max_nr_tokens) {
+            flush_block(false);
+        }
+    }
+
+    /** The number of extra bits for the lengths and distances in the current block.
+     */
+    [[nodiscard]] int64_t extra_cost() const noexcept
+    {
+        int64_t r = 0;
+        for (int i = 0; i != 29; ++i) {
+            r += static_cast<int64_t>(_literal_frequencies[257 + i]) * deflate_length_extra[i];
+        }
+        for (int i = 0; i != 30; ++i) {
+            r += static_cast<int64_t>(_distance_frequencies[i]) * deflate_distance_extra[i];
+        }
+        return r;
+    }
+
+    void put_tokens(deflate_code const &literal_code, deflate_code const &distance_code) noexcept
+    {
+        for (ttlet token : _tokens) {
+            if (token.distance == 0) {
+                literal_code.put(_writer, token.length);
+
+            } else {
+                ttlet length_symbol = deflate_length_symbol(token.length);
+                ttlet length_extra = deflate_length_extra[length_symbol - 257];
+                literal_code.put(_writer, length_symbol);
+                _writer.put((token.length - 3) & ((1 << length_extra) - 1), length_extra);
+
+                ttlet distance_symbol = deflate_distance_symbol(token.distance);
+                ttlet distance_extra = deflate_distance_extra[distance_symbol];
+                distance_code.put(_writer, distance_symbol);
+                _writer.put((token.distance - 1) & ((1 << distance_extra) - 1), distance_extra);
+            }
+        }
+        literal_code.put(_writer, 256);
+    }
+
+    void put_stored_block(ssize_t first, ssize_t last, bool final) noexcept
+    {
+        do {
+            ttlet size = std::min(last - first, ssize_t{0xffff});
+            _writer.put(final && first + size == last ? 1 : 0, 1);
+            _writer.put(0, 2);
+            _writer.align_to_byte();
+            _writer.put(static_cast<uint32_t>(size) | (static_cast<uint32_t>(~size & 0xffff) << 16), 32);
+            _writer.append(_bytes.data() + first, size);
+            first += size;
+        } while (first != last);
+    }
+
+    /** Run-length encode the code lengths.
+     * @return pairs of code length symbols and their extra bits value.
+     */
+    [[nodiscard]] static std::vector<std::pair<int, int>> encode_lengths(std::vector<int> const &lengths) noexcept
+    {
+        auto r = std::vector<std::pair<int, int>>{};
+
+        ssize_t i = 0;
+        while (i != std::ssize(lengths)) {
+            ttlet value = lengths[i];
+            auto run = ssize_t{1};
+            while (i + run != std::ssize(lengths) && lengths[i + run] == value) {
+                ++run;
+            }
+            i += run;
+
+            if (value == 0) {
+                while (run >= 11) {
+                    ttlet n = std::min(run, ssize_t{138});
+                    r.emplace_back(18, static_cast<int>(n - 11));
+                    run -= n;
+                }
+                if (run >= 3) {
+                    r.emplace_back(17, static_cast<int>(run - 3));
+                    run = 0;
+                }
+            } else {
+                r.emplace_back(value, 0);
+                --run;
+                while (run >= 3) {
+                    ttlet n = std::min(run, ssize_t{6});
+                    r.emplace_back(16, static_cast<int>(n - 3));
+                    run -= n;
+                }
+            }
+
+            for (; run != 0; --run) {
+                r.emplace_back(value, 0);
+            }
+        }
+        return r;
+    }
+
+    void flush_block(bool final) noexcept
+    {
+        constexpr auto code_length_extra = std::array{2, 3, 7};
+
+        _literal_frequencies[256] = 1;
+        deflate_fix_frequencies(_literal_frequencies);
+        deflate_fix_frequencies(_distance_frequencies);
+
+        auto literal_code = deflate_code(huffman_lengths_from_frequencies(_literal_frequencies, 15));
+        auto distance_code = deflate_code(huffman_lengths_from_frequencies(_distance_frequencies, 15));
+
+        auto nr_literals = ssize_t{286};
+        while (nr_literals > 257 && literal_code.lengths[nr_literals - 1] == 0) {
+            --nr_literals;
+        }
+        auto nr_distances = ssize_t{30};
+        while (nr_distances > 1 && distance_code.lengths[nr_distances - 1] == 0) {
+            --nr_distances;
+        }
+
+        auto lengths = std::vector<int>(literal_code.lengths.begin(), literal_code.lengths.begin() + nr_literals);
+        lengths.insert(lengths.end(), distance_code.lengths.begin(), distance_code.lengths.begin() + nr_distances);
+        ttlet encoded_lengths = encode_lengths(lengths);
+
+        auto code_length_frequencies = std::array<int, 19>{};
+        for (ttlet &entry : encoded_lengths) {
+            ++code_length_frequencies[entry.first];
+        }
+        deflate_fix_frequencies(code_length_frequencies);
+        ttlet code_length_code = deflate_code(huffman_lengths_from_frequencies(code_length_frequencies, 7));
+
+        auto nr_code_lengths = ssize_t{19};
+        while (nr_code_lengths > 4 && code_length_code.lengths[deflate_code_length_order[nr_code_lengths - 1]] == 0) {
+            --nr_code_lengths;
+        }
+
+        ttlet extra_bits = extra_cost();
+
+        auto dynamic_cost = 3 + 14 + 3 * nr_code_lengths + code_length_code.cost(code_length_frequencies) +
+            literal_code.cost(_literal_frequencies) + distance_code.cost(_distance_frequencies) + extra_bits;
+        for (int i = 0; i != 3; ++i) {
+            dynamic_cost += static_cast<int64_t>(code_length_frequencies[16 + i]) * code_length_extra[i];
+        }
+
+        ttlet fixed_cost = 3 + deflate_fixed_literal_code().cost(_literal_frequencies) +
+            deflate_fixed_distance_code().cost(_distance_frequencies) + extra_bits;
+
+        ttlet block_size = _token_end - _block_start;
+        ttlet stored_cost = (std::max(ssize_t{1}, (block_size + 0xfffe) / 0xffff) * 5 + block_size) * 8 + 7;
+
+        if (stored_cost <= dynamic_cost && stored_cost <= fixed_cost) {
+            put_stored_block(_block_start, _token_end, final);
+
+        } else if (fixed_cost <= dynamic_cost) {
+            _writer.put(final ? 1 : 0, 1);
+            _writer.put(1, 2);
+            put_tokens(deflate_fixed_literal_code(), deflate_fixed_distance_code());
+
+        } else {
+            _writer.put(final ? 1 : 0, 1);
+            _writer.put(2, 2);
+            _writer.put(static_cast<uint32_t>(nr_literals - 257), 5);
+            _writer.put(static_cast<uint32_t>(nr_distances - 1), 5);
+            _writer.put(static_cast<uint32_t>(nr_code_lengths - 4), 4);
+            for (ssize_t i = 0; i != nr_code_lengths; ++i) {
+                _writer.put(static_cast<uint32_t>(code_length_code.lengths[deflate_code_length_order[i]]), 3);
+            }
+            for (ttlet[symbol, extra] : encoded_lengths) {
+                code_length_code.put(_writer, symbol);
+                if (symbol >= 16) {
+                    _writer.put(static_cast<uint32_t>(extra), code_length_extra[symbol - 16]);
+                }
+            }
+            put_tokens(literal_code, distance_code);
+        }
+
+        _tokens.clear();
+        _literal_frequencies = {};
+        _distance_frequencies = {};
+        _block_start = _token_end;
+    }
+};
+
+bstring deflate(std::span<std::byte const> bytes, int level)
+{
+    tt_axiom(level >= 0 && level <= 9);
+    return deflate_encoder(bytes, level).compress();
+}
+
+} // namespace tt
@@ -0,0 +1,29 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "../required.hpp"
+#include "../byte_string.hpp"
+#include <span>
+
+namespace tt {
+
+/** Compress data using the deflate algorithm.
+ *
+ * The compression level selects the match finder:
+ *  - 0: No compression, only stored blocks.
+ *  - 1-3: Greedy matching with short hash-chains, for speed.
+ *  - 4-9: Lazy matching with increasingly longer hash-chains, for size.
+ *
+ * For each block the smallest of a stored, fixed-huffman or dynamic-huffman
+ * block is emitted.
+ *
+ * @param bytes The data to compress.
+ * @param level The compression level between 0 and 9.
+ * @return The raw deflate compressed data.
+ */
+[[nodiscard]] bstring deflate(std::span<std::byte const> bytes, int level = 6);
+
+}
@@ -0,0 +1,77 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/codec/deflate.hpp"
+#include "ttauri/codec/inflate.hpp"
+#include "ttauri/codec/gzip.hpp"
+#include "ttauri/codec/zlib.hpp"
+#include "ttauri/file_view.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <fmt/format.h>
+
+using namespace std;
+using namespace tt;
+
+static void deflate_round_trip(URL const &original_url)
+{
+    ttlet original = file_view(original_url);
+    ttlet original_bytes = original.bytes();
+
+    for (ttlet level : {0, 1, 4, 6, 9}) {
+        ttlet compressed = deflate(original_bytes, level);
+        ssize_t offset = 0;
+        ttlet decompressed = inflate(compressed, offset);
+        ASSERT_EQ(offset, std::ssize(compressed));
+        ASSERT_EQ(std::ssize(decompressed), std::ssize(original_bytes));
+        for (ssize_t i = 0; i != std::ssize(decompressed); ++i) {
+            ASSERT_EQ(decompressed[i], original_bytes[i]);
+        }
+
+        ttlet gzip_decompressed = gzip_decompress(gzip_compress(original_bytes, level));
+        ASSERT_TRUE(gzip_decompressed == decompressed);
+
+        ttlet zlib_decompressed = zlib_decompress(zlib_compress(original_bytes, level));
+        ASSERT_TRUE(zlib_decompressed == decompressed);
+    }
+}
+
+TEST(Deflate, RoundTrip) {
+    deflate_round_trip(URL("file:gzip_test1.bin"));
+    deflate_round_trip(URL("file:gzip_test2.bin"));
+    deflate_round_trip(URL("file:gzip_test3.bin"));
+    deflate_round_trip(URL("file:gzip_test4.bin"));
+    deflate_round_trip(URL("file:gzip_test5.bin"));
+    deflate_round_trip(URL("file:gzip_test6.bin"));
+    deflate_round_trip(URL("file:gzip_test7.bin"));
+    deflate_round_trip(URL("file:gzip_test8.bin"));
+}
+
+TEST(Deflate, Benchmark) {
+    ttlet original = file_view(URL("file:gzip_test7.bin"));
+    ttlet original_bytes = original.bytes();
+
+    constexpr int nr_iterations = 20;
+
+    for (ttlet level : {1, 6, 9}) {
+        ssize_t compressed_size = 0;
+
+        ttlet t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i != nr_iterations; ++i) {
+            compressed_size = std::ssize(deflate(original_bytes, level));
+        }
+        ttlet t1 = std::chrono::steady_clock::now();
+
+        ttlet duration = std::chrono::duration<double>(t1 - t0).count();
+        ttlet original_size = static_cast<double>(std::ssize(original_bytes));
+
+        std::cout << fmt::format(
+            "deflate level {}: {:.1f} MByte/s, ratio {:.3f}\n",
+            level,
+            original_size * nr_iterations / duration / 1e6,
+            compressed_size / original_size);
+    }
+}
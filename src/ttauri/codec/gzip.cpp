@@ -1,11 +1,13 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "gzip.hpp"
 #include "inflate.hpp"
+#include "deflate.hpp"
 #include "../endian.hpp"
 #include "../placement.hpp"
+#include <array>
 
 namespace tt {
 
@@ -84,4 +86,49 @@ bstring gzip_decompress(std::span<std::byte const> bytes, ssize_t max_size)
     return r;
 }
 
+[[nodiscard]] static uint32_t crc32(std::span<std::byte const> bytes) noexcept
+{
+    static constexpr auto table = []() {
+        auto r = std::array<uint32_t, 256>{};
+        for (uint32_t i = 0; i != 256; ++i) {
+            auto c = i;
+            for (int k = 0; k != 8; ++k) {
+                c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            }
+            r[i] = c;
+        }
+        return r;
+    }();
+
+    uint32_t c = 0xffffffff;
+    for (ttlet byte : bytes) {
+        c = table[(c ^ static_cast<uint8_t>(byte)) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xffffffff;
+}
+
+bstring gzip_compress(std::span<std::byte const> bytes, int level)
+{
+    auto header = GZIPMemberHeader{};
+    header.ID1 = 31;
+    header.ID2 = 139;
+    header.CM = 8;
+    header.FLG = 0;
+    header.MTIME = 0;
+    // XFL 2: maximum compression, 4: fastest algorithm.
+    header.XFL = level >= 6 ? 2 : 4;
+    // OS 255: unknown.
+    header.OS = 255;
+
+    auto r = bstring{};
+    r.append(reinterpret_cast<std::byte const *>(&header), sizeof(header));
+    r.append(deflate(bytes, level));
+
+    ttlet CRC32 = native_to_little(crc32(bytes));
+    ttlet ISIZE = native_to_little(static_cast<uint32_t>(std::size(bytes) & 0xffffffff));
+    r.append(reinterpret_cast<std::byte const *>(&CRC32), sizeof(CRC32));
+    r.append(reinterpret_cast<std::byte const *>(&ISIZE), sizeof(ISIZE));
+    return r;
+}
+
 } // namespace tt
\ No newline at end of file
@@ -1,4 +1,4 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
@@ -17,4 +17,12 @@ inline bstring gzip_decompress(URL const &url, ssize_t max_size=0x01000000) {
     return gzip_decompress(*url.loadView(), max_size);
 }
 
+/** Compress data into a single gzip member.
+ *
+ * @param bytes The data to compress.
+ * @param level The compression level between 0 and 9, see `deflate()`.
+ * @return gzip header, deflate compressed data and CRC32+ISIZE trailer.
+ */
+[[nodiscard]] bstring gzip_compress(std::span<std::byte const> bytes, int level = 6);
+
 }
@@ -1,314 +1,279 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "inflate.hpp"
-#include "../bits.hpp"
-#include "../placement.hpp"
-#include "../huffman.hpp"
+#include "inflate_table.hpp"
+#include "../endian.hpp"
 #include <array>
+#include <cstring>
 
 namespace tt {
 
-static void inflate_copy_block(std::span<std::byte const> bytes, ssize_t &bit_offset, ssize_t max_size, bstring &r)
-{
-    auto offset = (bit_offset + 7) / 8;
+/** Output buffer of the inflate algorithm.
+ * The buffer is over-allocated so that matches can be copied 8 bytes at a time
+ * without checking for the end of the buffer.
+ */
+class inflate_output {
+public:
+    /** The maximum number of bytes that may be written beyond the size of a match.
+     */
+    static constexpr ssize_t slack = 8;
+
+    inflate_output(ssize_t max_size) noexcept : _max_size(max_size)
+    {
+        _buffer.resize(std::min(max_size, ssize_t{0x1'0000}) + 258 + slack);
+    }
 
-    auto LEN = make_placement_ptr<little_uint16_buf_t>(bytes, offset);
-    [[maybe_unused]] auto NLEN = make_placement_ptr<little_uint16_buf_t>(bytes, offset);
+    [[nodiscard]] ssize_t size() const noexcept
+    {
+        return _size;
+    }
 
-    tt_parse_check((offset + LEN->value()) <= std::ssize(bytes), "input buffer overrun");
-    tt_parse_check((std::ssize(r) + LEN->value()) <= max_size, "output buffer overrun");
-    r.append(&bytes[offset], LEN->value());
+    /** Reserve room for writing `n` more bytes to the output.
+     * @throw parse_error when the output would become larger than max_size.
+     */
+    tt_force_inline void reserve(ssize_t n)
+    {
+        tt_parse_check(_size + n <= _max_size, "Output buffer overrun");
+        if (_size + n + slack > std::ssize(_buffer)) [[unlikely]] {
+            grow(n);
+        }
+    }
 
-    bit_offset = offset * 8;
-}
+    tt_force_inline void push_back(std::byte value) noexcept
+    {
+        _buffer[_size++] = value;
+    }
 
-[[nodiscard]] static int inflate_decode_length(
-    std::span<std::byte const> bytes,
-    ssize_t &bit_offset,
-    int symbol)
-{
-    switch (symbol) {
-    case 257: return 3;
-    case 258: return 4;
-    case 259: return 5;
-    case 260: return 6;
-    case 261: return 7;
-    case 262: return 8;
-    case 263: return 9;
-    case 264: return 10;
-    case 265: return get_bits(bytes, bit_offset, 1) + 11;
-    case 266: return get_bits(bytes, bit_offset, 1) + 13;
-    case 267: return get_bits(bytes, bit_offset, 1) + 15;
-    case 268: return get_bits(bytes, bit_offset, 1) + 17;
-    case 269: return get_bits(bytes, bit_offset, 2) + 19;
-    case 270: return get_bits(bytes, bit_offset, 2) + 23;
-    case 271: return get_bits(bytes, bit_offset, 2) + 27;
-    case 272: return get_bits(bytes, bit_offset, 2) + 31;
-    case 273: return get_bits(bytes, bit_offset, 3) + 35;
-    case 274: return get_bits(bytes, bit_offset, 3) + 43;
-    case 275: return get_bits(bytes, bit_offset, 3) + 51;
-    case 276: return get_bits(bytes, bit_offset, 3) + 59;
-    case 277: return get_bits(bytes, bit_offset, 4) + 67;
-    case 278: return get_bits(bytes, bit_offset, 4) + 83;
-    case 279: return get_bits(bytes, bit_offset, 4) + 99;
-    case 280: return get_bits(bytes, bit_offset, 4) + 115;
-    case 281: return get_bits(bytes, bit_offset, 5) + 131;
-    case 282: return get_bits(bytes, bit_offset, 5) + 163;
-    case 283: return get_bits(bytes, bit_offset, 5) + 195;
-    case 284: return get_bits(bytes, bit_offset, 5) + 227;
-    case 285: return 258;
-    default:
-        throw parse_error(fmt::format("Literal/Length symbol out of range {}", symbol)); 
+    void append(std::byte const *src, ssize_t n) noexcept
+    {
+        std::memcpy(_buffer.data() + _size, src, n);
+        _size += n;
     }
-}
 
-[[nodiscard]] static int inflate_decode_distance(
-    std::span<std::byte const> bytes,
-    ssize_t &bit_offset,
-    int symbol)
-{
-    switch (symbol) {
-    case 0: return 1;
-    case 1: return 2;
-    case 2: return 3;
-    case 3: return 4;
-    case 4: return get_bits(bytes, bit_offset, 1) + 5;
-    case 5: return get_bits(bytes, bit_offset, 1) + 7;
-    case 6: return get_bits(bytes, bit_offset, 2) + 9;
-    case 7: return get_bits(bytes, bit_offset, 2) + 13;
-    case 8: return get_bits(bytes, bit_offset, 3) + 17;
-    case 9: return get_bits(bytes, bit_offset, 3) + 25;
-    case 10: return get_bits(bytes, bit_offset, 4) + 33;
-    case 11: return get_bits(bytes, bit_offset, 4) + 49;
-    case 12: return get_bits(bytes, bit_offset, 5) + 65;
-    case 13: return get_bits(bytes, bit_offset, 5) + 97;
-    case 14: return get_bits(bytes, bit_offset, 6) + 129;
-    case 15: return get_bits(bytes, bit_offset, 6) + 193;
-    case 16: return get_bits(bytes, bit_offset, 7) + 257;
-    case 17: return get_bits(bytes, bit_offset, 7) + 385;
-    case 18: return get_bits(bytes, bit_offset, 8) + 513;
-    case 19: return get_bits(bytes, bit_offset, 8) + 769;
-    case 20: return get_bits(bytes, bit_offset, 9) + 1025;
-    case 21: return get_bits(bytes, bit_offset, 9) + 1537;
-    case 22: return get_bits(bytes, bit_offset, 10) + 2049;
-    case 23: return get_bits(bytes, bit_offset, 10) + 3073;
-    case 24: return get_bits(bytes, bit_offset, 11) + 4097;
-    case 25: return get_bits(bytes, bit_offset, 11) + 6145;
-    case 26: return get_bits(bytes, bit_offset, 12) + 8193;
-    case 27: return get_bits(bytes, bit_offset, 12) + 12289;
-    case 28: return get_bits(bytes, bit_offset, 13) + 16385;
-    case 29: return get_bits(bytes, bit_offset, 13) + 24577;
-    default:
-        throw parse_error(fmt::format("Distance symbol out of range {}", symbol)); 
+    /** Copy previously decoded data.
+     * `reserve()` must be called before `copy()`.
+     */
+    tt_force_inline void copy(ssize_t distance, ssize_t length) noexcept
+    {
+        tt_axiom(distance >= 1 && distance <= _size);
+
+        auto *dst = _buffer.data() + _size;
+        auto const *src = dst - distance;
+        _size += length;
+
+        if (distance >= 8) {
+            // The source is always at least 8 bytes before the destination, so it is
+            // safe to copy in 8 byte chunks; overrunning the end of the match into the slack.
+            for (ssize_t i = 0; i < length; i += 8) {
+                std::memcpy(dst + i, src + i, 8);
+            }
+        } else if (distance == 1) {
+            std::memset(dst, static_cast<int>(*src), length);
+        } else {
+            for (ssize_t i = 0; i != length; ++i) {
+                dst[i] = src[i];
+            }
+        }
     }
-}
 
-static void inflate_block(
-    std::span<std::byte const> bytes,
-    ssize_t &bit_offset,
-    ssize_t max_size,
-    huffman_tree<int16_t> const &literal_tree,
-    huffman_tree<int16_t> const &distance_tree,
-    bstring &r)
-{
-    while (true) {
-        // Test only every get_symbol, the trailer is at least 32 bits (Checksum)
-        // - 15 bits maximum huffman code.
-        // -  5 bits extra length.
-        // -  7 bits rounding up to byte.
-        tt_parse_check(((bit_offset + 27) >> 3) <= std::ssize(bytes), "Input buffer overrun");
+    [[nodiscard]] bstring finish() noexcept
+    {
+        _buffer.resize(_size);
+        return std::move(_buffer);
+    }
 
-        auto literal_symbol = literal_tree.get_symbol(bytes, bit_offset);
+private:
+    bstring _buffer;
+    ssize_t _size = 0;
+    ssize_t _max_size;
 
-        if (literal_symbol <= 255) {
-            tt_parse_check(std::ssize(r) < max_size, "Output buffer overrun");
-            r.push_back(static_cast<std::byte>(literal_symbol));
+    tt_no_inline void grow(ssize_t n)
+    {
+        auto new_size = std::max(std::ssize(_buffer) * 2, _size + n + slack);
+        new_size = std::min(new_size, _max_size + slack);
+        _buffer.resize(new_size);
+    }
+};
 
-        } else if (literal_symbol == 256) {
-            // End-of-block.
-            return;
+static void inflate_copy_block(std::span<std::byte const> bytes, inflate_bit_reader &reader, inflate_output &r)
+{
+    auto offset = reader.align_to_byte();
 
-        } else {
-            auto length = inflate_decode_length(bytes, bit_offset, literal_symbol); 
-            tt_parse_check(std::ssize(r) + length <= max_size, "Output buffer overrun");
-
-            // Test only every get_symbol, the trailer is at least 32 bits (Checksum)
-            // - 15 bits maximum huffman code.
-            // -  7 bits rounding up to byte.
-            tt_parse_check(((bit_offset + 22) >> 3) <= std::ssize(bytes), "Input buffer overrun");
-            auto distance_symbol = distance_tree.get_symbol(bytes, bit_offset);
-
-            // Test only every inflate_decode_distance, the trailer is at least 32 bits (Checksum)
-            // - 13 bits extra length.
-            // -  7 bits rounding up to byte.
-            tt_parse_check(((bit_offset + 20) >> 3) <= std::ssize(bytes), "Input buffer overrun");
-            auto distance = inflate_decode_distance(bytes, bit_offset, distance_symbol);
-
-            tt_parse_check(distance <= std::ssize(r), "Distance beyond start of decompressed data");
-            auto src_i = std::ssize(r) - distance;
-            for (auto i = 0; i != length; ++i) {
-                r.push_back(r[src_i++]);
-            }
-        }
-    }
+    tt_parse_check(offset + 4 <= std::ssize(bytes), "Input buffer overrun");
+    ttlet LEN = static_cast<int>(bytes[offset]) | (static_cast<int>(bytes[offset + 1]) << 8);
+    ttlet NLEN = static_cast<int>(bytes[offset + 2]) | (static_cast<int>(bytes[offset + 3]) << 8);
+    offset += 4;
+    tt_parse_check(LEN == (~NLEN & 0xffff), "Stored block LEN does not match NLEN");
+
+    tt_parse_check(offset + LEN <= std::ssize(bytes), "Input buffer overrun");
+    r.reserve(LEN);
+    r.append(&bytes[offset], LEN);
+
+    reader.seek(offset + LEN);
 }
 
-huffman_tree<int16_t> deflate_fixed_literal_tree = []() {
-    std::vector<int> lengths;
+static void inflate_block(inflate_bit_reader &reader, inflate_table const &literal_table, inflate_table const &distance_table, inflate_output &r)
+{
+    using kind_type = inflate_table::kind_type;
 
-    for (int i = 0; i <= 143; ++i) {
-        lengths.push_back(8);
-    }
-    for (int i = 144; i <= 255; ++i) {
-        lengths.push_back(9);
-    }
-    for (int i = 256; i <= 279; ++i) {
-        lengths.push_back(7);
-    }
-    for (int i = 280; i <= 287; ++i) {
-        lengths.push_back(8);
-    }
+    while (true) {
+        // Refill once for each literal or length/distance pair:
+        // 15 + 5 bits for the length and 15 + 13 bits for the distance.
+        reader.refill();
 
-    return huffman_tree<int16_t>::from_lengths(lengths);
-}();
+        ttlet literal_entry = literal_table.decode(reader);
+        ttlet literal_kind = inflate_table::kind(literal_entry);
 
-huffman_tree<int16_t> deflate_fixed_distance_tree = []() {
-    std::vector<int> lengths;
+        if (literal_kind == kind_type::literal) {
+            r.reserve(1);
+            r.push_back(static_cast<std::byte>(inflate_table::value(literal_entry)));
 
-    for (int i = 0; i <= 31; ++i) {
-        lengths.push_back(5);
-    }
+        } else if (literal_kind == kind_type::base) {
+            ttlet length = inflate_table::value(literal_entry) + reader.get(inflate_table::extra(literal_entry));
+            r.reserve(length);
 
-    return huffman_tree<int16_t>::from_lengths(lengths);
-}();
+            ttlet distance_entry = distance_table.decode(reader);
+            tt_parse_check(inflate_table::kind(distance_entry) == kind_type::base, "Distance code not in huffman table");
+            ttlet distance = inflate_table::value(distance_entry) + reader.get(inflate_table::extra(distance_entry));
 
+            tt_parse_check(distance <= r.size(), "Distance beyond start of decompressed data");
+            r.copy(distance, length);
 
+        } else if (literal_kind == kind_type::end_of_block) {
+            return;
 
-static void inflate_fixed_block(std::span<std::byte const> bytes, ssize_t &bit_offset, ssize_t max_size, bstring &r)
-{
-    inflate_block(bytes, bit_offset, max_size, deflate_fixed_literal_tree, deflate_fixed_distance_tree, r);
+        } else {
+            throw parse_error("Literal/Length code not in huffman table");
+        }
+    }
 }
 
-[[nodiscard]] static huffman_tree<int16_t> inflate_code_lengths(std::span<std::byte const> bytes, ssize_t &bit_offset, int nr_symbols)
+[[nodiscard]] static inflate_table inflate_code_lengths(inflate_bit_reader &reader, int nr_symbols)
 {
     // The symbols are in different order in the table.
-    constexpr auto symbols = std::array{
-        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
-    };
-
-    tt_parse_check(((bit_offset + (3 * static_cast<ssize_t>(nr_symbols)) + 7) >> 3) <= std::ssize(bytes), "Input buffer overrun");
+    constexpr auto symbols = std::array{16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
 
     auto lengths = std::vector<int>(std::ssize(symbols), 0);
     for (int i = 0; i != nr_symbols; ++i) {
-        ttlet symbol = symbols[i];
-        lengths[symbol] = get_bits(bytes, bit_offset, 3);
+        // 19 * 3 bits does not fit in the bit-buffer, refill every symbol.
+        reader.refill();
+        lengths[symbols[i]] = reader.get(3);
     }
-    return huffman_tree<int16_t>::from_lengths(std::move(lengths));
+    return inflate_table(lengths, inflate_code_length_symbols, 7);
 }
 
-std::vector<int> inflate_lengths(
-    std::span<std::byte const> bytes,
-    ssize_t &bit_offset,
-    int nr_symbols,
-    huffman_tree<int16_t> const &code_length_tree)
+[[nodiscard]] static std::vector<int> inflate_lengths(inflate_bit_reader &reader, int nr_symbols, inflate_table const &code_length_table)
 {
     auto r = std::vector<int>{};
     r.reserve(nr_symbols);
 
-    auto prev_length = 0;
     while (std::ssize(r) < nr_symbols) {
-        // Test only every get_symbol, the trailer is at least 32 bits (Checksum)
-        // -  7 bits maximum huffman code.
-        // -  7 bits extra length.
-        // -  7 bits rounding up to byte.
-        tt_parse_check(((bit_offset + 21) >> 3) <= std::ssize(bytes), "Input buffer overrun");
-        auto symbol = code_length_tree.get_symbol(bytes, bit_offset);
+        // 7 bits maximum huffman code + 7 bits extra length.
+        reader.refill();
+
+        ttlet entry = code_length_table.decode(reader);
+        tt_parse_check(inflate_table::kind(entry) == inflate_table::kind_type::literal, "Code length code not in huffman table");
+        ttlet symbol = inflate_table::value(entry);
 
+        auto copy_length = 0;
+        auto copy_value = 0;
         switch (symbol) {
-        case 16: {
-                auto copy_length = get_bits(bytes, bit_offset, 2) + 3;
-                while (copy_length--) {
-                    r.push_back(prev_length);
-                }
-            } break;
-        case 17: {
-                auto copy_length = get_bits(bytes, bit_offset, 3) + 3;
-                while (copy_length--) {
-                    r.push_back(0);
-                }
-            } break;
-        case 18: {
-                auto copy_length = get_bits(bytes, bit_offset, 7) + 11;
-                while (copy_length--) {
-                    r.push_back(0);
-                }
-            } break;
-        default:
-            r.push_back(prev_length = symbol);
+        case 16:
+            tt_parse_check(!r.empty(), "Repeat of previous code length without a previous code length");
+            copy_length = reader.get(2) + 3;
+            copy_value = r.back();
+            break;
+        case 17: copy_length = reader.get(3) + 3; break;
+        case 18: copy_length = reader.get(7) + 11; break;
+        default: copy_length = 1; copy_value = symbol;
         }
+
+        tt_parse_check(std::ssize(r) + copy_length <= nr_symbols, "Code lengths overrun the number of symbols");
+        r.insert(r.end(), copy_length, copy_value);
     }
 
     return r;
 }
 
-void inflate_dynamic_block(std::span<std::byte const> bytes, ssize_t &bit_offset, ssize_t max_size, bstring &r)
+inflate_table const &inflate_fixed_literal_table() noexcept
+{
+    static ttlet table = []() {
+        auto lengths = std::vector<int>(288, 0);
+        for (int i = 0; i <= 143; ++i) {
+            lengths[i] = 8;
+        }
+        for (int i = 144; i <= 255; ++i) {
+            lengths[i] = 9;
+        }
+        for (int i = 256; i <= 279; ++i) {
+            lengths[i] = 7;
+        }
+        for (int i = 280; i <= 287; ++i) {
+            lengths[i] = 8;
+        }
+        return inflate_table(lengths, inflate_literal_length_symbols, 9);
+    }();
+    return table;
+}
+
+inflate_table const &inflate_fixed_distance_table() noexcept
 {
-    // Test all lengths, the trailer is at least 32 bits (Checksum)
-    // - 14 bits lengths
-    // -  7 bits rounding up to byte.
-    tt_parse_check(((bit_offset + 21) >> 3) <= std::ssize(bytes), "Input buffer overrun");
-    ttlet HLIT = get_bits(bytes, bit_offset, 5);
-    ttlet HDIST = get_bits(bytes, bit_offset, 5);
-    ttlet HCLEN = get_bits(bytes, bit_offset, 4);
+    static ttlet table = inflate_table(std::vector<int>(32, 5), inflate_distance_symbols, 5);
+    return table;
+}
+
+void inflate_dynamic_tables(inflate_bit_reader &reader, inflate_table &literal_table, inflate_table &distance_table)
+{
+    reader.refill();
+    ttlet HLIT = reader.get(5);
+    ttlet HDIST = reader.get(5);
+    ttlet HCLEN = reader.get(4);
+    tt_parse_check(HLIT <= 29, "HLIT out of range");
+    tt_parse_check(HDIST <= 29, "HDIST out of range");
 
-    ttlet code_length_tree = inflate_code_lengths(bytes, bit_offset, HCLEN + 4);
+    ttlet code_length_table = inflate_code_lengths(reader, HCLEN + 4);
 
-    ttlet lengths = inflate_lengths(bytes, bit_offset, HLIT + HDIST + 258, code_length_tree);
+    ttlet lengths = inflate_lengths(reader, HLIT + HDIST + 258, code_length_table);
     tt_parse_check(lengths[256] != 0, "The end-of-block symbol must be in the table");
 
     ttlet lengths_ptr = lengths.data();
-    ttlet literal_tree = huffman_tree<int16_t>::from_lengths(lengths_ptr, HLIT + 257);
-    ttlet distance_tree = huffman_tree<int16_t>::from_lengths(&lengths_ptr[HLIT + 257], HDIST + 1);
+    literal_table = inflate_table(lengths_ptr, HLIT + 257, inflate_literal_length_symbols, 10);
+    distance_table = inflate_table(&lengths_ptr[HLIT + 257], HDIST + 1, inflate_distance_symbols, 9);
+}
 
-    inflate_block(bytes, bit_offset, max_size, literal_tree, distance_tree, r);
+static void inflate_dynamic_block(inflate_bit_reader &reader, inflate_output &r)
+{
+    auto literal_table = inflate_table{};
+    auto distance_table = inflate_table{};
+    inflate_dynamic_tables(reader, literal_table, distance_table);
+    inflate_block(reader, literal_table, distance_table, r);
 }
 
 bstring inflate(std::span<std::byte const> bytes, ssize_t &offset, ssize_t max_size)
 {
-    ssize_t bit_offset = offset * 8;
-
-    auto r = bstring{};
+    auto reader = inflate_bit_reader(bytes, offset);
+    auto r = inflate_output(max_size);
 
     bool BFINAL;
     do {
-        // Test all lengths, the trailer is at least 32 bits (Checksum)
-        // - 3 bits header
-        // - 7 bits rounding up to byte.
-        tt_parse_check(((bit_offset + 10) >> 3) <= std::ssize(bytes), "Input buffer overrun");
-
-        BFINAL = get_bits(bytes, bit_offset, 1);
-        ttlet BTYPE = get_bits(bytes, bit_offset, 2);
+        reader.refill();
+        BFINAL = static_cast<bool>(reader.get(1));
+        ttlet BTYPE = reader.get(2);
 
         switch (BTYPE) {
-        case 0:
-            inflate_copy_block(bytes, bit_offset, max_size - std::ssize(r), r);
-            break;
-        case 1:
-            inflate_fixed_block(bytes, bit_offset, max_size - std::ssize(r), r);
-            break;
-        case 2:
-            inflate_dynamic_block(bytes, bit_offset, max_size - std::ssize(r), r);
-            break;
-        default:
-            throw parse_error("Reserved block type");
+        case 0: inflate_copy_block(bytes, reader, r); break;
+        case 1: inflate_block(reader, inflate_fixed_literal_table(), inflate_fixed_distance_table(), r); break;
+        case 2: inflate_dynamic_block(reader, r); break;
+        default: throw parse_error("Reserved block type");
         }
 
     } while (!BFINAL);
 
-    offset = (bit_offset + 7) / 8;
-    return r;
+    tt_parse_check(reader.bit_offset() <= std::ssize(bytes) * 8, "Input buffer overrun");
+    offset = (reader.bit_offset() + 7) / 8;
+    return r.finish();
 }
 
-}
\ No newline at end of file
+} // namespace tt
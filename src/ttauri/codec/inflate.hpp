@@ -1,4 +1,4 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
@@ -24,5 +24,11 @@ namespace tt {
  */
 bstring inflate(std::span<std::byte const> bytes, ssize_t &offset, ssize_t max_size=0x0100'0000);
 
+/** Inflate compressed data using the deflate algorithm.
+ * This is the original implementation which walks a `huffman_tree` one bit at a time.
+ * It is slow and only used as a reference for testing and benchmarking `inflate()`.
+ */
+bstring inflate_reference(std::span<std::byte const> bytes, ssize_t &offset, ssize_t max_size=0x0100'0000);
+
 }
 
@@ -0,0 +1,363 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "inflate_stream.hpp"
+#include "../endian.hpp"
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+
+namespace tt {
+
+inflate_stream::inflate_stream(container_type container) :
+    _container(container), _window(2 * window_size + max_match_length + match_slack)
+{
+}
+
+void inflate_stream::write(std::span<std::byte const> bytes)
+{
+    // Drop the input that was fully consumed, so that memory usage does not grow.
+    ttlet consumed = _bit_offset / 8;
+    _input.erase(_input.begin(), _input.begin() + consumed);
+    _bit_offset -= consumed * 8;
+
+    _input.insert(_input.end(), bytes.begin(), bytes.end());
+}
+
+std::span<std::byte const> inflate_stream::unused_input() const noexcept
+{
+    if (_state == state_type::done) {
+        return std::span(_input).subspan(_bit_offset / 8);
+    } else {
+        return {};
+    }
+}
+
+ssize_t inflate_stream::read(std::span<std::byte> output)
+{
+    ssize_t r = 0;
+    while (true) {
+        ttlet n = std::min(std::ssize(output) - r, _window_end - _window_read);
+        std::memcpy(output.data() + r, _window.data() + _window_read, n);
+        _window_read += n;
+        r += n;
+
+        if (r == std::ssize(output)) {
+            return r;
+        }
+
+        if (!decode()) {
+            // The window is empty, so no progress means more compressed data is needed.
+            tt_parse_check(!_closed || _state == state_type::done, "Unexpected end of compressed data");
+            return r;
+        }
+    }
+}
+
+inflate_bit_reader inflate_stream::make_reader() const
+{
+    auto reader = inflate_bit_reader(_input, _bit_offset / 8);
+    reader.refill();
+    reader.consume(_bit_offset % 8);
+    return reader;
+}
+
+void inflate_stream::slide_window() noexcept
+{
+    ttlet keep = std::min(window_size, _window_end);
+    ttlet shift = _window_end - keep;
+    tt_axiom(_window_read >= shift);
+
+    std::memmove(_window.data(), _window.data() + shift, keep);
+    _window_end -= shift;
+    _window_read -= shift;
+}
+
+bool inflate_stream::decode()
+{
+    switch (_state) {
+    case state_type::header: return decode_header();
+    case state_type::block_header: return decode_block_header();
+    case state_type::stored: return decode_stored();
+    case state_type::huffman: return decode_huffman();
+    case state_type::trailer: return decode_trailer();
+    case state_type::done: return false;
+    default: tt_no_default();
+    }
+}
+
+bool inflate_stream::decode_header()
+{
+    // The header always starts at a byte boundary.
+    tt_axiom(_bit_offset % 8 == 0);
+    auto offset = _bit_offset / 8;
+    ttlet size = std::ssize(_input);
+
+    switch (_container) {
+    case container_type::deflate: break;
+
+    case container_type::zlib: {
+        if (offset + 2 > size) {
+            return false;
+        }
+        ttlet CMF = static_cast<int>(_input[offset++]);
+        ttlet FLG = static_cast<int>(_input[offset++]);
+
+        tt_parse_check((CMF * 256 + FLG) % 31 == 0, "zlib header checksum failed.");
+        tt_parse_check((CMF & 0xf) == 8, "zlib compression method must be 8");
+        tt_parse_check(((CMF >> 4) & 0xf) <= 7, "zlib LZ77 window too large");
+        tt_parse_check((FLG & 0x20) == 0, "zlib must not use a preset dicationary");
+    } break;
+
+    case container_type::gzip: {
+        if (_nr_members != 0 && offset == size && _closed) {
+            // No more members follow.
+            _state = state_type::done;
+            return true;
+        }
+
+        if (offset + 10 > size) {
+            return false;
+        }
+        tt_parse_check(_input[offset] == std::byte{31}, "GZIP Member header ID1 must be 31");
+        tt_parse_check(_input[offset + 1] == std::byte{139}, "GZIP Member header ID2 must be 139");
+        tt_parse_check(_input[offset + 2] == std::byte{8}, "GZIP Member header CM must be 8");
+        ttlet FLG = static_cast<int>(_input[offset + 3]);
+        tt_parse_check((FLG & 0xe0) == 0, "GZIP Member header FLG reserved bits must be 0");
+        offset += 10;
+
+        if (FLG & 4) {
+            // FEXTRA
+            if (offset + 2 > size) {
+                return false;
+            }
+            ttlet XLEN = static_cast<int>(_input[offset]) | (static_cast<int>(_input[offset + 1]) << 8);
+            offset += 2 + XLEN;
+        }
+
+        // FNAME and FCOMMENT are zero terminated strings.
+        for (ttlet flag : {8, 16}) {
+            if (FLG & flag) {
+                ttlet first = _input.begin() + std::min(offset, size);
+                ttlet last = std::find(first, _input.end(), std::byte{0});
+                if (last == _input.end()) {
+                    return false;
+                }
+                offset = std::distance(_input.begin(), last) + 1;
+            }
+        }
+
+        if (FLG & 2) {
+            // FHCRC
+            offset += 2;
+        }
+
+        if (offset > size) {
+            return false;
+        }
+    } break;
+
+    default: tt_no_default();
+    }
+
+    _bit_offset = offset * 8;
+    _total_size = 0;
+    _state = state_type::block_header;
+    return true;
+}
+
+bool inflate_stream::decode_block_header()
+{
+    auto reader = make_reader();
+    ttlet end_bits = std::ssize(_input) * 8;
+
+    try {
+        reader.refill();
+        _final_block = static_cast<bool>(reader.get(1));
+        ttlet BTYPE = reader.get(2);
+
+        switch (BTYPE) {
+        case 0: {
+            ttlet offset = reader.align_to_byte();
+            if (offset + 4 > std::ssize(_input)) {
+                tt_parse_check(!_closed, "Input buffer overrun");
+                return false;
+            }
+
+            ttlet LEN = static_cast<int>(_input[offset]) | (static_cast<int>(_input[offset + 1]) << 8);
+            ttlet NLEN = static_cast<int>(_input[offset + 2]) | (static_cast<int>(_input[offset + 3]) << 8);
+            tt_parse_check(LEN == (~NLEN & 0xffff), "Stored block LEN does not match NLEN");
+
+            _stored_remaining = LEN;
+            _bit_offset = (offset + 4) * 8;
+            _state = state_type::stored;
+            return true;
+        }
+        case 1: _fixed_tables = true; break;
+        case 2:
+            _fixed_tables = false;
+            inflate_dynamic_tables(reader, _literal_table, _distance_table);
+            break;
+        default: throw parse_error("Reserved block type");
+        }
+
+    } catch (parse_error const &) {
+        // The header may have been parsed using the zero bits beyond the end
+        // of the input, wait for more data to see if the header is valid.
+        if (!_closed && reader.bit_offset() + 64 > end_bits) {
+            return false;
+        }
+        throw;
+    }
+
+    if (reader.bit_offset() > end_bits) {
+        tt_parse_check(!_closed, "Input buffer overrun");
+        return false;
+    }
+
+    _bit_offset = reader.bit_offset();
+    _state = state_type::huffman;
+    return true;
+}
+
+bool inflate_stream::decode_stored()
+{
+    ttlet offset = _bit_offset / 8;
+
+    if (_window_end + _stored_remaining > std::ssize(_window)) {
+        slide_window();
+    }
+
+    auto n = std::min(_stored_remaining, std::ssize(_input) - offset);
+    n = std::min(n, window_size - (_window_end - _window_read));
+    n = std::min(n, std::ssize(_window) - _window_end);
+
+    if (n == 0 && _stored_remaining != 0) {
+        return false;
+    }
+
+    std::memcpy(_window.data() + _window_end, _input.data() + offset, n);
+    _window_end += n;
+    _total_size += n;
+    _stored_remaining -= n;
+    _bit_offset += n * 8;
+
+    if (_stored_remaining == 0) {
+        _state = _final_block ? state_type::trailer : state_type::block_header;
+    }
+    return true;
+}
+
+bool inflate_stream::decode_huffman()
+{
+    using kind_type = inflate_table::kind_type;
+
+    ttlet &literal_table = _fixed_tables ? inflate_fixed_literal_table() : _literal_table;
+    ttlet &distance_table = _fixed_tables ? inflate_fixed_distance_table() : _distance_table;
+
+    auto reader = make_reader();
+    ttlet end_bits = std::ssize(_input) * 8;
+    auto progress = false;
+
+    // Stop when the window is filled with data that was not yet read by the caller.
+    while (_window_end - _window_read < window_size) {
+        // A literal or length/distance pair uses at most 48 bits. Until the stream is closed
+        // only decode when these bits are available, since we can not rollback a partial decode.
+        if (!_closed && end_bits - reader.bit_offset() < 48) {
+            break;
+        }
+
+        if (_window_end + max_match_length + match_slack > std::ssize(_window)) {
+            slide_window();
+        }
+
+        reader.refill();
+        progress = true;
+
+        ttlet literal_entry = literal_table.decode(reader);
+        ttlet literal_kind = inflate_table::kind(literal_entry);
+
+        if (literal_kind == kind_type::literal) {
+            _window[_window_end++] = static_cast<std::byte>(inflate_table::value(literal_entry));
+            ++_total_size;
+
+        } else if (literal_kind == kind_type::base) {
+            ttlet length = inflate_table::value(literal_entry) + reader.get(inflate_table::extra(literal_entry));
+
+            ttlet distance_entry = distance_table.decode(reader);
+            tt_parse_check(inflate_table::kind(distance_entry) == kind_type::base, "Distance code not in huffman table");
+            ttlet distance = inflate_table::value(distance_entry) + reader.get(inflate_table::extra(distance_entry));
+
+            tt_parse_check(distance <= _window_end, "Distance beyond start of decompressed data");
+
+            auto *dst = _window.data() + _window_end;
+            auto const *src = dst - distance;
+            if (distance >= 8) {
+                for (ssize_t i = 0; i < length; i += 8) {
+                    std::memcpy(dst + i, src + i, 8);
+                }
+            } else {
+                for (ssize_t i = 0; i != length; ++i) {
+                    dst[i] = src[i];
+                }
+            }
+            _window_end += length;
+            _total_size += length;
+
+        } else if (literal_kind == kind_type::end_of_block) {
+            _state = _final_block ? state_type::trailer : state_type::block_header;
+            break;
+
+        } else {
+            throw parse_error("Literal/Length code not in huffman table");
+        }
+    }
+
+    tt_parse_check(reader.bit_offset() <= end_bits, "Input buffer overrun");
+    _bit_offset = reader.bit_offset();
+    return progress;
+}
+
+bool inflate_stream::decode_trailer()
+{
+    auto offset = (_bit_offset + 7) / 8;
+    ttlet size = std::ssize(_input);
+
+    switch (_container) {
+    case container_type::deflate:
+        _bit_offset = offset * 8;
+        _state = state_type::done;
+        return true;
+
+    case container_type::zlib:
+        if (offset + 4 > size) {
+            return false;
+        }
+        // The ADLER32 check value is not verified.
+        _bit_offset = (offset + 4) * 8;
+        _state = state_type::done;
+        return true;
+
+    case container_type::gzip: {
+        if (offset + 8 > size) {
+            return false;
+        }
+        // The CRC32 check value is not verified.
+        uint32_t ISIZE;
+        std::memcpy(&ISIZE, _input.data() + offset + 4, sizeof(ISIZE));
+        tt_parse_check(
+            little_to_native(ISIZE) == (_total_size & 0xffffffff),
+            "GZIP Member header ISIZE must be same as the lower 32 bits of the inflated size.");
+
+        _bit_offset = (offset + 8) * 8;
+        ++_nr_members;
+        _state = state_type::header;
+        return true;
+    }
+
+    default: tt_no_default();
+    }
+}
+
+} // namespace tt
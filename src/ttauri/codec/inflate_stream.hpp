@@ -0,0 +1,161 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "inflate_table.hpp"
+#include "../required.hpp"
+#include <span>
+#include <vector>
+#include <cstddef>
+
+namespace tt {
+
+/** Incremental inflate decoder.
+ *
+ * Compressed data is passed to the decoder in chunks of any size using `write()`,
+ * decompressed data is retrieved into a caller provided buffer using `read()`.
+ * Memory usage is bounded by the 32 KiB sliding window, plus the compressed data
+ * that was written but not yet consumed.
+ *
+ * Example, decompressing a gzip file in chunks:
+ * ```
+ * auto stream = inflate_stream(inflate_stream::container_type::gzip);
+ * auto buffer = std::array<std::byte, 0x1'0000>{};
+ * for (auto chunk: chunks) {
+ *     stream.write(chunk);
+ *     while (ttlet n = stream.read(buffer)) {
+ *         consume(std::span(buffer.data(), n));
+ *     }
+ * }
+ * stream.close();
+ * while (ttlet n = stream.read(buffer)) {
+ *     consume(std::span(buffer.data(), n));
+ * }
+ * ```
+ */
+class inflate_stream {
+public:
+    /** The format around the deflate compressed data.
+     */
+    enum class container_type {
+        /** Raw deflate data without header or trailer.
+         */
+        deflate,
+
+        /** zlib header and ADLER32 trailer, RFC 1950.
+         */
+        zlib,
+
+        /** One or more gzip members, RFC 1952.
+         */
+        gzip
+    };
+
+    inflate_stream(container_type container = container_type::deflate);
+
+    inflate_stream(inflate_stream const &) = delete;
+    inflate_stream(inflate_stream &&) noexcept = default;
+    inflate_stream &operator=(inflate_stream const &) = delete;
+    inflate_stream &operator=(inflate_stream &&) noexcept = default;
+
+    /** Add compressed data to the decoder.
+     * The data is copied, the caller may reuse the buffer after the call.
+     */
+    void write(std::span<std::byte const> bytes);
+
+    /** Signal that there is no more compressed data.
+     * After close() the decoder will report truncated data as an error.
+     */
+    void close() noexcept
+    {
+        _closed = true;
+    }
+
+    /** Decompress data into the output buffer.
+     *
+     * @param output The buffer to write decompressed data into.
+     * @return The number of bytes written to output. Less than the size of the output
+     *         buffer when more compressed data is needed or the end of the stream was reached.
+     * @throw parse_error when the compressed data is invalid, or when it is truncated after `close()`.
+     */
+    [[nodiscard]] ssize_t read(std::span<std::byte> output);
+
+    /** Check if the end of the compressed stream was reached and all data was read.
+     */
+    [[nodiscard]] bool done() const noexcept
+    {
+        return _state == state_type::done && _window_read == _window_end;
+    }
+
+    /** Compressed data that was written after the end of the stream.
+     */
+    [[nodiscard]] std::span<std::byte const> unused_input() const noexcept;
+
+private:
+    enum class state_type { header, block_header, stored, huffman, trailer, done };
+
+    static constexpr ssize_t window_size = 0x8000;
+    static constexpr ssize_t max_match_length = 258;
+    static constexpr ssize_t match_slack = 8;
+
+    container_type _container;
+    state_type _state = state_type::header;
+    bool _closed = false;
+    bool _final_block = false;
+
+    /** Compressed data that has not been fully consumed.
+     */
+    std::vector<std::byte> _input;
+
+    /** The position of the next bit to read in `_input`.
+     */
+    ssize_t _bit_offset = 0;
+
+    /** Sliding window holding at least the last 32 KiB of decompressed data.
+     */
+    std::vector<std::byte> _window;
+    ssize_t _window_end = 0;
+    ssize_t _window_read = 0;
+
+    /** The number of decompressed bytes of the current gzip member.
+     */
+    uint64_t _total_size = 0;
+
+    /** The number of gzip members that were fully decoded.
+     */
+    int _nr_members = 0;
+
+    ssize_t _stored_remaining = 0;
+
+    /** The current huffman block uses the fixed tables instead of `_literal_table` and `_distance_table`.
+     */
+    bool _fixed_tables = false;
+    inflate_table _literal_table;
+    inflate_table _distance_table;
+
+    [[nodiscard]] ssize_t available_bits() const noexcept
+    {
+        return std::ssize(_input) * 8 - _bit_offset;
+    }
+
+    [[nodiscard]] inflate_bit_reader make_reader() const;
+
+    /** Decode data into the sliding window.
+     * @return true if any progress was made.
+     */
+    [[nodiscard]] bool decode();
+
+    [[nodiscard]] bool decode_header();
+    [[nodiscard]] bool decode_block_header();
+    [[nodiscard]] bool decode_stored();
+    [[nodiscard]] bool decode_huffman();
+    [[nodiscard]] bool decode_trailer();
+
+    /** Move the last 32 KiB of the window to the start.
+     */
+    void slide_window() noexcept;
+};
+
+} // namespace tt
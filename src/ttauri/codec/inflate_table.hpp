@@ -0,0 +1,369 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "../required.hpp"
+#include "../endian.hpp"
+#include "../check.hpp"
+#include <span>
+#include <array>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+namespace tt {
+
+/** Bit reader for deflate streams.
+ * Bits are read LSB first through a 64-bit buffer which is refilled 8 bytes at a time.
+ *
+ * After `refill()` at least 56 bits are available, which is enough to decode a
+ * literal/length symbol, its extra bits, a distance symbol and its extra bits
+ * without refilling in between.
+ *
+ * Reading beyond the end of the byte array inserts zero bits, the overrun is
+ * detected on the next refill.
+ */
+class inflate_bit_reader {
+public:
+    inflate_bit_reader(std::span<std::byte const> bytes, ssize_t byte_offset) noexcept :
+        _ptr(bytes.data()), _size(std::ssize(bytes)), _byte_offset(byte_offset), _buffer(0), _nr_bits(0)
+    {
+    }
+
+    /** The number of bits consumed from the start of the byte array.
+     */
+    [[nodiscard]] ssize_t bit_offset() const noexcept
+    {
+        return _byte_offset * 8 - _nr_bits;
+    }
+
+    /** Make sure there are at least 56 bits in the bit-buffer.
+     * @throw parse_error when bits beyond the end of the byte array have been consumed.
+     */
+    tt_force_inline void refill()
+    {
+        if (_byte_offset + 8 <= _size) [[likely]] {
+            uint64_t tmp;
+            std::memcpy(&tmp, _ptr + _byte_offset, sizeof(tmp));
+            _buffer |= little_to_native(tmp) << _nr_bits;
+            _byte_offset += (63 - _nr_bits) >> 3;
+            _nr_bits |= 56;
+        } else {
+            refill_slow();
+        }
+    }
+
+    /** Get the next nr_bits without consuming them.
+     */
+    [[nodiscard]] tt_force_inline uint32_t peek(int nr_bits) const noexcept
+    {
+        tt_axiom(nr_bits <= _nr_bits);
+        return static_cast<uint32_t>(_buffer & ((uint64_t{1} << nr_bits) - 1));
+    }
+
+    tt_force_inline void consume(int nr_bits) noexcept
+    {
+        tt_axiom(nr_bits <= _nr_bits);
+        _buffer >>= nr_bits;
+        _nr_bits -= nr_bits;
+    }
+
+    /** Get and consume the next nr_bits from the bit-buffer.
+     * There must be enough bits available in the bit-buffer, see `refill()`.
+     */
+    [[nodiscard]] tt_force_inline int get(int nr_bits) noexcept
+    {
+        ttlet r = peek(nr_bits);
+        consume(nr_bits);
+        return static_cast<int>(r);
+    }
+
+    /** Skip to the next byte boundary and return the byte offset.
+     * The bit-buffer is cleared, the caller may read bytes directly
+     * from the byte array before calling `seek()`.
+     */
+    [[nodiscard]] ssize_t align_to_byte() noexcept
+    {
+        ttlet r = (bit_offset() + 7) / 8;
+        seek(r);
+        return r;
+    }
+
+    /** Continue reading at a byte offset.
+     */
+    void seek(ssize_t byte_offset) noexcept
+    {
+        _byte_offset = byte_offset;
+        _buffer = 0;
+        _nr_bits = 0;
+    }
+
+private:
+    std::byte const *_ptr;
+    ssize_t _size;
+    ssize_t _byte_offset;
+    uint64_t _buffer;
+    int _nr_bits;
+
+    tt_no_inline void refill_slow()
+    {
+        tt_parse_check(bit_offset() <= _size * 8, "Input buffer overrun");
+
+        while (_nr_bits <= 56) {
+            ttlet byte = _byte_offset < _size ? static_cast<uint64_t>(_ptr[_byte_offset]) : uint64_t{0};
+            _buffer |= byte << _nr_bits;
+            _nr_bits += 8;
+            ++_byte_offset;
+        }
+    }
+};
+
+/** Multi-level lookup table for decoding deflate huffman codes.
+ *
+ * The primary table is indexed by the next `primary_bits` bits of the stream.
+ * Codes that are longer than `primary_bits` are found through a link to a
+ * sub-table which is indexed by the remaining bits of the code.
+ *
+ * Each entry is a 32 bit value which directly describes what to do with the symbol,
+ * so that the decoder does not need to switch on the symbol value:
+ *  - [3:0] Number of bits of the code to consume.
+ *  - [7:4] Number of extra bits following the code.
+ *  - [11:8] The kind of entry.
+ *  - [31:16] Literal value, base value of a length or distance, or offset to the sub-table.
+ */
+class inflate_table {
+public:
+    enum class kind_type : uint32_t {
+        invalid = 0,
+        literal = 1,
+        base = 2,
+        end_of_block = 3,
+        link = 4
+    };
+
+    [[nodiscard]] static constexpr uint32_t make_entry(kind_type kind, int value = 0, int extra = 0, int nr_bits = 0) noexcept
+    {
+        return (static_cast<uint32_t>(value) << 16) | (static_cast<uint32_t>(kind) << 8) | (static_cast<uint32_t>(extra) << 4) |
+            static_cast<uint32_t>(nr_bits);
+    }
+
+    [[nodiscard]] static constexpr int nr_bits(uint32_t entry) noexcept
+    {
+        return static_cast<int>(entry & 0xf);
+    }
+
+    [[nodiscard]] static constexpr int extra(uint32_t entry) noexcept
+    {
+        return static_cast<int>((entry >> 4) & 0xf);
+    }
+
+    [[nodiscard]] static constexpr kind_type kind(uint32_t entry) noexcept
+    {
+        return static_cast<kind_type>((entry >> 8) & 0xf);
+    }
+
+    [[nodiscard]] static constexpr int value(uint32_t entry) noexcept
+    {
+        return static_cast<int>(entry >> 16);
+    }
+
+    inflate_table() noexcept = default;
+
+    /** Build a canonical-huffman lookup table from a set of code lengths.
+     *
+     * @param lengths The code length of each symbol, zero means the symbol is unused.
+     * @param nr_symbols Number of symbols in the lengths array.
+     * @param symbol_entries For each symbol the entry without the number of bits.
+     * @param primary_bits The number of bits used to index the primary table.
+     * @throw parse_error when the code is over-subscribed.
+     */
+    inflate_table(int const *lengths, ssize_t nr_symbols, std::span<uint32_t const> symbol_entries, int primary_bits) :
+        _primary_bits(primary_bits)
+    {
+        tt_axiom(nr_symbols <= std::ssize(symbol_entries));
+
+        auto count = std::array<int, 16>{};
+        for (ssize_t symbol = 0; symbol != nr_symbols; ++symbol) {
+            tt_parse_check(lengths[symbol] >= 0 && lengths[symbol] <= 15, "Huffman code length out of range");
+            ++count[lengths[symbol]];
+        }
+        count[0] = 0;
+
+        // An incomplete code is allowed, for example a single distance code.
+        auto left = 1;
+        for (int length = 1; length <= 15; ++length) {
+            left <<= 1;
+            left -= count[length];
+            tt_parse_check(left >= 0, "Over-subscribed huffman code");
+        }
+
+        auto next_code = std::array<int, 16>{};
+        auto code = 0;
+        for (int length = 1; length <= 15; ++length) {
+            code = (code + count[length - 1]) << 1;
+            next_code[length] = code;
+        }
+
+        // Assign the canonical codes, bit-reversed since deflate reads the codes MSB first from a LSB first stream.
+        auto codes = std::vector<uint16_t>(nr_symbols, 0);
+        for (ssize_t symbol = 0; symbol != nr_symbols; ++symbol) {
+            if (ttlet length = lengths[symbol]) {
+                codes[symbol] = reverse_bits(next_code[length]++, length);
+            }
+        }
+
+        ttlet primary_size = 1 << primary_bits;
+        ttlet primary_mask = primary_size - 1;
+
+        // Determine the size of the sub-table for each primary entry.
+        auto sub_lengths = std::vector<uint8_t>(primary_size, 0);
+        for (ssize_t symbol = 0; symbol != nr_symbols; ++symbol) {
+            ttlet length = lengths[symbol];
+            if (length > primary_bits) {
+                auto &sub_length = sub_lengths[codes[symbol] & primary_mask];
+                sub_length = std::max(sub_length, static_cast<uint8_t>(length));
+            }
+        }
+
+        _entries.assign(primary_size, make_entry(kind_type::invalid));
+        for (int i = 0; i != primary_size; ++i) {
+            if (sub_lengths[i] != 0) {
+                ttlet sub_bits = sub_lengths[i] - primary_bits;
+                ttlet offset = std::ssize(_entries);
+                _entries[i] = make_entry(kind_type::link, static_cast<int>(offset), sub_bits, primary_bits);
+                _entries.resize(offset + (1 << sub_bits), make_entry(kind_type::invalid));
+            }
+        }
+
+        for (ssize_t symbol = 0; symbol != nr_symbols; ++symbol) {
+            ttlet length = lengths[symbol];
+            if (length == 0) {
+                continue;
+            }
+
+            ttlet code = static_cast<int>(codes[symbol]);
+            if (length <= primary_bits) {
+                ttlet entry = symbol_entries[symbol] | static_cast<uint32_t>(length);
+                for (auto i = code; i < primary_size; i += 1 << length) {
+                    _entries[i] = entry;
+                }
+
+            } else {
+                ttlet link = _entries[code & primary_mask];
+                ttlet offset = value(link);
+                ttlet sub_size = 1 << extra(link);
+                ttlet sub_length = length - primary_bits;
+                ttlet entry = symbol_entries[symbol] | static_cast<uint32_t>(sub_length);
+                for (auto i = code >> primary_bits; i < sub_size; i += 1 << sub_length) {
+                    _entries[offset + i] = entry;
+                }
+            }
+        }
+    }
+
+    inflate_table(std::vector<int> const &lengths, std::span<uint32_t const> symbol_entries, int primary_bits) :
+        inflate_table(lengths.data(), std::ssize(lengths), symbol_entries, primary_bits)
+    {
+    }
+
+    /** Decode the next symbol.
+     * The bit-reader must have at least 15 bits available.
+     *
+     * @return The entry of the decoded symbol, an entry of kind invalid when
+     *         the code was not part of the huffman table.
+     */
+    [[nodiscard]] tt_force_inline uint32_t decode(inflate_bit_reader &reader) const noexcept
+    {
+        auto entry = _entries[reader.peek(_primary_bits)];
+        if (kind(entry) == kind_type::link) [[unlikely]] {
+            reader.consume(_primary_bits);
+            entry = _entries[value(entry) + reader.peek(extra(entry))];
+        }
+        reader.consume(nr_bits(entry));
+        return entry;
+    }
+
+private:
+    std::vector<uint32_t> _entries;
+    int _primary_bits = 0;
+
+    [[nodiscard]] static uint16_t reverse_bits(int code, int length) noexcept
+    {
+        auto r = 0;
+        for (int i = 0; i != length; ++i) {
+            r = (r << 1) | (code & 1);
+            code >>= 1;
+        }
+        return static_cast<uint16_t>(r);
+    }
+};
+
+/** Entries for the literal/length alphabet.
+ * Symbols 286 and 287 may appear in the fixed huffman table but are invalid.
+ */
+constexpr auto inflate_literal_length_symbols = []() {
+    constexpr auto bases = std::array<int, 29>{3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                               31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr auto extras = std::array<int, 29>{0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+    auto r = std::array<uint32_t, 288>{};
+    for (int symbol = 0; symbol != 256; ++symbol) {
+        r[symbol] = inflate_table::make_entry(inflate_table::kind_type::literal, symbol);
+    }
+    r[256] = inflate_table::make_entry(inflate_table::kind_type::end_of_block);
+    for (int i = 0; i != 29; ++i) {
+        r[257 + i] = inflate_table::make_entry(inflate_table::kind_type::base, bases[i], extras[i]);
+    }
+    r[286] = inflate_table::make_entry(inflate_table::kind_type::invalid);
+    r[287] = inflate_table::make_entry(inflate_table::kind_type::invalid);
+    return r;
+}();
+
+/** Entries for the distance alphabet.
+ * Symbols 30 and 31 may appear in the fixed huffman table but are invalid.
+ */
+constexpr auto inflate_distance_symbols = []() {
+    constexpr auto bases = std::array<int, 30>{1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                               193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr auto extras =
+        std::array<int, 30>{0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    auto r = std::array<uint32_t, 32>{};
+    for (int i = 0; i != 30; ++i) {
+        r[i] = inflate_table::make_entry(inflate_table::kind_type::base, bases[i], extras[i]);
+    }
+    r[30] = inflate_table::make_entry(inflate_table::kind_type::invalid);
+    r[31] = inflate_table::make_entry(inflate_table::kind_type::invalid);
+    return r;
+}();
+
+/** Entries for the code-length alphabet, the symbol is returned as literal.
+ */
+constexpr auto inflate_code_length_symbols = []() {
+    auto r = std::array<uint32_t, 19>{};
+    for (int symbol = 0; symbol != 19; ++symbol) {
+        r[symbol] = inflate_table::make_entry(inflate_table::kind_type::literal, symbol);
+    }
+    return r;
+}();
+
+/** The huffman table for literal/length symbols of a fixed huffman block.
+ */
+[[nodiscard]] inflate_table const &inflate_fixed_literal_table() noexcept;
+
+/** The huffman table for distance symbols of a fixed huffman block.
+ */
+[[nodiscard]] inflate_table const &inflate_fixed_distance_table() noexcept;
+
+/** Read the code lengths at the start of a dynamic huffman block and build the tables.
+ *
+ * @param reader The bit-reader positioned directly after the block header.
+ * @param [out] literal_table The table for literal/length symbols.
+ * @param [out] distance_table The table for distance symbols.
+ * @throw parse_error on invalid code lengths.
+ */
+void inflate_dynamic_tables(inflate_bit_reader &reader, inflate_table &literal_table, inflate_table &distance_table);
+
+} // namespace tt
@@ -0,0 +1,158 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/codec/inflate.hpp"
+#include "ttauri/codec/inflate_stream.hpp"
+#include "ttauri/file_view.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <fmt/format.h>
+
+using namespace std;
+using namespace tt;
+
+/** Find the start of the deflate stream in a gzip file.
+ * The test files have a FNAME field in the header.
+ */
+static ssize_t skip_gzip_header(std::span<std::byte const> bytes)
+{
+    ssize_t offset = 10;
+    if (static_cast<int>(bytes[3]) & 8) {
+        while (bytes[offset++] != std::byte{0}) {}
+    }
+    return offset;
+}
+
+static void inflate_compare(URL const &compressed_url, URL const &original_url)
+{
+    ttlet compressed = file_view(compressed_url);
+    ttlet compressed_bytes = compressed.bytes();
+    ttlet original = file_view(original_url);
+    ttlet original_bytes = original.bytes();
+
+    ttlet start = skip_gzip_header(compressed_bytes);
+
+    auto offset = start;
+    ttlet decompressed = inflate(compressed_bytes, offset);
+
+    auto reference_offset = start;
+    ttlet reference = inflate_reference(compressed_bytes, reference_offset);
+
+    ASSERT_EQ(offset, reference_offset);
+    ASSERT_EQ(std::ssize(decompressed), std::ssize(original_bytes));
+    ASSERT_TRUE(decompressed == reference);
+    for (ssize_t i = 0; i != std::ssize(decompressed); ++i) {
+        ASSERT_EQ(decompressed[i], original_bytes[i]);
+    }
+}
+
+TEST(Inflate, CompareWithReference) {
+    inflate_compare(URL("file:gzip_test1.bin.gz"), URL("file:gzip_test1.bin"));
+    inflate_compare(URL("file:gzip_test2.bin.gz"), URL("file:gzip_test2.bin"));
+    inflate_compare(URL("file:gzip_test3.bin.gz"), URL("file:gzip_test3.bin"));
+    inflate_compare(URL("file:gzip_test4.bin.gz"), URL("file:gzip_test4.bin"));
+    inflate_compare(URL("file:gzip_test5.bin.gz"), URL("file:gzip_test5.bin"));
+    inflate_compare(URL("file:gzip_test6.bin.gz"), URL("file:gzip_test6.bin"));
+    inflate_compare(URL("file:gzip_test7.bin.gz"), URL("file:gzip_test7.bin"));
+    inflate_compare(URL("file:gzip_test8.bin.gz"), URL("file:gzip_test8.bin"));
+}
+
+TEST(Inflate, Truncated) {
+    ttlet compressed = file_view(URL("file:gzip_test4.bin.gz"));
+    ttlet compressed_bytes = compressed.bytes();
+
+    ttlet start = skip_gzip_header(compressed_bytes);
+    ttlet truncated = compressed_bytes.subspan(0, std::ssize(compressed_bytes) / 2);
+
+    auto offset = start;
+    ASSERT_THROW(inflate(truncated, offset), parse_error);
+}
+
+/** Decompress a gzip file by writing it in chunks and reading into a small buffer.
+ */
+static void inflate_stream_compare(URL const &compressed_url, URL const &original_url, ssize_t chunk_size, ssize_t buffer_size)
+{
+    ttlet compressed = file_view(compressed_url);
+    ttlet compressed_bytes = compressed.bytes();
+    ttlet original = file_view(original_url);
+    ttlet original_bytes = original.bytes();
+
+    auto stream = inflate_stream(inflate_stream::container_type::gzip);
+    auto buffer = std::vector<std::byte>(buffer_size);
+    auto decompressed = bstring{};
+
+    for (ssize_t offset = 0; offset < std::ssize(compressed_bytes); offset += chunk_size) {
+        stream.write(compressed_bytes.subspan(offset, std::min(chunk_size, std::ssize(compressed_bytes) - offset)));
+        while (ttlet n = stream.read(buffer)) {
+            decompressed.append(buffer.data(), n);
+        }
+    }
+    stream.close();
+    while (ttlet n = stream.read(buffer)) {
+        decompressed.append(buffer.data(), n);
+    }
+
+    ASSERT_TRUE(stream.done());
+    ASSERT_EQ(std::ssize(decompressed), std::ssize(original_bytes));
+    for (ssize_t i = 0; i != std::ssize(decompressed); ++i) {
+        ASSERT_EQ(decompressed[i], original_bytes[i]);
+    }
+}
+
+TEST(Inflate, Stream) {
+    for (ttlet [chunk_size, buffer_size]: {std::pair{1, 1}, std::pair{7, 100}, std::pair{4096, 4096}, std::pair{0x10000, 0x10000}}) {
+        inflate_stream_compare(URL("file:gzip_test1.bin.gz"), URL("file:gzip_test1.bin"), chunk_size, buffer_size);
+        inflate_stream_compare(URL("file:gzip_test3.bin.gz"), URL("file:gzip_test3.bin"), chunk_size, buffer_size);
+        inflate_stream_compare(URL("file:gzip_test4.bin.gz"), URL("file:gzip_test4.bin"), chunk_size, buffer_size);
+        inflate_stream_compare(URL("file:gzip_test7.bin.gz"), URL("file:gzip_test7.bin"), chunk_size, buffer_size);
+    }
+}
+
+TEST(Inflate, StreamTruncated) {
+    ttlet compressed = file_view(URL("file:gzip_test4.bin.gz"));
+    ttlet compressed_bytes = compressed.bytes();
+
+    auto stream = inflate_stream(inflate_stream::container_type::gzip);
+    auto buffer = std::vector<std::byte>(0x10000);
+
+    stream.write(compressed_bytes.subspan(0, std::ssize(compressed_bytes) / 2));
+    [[maybe_unused]] ttlet n = stream.read(buffer);
+    ASSERT_FALSE(stream.done());
+
+    stream.close();
+    ASSERT_THROW(static_cast<void>(stream.read(buffer)), parse_error);
+}
+
+TEST(Inflate, Benchmark) {
+    ttlet compressed = file_view(URL("file:gzip_test7.bin.gz"));
+    ttlet compressed_bytes = compressed.bytes();
+    ttlet start = skip_gzip_header(compressed_bytes);
+
+    constexpr int nr_iterations = 100;
+    ssize_t nr_bytes = 0;
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i != nr_iterations; ++i) {
+        auto offset = start;
+        nr_bytes += std::ssize(inflate_reference(compressed_bytes, offset));
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i != nr_iterations; ++i) {
+        auto offset = start;
+        nr_bytes -= std::ssize(inflate(compressed_bytes, offset));
+    }
+    ttlet t2 = std::chrono::steady_clock::now();
+    ASSERT_EQ(nr_bytes, 0);
+
+    ttlet reference_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet duration = std::chrono::duration<double>(t2 - t1).count();
+    ttlet original_size = 38240.0 * nr_iterations;
+
+    std::cout << fmt::format(
+        "inflate_reference: {:.1f} MByte/s, inflate: {:.1f} MByte/s\n",
+        original_size / reference_duration / 1e6,
+        original_size / duration / 1e6);
+}
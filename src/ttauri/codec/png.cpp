@@ -1,14 +1,21 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "png.hpp"
-#include "zlib.hpp"
+#include "inflate_stream.hpp"
 #include "../endian.hpp"
 #include "../placement.hpp"
 #include "../color/sRGB.hpp"
 #include "../color/Rec2100.hpp"
 #include "../color/color_space.hpp"
+#include "../thread_pool.hpp"
+#include <cstring>
+#include <tuple>
+
+#if TT_PROCESSOR == TT_CPU_X64
+#include <immintrin.h>
+#endif
 
 namespace tt {
 
@@ -280,6 +287,12 @@ void png::read_chunks(std::span<std::byte const> bytes, ssize_t &offset)
         read_sRGB(sRGB_bytes);
     }
 
+    // Without a color space conversion each sample can be converted directly to a half-float.
+    if (color_to_sRGB == matrix3{}) {
+        std::tie(half_transfer_function, half_alpha_function) =
+            detail::png_half_transfer_function(transfer_function, bit_depth);
+    }
+
 }
 
 png::png(std::span<std::byte const> bytes) :
@@ -301,49 +314,158 @@ png::png(std::unique_ptr<resource_view> view) :
     read_chunks(bytes, offset);
 }
 
-bstring png::decompress_IDATs(ssize_t image_data_size) const {
-    if (std::ssize(idat_chunk_data) == 1) {
-        return zlib_decompress(idat_chunk_data[0], image_data_size);
-    } else {
-        // Merge all idat chunks together.
-        ttlet compressed_data_size = std::accumulate(
-            idat_chunk_data.cbegin(), idat_chunk_data.cend(), ssize_t{0},
-            [](ttlet &a, ttlet &b) {
-            return a + std::ssize(b);
-        }
-        );
+#if TT_PROCESSOR == TT_CPU_X64
+/** Load a single pixel of 3, 4, 6 or 8 bytes into the low bytes of a register.
+ */
+template<int BytesPerPixel>
+[[nodiscard]] static __m128i load_pixel(uint8_t const *ptr) noexcept
+{
+    static_assert(BytesPerPixel <= 8);
+    uint64_t tmp = 0;
+    std::memcpy(&tmp, ptr, BytesPerPixel);
+    return _mm_cvtsi64_si128(static_cast<int64_t>(tmp));
+}
 
-        bstring compressed_data;
-        compressed_data.reserve(compressed_data_size);
-        for (ttlet &chunk_data : idat_chunk_data) {
-            std::copy(chunk_data.begin(), chunk_data.end(), std::back_inserter(compressed_data));
-        }
+/** Store the low bytes of a register as a single pixel of 3, 4, 6 or 8 bytes.
+ */
+template<int BytesPerPixel>
+static void store_pixel(uint8_t *ptr, __m128i pixel) noexcept
+{
+    static_assert(BytesPerPixel <= 8);
+    ttlet tmp = static_cast<uint64_t>(_mm_cvtsi128_si64(pixel));
+    std::memcpy(ptr, &tmp, BytesPerPixel);
+}
+
+/* The SIMD filters below handle all samples of a pixel at once. Sub, average
+ * and paeth depend on the previous unfiltered pixel in the same line, so the
+ * line itself is still processed one pixel at a time.
+ */
 
-        return zlib_decompress(compressed_data, image_data_size);
+template<int BytesPerPixel>
+static void unfilter_line_sub_sse(std::span<uint8_t> line) noexcept
+{
+    auto left = _mm_setzero_si128();
+    for (ssize_t i = 0; i != std::ssize(line); i += BytesPerPixel) {
+        left = _mm_add_epi8(left, load_pixel<BytesPerPixel>(line.data() + i));
+        store_pixel<BytesPerPixel>(line.data() + i, left);
     }
 }
 
-void png::unfilter_line_sub(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept
+static void unfilter_line_up_sse(std::span<uint8_t> line, std::span<uint8_t const> prev_line) noexcept
 {
-    for (int i = 0; i != bytes_per_line; ++i) {
-        int j = i - bytes_per_pixel;
+    ssize_t i = 0;
+    for (; i + 16 <= std::ssize(line); i += 16) {
+        ttlet up = _mm_loadu_si128(reinterpret_cast<__m128i const *>(prev_line.data() + i));
+        ttlet raw = _mm_loadu_si128(reinterpret_cast<__m128i const *>(line.data() + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(line.data() + i), _mm_add_epi8(raw, up));
+    }
+    for (; i != std::ssize(line); ++i) {
+        line[i] += prev_line[i];
+    }
+}
+
+template<int BytesPerPixel>
+static void unfilter_line_average_sse(std::span<uint8_t> line, std::span<uint8_t const> prev_line) noexcept
+{
+    ttlet ones = _mm_set1_epi8(1);
+
+    auto left = _mm_setzero_si128();
+    for (ssize_t i = 0; i != std::ssize(line); i += BytesPerPixel) {
+        ttlet up = load_pixel<BytesPerPixel>(prev_line.data() + i);
+
+        // _mm_avg_epu8() rounds up, the filter rounds down.
+        auto average = _mm_avg_epu8(left, up);
+        average = _mm_sub_epi8(average, _mm_and_si128(_mm_xor_si128(left, up), ones));
+
+        left = _mm_add_epi8(load_pixel<BytesPerPixel>(line.data() + i), average);
+        store_pixel<BytesPerPixel>(line.data() + i, left);
+    }
+}
+
+template<int BytesPerPixel>
+static void unfilter_line_paeth_sse(std::span<uint8_t> line, std::span<uint8_t const> prev_line) noexcept
+{
+    ttlet zero = _mm_setzero_si128();
+
+    // The predictor is calculated with 16 bit samples, so that a + b - c does not overflow.
+    auto left = _mm_setzero_si128();
+    auto left_up = _mm_setzero_si128();
+    for (ssize_t i = 0; i != std::ssize(line); i += BytesPerPixel) {
+        ttlet up = _mm_unpacklo_epi8(load_pixel<BytesPerPixel>(prev_line.data() + i), zero);
+
+        // p = a + b - c; pa = |p - a| = |b - c|; pb = |p - b| = |a - c|; pc = |p - c| = |(b - c) + (a - c)|
+        ttlet up_min_left_up = _mm_sub_epi16(up, left_up);
+        ttlet left_min_left_up = _mm_sub_epi16(left, left_up);
+        ttlet pa = _mm_abs_epi16(up_min_left_up);
+        ttlet pb = _mm_abs_epi16(left_min_left_up);
+        ttlet pc = _mm_abs_epi16(_mm_add_epi16(up_min_left_up, left_min_left_up));
+
+        // On a tie the order of preference is left, up, left_up.
+        ttlet smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        auto predictor = _mm_blendv_epi8(left_up, up, _mm_cmpeq_epi16(smallest, pb));
+        predictor = _mm_blendv_epi8(predictor, left, _mm_cmpeq_epi16(smallest, pa));
+
+        ttlet raw = _mm_unpacklo_epi8(load_pixel<BytesPerPixel>(line.data() + i), zero);
+        left = _mm_and_si128(_mm_add_epi16(raw, predictor), _mm_set1_epi16(0xff));
+        left_up = up;
+        store_pixel<BytesPerPixel>(line.data() + i, _mm_packus_epi16(left, left));
+    }
+}
+
+/** Unfilter a line with SIMD.
+ * @return false when there is no SIMD filter for this pixel size.
+ */
+[[nodiscard]] static bool unfilter_line_sse(
+    int filter_type,
+    std::span<uint8_t> line,
+    std::span<uint8_t const> prev_line,
+    int bytes_per_pixel) noexcept
+{
+    switch (filter_type * 16 + bytes_per_pixel) {
+    case 0x13: unfilter_line_sub_sse<3>(line); return true;
+    case 0x14: unfilter_line_sub_sse<4>(line); return true;
+    case 0x16: unfilter_line_sub_sse<6>(line); return true;
+    case 0x18: unfilter_line_sub_sse<8>(line); return true;
+    case 0x33: unfilter_line_average_sse<3>(line, prev_line); return true;
+    case 0x34: unfilter_line_average_sse<4>(line, prev_line); return true;
+    case 0x36: unfilter_line_average_sse<6>(line, prev_line); return true;
+    case 0x38: unfilter_line_average_sse<8>(line, prev_line); return true;
+    case 0x43: unfilter_line_paeth_sse<3>(line, prev_line); return true;
+    case 0x44: unfilter_line_paeth_sse<4>(line, prev_line); return true;
+    case 0x46: unfilter_line_paeth_sse<6>(line, prev_line); return true;
+    case 0x48: unfilter_line_paeth_sse<8>(line, prev_line); return true;
+    default:
+        // The up filter does not depend on the pixel size.
+        if (filter_type == 2) {
+            unfilter_line_up_sse(line, prev_line);
+            return true;
+        }
+        return false;
+    }
+}
+#endif
+
+static void unfilter_line_sub(std::span<uint8_t> line, int bytes_per_pixel) noexcept
+{
+    for (ssize_t i = 0; i != std::ssize(line); ++i) {
+        ttlet j = i - bytes_per_pixel;
 
         uint8_t prev_raw = j >= 0 ? line[j] : 0;
         line[i] += prev_raw;
     }
 }
 
-void png::unfilter_line_up(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept
+static void unfilter_line_up(std::span<uint8_t> line, std::span<uint8_t const> prev_line) noexcept
 {
-    for (int i = 0; i != bytes_per_line; ++i) {
+    for (ssize_t i = 0; i != std::ssize(line); ++i) {
         line[i] += prev_line[i];
     }
 }
 
-void png::unfilter_line_average(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept
+static void unfilter_line_average(std::span<uint8_t> line, std::span<uint8_t const> prev_line, int bytes_per_pixel) noexcept
 {
-    for (int i = 0; i != bytes_per_line; ++i) {
-        int j = i - bytes_per_pixel;
+    for (ssize_t i = 0; i != std::ssize(line); ++i) {
+        ttlet j = i - bytes_per_pixel;
 
         uint8_t prev_raw = j >= 0 ? line[j] : 0;
         line[i] += (prev_raw + prev_line[i]) / 2;
@@ -369,10 +491,10 @@ static uint8_t paeth_predictor(uint8_t _a, uint8_t _b, uint8_t _c) noexcept {
     }
 }
 
-void png::unfilter_line_paeth(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept
+static void unfilter_line_paeth(std::span<uint8_t> line, std::span<uint8_t const> prev_line, int bytes_per_pixel) noexcept
 {
-    for (int i = 0; i != bytes_per_line; ++i) {
-        int j = i - bytes_per_pixel;
+    for (ssize_t i = 0; i != std::ssize(line); ++i) {
+        ttlet j = i - bytes_per_pixel;
 
         uint8_t up = prev_line[i];
         uint8_t left = j >= 0 ? line[j] : 0;
@@ -381,29 +503,45 @@ void png::unfilter_line_paeth(std::span<uint8_t> line, std::span<uint8_t const>
     }
 }
 
-void png::unfilter_line(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const
+namespace detail {
+
+void png_unfilter_line_reference(
+    int filter_type,
+    std::span<uint8_t> line,
+    std::span<uint8_t const> prev_line,
+    int bytes_per_pixel) noexcept
 {
-    switch (line[0]) {
-    case 0: return;
-    case 1: return unfilter_line_sub(line.subspan(1, bytes_per_line), prev_line);
-    case 2: return unfilter_line_up(line.subspan(1, bytes_per_line), prev_line);
-    case 3: return unfilter_line_average(line.subspan(1, bytes_per_line), prev_line);
-    case 4: return unfilter_line_paeth(line.subspan(1, bytes_per_line), prev_line);
-    default:
-        throw parse_error("Unknown line-filter type");
+    switch (filter_type) {
+    case 1: return unfilter_line_sub(line, bytes_per_pixel);
+    case 2: return unfilter_line_up(line, prev_line);
+    case 3: return unfilter_line_average(line, prev_line, bytes_per_pixel);
+    case 4: return unfilter_line_paeth(line, prev_line, bytes_per_pixel);
+    default: tt_no_default();
     }
 }
 
-void png::unfilter_lines(bstring &image_data) const
+void png_unfilter_line(int filter_type, std::span<uint8_t> line, std::span<uint8_t const> prev_line, int bytes_per_pixel) noexcept
 {
-    auto image_bytes = std::span(reinterpret_cast<uint8_t *>(image_data.data()), std::ssize(image_data));
-    auto zero_line = bstring(bytes_per_line, std::byte{0});
+#if TT_PROCESSOR == TT_CPU_X64
+    if (unfilter_line_sse(filter_type, line, prev_line, bytes_per_pixel)) {
+        return;
+    }
+#endif
+    png_unfilter_line_reference(filter_type, line, prev_line, bytes_per_pixel);
+}
+
+} // namespace detail
 
-    auto prev_line = std::span(reinterpret_cast<uint8_t *>(zero_line.data()), std::ssize(zero_line));
-    for (int y = 0; y != height; ++y) {
-        auto line = image_bytes.subspan(y * stride, stride);
-        unfilter_line(line, prev_line);
-        prev_line = line.subspan(1, bytes_per_line);
+void png::unfilter_line(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const
+{
+    switch (line[0]) {
+    case 0: return;
+    case 1:
+    case 2:
+    case 3:
+    case 4: return detail::png_unfilter_line(line[0], line.subspan(1, bytes_per_line), prev_line, bytes_per_pixel);
+    default:
+        throw parse_error("Unknown line-filter type");
     }
 }
 
@@ -416,77 +554,193 @@ static int get_sample(std::span<std::byte const> bytes, ssize_t &offset, bool tw
     return value;
 }
 
-i32x4 png::extract_pixel_from_line(std::span<std::byte const> bytes, int x) const noexcept
+/** Convert a line of 8 or 16 bit samples to half-float pixels using lookup tables.
+ */
+template<int BytesPerSample, bool IsColor, bool HasAlpha>
+static void data_to_half_line(
+    std::span<std::byte const> bytes,
+    pixel_row<sfloat_rgba16> &line,
+    float16 const *transfer_function,
+    float16 const *alpha_function) noexcept
 {
-    tt_axiom(bit_depth == 8 || bit_depth == 16);
-    tt_axiom(!is_palletted);
+    auto ptr = reinterpret_cast<uint8_t const *>(bytes.data());
+
+    ttlet get_sample = [&ptr]() {
+        auto value = static_cast<int>(*ptr++);
+        if constexpr (BytesPerSample == 2) {
+            value = (value << 8) | static_cast<int>(*ptr++);
+        }
+        return value;
+    };
+
+    ttlet opaque = float16{1.0f};
+    for (ssize_t x = 0; x != line.width(); ++x) {
+        ttlet r = transfer_function[get_sample()];
+        ttlet g = IsColor ? transfer_function[get_sample()] : r;
+        ttlet b = IsColor ? transfer_function[get_sample()] : r;
+        ttlet a = HasAlpha ? alpha_function[get_sample()] : opaque;
+        line[x] = sfloat_rgba16{r, g, b, a};
+    }
+}
 
-    int r = 0;
-    int g = 0;
-    int b = 0;
-    int a = 0;
+namespace detail {
 
-    ssize_t offset = x * bytes_per_pixel;
-    if (is_color) {
-        r = get_sample(bytes, offset, bit_depth == 16);
-        g = get_sample(bytes, offset, bit_depth == 16);
-        b = get_sample(bytes, offset, bit_depth == 16);
-    } else {
-        r = g = b = get_sample(bytes, offset, bit_depth == 16);
+[[nodiscard]] std::pair<std::vector<float16>, std::vector<float16>>
+png_half_transfer_function(std::span<float const> transfer_function, int bit_depth) noexcept
+{
+    ttlet value_range = bit_depth == 8 ? 256 : 65536;
+    tt_axiom(std::ssize(transfer_function) >= value_range);
+    ttlet alpha_mul = bit_depth == 16 ? 1.0f / 65535.0f : 1.0f / 255.0f;
+
+    auto half_transfer_function = std::vector<float16>(value_range);
+    auto half_alpha_function = std::vector<float16>(value_range);
+
+#if TT_PROCESSOR == TT_CPU_X64
+    // Both tables are a multiple of 4 entries, convert 4 floats at a time.
+    for (int i = 0; i != value_range; i += 4) {
+        ttlet linear = _mm_loadu_ps(transfer_function.data() + i);
+        _mm_storeu_si64(half_transfer_function.data() + i, _mm_cvtps_ph(linear, _MM_FROUND_CUR_DIRECTION));
+
+        ttlet alpha = _mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(i, i + 1, i + 2, i + 3)), _mm_set1_ps(alpha_mul));
+        _mm_storeu_si64(half_alpha_function.data() + i, _mm_cvtps_ph(alpha, _MM_FROUND_CUR_DIRECTION));
     }
-    if (has_alpha) {
-        a = get_sample(bytes, offset, bit_depth == 16);
-    } else {
-        a = (bit_depth == 16) ? 65535 : 255;
+#else
+    for (int i = 0; i != value_range; ++i) {
+        half_transfer_function[i] = float16{transfer_function[i]};
+        half_alpha_function[i] = float16{static_cast<float>(i) * alpha_mul};
     }
+#endif
 
-    return {r, g, b, a};
+    return {std::move(half_transfer_function), std::move(half_alpha_function)};
 }
 
-void png::data_to_image_line(std::span<std::byte const> bytes, pixel_row<sfloat_rgba16> &line) const noexcept
+void png_data_to_half_line(
+    std::span<std::byte const> bytes,
+    pixel_row<sfloat_rgba16> &row,
+    int bit_depth,
+    bool is_color,
+    bool has_alpha,
+    std::span<float16 const> half_transfer_function,
+    std::span<float16 const> half_alpha_function) noexcept
 {
-    ttlet alpha_mul = bit_depth == 16 ? 1.0f/65535.0f : 1.0f/255.0f;
-    for (int x = 0; x != width; ++x) {
-        ttlet value = extract_pixel_from_line(bytes, x);
+    ttlet *transfer = half_transfer_function.data();
+    ttlet *alpha = half_alpha_function.data();
+    switch ((bit_depth == 16 ? 4 : 0) | (is_color ? 2 : 0) | (has_alpha ? 1 : 0)) {
+    case 0: return data_to_half_line<1, false, false>(bytes, row, transfer, alpha);
+    case 1: return data_to_half_line<1, false, true>(bytes, row, transfer, alpha);
+    case 2: return data_to_half_line<1, true, false>(bytes, row, transfer, alpha);
+    case 3: return data_to_half_line<1, true, true>(bytes, row, transfer, alpha);
+    case 4: return data_to_half_line<2, false, false>(bytes, row, transfer, alpha);
+    case 5: return data_to_half_line<2, false, true>(bytes, row, transfer, alpha);
+    case 6: return data_to_half_line<2, true, false>(bytes, row, transfer, alpha);
+    case 7: return data_to_half_line<2, true, true>(bytes, row, transfer, alpha);
+    default: tt_no_default();
+    }
+}
+
+void png_data_to_image_line_reference(
+    std::span<std::byte const> bytes,
+    pixel_row<sfloat_rgba16> &row,
+    int bit_depth,
+    bool is_color,
+    bool has_alpha,
+    std::span<float const> transfer_function,
+    matrix3 const &color_to_sRGB) noexcept
+{
+    tt_axiom(bit_depth == 8 || bit_depth == 16);
+
+    ttlet two_bytes = bit_depth == 16;
+    ttlet alpha_mul = two_bytes ? 1.0f/65535.0f : 1.0f/255.0f;
+
+    ssize_t offset = 0;
+    for (ssize_t x = 0; x != row.width(); ++x) {
+        int r = 0;
+        int g = 0;
+        int b = 0;
+        int a = 0;
+
+        if (is_color) {
+            r = get_sample(bytes, offset, two_bytes);
+            g = get_sample(bytes, offset, two_bytes);
+            b = get_sample(bytes, offset, two_bytes);
+        } else {
+            r = g = b = get_sample(bytes, offset, two_bytes);
+        }
+        if (has_alpha) {
+            a = get_sample(bytes, offset, two_bytes);
+        } else {
+            a = two_bytes ? 65535 : 255;
+        }
 
         ttlet linear_color = color(
-            transfer_function[value.x()],
-            transfer_function[value.y()],
-            transfer_function[value.z()]
+            transfer_function[r],
+            transfer_function[g],
+            transfer_function[b]
         );
 
         auto lesRGB_color = color_to_sRGB * linear_color;
-        lesRGB_color.a() = static_cast<float>(value.w()) * alpha_mul;
+        lesRGB_color.a() = static_cast<float>(a) * alpha_mul;
 
-        line[x] = lesRGB_color;
+        row[x] = lesRGB_color;
     }
 }
 
-void png::data_to_image(bstring bytes, pixel_map<sfloat_rgba16> &image) const noexcept
-{
-    auto bytes_span = std::span(bytes);
+} // namespace detail
 
-    for (int y = 0; y != height; ++y) {
-        int inv_y = height - y - 1;
+void png::data_to_image_line(std::span<std::byte const> bytes, pixel_row<sfloat_rgba16> &line) const noexcept
+{
+    tt_axiom(!is_palletted);
 
-        auto bytes_line = bytes_span.subspan(inv_y * stride + 1, bytes_per_line);
-        auto pixel_line = image[y];
-        data_to_image_line(bytes_line, pixel_line);
+    if (!half_transfer_function.empty()) {
+        detail::png_data_to_half_line(
+            bytes, line, bit_depth, is_color, has_alpha, half_transfer_function, half_alpha_function);
+    } else {
+        detail::png_data_to_image_line_reference(
+            bytes, line, bit_depth, is_color, has_alpha, transfer_function, color_to_sRGB);
     }
 }
 
 void png::decode_image(pixel_map<sfloat_rgba16> &image) const
 {
-    // There is a filter selection byte in front of every line.
-    ttlet image_data_size = stride * height;
-
-    auto image_data = decompress_IDATs(image_data_size);
-    tt_parse_check(std::ssize(image_data) == image_data_size, "Uncompressed image data has incorrect size.");
-
-    unfilter_lines(image_data);
+    // Decompress, unfilter and convert the image line by line, so that only the
+    // current and previous line are kept in memory.
+    auto stream = inflate_stream(inflate_stream::container_type::zlib);
+
+    // There is a filter selection byte in front of every line. The line before the first is all zero.
+    auto line_buffer = std::vector<uint8_t>(stride * 2, 0);
+    auto line = std::span(line_buffer).subspan(0, stride);
+    auto prev_line = std::span(line_buffer).subspan(stride, stride);
+    ssize_t line_size = 0;
+    int y = 0;
+
+    ttlet decode_lines = [&]() {
+        while (y != height) {
+            line_size += stream.read(std::as_writable_bytes(line.subspan(line_size)));
+            if (line_size != stride) {
+                // More compressed data is needed.
+                return;
+            }
+
+            unfilter_line(line, prev_line.subspan(1, bytes_per_line));
+
+            // PNG images are stored top to bottom, pixel_maps bottom to top.
+            auto row = image[height - y - 1];
+            data_to_image_line(std::as_bytes(line.subspan(1, bytes_per_line)), row);
+
+            std::swap(line, prev_line);
+            line_size = 0;
+            ++y;
+        }
+    };
 
-    data_to_image(image_data, image);
+    for (ttlet &chunk_data : idat_chunk_data) {
+        stream.write(chunk_data);
+        decode_lines();
+    }
+    stream.close();
+    decode_lines();
 
+    tt_parse_check(y == height, "Uncompressed image data has incorrect size.");
 }
 
 pixel_map<sfloat_rgba16> png::load(URL const &url)
@@ -497,5 +751,29 @@ pixel_map<sfloat_rgba16> png::load(URL const &url)
     return image;
 }
 
+/** The thread pool shared by all asynchronous PNG decodes.
+ */
+[[nodiscard]] static thread_pool &png_decode_pool() noexcept
+{
+    static auto pool = thread_pool("png_decode");
+    return pool;
+}
+
+std::future<pixel_map<sfloat_rgba16>> png::load_async(URL const &url)
+{
+    return png_decode_pool().submit([url]() {
+        return load(url);
+    });
+}
+
+std::vector<std::future<pixel_map<sfloat_rgba16>>> png::load_async(std::span<URL const> urls)
+{
+    auto r = std::vector<std::future<pixel_map<sfloat_rgba16>>>{};
+    r.reserve(std::ssize(urls));
+    for (ttlet &url : urls) {
+        r.push_back(load_async(url));
+    }
+    return r;
+}
 
 }
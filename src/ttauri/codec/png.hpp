@@ -8,6 +8,7 @@
 #include "../required.hpp"
 #include "../pixel_map.hpp"
 #include "../color/sfloat_rgba16.hpp"
+#include "../float16.hpp"
 #include "../geometry/identity.hpp"
 #include "../numeric_array.hpp"
 #include "../URL.hpp"
@@ -15,10 +16,67 @@
 #include "../byte_string.hpp"
 #include <span>
 #include <vector>
+#include <future>
 #include <cstddef>
 #include <cstdint>
+#include <utility>
 
 namespace tt {
+namespace detail {
+
+/** Reverse the filter of a line of a PNG image.
+ * Whole pixels are unfiltered at once with SIMD where available, otherwise this
+ * falls back to `png_unfilter_line_reference()`.
+ *
+ * @param filter_type The filter of the line: 1 = sub, 2 = up, 3 = average, 4 = paeth.
+ * @param line The filtered bytes of the line without the filter-type byte, unfiltered in place.
+ * @param prev_line The unfiltered bytes of the previous line, all zero for the first line.
+ * @param bytes_per_pixel The number of bytes of a pixel, at least 1.
+ */
+void png_unfilter_line(int filter_type, std::span<uint8_t> line, std::span<uint8_t const> prev_line, int bytes_per_pixel) noexcept;
+
+/** Reverse the filter of a line of a PNG image, one byte at a time.
+ * @see png_unfilter_line()
+ */
+void png_unfilter_line_reference(
+    int filter_type,
+    std::span<uint8_t> line,
+    std::span<uint8_t const> prev_line,
+    int bytes_per_pixel) noexcept;
+
+/** Make the half-float lookup tables for the samples of an image.
+ *
+ * @param transfer_function The linear value for each sample value.
+ * @param bit_depth The number of bits of a sample, 8 or 16.
+ * @return The half-float transfer function for color samples, and the half-float value of each alpha sample.
+ */
+[[nodiscard]] std::pair<std::vector<float16>, std::vector<float16>>
+png_half_transfer_function(std::span<float const> transfer_function, int bit_depth) noexcept;
+
+/** Convert a line of 8 or 16 bit samples to pixels through half-float lookup tables.
+ * This can only be used when no color space conversion is needed.
+ */
+void png_data_to_half_line(
+    std::span<std::byte const> bytes,
+    pixel_row<sfloat_rgba16> &row,
+    int bit_depth,
+    bool is_color,
+    bool has_alpha,
+    std::span<float16 const> half_transfer_function,
+    std::span<float16 const> half_alpha_function) noexcept;
+
+/** Convert a line of 8 or 16 bit samples to pixels through the transfer function and the color conversion matrix.
+ */
+void png_data_to_image_line_reference(
+    std::span<std::byte const> bytes,
+    pixel_row<sfloat_rgba16> &row,
+    int bit_depth,
+    bool is_color,
+    bool has_alpha,
+    std::span<float const> transfer_function,
+    matrix3 const &color_to_sRGB) noexcept;
+
+} // namespace detail
 
 class png {
 public:
@@ -37,6 +95,20 @@ public:
 
     static pixel_map<sfloat_rgba16> load(URL const &url);
 
+    /** Load and decode a PNG file on the shared decode thread pool.
+     *
+     * @param url The location of the PNG file.
+     * @return A future of the decoded image, which rethrows any error on get().
+     */
+    [[nodiscard]] static std::future<pixel_map<sfloat_rgba16>> load_async(URL const &url);
+
+    /** Load and decode many PNG files in parallel on the shared decode thread pool.
+     *
+     * @param urls The locations of the PNG files.
+     * @return A future for each decoded image, in the same order as `urls`.
+     */
+    [[nodiscard]] static std::vector<std::future<pixel_map<sfloat_rgba16>>> load_async(std::span<URL const> urls);
+
 private:
     /** Matrix to convert png color values to sRGB.
      * The default are sRGB color primaries and white-point.
@@ -47,6 +119,15 @@ private:
      */
     std::vector<float> transfer_function;
 
+    /** The transfer function as half-floats, for when `color_to_sRGB` is the identity matrix.
+     * Empty when a color conversion is needed.
+     */
+    std::vector<float16> half_transfer_function;
+
+    /** Convert an alpha sample to a half-float, used together with `half_transfer_function`.
+     */
+    std::vector<float16> half_alpha_function;
+
     int width = 0;
     int height = 0;
     int bit_depth = 0;
@@ -83,16 +164,8 @@ private:
     void generate_sRGB_transfer_function() noexcept;
     void generate_Rec2100_transfer_function() noexcept;
     void generate_gamma_transfer_function(float gamma) noexcept;
-    bstring decompress_IDATs(ssize_t image_data_size) const;
-    void unfilter_lines(bstring &image_data) const;
     void unfilter_line(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const;
-    void unfilter_line_sub(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept;
-    void unfilter_line_up(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept;
-    void unfilter_line_average(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept;
-    void unfilter_line_paeth(std::span<uint8_t> line, std::span<uint8_t const> prev_line) const noexcept;
-    void data_to_image(bstring bytes, pixel_map<sfloat_rgba16> &image) const noexcept;
     void data_to_image_line(std::span<std::byte const> bytes, pixel_row<sfloat_rgba16> &row) const noexcept;
-    i32x4 extract_pixel_from_line(std::span<std::byte const> bytes, int x) const noexcept;
 
 };
 
@@ -0,0 +1,127 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/codec/png.hpp"
+#include "ttauri/color/sRGB.hpp"
+#include "ttauri/URL.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+using namespace tt;
+
+static std::vector<uint8_t> random_bytes(std::mt19937 &rng, ssize_t size)
+{
+    auto dist = std::uniform_int_distribution<int>{0, 255};
+
+    auto r = std::vector<uint8_t>{};
+    r.reserve(size);
+    for (ssize_t i = 0; i != size; ++i) {
+        r.push_back(static_cast<uint8_t>(dist(rng)));
+    }
+    return r;
+}
+
+TEST(png, unfilter_line)
+{
+    auto rng = std::mt19937{42};
+
+    for (int bytes_per_pixel : {1, 2, 3, 4, 6, 8}) {
+        // Include widths that are not a multiple of the 16 byte SIMD registers.
+        for (int width : {1, 2, 5, 16, 33, 100}) {
+            ttlet bytes_per_line = width * bytes_per_pixel;
+
+            for (int filter_type = 1; filter_type <= 4; ++filter_type) {
+                for (int i = 0; i != 10; ++i) {
+                    ttlet prev_line = random_bytes(rng, bytes_per_line);
+                    auto line = random_bytes(rng, bytes_per_line);
+                    auto expected = line;
+
+                    detail::png_unfilter_line(filter_type, line, prev_line, bytes_per_pixel);
+                    detail::png_unfilter_line_reference(filter_type, expected, prev_line, bytes_per_pixel);
+                    ASSERT_EQ(line, expected) << "bytes_per_pixel=" << bytes_per_pixel << " width=" << width
+                                              << " filter_type=" << filter_type;
+                }
+            }
+        }
+    }
+}
+
+TEST(png, data_to_half_line)
+{
+    auto rng = std::mt19937{42};
+
+    for (int bit_depth : {8, 16}) {
+        ttlet value_range = bit_depth == 8 ? 256 : 65536;
+
+        auto transfer_function = std::vector<float>{};
+        transfer_function.reserve(value_range);
+        for (int i = 0; i != value_range; ++i) {
+            transfer_function.push_back(sRGB_gamma_to_linear(static_cast<float>(i) / static_cast<float>(value_range - 1)));
+        }
+
+        ttlet[half_transfer_function, half_alpha_function] = detail::png_half_transfer_function(transfer_function, bit_depth);
+        ASSERT_EQ(std::ssize(half_transfer_function), value_range);
+        ASSERT_EQ(std::ssize(half_alpha_function), value_range);
+
+        for (bool is_color : {false, true}) {
+            for (bool has_alpha : {false, true}) {
+                ttlet width = 100;
+                ttlet samples_per_pixel = (is_color ? 3 : 1) + (has_alpha ? 1 : 0);
+                ttlet data = random_bytes(rng, width * samples_per_pixel * (bit_depth / 8));
+                ttlet bytes = std::span{reinterpret_cast<std::byte const *>(data.data()), data.size()};
+
+                auto image = pixel_map<sfloat_rgba16>{width, 2};
+                auto half_row = image[0];
+                auto reference_row = image[1];
+
+                detail::png_data_to_half_line(
+                    bytes, half_row, bit_depth, is_color, has_alpha, half_transfer_function, half_alpha_function);
+                detail::png_data_to_image_line_reference(
+                    bytes, reference_row, bit_depth, is_color, has_alpha, transfer_function, geo::identity());
+
+                for (ssize_t x = 0; x != width; ++x) {
+                    ASSERT_TRUE(half_row[x] == reference_row[x])
+                        << "bit_depth=" << bit_depth << " is_color=" << is_color << " has_alpha=" << has_alpha << " x=" << x;
+                }
+            }
+        }
+    }
+}
+
+static void load_async_compare(std::vector<URL> const &urls)
+{
+    auto futures = png::load_async(urls);
+    ASSERT_EQ(std::ssize(futures), std::ssize(urls));
+
+    for (ssize_t i = 0; i != std::ssize(urls); ++i) {
+        ttlet expected = png::load(urls[i]);
+        ttlet image = futures[i].get();
+
+        ASSERT_EQ(image.width(), expected.width());
+        ASSERT_EQ(image.height(), expected.height());
+        for (ssize_t y = 0; y != image.height(); ++y) {
+            ttlet row = image[y];
+            ttlet expected_row = expected[y];
+            for (ssize_t x = 0; x != image.width(); ++x) {
+                ASSERT_TRUE(row[x] == expected_row[x]) << urls[i] << " x=" << x << " y=" << y;
+            }
+        }
+    }
+}
+
+TEST(png, load_async)
+{
+    // 8 bit RGBA.
+    load_async_compare({URL("file:png_test1.png")});
+
+    // 16 bit RGB, using every filter type.
+    load_async_compare({URL("file:png_test2.png")});
+
+    // Decode both images at the same time, and the same image twice.
+    load_async_compare({URL("file:png_test1.png"), URL("file:png_test2.png"), URL("file:png_test1.png")});
+}
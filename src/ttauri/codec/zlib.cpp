@@ -1,11 +1,13 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "zlib.hpp"
 #include "inflate.hpp"
+#include "deflate.hpp"
 #include "../endian.hpp"
 #include "../placement.hpp"
+#include <algorithm>
 
 namespace tt {
 
@@ -38,5 +40,44 @@ bstring zlib_decompress(std::span<std::byte const> bytes, ssize_t max_size)
     return r;
 }
 
+[[nodiscard]] static uint32_t adler32(std::span<std::byte const> bytes) noexcept
+{
+    constexpr uint32_t modulo = 65521;
+
+    // 5552 is the largest number of bytes that can be summed before b overflows.
+    constexpr ssize_t chunk_size = 5552;
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (ssize_t offset = 0; offset < std::ssize(bytes); offset += chunk_size) {
+        ttlet last = std::min(offset + chunk_size, std::ssize(bytes));
+        for (auto i = offset; i != last; ++i) {
+            a += static_cast<uint8_t>(bytes[i]);
+            b += a;
+        }
+        a %= modulo;
+        b %= modulo;
+    }
+    return (b << 16) | a;
+}
+
+bstring zlib_compress(std::span<std::byte const> bytes, int level)
+{
+    // Compression method 8 (deflate) with a 32 KiB window.
+    constexpr int CMF = 0x78;
 
-}
\ No newline at end of file
+    ttlet FLEVEL = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    auto FLG = FLEVEL << 6;
+    FLG += (31 - (CMF * 256 + FLG) % 31) % 31;
+
+    auto r = bstring{};
+    r.push_back(static_cast<std::byte>(CMF));
+    r.push_back(static_cast<std::byte>(FLG));
+    r.append(deflate(bytes, level));
+
+    ttlet ADLER32 = native_to_big(adler32(bytes));
+    r.append(reinterpret_cast<std::byte const *>(&ADLER32), sizeof(ADLER32));
+    return r;
+}
+
+}
@@ -1,4 +1,4 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
@@ -17,4 +17,12 @@ inline bstring zlib_decompress(URL const &url, ssize_t max_size=0x01000000) {
     return zlib_decompress(file_view(url), max_size);
 }
 
+/** Compress data into the zlib format.
+ *
+ * @param bytes The data to compress.
+ * @param level The compression level between 0 and 9, see `deflate()`.
+ * @return zlib header, deflate compressed data and ADLER32 check value.
+ */
+[[nodiscard]] bstring zlib_compress(std::span<std::byte const> bytes, int level = 6);
+
 }
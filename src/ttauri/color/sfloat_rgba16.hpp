@@ -48,6 +48,8 @@ public:
         return f32x4{_mm_cvtph_ps(rhs_fp16)};
     }
 
+    sfloat_rgba16(float16 r, float16 g, float16 b, float16 a) noexcept : v{r, g, b, a} {}
+
     sfloat_rgba16(color const &rhs) noexcept : sfloat_rgba16(static_cast<f32x4>(rhs)) {}
 
     sfloat_rgba16 &operator=(color const &rhs) noexcept
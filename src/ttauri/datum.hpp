@@ -18,6 +18,7 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <memory_resource>
 #include <cstring>
 #include <cstdint>
 #include <variant>
@@ -28,11 +29,15 @@
 #include <numeric>
 #include <string_view>
 #include <cmath>
+#include <atomic>
+#include <bit>
 
 namespace tt {
 template<bool HasLargeObjects>
 class datum_impl;
 
+class datum_arena;
+
 }
 
 namespace std {
@@ -105,12 +110,20 @@ inline std::ostream &operator<<(std::ostream &lhs, datum_type_t rhs)
  * you can serialize your own types by adding conversion constructor and
  * operator to and from the datum on your type.
  *
+ * Strings of up to 6 bytes are stored inside the datum. Vectors and maps are
+ * shared between copies of a datum, and are only copied when modified.
+ * The large objects of a whole document may be allocated from a `datum_arena`.
+ *
  * @param HasLargeObjects true when the datum will manage memory for large objects
  */
 template<bool HasLargeObjects>
 class datum_impl {
 private:
     /** Encode 0 to 6 UTF-8 code units in to a uint64_t.
+     * The code units are stored from the most significant byte of the 48 bit
+     * payload, the remaining bytes are zero. The length of the string is the
+     * number of non-zero bytes, therefor strings containing a nul character
+     * are not encoded.
      *
      * @param str String to encode into an uint64_t
      * @return Encoded string, or zero if `str` did not fit.
@@ -119,16 +132,28 @@ private:
     {
         ttlet len = str.size();
 
-        if (len > 5) {
+        if (len > 6) {
             return 0;
         }
 
         uint64_t x = 0;
-        for (uint64_t i = 0; i < len; i++) {
-            x <<= 8;
-            x |= str[i];
+        for (uint64_t i = 0; i != len; i++) {
+            ttlet c = static_cast<uint8_t>(str[i]);
+            if (c == 0) {
+                return 0;
+            }
+            x |= static_cast<uint64_t>(c) << (40 - i * 8);
         }
-        return (string_mask + (len << 40)) | x;
+        return string_mask | x;
+    }
+
+    /** Encode a single character into a uint64_t.
+     *
+     * @return Encoded string, or zero if `c` is a nul character.
+     */
+    static constexpr uint64_t make_string(char c)
+    {
+        return c == 0 ? 0 : string_mask | (static_cast<uint64_t>(static_cast<uint8_t>(c)) << 40);
     }
 
     /** Encode a pointer into a uint64_t.
@@ -176,6 +201,12 @@ private:
     static constexpr uint16_t exponent_mask = 0b0111'1111'1111'0000;
     static constexpr uint64_t pointer_mask = 0x0000'ffff'ffff'ffff;
 
+    /** Set in the pointer of an object that is owned by a `datum_arena`.
+     * All objects are at least 8 byte aligned, so the least significant bit of
+     * a pointer is free.
+     */
+    static constexpr uint64_t arena_flag = 1;
+
     static constexpr uint64_t small_undefined = 0;
     static constexpr uint64_t small_null = 1;
     static constexpr uint64_t small_true = 2;
@@ -290,6 +321,14 @@ private:
         return HasLargeObjects && (type_id() & 0xfff0) == 0xfff0;
     }
 
+    /** Check if the object is owned by a datum_arena.
+     * This datum must hold a pointer.
+     */
+    bool is_arena_pointer() const noexcept
+    {
+        return (u64 & arena_flag) != 0;
+    }
+
     bool is_phy_string_ptr() const noexcept
     {
         return HasLargeObjects && type_id() == phy_string_ptr_id;
@@ -339,6 +378,31 @@ private:
         return static_cast<int64_t>(u64 << 16) >> 16;
     }
 
+    /** A vector or map that is shared between copies of a datum.
+     *
+     * Copying a datum holding a vector or map only increments the reference
+     * count, the object is copied when one of the datums that share it is
+     * modified. Once a reference to an item inside the object has been handed
+     * out the object is no longer shareable, since modifications through that
+     * reference would be visible in all copies; copies of such an object are
+     * deep copies.
+     */
+    template<typename T>
+    struct shared_object {
+        /** Number of datums sharing this object, or zero when the object is not shareable.
+         */
+        std::atomic<int64_t> count;
+        T value;
+
+        template<typename... Args>
+        shared_object(Args &&... args) : count(1), value(std::forward<Args>(args)...)
+        {
+        }
+    };
+
+    using shared_vector = shared_object<std::pmr::vector<datum_impl>>;
+    using shared_map = shared_object<std::pmr::unordered_map<datum_impl, datum_impl>>;
+
     /** Extract a pointer for an existing object from datum's storage.
      * Canonical pointers on x86 and ARM are at most 48 bit and are sign extended to 64 bit.
      * Since the pointer is stored as a 48 bit integer, this function will launder it.
@@ -346,21 +410,101 @@ private:
     template<typename O>
     O *get_pointer() const
     {
-        return std::launder(reinterpret_cast<O *>(get_signed_integer()));
+        return std::launder(reinterpret_cast<O *>(get_signed_integer() & ~static_cast<int64_t>(arena_flag)));
+    }
+
+    [[nodiscard]] std::pmr::vector<datum_impl> const *get_vector() const noexcept
+    {
+        return &get_pointer<shared_vector>()->value;
+    }
+
+    [[nodiscard]] std::pmr::unordered_map<datum_impl, datum_impl> const *get_map() const noexcept
+    {
+        return &get_pointer<shared_map>()->value;
+    }
+
+    /** Get the object that is shared between datums for modification.
+     * When the object is shared with other datums or owned by an arena, a copy
+     * is made on the heap first.
+     *
+     * @param keep_shareable false when a reference to an item inside the object is going
+     *                       to be returned to the caller.
+     */
+    template<typename T>
+    [[nodiscard]] T *get_unique(uint64_t mask, bool keep_shareable)
+    {
+        auto *p = get_pointer<shared_object<T>>();
+        if (is_arena_pointer() || p->count.load(std::memory_order::acquire) > 1) {
+            auto *const q = new shared_object<T>(p->value);
+            if (!is_arena_pointer()) {
+                release_shared(p);
+            }
+            u64 = make_pointer(mask, q);
+            p = q;
+        }
+        if (!keep_shareable) {
+            p->count.store(0, std::memory_order::relaxed);
+        }
+        return &p->value;
+    }
+
+    [[nodiscard]] std::pmr::vector<datum_impl> *get_unique_vector(bool keep_shareable = false)
+    {
+        return get_unique<std::pmr::vector<datum_impl>>(vector_ptr_mask, keep_shareable);
+    }
+
+    [[nodiscard]] std::pmr::unordered_map<datum_impl, datum_impl> *get_unique_map(bool keep_shareable = false)
+    {
+        return get_unique<std::pmr::unordered_map<datum_impl, datum_impl>>(map_ptr_mask, keep_shareable);
+    }
+
+    /** Release a reference to a shared object, deleting it when it was the last reference.
+     */
+    template<typename T>
+    static void release_shared(shared_object<T> *p) noexcept
+    {
+        // An unshareable object has a count of zero and is owned by a single datum.
+        ttlet count = p->count.load(std::memory_order::acquire);
+        if (count <= 1 || p->count.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+            delete p;
+        }
+    }
+
+    /** Share or copy the object of another datum.
+     */
+    template<typename T>
+    void copy_shared(uint64_t mask, datum_impl const &other)
+    {
+        auto *const p = other.get_pointer<shared_object<T>>();
+        auto count = p->count.load(std::memory_order::relaxed);
+        while (count != 0) {
+            if (p->count.compare_exchange_weak(count, count + 1, std::memory_order::relaxed)) {
+                u64 = other.u64;
+                return;
+            }
+        }
+
+        auto *const q = new shared_object<T>(p->value);
+        u64 = make_pointer(mask, q);
     }
 
     /** Delete the object that the datum is pointing to.
      * This function should only be called on a datum that holds a pointer.
+     * Objects owned by an arena are released together with the arena.
      */
     void delete_pointer() noexcept
     {
         if constexpr (HasLargeObjects) {
+            if (is_arena_pointer()) {
+                return;
+            }
+
             switch (type_id()) {
             case phy_integer_ptr_id: delete get_pointer<int64_t>(); break;
-            case phy_string_ptr_id: delete get_pointer<std::string>(); break;
+            case phy_string_ptr_id: delete get_pointer<std::pmr::string>(); break;
             case phy_url_ptr_id: delete get_pointer<URL>(); break;
-            case phy_vector_ptr_id: delete get_pointer<datum_impl::vector>(); break;
-            case phy_map_ptr_id: delete get_pointer<datum_impl::map>(); break;
+            case phy_vector_ptr_id: release_shared(get_pointer<shared_vector>()); break;
+            case phy_map_ptr_id: release_shared(get_pointer<shared_map>()); break;
             case phy_decimal_ptr_id: delete get_pointer<decimal>(); break;
             case phy_bytes_ptr_id: delete get_pointer<bstring>(); break;
             default: tt_no_default();
@@ -370,12 +514,18 @@ private:
 
     /** Copy the object pointed to by the other datum into this datum.
      * Other datum must point to an object. This datum must not point to an object.
+     * Objects owned by an arena are not modified, and are shared instead of copied.
      *
      * @param other The other datum which holds a pointer to an object.
      */
     void copy_pointer(datum_impl const &other) noexcept
     {
         if constexpr (HasLargeObjects) {
+            if (other.is_arena_pointer()) {
+                u64 = other.u64;
+                return;
+            }
+
             switch (other.type_id()) {
             case phy_integer_ptr_id: {
                 auto *const p = new int64_t(*other.get_pointer<int64_t>());
@@ -383,7 +533,7 @@ private:
             } break;
 
             case phy_string_ptr_id: {
-                auto *const p = new std::string(*other.get_pointer<std::string>());
+                auto *const p = new std::pmr::string(*other.get_pointer<std::pmr::string>());
                 u64 = make_pointer(string_ptr_mask, p);
             } break;
 
@@ -392,15 +542,8 @@ private:
                 u64 = make_pointer(url_ptr_mask, p);
             } break;
 
-            case phy_vector_ptr_id: {
-                auto *const p = new datum_impl::vector(*other.get_pointer<datum_impl::vector>());
-                u64 = make_pointer(vector_ptr_mask, p);
-            } break;
-
-            case phy_map_ptr_id: {
-                auto *const p = new datum_impl::map(*other.get_pointer<datum_impl::map>());
-                u64 = make_pointer(map_ptr_mask, p);
-            } break;
+            case phy_vector_ptr_id: copy_shared<datum_impl::vector>(vector_ptr_mask, other); break;
+            case phy_map_ptr_id: copy_shared<datum_impl::map>(map_ptr_mask, other); break;
 
             case phy_decimal_ptr_id: {
                 auto *const p = new decimal(*other.get_pointer<decimal>());
@@ -417,9 +560,20 @@ private:
         }
     }
 
+    friend class datum_arena;
+
 public:
-    using vector = std::vector<datum_impl>;
-    using map = std::unordered_map<datum_impl, datum_impl>;
+    /** A vector of datums.
+     * The vectors of a datum allocate from the default memory resource, unless
+     * they are made by a `datum_arena`.
+     */
+    using vector = std::pmr::vector<datum_impl>;
+
+    /** A map of datums.
+     * The maps of a datum allocate from the default memory resource, unless
+     * they are made by a `datum_arena`.
+     */
+    using map = std::pmr::unordered_map<datum_impl, datum_impl>;
     struct undefined {
     };
     struct null {
@@ -452,17 +606,19 @@ public:
     datum_impl &operator=(datum_impl const &other) noexcept
     {
         if (this != &other) {
-            if (is_phy_pointer()) {
-                [[unlikely]] delete_pointer();
+            // `other` may be owned by this datum, so copy it before deleting our object.
+            if (other.is_phy_pointer()) {
+                [[unlikely]] return *this = datum_impl{other};
             }
 
-            if (other.is_phy_pointer()) {
-                [[unlikely]] copy_pointer(other);
+            // We do a memcpy, because we don't know the type in the union.
+            uint64_t tmp;
+            std::memcpy(&tmp, &other, sizeof(tmp));
 
-            } else {
-                // We do a memcpy, because we don't know the type in the union.
-                std::memcpy(this, &other, sizeof(*this));
+            if (is_phy_pointer()) {
+                [[unlikely]] delete_pointer();
             }
+            std::memcpy(this, &tmp, sizeof(*this));
         }
         return *this;
     }
@@ -478,9 +634,16 @@ public:
     {
         if (this != &other) {
             // We do a memcpy, because we don't know the type in the union.
-            std::memcpy(this, &other, sizeof(*this));
+            // `other` may be owned by this datum, so take its value before deleting our object.
+            uint64_t tmp;
+            std::memcpy(&tmp, &other, sizeof(tmp));
+            other.u64 = undefined_mask;
+
+            if (is_phy_pointer()) {
+                [[unlikely]] delete_pointer();
+            }
+            std::memcpy(this, &tmp, sizeof(*this));
         }
-        other.u64 = undefined_mask;
         return *this;
     }
 
@@ -566,13 +729,18 @@ public:
     datum_impl(signed char value) noexcept : datum_impl(static_cast<signed long long>(value)) {}
 
     datum_impl(bool value) noexcept : u64(value ? true_mask : false_mask) {}
-    datum_impl(char value) noexcept : u64(string_mask | (uint64_t{1} << 40) | value) {}
+    datum_impl(char value) noexcept : u64(make_string(value))
+    {
+        if (u64 == 0) {
+            *this = std::string_view{&value, 1};
+        }
+    }
 
     datum_impl(std::string_view value) noexcept : u64(make_string(value))
     {
         if (u64 == 0) {
             if constexpr (HasLargeObjects) {
-                auto *const p = new std::string(value);
+                auto *const p = new std::pmr::string(value);
                 u64 = make_pointer(string_ptr_mask, p);
             } else {
                 throw std::overflow_error(fmt::format("Constructing string {} to datum, larger than 6 characters", value));
@@ -600,28 +768,28 @@ public:
     template<bool P = HasLargeObjects, std::enable_if_t<P, int> = 0>
     datum_impl(datum_impl::vector const &value) noexcept
     {
-        auto *const p = new datum_impl::vector(value);
+        auto *const p = new shared_vector(value);
         u64 = make_pointer(vector_ptr_mask, p);
     }
 
     template<bool P = HasLargeObjects, std::enable_if_t<P, int> = 0>
     datum_impl(datum_impl::vector &&value) noexcept
     {
-        auto *const p = new datum_impl::vector(std::move(value));
+        auto *const p = new shared_vector(std::move(value));
         u64 = make_pointer(vector_ptr_mask, p);
     }
 
     template<bool P = HasLargeObjects, std::enable_if_t<P, int> = 0>
     datum_impl(datum_impl::map const &value) noexcept
     {
-        auto *const p = new datum_impl::map(value);
+        auto *const p = new shared_map(value);
         u64 = make_pointer(map_ptr_mask, p);
     }
 
     template<bool P = HasLargeObjects, std::enable_if_t<P, int> = 0>
     datum_impl(datum_impl::map &&value) noexcept
     {
-        auto *const p = new datum_impl::map(std::move(value));
+        auto *const p = new shared_map(std::move(value));
         u64 = make_pointer(map_ptr_mask, p);
     }
 
@@ -807,7 +975,10 @@ public:
         if (is_phy_pointer()) {
             [[unlikely]] delete_pointer();
         }
-        u64 = string_mask | (uint64_t{1} << 40) | static_cast<uint64_t>(rhs);
+        u64 = make_string(rhs);
+        if (u64 == 0) {
+            *this = std::string_view{&rhs, 1};
+        }
         return *this;
     }
 
@@ -820,7 +991,7 @@ public:
         u64 = make_string(rhs);
         if (u64 == 0) {
             if constexpr (HasLargeObjects) {
-                auto *const p = new std::string(rhs);
+                auto *const p = new std::pmr::string(rhs);
                 u64 = make_pointer(string_ptr_mask, p);
             } else {
                 throw std::overflow_error(fmt::format("Assigning string {} to datum, larger than 6 characters", rhs));
@@ -872,7 +1043,7 @@ public:
             [[unlikely]] delete_pointer();
         }
 
-        auto *const p = new datum_impl::vector(rhs);
+        auto *const p = new shared_vector(rhs);
         u64 = make_pointer(vector_ptr_mask, p);
 
         return *this;
@@ -885,7 +1056,7 @@ public:
             [[unlikely]] delete_pointer();
         }
 
-        auto *const p = new datum_impl::vector(std::move(rhs));
+        auto *const p = new shared_vector(std::move(rhs));
         u64 = make_pointer(vector_ptr_mask, p);
 
         return *this;
@@ -898,7 +1069,7 @@ public:
             [[unlikely]] delete_pointer();
         }
 
-        auto *const p = new datum_impl::map(rhs);
+        auto *const p = new shared_map(rhs);
         u64 = make_pointer(map_ptr_mask, p);
 
         return *this;
@@ -911,7 +1082,7 @@ public:
             [[unlikely]] delete_pointer();
         }
 
-        auto *const p = new datum_impl::map(std::move(rhs));
+        auto *const p = new shared_map(std::move(rhs));
         u64 = make_pointer(map_ptr_mask, p);
 
         return *this;
@@ -1116,9 +1287,9 @@ public:
     explicit operator char() const
     {
         if (is_phy_string() && size() == 1) {
-            return u64 & 0xff;
+            return static_cast<char>((u64 >> 40) & 0xff);
         } else if (is_phy_string_ptr() && size() == 1) {
-            return get_pointer<std::string>()->at(0);
+            return get_pointer<std::pmr::string>()->at(0);
         } else {
             throw operation_error(
                 "Value {} of type {} can not be converted to a char", this->repr(), this->type_name());
@@ -1165,16 +1336,16 @@ public:
 
         case phy_string_id: {
             ttlet length = size();
-            char buffer[5];
+            char buffer[6];
             for (int i = 0; i < length; i++) {
-                buffer[i] = (u64 >> ((length - i - 1) * 8)) & 0xff;
+                buffer[i] = static_cast<char>((u64 >> (40 - i * 8)) & 0xff);
             }
             return std::string(buffer, length);
         }
 
         case phy_string_ptr_id:
             if constexpr (HasLargeObjects) {
-                return *get_pointer<std::string>();
+                return std::string{*get_pointer<std::pmr::string>()};
             } else {
                 tt_no_default();
             }
@@ -1271,7 +1442,7 @@ public:
     explicit operator datum_impl::vector() const
     {
         if (is_vector()) {
-            return *get_pointer<datum_impl::vector>();
+            return *get_vector();
         } else {
             throw operation_error(
                 "Value {} of type {} can not be converted to a Vector", this->repr(), this->type_name());
@@ -1282,7 +1453,7 @@ public:
     explicit operator datum_impl::map() const
     {
         if (is_map()) {
-            return *get_pointer<datum_impl::map>();
+            return *get_map();
         } else {
             throw operation_error(
                 "Value {} of type {} can not be converted to a Map", this->repr(), this->type_name());
@@ -1294,6 +1465,11 @@ public:
      * When this datum holds undefined it is treated as if datum holds an empty map.
      * When this datum holds a vector, the index must be datum holding an integer.
      *
+     * The returned reference may be written to after this datum was copied; for example a
+     * formula evaluates the index expression after taking a reference to the left hand side.
+     * Therefore the vector or map is made unique and is no longer shared with later copies,
+     * which will make a deep copy instead. Index a const datum to read without losing sharing.
+     *
      * @param rhs An index into the map or vector.
      */
     template<bool P = HasLargeObjects, std::enable_if_t<P, int> = 0>
@@ -1301,18 +1477,18 @@ public:
     {
         if (is_undefined()) {
             // When accessing a name on an undefined it means we need replace it with an empty map.
-            auto *p = new datum_impl::map();
+            auto *p = new shared_map();
             u64 = map_ptr_mask | (reinterpret_cast<uint64_t>(p) & pointer_mask);
         }
 
         if (is_map()) {
-            auto &m = *get_pointer<datum_impl::map>();
+            auto &m = *get_unique_map();
             auto [i, did_insert] = m.try_emplace(rhs);
             return i->second;
 
         } else if (is_vector() && rhs.is_integer()) {
             auto index = static_cast<int64_t>(rhs);
-            auto &v = *get_pointer<datum_impl::vector>();
+            auto &v = *get_unique_vector();
 
             if (index < 0) {
                 index = std::ssize(v) + index;
@@ -1341,7 +1517,7 @@ public:
     datum_impl operator[](datum_impl const &rhs) const
     {
         if (is_map()) {
-            ttlet &m = *get_pointer<datum_impl::map>();
+            ttlet &m = *get_map();
             ttlet i = m.find(rhs);
             if (i == m.cend()) {
                 throw operation_error("Could not find key {} in map of size {}", rhs.repr(), std::ssize(m));
@@ -1350,7 +1526,7 @@ public:
 
         } else if (is_vector() && rhs.is_integer()) {
             auto index = static_cast<int64_t>(rhs);
-            ttlet &v = *get_pointer<datum_impl::vector>();
+            ttlet &v = *get_vector();
 
             if (index < 0) {
                 index = std::ssize(v) + index;
@@ -1380,13 +1556,13 @@ public:
     bool contains(datum_impl const &rhs) const noexcept
     {
         if (is_map()) {
-            ttlet &m = *get_pointer<datum_impl::map>();
+            ttlet &m = *get_map();
             ttlet i = m.find(rhs);
             return i != m.cend();
 
         } else if (is_vector() && rhs.is_integer()) {
             auto index = static_cast<int64_t>(rhs);
-            ttlet &v = *get_pointer<datum_impl::vector>();
+            ttlet &v = *get_vector();
 
             if (index < 0) {
                 index = std::ssize(v) + index;
@@ -1409,12 +1585,12 @@ public:
     {
         if (is_undefined()) {
             // When appending on undefined it means we need replace it with an empty vector.
-            auto *p = new datum_impl::vector();
+            auto *p = new shared_vector();
             u64 = vector_ptr_mask | (reinterpret_cast<uint64_t>(p) & pointer_mask);
         }
 
         if (is_vector()) {
-            auto *v = get_pointer<datum_impl::vector>();
+            auto *v = get_unique_vector();
             v->emplace_back();
             return v->back();
 
@@ -1428,12 +1604,12 @@ public:
     {
         if (is_undefined()) {
             // When appending on undefined it means we need replace it with an empty vector.
-            auto *p = new datum_impl::vector();
+            auto *p = new shared_vector();
             u64 = vector_ptr_mask | (reinterpret_cast<uint64_t>(p) & pointer_mask);
         }
 
         if (is_vector()) {
-            auto *v = get_pointer<datum_impl::vector>();
+            auto *v = get_unique_vector(true);
             v->emplace_back(std::forward<Args>(args)...);
 
         } else {
@@ -1446,12 +1622,12 @@ public:
     {
         if (is_undefined()) {
             // When appending on undefined it means we need replace it with an empty vector.
-            auto *p = new datum_impl::vector();
+            auto *p = new shared_vector();
             u64 = vector_ptr_mask | (reinterpret_cast<uint64_t>(p) & pointer_mask);
         }
 
         if (is_vector()) {
-            auto *v = get_pointer<datum_impl::vector>();
+            auto *v = get_unique_vector(true);
             v->push_back(std::forward<Arg>(arg));
 
         } else {
@@ -1462,7 +1638,7 @@ public:
     void pop_back()
     {
         if (is_vector()) {
-            auto *v = get_pointer<datum_impl::vector>();
+            auto *v = get_unique_vector(true);
             v->pop_back();
 
         } else {
@@ -1510,7 +1686,7 @@ public:
     datum_impl const &front() const
     {
         if (is_vector()) {
-            ttlet *v = get_pointer<datum_impl::vector>();
+            ttlet *v = get_vector();
             return v->front();
 
         } else {
@@ -1518,10 +1694,13 @@ public:
         }
     }
 
+    /** Get a reference to the first item of a vector.
+     * Like the non-const `operator[]`, the vector is no longer shared with later copies.
+     */
     datum_impl &front()
     {
         if (is_vector()) {
-            auto *v = get_pointer<datum_impl::vector>();
+            auto *v = get_unique_vector();
             return v->front();
 
         } else {
@@ -1532,7 +1711,7 @@ public:
     datum_impl const &back() const
     {
         if (is_vector()) {
-            ttlet *v = get_pointer<datum_impl::vector>();
+            ttlet *v = get_vector();
             return v->back();
 
         } else {
@@ -1540,10 +1719,13 @@ public:
         }
     }
 
+    /** Get a reference to the last item of a vector.
+     * Like the non-const `operator[]`, the vector is no longer shared with later copies.
+     */
     datum_impl &back()
     {
         if (is_vector()) {
-            auto *v = get_pointer<datum_impl::vector>();
+            auto *v = get_unique_vector();
             return v->back();
 
         } else {
@@ -1780,10 +1962,14 @@ public:
     size_t size() const
     {
         switch (type_id()) {
-        case phy_string_id: return (u64 >> 40) & 0xff;
-        case phy_string_ptr_id: return get_pointer<std::string>()->size();
-        case phy_vector_ptr_id: return get_pointer<datum_impl::vector>()->size();
-        case phy_map_ptr_id: return get_pointer<datum_impl::map>()->size();
+        case phy_string_id: {
+            // The string is stored from the most significant byte, followed by zero bytes.
+            ttlet payload = get_unsigned_integer();
+            return payload == 0 ? 0 : 6 - std::countr_zero(payload) / 8;
+        }
+        case phy_string_ptr_id: return get_pointer<std::pmr::string>()->size();
+        case phy_vector_ptr_id: return get_vector()->size();
+        case phy_map_ptr_id: return get_map()->size();
         case phy_bytes_ptr_id: return get_pointer<bstring>()->size();
         default: throw operation_error("Can't get size of value {} of type {}.", this->repr(), this->type_name());
         }
@@ -1793,7 +1979,7 @@ public:
     typename map::const_iterator map_begin() const
     {
         if (is_phy_map_ptr()) {
-            return get_pointer<datum_impl::map>()->begin();
+            return get_map()->begin();
         } else {
             throw operation_error("map_begin() expect datum to be a map, but it is a {}.", this->type_name());
         }
@@ -1803,7 +1989,7 @@ public:
     typename map::const_iterator map_end() const
     {
         if (is_phy_map_ptr()) {
-            return get_pointer<datum_impl::map>()->end();
+            return get_map()->end();
         } else {
             throw operation_error("map_end() expect datum to be a map, but it is a {}.", this->type_name());
         }
@@ -1813,7 +1999,7 @@ public:
     typename vector::const_iterator vector_begin() const
     {
         if (is_phy_vector_ptr()) {
-            return get_pointer<datum_impl::vector>()->begin();
+            return get_vector()->begin();
         } else {
             throw operation_error(
                 "vector_begin() expect datum to be a vector, but it is a {}.", this->type_name());
@@ -1824,7 +2010,7 @@ public:
     typename vector::const_iterator vector_end() const
     {
         if (is_phy_vector_ptr()) {
-            return get_pointer<datum_impl::vector>()->end();
+            return get_vector()->end();
         } else {
             throw operation_error("vector_end() expect datum to be a vector, but it is a {}.", this->type_name());
         }
@@ -1837,7 +2023,8 @@ public:
         } else if (is_phy_pointer()) {
             [[unlikely]] switch (type_id())
             {
-            case phy_string_ptr_id: return std::hash<std::string>{}(*get_pointer<std::string>());
+            case phy_integer_ptr_id: return std::hash<int64_t>{}(*get_pointer<int64_t>());
+            case phy_string_ptr_id: return std::hash<std::string_view>{}(*get_pointer<std::pmr::string>());
             case phy_url_ptr_id: return std::hash<URL>{}(*get_pointer<URL>());
             case phy_vector_ptr_id:
                 return std::accumulate(vector_begin(), vector_end(), size_t{0}, [](size_t a, auto x) {
@@ -1999,9 +2186,9 @@ public:
         case datum_impl::phy_url_ptr_id:
             return (rhs.is_url() || rhs.is_string()) && static_cast<URL>(lhs) == static_cast<URL>(rhs);
         case datum_impl::phy_vector_ptr_id:
-            return rhs.is_vector() && *lhs.get_pointer<datum_impl::vector>() == *rhs.get_pointer<datum_impl::vector>();
+            return rhs.is_vector() && (lhs.u64 == rhs.u64 || *lhs.get_vector() == *rhs.get_vector());
         case datum_impl::phy_map_ptr_id:
-            return rhs.is_map() && *lhs.get_pointer<datum_impl::map>() == *rhs.get_pointer<datum_impl::map>();
+            return rhs.is_map() && (lhs.u64 == rhs.u64 || *lhs.get_map() == *rhs.get_map());
         case datum_impl::phy_bytes_ptr_id: return (rhs.is_bytes() && static_cast<bstring>(lhs) == static_cast<bstring>(rhs));
         default:
             if (lhs.is_phy_float()) {
@@ -2066,13 +2253,13 @@ public:
             }
         case datum_impl::phy_vector_ptr_id:
             if (rhs.is_vector()) {
-                return *lhs.get_pointer<datum_impl::vector>() < *rhs.get_pointer<datum_impl::vector>();
+                return *lhs.get_vector() < *rhs.get_vector();
             } else {
                 return lhs.type_order() < rhs.type_order();
             }
         case datum_impl::phy_map_ptr_id:
             if (rhs.is_map()) {
-                return *lhs.get_pointer<datum_impl::map>() < *rhs.get_pointer<datum_impl::map>();
+                return *lhs.get_map() < *rhs.get_map();
             } else {
                 return lhs.type_order() < rhs.type_order();
             }
@@ -2139,12 +2326,12 @@ public:
 
         } else if (lhs.is_vector() && rhs.is_vector()) {
             auto lhs_ = static_cast<datum_impl::vector>(lhs);
-            ttlet &rhs_ = *(rhs.get_pointer<datum_impl::vector>());
+            ttlet &rhs_ = *(rhs.get_vector());
             std::copy(rhs_.begin(), rhs_.end(), std::back_inserter(lhs_));
             return datum_impl{std::move(lhs_)};
 
         } else if (lhs.is_map() && rhs.is_map()) {
-            ttlet &lhs_ = *(lhs.get_pointer<datum_impl::map>());
+            ttlet &lhs_ = *(lhs.get_map());
             auto rhs_ = static_cast<datum_impl::map>(rhs);
             for (ttlet &item : lhs_) {
                 rhs_.try_emplace(item.first, item.second);
@@ -2426,7 +2613,7 @@ public:
         if (lhs.is_map() && rhs.is_map()) {
             result = lhs;
 
-            auto result_map = result.get_pointer<datum_impl::map>();
+            auto result_map = result.get_unique_map(true);
             for (auto rhs_i = rhs.map_begin(); rhs_i != rhs.map_end(); rhs_i++) {
                 auto result_i = result_map->find(rhs_i->first);
                 if (result_i == result_map->end()) {
@@ -2439,7 +2626,7 @@ public:
         } else if (lhs.is_vector() && rhs.is_vector()) {
             result = lhs;
 
-            auto result_vector = result.get_pointer<datum_impl::vector>();
+            auto result_vector = result.get_unique_vector(true);
             for (auto rhs_i = rhs.vector_begin(); rhs_i != rhs.vector_end(); rhs_i++) {
                 result_vector->push_back(*rhs_i);
             }
@@ -2523,6 +2710,217 @@ bool operator<(
 using datum = datum_impl<true>;
 using sdatum = datum_impl<false>;
 
+/** An arena that owns the large objects of a datum document.
+ *
+ * The strings, large numbers, vectors and maps made by the arena, including
+ * the items of the vectors and maps, are allocated from a monotonic buffer.
+ * They are not freed one by one; all memory is released at once when the
+ * arena is destroyed.
+ *
+ * The objects in the arena are never modified. Copies of a datum that refers
+ * to the arena share its object, and modifying such a datum first copies the
+ * object out of the arena onto the heap. The items of that copy still refer to
+ * the arena. Therefor no datum that was made by, or copied from, the arena may
+ * be used after the arena is destroyed.
+ */
+class datum_arena {
+public:
+    datum_arena() = default;
+    ~datum_arena()
+    {
+        for (ttlet[ptr, destroy] : _destructors) {
+            destroy(ptr);
+        }
+    }
+
+    datum_arena(datum_arena const &) = delete;
+    datum_arena(datum_arena &&) = delete;
+    datum_arena &operator=(datum_arena const &) = delete;
+    datum_arena &operator=(datum_arena &&) = delete;
+
+    /** Create an arena.
+     * @param initial_size The size in bytes of the first block of memory.
+     */
+    explicit datum_arena(size_t initial_size) : _resource(initial_size) {}
+
+    [[nodiscard]] std::pmr::memory_resource *resource() noexcept
+    {
+        return &_resource;
+    }
+
+    /** Make an empty vector that allocates from the arena.
+     * Fill the vector and pass it to `make()` to build a document without
+     * allocating on the heap.
+     */
+    [[nodiscard]] datum::vector make_vector() noexcept
+    {
+        return datum::vector(&_resource);
+    }
+
+    /** Make an empty map that allocates from the arena.
+     * @see make_vector()
+     */
+    [[nodiscard]] datum::map make_map()
+    {
+        return datum::map(&_resource);
+    }
+
+    /** Make a datum holding a string.
+     * Strings of more than 6 bytes are stored in the arena.
+     */
+    [[nodiscard]] datum make(std::string_view value)
+    {
+        auto r = datum{};
+        r.u64 = datum::make_string(value);
+        if (r.u64 == 0) {
+            r.u64 = make_pointer(datum::string_ptr_mask, make_object<std::pmr::string>(value, &_resource));
+        }
+        return r;
+    }
+
+    /** Make a datum holding a vector stored in the arena.
+     * The vector should have been made with `make_vector()`, otherwise its items are
+     * moved into the arena. Items that hold objects on the heap are copied into the arena.
+     */
+    [[nodiscard]] datum make(datum::vector &&value)
+    {
+        auto *const p = make_object<datum::shared_vector>(std::move(value), &_resource);
+        for (auto &item : p->value) {
+            if (is_heap_pointer(item)) {
+                item = copy(item);
+            }
+        }
+        return make_datum(datum::vector_ptr_mask, p);
+    }
+
+    /** Make a datum holding a map stored in the arena.
+     * The map should have been made with `make_map()`, otherwise its items are
+     * moved into the arena. Items that hold objects on the heap are copied into the arena.
+     */
+    [[nodiscard]] datum make(datum::map &&value)
+    {
+        ttlet in_arena = value.get_allocator().resource() == &_resource &&
+            std::none_of(value.cbegin(), value.cend(), [](ttlet &item) {
+                                 return is_heap_pointer(item.first);
+                             });
+
+        auto *const p = in_arena ? make_object<datum::shared_map>(std::move(value)) :
+                                   make_object<datum::shared_map>(&_resource);
+        if (in_arena) {
+            for (auto &[key, item] : p->value) {
+                if (is_heap_pointer(item)) {
+                    item = copy(item);
+                }
+            }
+        } else {
+            // The keys of a map are const, so they can only be copied into the arena by rebuilding the map.
+            p->value.reserve(value.size());
+            for (auto &[key, item] : value) {
+                p->value.emplace(copy(key), copy(item));
+            }
+        }
+        return make_datum(datum::map_ptr_mask, p);
+    }
+
+    /** Copy a datum into the arena.
+     * The objects of `value` that are on the heap are copied into the arena
+     * recursively, objects that are already in an arena are shared.
+     */
+    [[nodiscard]] datum copy(datum const &value)
+    {
+        if (!is_heap_pointer(value)) {
+            return value;
+        }
+
+        switch (value.type_id()) {
+        case datum::phy_integer_ptr_id:
+            return make_datum(datum::integer_ptr_mask, make_object<int64_t>(*value.get_pointer<int64_t>()));
+
+        case datum::phy_decimal_ptr_id:
+            return make_datum(datum::decimal_ptr_mask, make_object<decimal>(*value.get_pointer<decimal>()));
+
+        case datum::phy_string_ptr_id: return make(std::string_view{*value.get_pointer<std::pmr::string>()});
+
+        case datum::phy_url_ptr_id:
+            return make_datum(datum::url_ptr_mask, make_external_object<URL>(*value.get_pointer<URL>()));
+
+        case datum::phy_bytes_ptr_id:
+            return make_datum(datum::bytes_ptr_mask, make_external_object<bstring>(*value.get_pointer<bstring>()));
+
+        case datum::phy_vector_ptr_id: {
+            ttlet &v = *value.get_vector();
+            auto r = make_vector();
+            r.reserve(v.size());
+            for (ttlet &item : v) {
+                r.push_back(copy(item));
+            }
+            return make(std::move(r));
+        }
+
+        case datum::phy_map_ptr_id: {
+            ttlet &m = *value.get_map();
+            auto r = make_map();
+            r.reserve(m.size());
+            for (ttlet &[key, item] : m) {
+                r.emplace(copy(key), copy(item));
+            }
+            return make(std::move(r));
+        }
+
+        default: tt_no_default();
+        }
+    }
+
+private:
+    std::pmr::monotonic_buffer_resource _resource;
+
+    /** Objects in the arena that own memory outside of the arena.
+     */
+    std::vector<std::pair<void *, void (*)(void *)>> _destructors;
+
+    [[nodiscard]] static bool is_heap_pointer(datum const &value) noexcept
+    {
+        return value.is_phy_pointer() && !value.is_arena_pointer();
+    }
+
+    [[nodiscard]] static uint64_t make_pointer(uint64_t mask, void *ptr) noexcept
+    {
+        return datum::make_pointer(mask, ptr) | datum::arena_flag;
+    }
+
+    [[nodiscard]] static datum make_datum(uint64_t mask, void *ptr) noexcept
+    {
+        auto r = datum{};
+        r.u64 = make_pointer(mask, ptr);
+        return r;
+    }
+
+    /** Construct an object in the arena.
+     * The object must be trivially destructible or only allocate from the arena,
+     * since it is never destroyed.
+     */
+    template<typename T, typename... Args>
+    [[nodiscard]] T *make_object(Args &&... args)
+    {
+        static_assert(alignof(T) > datum::arena_flag, "The arena flag is stored in the least significant bit of the pointer");
+        auto *const p = static_cast<T *>(_resource.allocate(sizeof(T), alignof(T)));
+        return std::construct_at(p, std::forward<Args>(args)...);
+    }
+
+    /** Construct an object in the arena which is destroyed together with the arena.
+     */
+    template<typename T>
+    [[nodiscard]] T *make_external_object(T const &value)
+    {
+        _destructors.reserve(_destructors.size() + 1);
+        auto *const p = make_object<T>(value);
+        _destructors.emplace_back(p, [](void *ptr) {
+            std::destroy_at(static_cast<T *>(ptr));
+        });
+        return p;
+    }
+};
+
 } // namespace tt
 
 namespace std {
@@ -128,3 +128,95 @@ TEST(Datum, ArrayOperations) {
     ASSERT_EQ(v[-2], 14);
     ASSERT_EQ(v[-1], 15);
 }
+
+TEST(Datum, ShortStrings) {
+    for (ttlet &str : {""s, "a"s, "ab"s, "abcde"s, "abcdef"s, "abcdefg"s, "\xe2\x82\xac"s, "a\0b"s, "\0"s}) {
+        ttlet v = datum{str};
+        ASSERT_TRUE(v.is_string());
+        ASSERT_EQ(v.size(), str.size());
+        ASSERT_EQ(static_cast<std::string>(v), str);
+        ASSERT_EQ(v, datum{std::string{str}});
+    }
+
+    ASSERT_EQ(static_cast<char>(datum{'x'}), 'x');
+    ASSERT_EQ(static_cast<char>(datum{'\xff'}), '\xff');
+    ASSERT_EQ(static_cast<char>(datum{'\0'}), '\0');
+    ASSERT_TRUE(datum{"abc"} < datum{"abd"});
+    ASSERT_TRUE(datum{"ab"} < datum{"abc"});
+}
+
+TEST(Datum, SharedVectorAndMap) {
+    auto a = datum{datum::vector{1, 2, 3}};
+    auto b = a;
+    ASSERT_EQ(a, b);
+
+    // Modifying a copy does not modify the original.
+    b.push_back(4);
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_EQ(b.size(), 4);
+
+    auto m = datum{datum::map{}};
+    m["x"] = a;
+    auto n = m;
+    n["x"][0] = 42;
+    ASSERT_EQ(m["x"][0], 1);
+    ASSERT_EQ(n["x"][0], 42);
+    ASSERT_EQ(a[0], 1);
+
+    // A reference into the map stays valid and is not shared by later copies.
+    auto &x = m["y"];
+    ttlet o = m;
+    x = 5;
+    ASSERT_EQ(m["y"], 5);
+    ASSERT_TRUE(o["y"].is_undefined());
+
+    // Assigning a datum to one of its own items.
+    m["z"] = m;
+    ASSERT_EQ(m["z"]["y"], 5);
+    ASSERT_TRUE(std::as_const(m)["z"]["z"].is_undefined());
+    m = m["z"];
+    ASSERT_EQ(m["y"], 5);
+    m = std::move(m["x"]);
+    ASSERT_EQ(m, a);
+}
+
+TEST(Datum, Arena) {
+    auto heap_list = datum{datum::vector{1, "a long string", datum::vector{2, 3}}};
+    auto heap_document = datum{datum::map{}};
+    heap_document["list"] = heap_list;
+    heap_document["a long key"] = "another long string";
+    heap_document["big"] = 0x7fff'ffff'ffff'ffffLL;
+    heap_document["url"] = URL("file:foo.txt");
+
+    auto arena = datum_arena{};
+
+    // Build a document directly in the arena.
+    auto list = arena.make_vector();
+    list.push_back(1);
+    list.push_back(arena.make("a long string"));
+    list.push_back(arena.copy(datum{datum::vector{2, 3}}));
+    auto document = arena.make_map();
+    document.emplace(arena.make("list"), arena.make(std::move(list)));
+    document.emplace(arena.make("a long key"), arena.make("another long string"));
+
+    // Heap objects are copied into the arena.
+    document.emplace(arena.make("big"), 0x7fff'ffff'ffff'ffffLL);
+    document.emplace(arena.make("url"), URL("file:foo.txt"));
+    auto a = arena.make(std::move(document));
+    ASSERT_EQ(a, heap_document);
+    ASSERT_EQ(std::hash<datum>{}(a), std::hash<datum>{}(heap_document));
+    ASSERT_EQ(arena.copy(heap_document), heap_document);
+
+    // Modifying a datum in the arena copies it to the heap, the arena is not modified.
+    auto b = a;
+    b["list"].push_back(4);
+    b["big"] = 5;
+    ASSERT_EQ(a, heap_document);
+    ASSERT_EQ(b["list"].size(), 4);
+    ASSERT_EQ(b["list"][1], "a long string");
+    ASSERT_EQ(b["big"], 5);
+
+    // A map that is not made by the arena is rebuilt in the arena.
+    auto c = arena.make(datum::map{{datum{"a long key"}, datum{"a long value"}}});
+    ASSERT_EQ(c["a long key"], "a long value");
+}
@@ -7,6 +7,7 @@
 #include "exception.hpp"
 #include "int_overflow.hpp"
 #include "math.hpp"
+#include "float_conversion.hpp"
 #include <fmt/ostream.h>
 #include <limits>
 #include <string_view>
@@ -499,82 +500,69 @@ private:
         return static_cast<uint64_t>(m) << exponent_bits | static_cast<uint8_t>(e);
     }
 
+    /** Convert a double to the shortest decimal which rounds back to the same double.
+     */
     [[nodiscard]] static std::pair<int, long long> to_exponent_mantissa(double x) noexcept
     {
-        uint64_t x_;
-        std::memcpy(&x_, &x, sizeof(x_));
-
-        auto e2 = static_cast<int>((x_ << 1) >> 53) - 1023 - 52;
-        auto m = static_cast<long long>((x_ << 12) >> 12);
-        if (e2 > (-1023 - 52)) {
-            // Add leading '1'.
-            m |= (1LL << 52);
-        }
-
-        if (static_cast<int64_t>(x_) < 0) {
-            m = -m;
-        }
-
-        if (m == 0) {
+        if (x == 0.0) {
             return {0, 0};
         }
 
-        int e10 = 0;
-        while (e2 < 0) {
-            while (is_valid_mantissa(m)) {
-                m *= 10;
-                e10--;
-            }
-            m /= 2;
-            e2++;
-        }
-
-        while (e2 > 0) {
-            while (!is_valid_mantissa(m)) {
-                m /= 10;
-                e10++;
-            }
-            m *= 2;
-            e2--;
-        }
-
-        return {e10, m};
+        ttlet[e, m] = float_to_decimal(std::abs(x));
+        // The mantissa has at most 17 digits, which fits in a long long.
+        return {e, x < 0.0 ? -static_cast<long long>(m) : static_cast<long long>(m)};
     }
 
     [[nodiscard]] std::pair<int, long long> to_exponent_mantissa(std::string_view str)
     {
-        std::string mantissa_str;
+        auto ptr = str.data();
+        ttlet last = ptr + str.size();
 
+        ttlet negative = ptr != last && *ptr == '-';
+        if (negative) {
+            ++ptr;
+        }
+
+        uint64_t mantissa = 0;
+        bool overflow = false;
         int nr_digits = 0;
         int nr_digits_in_front_of_point = -1;
-        for (ttlet c : str) {
+        while (ptr != last) {
+            if (last - ptr >= 8 && is_eight_digits(ptr)) {
+                // Long runs of digits without separators are converted eight at a time.
+                overflow |= mul_overflow(mantissa, uint64_t{100'000'000}, &mantissa);
+                overflow |= add_overflow(mantissa, parse_eight_digits(ptr), &mantissa);
+                nr_digits += 8;
+                ptr += 8;
+                continue;
+            }
+
+            ttlet c = *ptr++;
             if (c >= '0' && c <= '9') {
-                mantissa_str += c;
+                overflow |= mul_overflow(mantissa, uint64_t{10}, &mantissa);
+                overflow |= add_overflow(mantissa, static_cast<uint64_t>(c - '0'), &mantissa);
                 nr_digits++;
             } else if (c == '.') {
                 nr_digits_in_front_of_point = nr_digits;
             } else if (c == '\'' || c == ',') {
                 // Ignore thousand separators.
-            } else if (c == '-') {
-                mantissa_str += c;
             } else {
                 throw parse_error("Unexpected character in decimal number '{}'", str);
             }
         }
 
-        int exponent = (nr_digits_in_front_of_point >= 0) ? (nr_digits_in_front_of_point - nr_digits) : 0;
+        if (nr_digits == 0) {
+            throw parse_error("Could not parse mantissa '{}'", str);
+        }
 
-        auto first = mantissa_str.data();
-        auto last = first + mantissa_str.size();
-        long long mantissa;
-        auto result = std::from_chars(first, last, mantissa, 10);
-        if (result.ptr == first) {
-            throw parse_error("Could not parse mantissa '{}'", mantissa_str);
-        } else if (result.ec == std::errc::result_out_of_range) {
-            throw parse_error("Mantissa '{}' out of range ", mantissa_str);
-        } else {
-            return {exponent, mantissa};
+        // The magnitude of the minimum long long is one larger than the maximum.
+        ttlet mantissa_max = static_cast<uint64_t>(std::numeric_limits<long long>::max()) + (negative ? 1 : 0);
+        if (overflow || mantissa > mantissa_max) {
+            throw parse_error("Mantissa '{}' out of range ", str);
         }
+
+        int exponent = (nr_digits_in_front_of_point >= 0) ? (nr_digits_in_front_of_point - nr_digits) : 0;
+        return {exponent, negative ? static_cast<long long>(0 - mantissa) : static_cast<long long>(mantissa)};
     }
 };
 
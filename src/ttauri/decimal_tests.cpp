@@ -174,3 +174,47 @@ TEST(Decimal, Div) {
     ASSERT_EQ(decimal(-2, 42) / decimal(0, 55), decimal(-17, 763636363636363));
     ASSERT_EQ(decimal(-2, 42) / decimal(2, 55), decimal(-19, 763636363636363));
 }
+
+TEST(Decimal, StringConstructionLong) {
+    decimal x;
+
+    // Long runs of digits are parsed eight at a time.
+    ASSERT_NO_THROW(x = decimal("1234567890123456"));
+    ASSERT_EQ(x.mantissa(), 1'234'567'890'123'456);
+    ASSERT_EQ(x.exponent(), 0);
+
+    ASSERT_NO_THROW(x = decimal("-12345678.12345678"));
+    ASSERT_EQ(x.mantissa(), -1'234'567'812'345'678);
+    ASSERT_EQ(x.exponent(), -8);
+
+    ASSERT_NO_THROW(x = decimal("0000000000000000000000000001"));
+    ASSERT_EQ(x.mantissa(), 1);
+    ASSERT_EQ(x.exponent(), 0);
+
+    // max int64_t             9'223'372'036'854'775'807
+    ASSERT_NO_THROW(x = decimal("9223372036854775807"));
+    ASSERT_EQ(x.mantissa(), 9'223'372'036'854'775);
+    ASSERT_EQ(x.exponent(), 3);
+
+    ASSERT_NO_THROW(x = decimal("-9223372036854775808"));
+    ASSERT_EQ(x.mantissa(), -9'223'372'036'854'775);
+    ASSERT_EQ(x.exponent(), 3);
+
+    ASSERT_THROW(x = decimal("9223372036854775808"), parse_error);
+    ASSERT_THROW(x = decimal("12345678901234567890123"), parse_error);
+    ASSERT_THROW(x = decimal(""), parse_error);
+    ASSERT_THROW(x = decimal("-"), parse_error);
+    ASSERT_THROW(x = decimal("12a45678"), parse_error);
+    ASSERT_THROW(x = decimal("1-2"), parse_error);
+}
+
+TEST(Decimal, DoubleConstruction) {
+    // A double is converted to the shortest decimal which rounds back to the same double.
+    ASSERT_EQ(decimal(0.0), decimal(0, 0));
+    ASSERT_EQ(decimal(1.0), decimal(0, 1));
+    ASSERT_EQ(decimal(-1.5), decimal(-1, -15));
+    ASSERT_EQ(decimal(0.1), decimal(-1, 1));
+    ASSERT_EQ(decimal(1234.5678), decimal(-4, 12345678));
+    ASSERT_EQ(decimal(1e20), decimal(20, 1));
+    ASSERT_EQ(decimal(0.30000000000000004), decimal(-17, 30000000000000004));
+}
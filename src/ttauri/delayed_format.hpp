@@ -61,6 +61,13 @@ public:
         tt_not_implemented();
     }
 
+    /** The captured arguments.
+     */
+    [[nodiscard]] std::tuple<Values...> const &values() const noexcept
+    {
+        return _values;
+    }
+
 private:
     std::tuple<Values...> _values;
 };
@@ -0,0 +1,98 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file float_conversion.hpp
+ *
+ * Fast conversion between decimal strings and floating point numbers, bypassing std::locale.
+ *
+ * Parsing uses the Eisel-Lemire algorithm which handles nearly all inputs with one or two
+ * 64x64-bit multiplications, falling back to `std::from_chars()` for the rare cases it can
+ * not decide. Printing uses the Schubfach algorithm to find the shortest decimal that
+ * round-trips. Both use the same table of 128-bit powers of five.
+ */
+
+#pragma once
+
+#include "required.hpp"
+#include "endian.hpp"
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <utility>
+
+namespace tt {
+
+/** Check if the next eight characters are decimal digits.
+ * All eight characters are checked at once inside a 64-bit register.
+ *
+ * @param ptr A pointer to at least eight characters.
+ */
+[[nodiscard]] inline bool is_eight_digits(char const *ptr) noexcept
+{
+    uint64_t v;
+    std::memcpy(&v, ptr, sizeof(v));
+    v = little_to_native(v);
+
+    // A byte underflows when it is below '0', and overflows into the top bit when it is above '9'.
+    return (((v + 0x4646'4646'4646'4646) | (v - 0x3030'3030'3030'3030)) & 0x8080'8080'8080'8080) == 0;
+}
+
+/** Convert eight decimal digits to an integer.
+ * The digits are combined in pairs, then quads, then the two halves, with three
+ * multiplications in a 64-bit register instead of eight sequential multiply-adds.
+ *
+ * @param ptr A pointer to eight decimal digits, see `is_eight_digits()`.
+ * @return The value of the digits, where the first character is the most significant digit.
+ */
+[[nodiscard]] inline uint64_t parse_eight_digits(char const *ptr) noexcept
+{
+    uint64_t v;
+    std::memcpy(&v, ptr, sizeof(v));
+    v = little_to_native(v) - 0x3030'3030'3030'3030;
+
+    v = (v * 10) + (v >> 8);
+    return (((v & 0x0000'00ff'0000'00ff) * (100 + (1'000'000ULL << 32))) +
+            (((v >> 16) & 0x0000'00ff'0000'00ff) * (1 + (10'000ULL << 32)))) >>
+        32;
+}
+
+/** The maximum number of characters written by `float_to_chars()`.
+ * For example "-2.2250738585072014e-308".
+ */
+constexpr ssize_t float_to_chars_max_size = 24;
+
+/** Find the shortest decimal number which rounds to the given floating point number.
+ *
+ * @param value A positive, finite and non-zero number.
+ * @return The decimal exponent and the mantissa without trailing zeros,
+ *         so that value == mantissa * 10^exponent after rounding.
+ */
+[[nodiscard]] std::pair<int, uint64_t> float_to_decimal(double value) noexcept;
+
+/** Convert a floating point number to the shortest string which round-trips.
+ * The format is the same as `std::to_chars(first, last, value, std::chars_format::general)`:
+ * fixed notation for decimal exponents in [-4, 6), scientific notation otherwise.
+ *
+ * @param first The start of the output buffer.
+ * @param last One beyond the end of the output buffer.
+ * @param value The number to convert.
+ * @return A pointer beyond the last character written, with `std::errc::value_too_large`
+ *         when the buffer is too small.
+ */
+std::to_chars_result float_to_chars(char *first, char *last, double value) noexcept;
+
+/** Convert a string to a correctly rounded floating point number.
+ * This is a replacement for `std::from_chars(first, last, value)` for the general format:
+ * an optional minus sign, digits with an optional decimal point, and an optional exponent.
+ *
+ * @param first The start of the string.
+ * @param last One beyond the end of the string.
+ * @param[out] value The converted number; unmodified on error.
+ * @return A pointer beyond the last character of the number, with `std::errc::invalid_argument` when
+ *         there is no number, or `std::errc::result_out_of_range` when the number overflows to
+ *         infinity or underflows to zero.
+ */
+std::from_chars_result float_from_chars(char const *first, char const *last, double &value) noexcept;
+
+} // namespace tt
@@ -0,0 +1,279 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/float_conversion.hpp"
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <bit>
+
+using namespace std;
+using namespace tt;
+
+static std::string float_to_string(double value)
+{
+    auto buffer = std::array<char, float_to_chars_max_size>{};
+    ttlet[last, ec] = float_to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    return std::string(buffer.data(), last);
+}
+
+static std::string std_to_string(double value)
+{
+    auto buffer = std::array<char, 64>{};
+    ttlet[last, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, std::chars_format::general);
+    return std::string(buffer.data(), last);
+}
+
+/** Check that float_from_chars() gives the same result as std::from_chars().
+ */
+static void check_from_chars(std::string_view str)
+{
+    auto value = -1.0;
+    ttlet[last, ec] = float_from_chars(str.data(), str.data() + str.size(), value);
+
+    auto expected = -1.0;
+    ttlet[expected_last, expected_ec] = std::from_chars(str.data(), str.data() + str.size(), expected);
+
+    ASSERT_EQ(ec, expected_ec) << str;
+    ASSERT_EQ(last, expected_last) << str;
+    ASSERT_EQ(std::bit_cast<uint64_t>(value), std::bit_cast<uint64_t>(expected)) << str;
+}
+
+TEST(float_conversion, eight_digits)
+{
+    ASSERT_TRUE(is_eight_digits("01234567"));
+    ASSERT_TRUE(is_eight_digits("99999999"));
+    ASSERT_FALSE(is_eight_digits("0123456."));
+    ASSERT_FALSE(is_eight_digits("/1234567"));
+    ASSERT_FALSE(is_eight_digits("0123:567"));
+    ASSERT_FALSE(is_eight_digits("1234567e"));
+
+    ASSERT_EQ(parse_eight_digits("00000000"), 0);
+    ASSERT_EQ(parse_eight_digits("01234567"), 1234567);
+    ASSERT_EQ(parse_eight_digits("87654321"), 87654321);
+    ASSERT_EQ(parse_eight_digits("99999999"), 99999999);
+}
+
+TEST(float_conversion, from_chars)
+{
+    for (ttlet str : {
+             "0",
+             "-0",
+             "0.0",
+             "1",
+             "-1",
+             "1.",
+             ".5",
+             "43.5",
+             "1e5",
+             "1E+5",
+             "1e-5",
+             "1e",
+             "1e+",
+             "1.5x",
+             "0.1",
+             "3.14159265358979323846264338327950288",
+             "123456789012345678901234567890",
+             "0.000000000000000000000000000001234567890123456789",
+             "9007199254740993",
+             "9007199254740993.0000000000000000001",
+             "2.2250738585072011e-308",
+             "2.2250738585072014e-308",
+             "4.9406564584124654e-324",
+             "2.4703282292062327e-324",
+             "2.4703282292062328e-324",
+             "1.7976931348623157e308",
+             "1.7976931348623158e308",
+             "1.7976931348623159e308",
+             "1e-400",
+             "1e400",
+             "0e999999999",
+             "1e99999999999999999999",
+             "7.2057594037927933e16",
+             "inf",
+             "-nan",
+             "",
+             "-",
+             ".",
+             "x"}) {
+        check_from_chars(str);
+    }
+}
+
+TEST(float_conversion, from_chars_random)
+{
+    auto random = std::mt19937_64{42};
+
+    for (int i = 0; i != 200'000; ++i) {
+        ttlet value = std::bit_cast<double>(random());
+        if (!std::isfinite(value)) {
+            continue;
+        }
+
+        // The shortest representation, and one with more digits than needed.
+        check_from_chars(std_to_string(value));
+        check_from_chars(fmt::format("{:.17e}", value));
+        check_from_chars(fmt::format("{:.25e}", value));
+    }
+
+    // Random digits with random exponents, including halfway cases and long mantissas.
+    for (int i = 0; i != 200'000; ++i) {
+        auto str = std::string{};
+        ttlet nr_digits = static_cast<int>(random() % 30) + 1;
+        for (int j = 0; j != nr_digits; ++j) {
+            str += static_cast<char>('0' + random() % 10);
+        }
+        if (random() % 2) {
+            str.insert(random() % str.size(), 1, '.');
+        }
+        str += fmt::format("e{}", static_cast<int>(random() % 700) - 350);
+        check_from_chars(str);
+    }
+}
+
+TEST(float_conversion, to_chars)
+{
+    for (ttlet value : {
+             0.0,
+             -0.0,
+             1.0,
+             -1.0,
+             0.1,
+             100.0,
+             1e6,
+             1234567.0,
+             123456.7,
+             0.0001,
+             0.00001,
+             1e21,
+             1e22,
+             1e23,
+             5e-324,
+             2.2250738585072014e-308,
+             1.7976931348623157e308,
+             9007199254740993.0,
+             std::numeric_limits<double>::infinity(),
+             -std::numeric_limits<double>::infinity(),
+             std::numeric_limits<double>::quiet_NaN()}) {
+        ASSERT_EQ(float_to_string(value), std_to_string(value));
+    }
+
+    // Buffer too small.
+    auto buffer = std::array<char, 3>{};
+    ttlet[last, ec] = float_to_chars(buffer.data(), buffer.data() + buffer.size(), 1.25);
+    ASSERT_EQ(ec, std::errc::value_too_large);
+}
+
+TEST(float_conversion, to_chars_random)
+{
+    auto random = std::mt19937_64{42};
+
+    for (int i = 0; i != 1'000'000; ++i) {
+        ttlet value = std::bit_cast<double>(random());
+        ASSERT_EQ(float_to_string(value), std_to_string(value));
+    }
+
+    // Powers of two have an asymmetric rounding interval.
+    for (int i = -1074; i != 1024; ++i) {
+        ttlet value = std::ldexp(1.0, i);
+        ASSERT_EQ(float_to_string(value), std_to_string(value));
+    }
+
+    // Integers and short decimals.
+    for (int i = 0; i != 100'000; ++i) {
+        ttlet value = static_cast<double>(i) / 100.0;
+        ASSERT_EQ(float_to_string(value), std_to_string(value));
+    }
+}
+
+TEST(float_conversion, benchmark)
+{
+    constexpr int nr_values = 100'000;
+    constexpr int nr_iterations = 10;
+
+    // Telemetry-like values with a few decimals, and full precision values.
+    auto random = std::mt19937_64{42};
+    auto values = std::vector<double>{};
+    for (int i = 0; i != nr_values; ++i) {
+        if (i % 2) {
+            values.push_back(static_cast<double>(random() % 10'000'000) / 1000.0);
+        } else {
+            values.push_back(std::bit_cast<double>((random() >> 2) | 0x3000'0000'0000'0000));
+        }
+    }
+
+    auto strings = std::vector<std::string>{};
+    for (ttlet value : values) {
+        strings.push_back(std_to_string(value));
+    }
+
+    auto measure = [&](auto f) {
+        ttlet t0 = std::chrono::steady_clock::now();
+        double sum = 0.0;
+        for (int i = 0; i != nr_iterations; ++i) {
+            for (ttlet &str : strings) {
+                sum += f(str);
+            }
+        }
+        ttlet t1 = std::chrono::steady_clock::now();
+        [[maybe_unused]] volatile double sink = sum;
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / (nr_iterations * nr_values);
+    };
+
+    ttlet float_from_chars_time = measure([](std::string const &str) {
+        double value;
+        float_from_chars(str.data(), str.data() + str.size(), value);
+        return value;
+    });
+    ttlet std_from_chars_time = measure([](std::string const &str) {
+        double value;
+        std::from_chars(str.data(), str.data() + str.size(), value);
+        return value;
+    });
+    ttlet strtod_time = measure([](std::string const &str) {
+        return std::strtod(str.c_str(), nullptr);
+    });
+
+    std::cout << fmt::format(
+        "parse: float_from_chars {:.1f} ns, std::from_chars {:.1f} ns, strtod {:.1f} ns\n",
+        float_from_chars_time,
+        std_from_chars_time,
+        strtod_time);
+
+    auto measure_print = [&](auto f) {
+        auto buffer = std::array<char, 64>{};
+        ttlet t0 = std::chrono::steady_clock::now();
+        ssize_t size = 0;
+        for (int i = 0; i != nr_iterations; ++i) {
+            for (ttlet value : values) {
+                size += f(buffer.data(), buffer.data() + buffer.size(), value) - buffer.data();
+            }
+        }
+        ttlet t1 = std::chrono::steady_clock::now();
+        [[maybe_unused]] volatile ssize_t sink = size;
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / (nr_iterations * nr_values);
+    };
+
+    ttlet float_to_chars_time = measure_print([](char *first, char *last, double value) {
+        return float_to_chars(first, last, value).ptr;
+    });
+    ttlet std_to_chars_time = measure_print([](char *first, char *last, double value) {
+        return std::to_chars(first, last, value, std::chars_format::general).ptr;
+    });
+    ttlet fmt_time = measure_print([](char *first, char *, double value) {
+        return fmt::format_to(first, "{}", value);
+    });
+
+    std::cout << fmt::format(
+        "print: float_to_chars {:.1f} ns, std::to_chars {:.1f} ns, fmt::format {:.1f} ns\n",
+        float_to_chars_time,
+        std_to_chars_time,
+        fmt_time);
+}
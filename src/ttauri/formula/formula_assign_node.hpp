@@ -5,6 +5,7 @@
 #pragma once
 
 #include "formula_binary_operator_node.hpp"
+#include "formula_name_node.hpp"
 
 namespace tt {
 
@@ -17,6 +18,16 @@ struct formula_assign_node final : formula_binary_operator_node {
         return lhs->assign(context, rhs_);
     }
 
+    void compile(formula_compiler& compiler, int dst) const override {
+        if (ttlet name = dynamic_cast<formula_name_node const *>(lhs.get())) {
+            compiler.compile(*rhs, dst);
+            compiler.emit_store(*this, name->name, dst);
+        } else {
+            // Unpacking and assignment to members are done by the tree.
+            compiler.emit_evaluate(*this, dst);
+        }
+    }
+
     std::string string() const noexcept override {
         return fmt::format("({} = {})", *lhs, *rhs);
     }
@@ -23,6 +23,14 @@ struct formula_bit_or_node final : formula_binary_operator_node {
         }
     }
 
+    bool is_constant() const noexcept override {
+        return lhs->is_constant() && rhs->is_constant();
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.emit_binary(formula_opcode::bit_or, *this, *lhs, *rhs, dst);
+    }
+
     std::string string() const noexcept override {
         return fmt::format("({} | {})", *lhs, *rhs);
     }
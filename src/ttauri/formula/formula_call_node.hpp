@@ -39,6 +39,11 @@ struct formula_call_node final : formula_node {
         return lhs->call(context, args_);
     }
 
+    void compile(formula_compiler& compiler, int dst) const override {
+        // The instruction refers to the callee, which may be a function or a method.
+        compiler.emit_list(formula_opcode::call, *lhs, args, dst);
+    }
+
     std::vector<std::string> get_name_and_argument_names() const override {
         std::vector<std::string> r;
 
@@ -10,6 +10,8 @@
 #include <unordered_map>
 #include <vector>
 #include <string_view>
+#include <functional>
+#include <algorithm>
 
 namespace tt {
 
@@ -17,9 +19,31 @@ struct formula_evaluation_context {
     using scope = std::unordered_map<std::string, datum>;
     using stack = std::vector<scope>;
 
+    using output_sink_type = std::function<void(std::string_view)>;
+
+    /** The output is flushed to the sink when the buffered output is larger than this.
+     */
+    constexpr static ssize_t output_flush_threshold = 65536;
+
     ssize_t output_disable_count = 0;
+
+    /** Output that has not yet been flushed to the sink.
+     */
     std::string output;
 
+    /** The sink to which output is flushed.
+     * When empty all output stays in `output`.
+     */
+    output_sink_type output_sink;
+
+    /** Number of characters already flushed to the sink.
+     */
+    ssize_t output_flushed_size = 0;
+
+    /** While the output is held it will not be flushed, so that it can be reset.
+     */
+    ssize_t output_hold_count = 0;
+
     stack local_stack;
 
     struct loop_info {
@@ -48,28 +72,83 @@ struct formula_evaluation_context {
 
     /** Write data to the output.
     */
-    void write(std::string_view text) noexcept {
+    void write(std::string_view text) {
         if (output_disable_count == 0) {
             output += text;
+
+            if (output_hold_count == 0 && std::ssize(output) >= output_flush_threshold) {
+                flush_output();
+            }
+        }
+    }
+
+    /** Write the buffered output to the sink.
+    */
+    void flush_output() {
+        if (output_sink && std::ssize(output) > 0) {
+            output_sink(output);
+            output_flushed_size += std::ssize(output);
+            output.clear();
         }
     }
 
-    /** Get the size of the output.
+    /** Get the size of the output, including the output flushed to the sink.
     * Used if you need to reset the output to a previous position.
     */
     ssize_t output_size() const noexcept {
-        return std::ssize(output);
+        return output_flushed_size + std::ssize(output);
     }
 
     /** Set the size of the output.
     * Used if you need to reset the output to a previous position.
+    *
+    * Output that was already flushed can not be reset, the output should be
+    * held with `hold_output()` to reset it reliably. Only a `#return` outside of
+    * a function resets unheld output, which results in an error anyway.
     */
     void set_output_size(ssize_t new_size) noexcept {
-        tt_assert(new_size > 0);
+        tt_assert(new_size >= 0);
         tt_assert(new_size <= output_size());
-        output.resize(new_size);
+        output.resize(std::max(new_size, output_flushed_size) - output_flushed_size);
     }
 
+    /** Hold the output, so that it can be reset to the current position.
+    * @return The current size of the output.
+    */
+    ssize_t hold_output() noexcept {
+        ++output_hold_count;
+        return output_size();
+    }
+
+    void release_output() noexcept {
+        tt_assert(output_hold_count > 0);
+        --output_hold_count;
+    }
+
+    /** Holds the output during the lifetime of this object.
+    * The output is released even when evaluation is interrupted by an exception.
+    */
+    class output_hold_guard {
+    public:
+        output_hold_guard(formula_evaluation_context &context) noexcept :
+            context(context), output_size(context.hold_output()) {}
+
+        ~output_hold_guard() {
+            context.release_output();
+        }
+
+        output_hold_guard(output_hold_guard const &) = delete;
+        output_hold_guard &operator=(output_hold_guard const &) = delete;
+
+    private:
+        formula_evaluation_context &context;
+
+    public:
+        /** The size of the output at the moment it was held.
+        */
+        ssize_t const output_size;
+    };
+
     void enable_output() noexcept {
         tt_assert(output_disable_count > 0);
         output_disable_count--;
@@ -44,6 +44,11 @@ struct formula_filter_node final : formula_binary_operator_node {
         }
     }
 
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.compile(*lhs, dst);
+        compiler.emit(formula_opcode::filter, *this, dst, dst);
+    }
+
     std::string string() const noexcept override {
         return fmt::format("({} ! {})", *lhs, *rhs);
     }
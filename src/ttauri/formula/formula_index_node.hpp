@@ -13,7 +13,7 @@ struct formula_index_node final : formula_binary_operator_node {
         formula_binary_operator_node(std::move(location), std::move(lhs), std::move(rhs)) {}
 
     datum evaluate(formula_evaluation_context& context) const override {
-        auto lhs_ = lhs->evaluate(context);
+        ttlet lhs_ = lhs->evaluate(context);
         auto rhs_ = rhs->evaluate(context);
 
         if (!lhs_.contains(rhs_)) {
@@ -40,6 +40,14 @@ struct formula_index_node final : formula_binary_operator_node {
         }
     }
 
+    bool is_constant() const noexcept override {
+        return lhs->is_constant() && rhs->is_constant();
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.emit_binary(formula_opcode::index, *this, *lhs, *rhs, dst);
+    }
+
     std::string string() const noexcept override {
         return fmt::format("({}[{}])", *lhs, *rhs);
     }
@@ -16,6 +16,14 @@ struct formula_le_node final : formula_binary_operator_node {
         return lhs->evaluate(context) <= rhs->evaluate(context);
     }
 
+    bool is_constant() const noexcept override {
+        return lhs->is_constant() && rhs->is_constant();
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.emit_binary(formula_opcode::le, *this, *lhs, *rhs, dst);
+    }
+
     std::string string() const noexcept override {
         return fmt::format("({} <= {})", *lhs, *rhs);
     }
@@ -18,6 +18,14 @@ struct formula_literal_node final : formula_node {
         return value;
     }
 
+    bool is_constant() const noexcept override {
+        return true;
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.emit_constant(*this, value, dst);
+    }
+
     std::string string() const noexcept override {
         return value.repr();
     }
@@ -22,6 +22,14 @@ struct formula_logical_not_node final : formula_unary_operator_node {
         }
     }
 
+    bool is_constant() const noexcept override {
+        return rhs->is_constant();
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.emit_unary(formula_opcode::logical_not, *this, *rhs, dst);
+    }
+
     std::string string() const noexcept override {
         return fmt::format("(! {})", *rhs);
     }
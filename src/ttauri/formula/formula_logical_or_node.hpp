@@ -21,6 +21,18 @@ struct formula_logical_or_node final : formula_binary_operator_node {
         }
     }
 
+    bool is_constant() const noexcept override {
+        return lhs->is_constant() && rhs->is_constant();
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        // The result is lhs when it is true.
+        compiler.compile(*lhs, dst);
+        ttlet jump = compiler.emit_jump(formula_opcode::jump_if_true, *this, dst);
+        compiler.compile(*rhs, dst);
+        compiler.patch_jump(jump);
+    }
+
     std::string string() const noexcept override {
         return fmt::format("({} || {})", *lhs, *rhs);
     }
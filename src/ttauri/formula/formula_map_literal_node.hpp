@@ -5,6 +5,7 @@
 #pragma once
 
 #include "formula_node.hpp"
+#include <algorithm>
 
 namespace tt {
 
@@ -38,6 +39,11 @@ struct formula_map_literal_node final : formula_node {
         return datum{std::move(r)};
     }
 
+    bool is_constant() const noexcept override {
+        return std::all_of(keys.cbegin(), keys.cend(), [](ttlet &key) { return key->is_constant(); }) &&
+            std::all_of(values.cbegin(), values.cend(), [](ttlet &value) { return value->is_constant(); });
+    }
+
     std::string string() const noexcept override {
         tt_assert(keys.size() == values.size());
 
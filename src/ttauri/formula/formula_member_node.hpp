@@ -61,6 +61,11 @@ struct formula_member_node final : formula_binary_operator_node {
         }
     }
 
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.compile(*lhs, dst);
+        compiler.emit(formula_opcode::member, *this, dst, dst, compiler.add_constant(rhs_name->name));
+    }
+
     datum &evaluate_lvalue(formula_evaluation_context& context) const override {
         auto &lhs_ = lhs->evaluate_lvalue(context);
         try {
@@ -67,6 +67,10 @@ struct formula_name_node final : formula_node {
         }
     }
 
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.emit_load(*this, name, dst);
+    }
+
     datum call(formula_evaluation_context& context, datum::vector const &arguments) const override {
         return function(context, arguments);
     }
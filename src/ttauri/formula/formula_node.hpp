@@ -6,6 +6,7 @@
 
 #include "formula_post_process_context.hpp"
 #include "formula_evaluation_context.hpp"
+#include "formula_program.hpp"
 #include "../required.hpp"
 #include "../parse_location.hpp"
 #include "../datum.hpp"
@@ -40,6 +41,20 @@ struct formula_node {
     */
     virtual datum evaluate(formula_evaluation_context& context) const = 0;
 
+    /** Check if the formula only consists of literals and operators without side effects.
+    * Such a formula is evaluated once when it is compiled.
+    */
+    virtual bool is_constant() const noexcept {
+        return false;
+    }
+
+    /** Compile into bytecode, leaving the result in register `dst`.
+    * By default the bytecode calls back into evaluate().
+    */
+    virtual void compile(formula_compiler& compiler, int dst) const {
+        compiler.emit_evaluate(*this, dst);
+    }
+
     datum evaluate_without_output(formula_evaluation_context& context) const {
         context.disable_output();
         auto r = evaluate(context);
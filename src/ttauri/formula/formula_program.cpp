@@ -0,0 +1,347 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "formula_program.hpp"
+#include "formula_node.hpp"
+#include "formula_filter_node.hpp"
+#include "../error_info.hpp"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <array>
+#include <limits>
+
+namespace tt {
+
+void formula_compiler::compile(formula_node const &node, int dst)
+{
+    if (node.is_constant()) {
+        auto scratch_context = formula_evaluation_context{};
+        try {
+            return emit_constant(node, node.evaluate(scratch_context), dst);
+        } catch (...) {
+            // Leave the error to be thrown with its location when the program is evaluated.
+            error_info::close();
+        }
+    }
+    node.compile(*this, dst);
+}
+
+int formula_compiler::allocate_registers(int count)
+{
+    ttlet first = _nr_allocated_registers;
+    _nr_allocated_registers += count;
+    tt_parse_check(_nr_allocated_registers <= std::numeric_limits<uint16_t>::max(), "Formula is too large to compile");
+
+    _program._nr_registers = std::max(_program._nr_registers, _nr_allocated_registers);
+    return first;
+}
+
+void formula_compiler::free_registers(int count) noexcept
+{
+    tt_axiom(_nr_allocated_registers >= count);
+    _nr_allocated_registers -= count;
+}
+
+void formula_compiler::emit(formula_opcode opcode, formula_node const &node, int dst, int lhs, int rhs)
+{
+    tt_parse_check(std::ssize(_program._code) < std::numeric_limits<uint16_t>::max(), "Formula is too large to compile");
+
+    _program._code.push_back(formula_instruction{
+        opcode, narrow_cast<uint16_t>(dst), narrow_cast<uint16_t>(lhs), narrow_cast<uint16_t>(rhs), &node});
+}
+
+void formula_compiler::emit_constant(formula_node const &node, datum const &value, int dst)
+{
+    emit(formula_opcode::load_constant, node, dst, add_constant(value));
+}
+
+void formula_compiler::emit_load(formula_node const &node, std::string const &name, int dst)
+{
+    emit(formula_opcode::load_name, node, dst, add_name(name));
+}
+
+void formula_compiler::emit_store(formula_node const &node, std::string const &name, int dst)
+{
+    emit(formula_opcode::store_name, node, dst, add_name(name), dst);
+}
+
+void formula_compiler::emit_evaluate(formula_node const &node, int dst)
+{
+    emit(formula_opcode::evaluate, node, dst);
+}
+
+void formula_compiler::emit_binary(
+    formula_opcode opcode,
+    formula_node const &node,
+    formula_node const &lhs,
+    formula_node const &rhs,
+    int dst)
+{
+    compile(lhs, dst);
+    ttlet tmp = allocate_registers();
+    compile(rhs, tmp);
+    emit(opcode, node, dst, dst, tmp);
+    free_registers();
+}
+
+void formula_compiler::emit_unary(formula_opcode opcode, formula_node const &node, formula_node const &rhs, int dst)
+{
+    compile(rhs, dst);
+    emit(opcode, node, dst, dst);
+}
+
+void formula_compiler::emit_list(
+    formula_opcode opcode,
+    formula_node const &node,
+    std::vector<std::unique_ptr<formula_node>> const &args,
+    int dst)
+{
+    ttlet nr_args = narrow_cast<int>(std::ssize(args));
+    ttlet first = allocate_registers(nr_args);
+    for (int i = 0; i != nr_args; ++i) {
+        compile(*args[i], first + i);
+    }
+    emit(opcode, node, dst, first, nr_args);
+    free_registers(nr_args);
+}
+
+ssize_t formula_compiler::emit_jump(formula_opcode opcode, formula_node const &node, int condition)
+{
+    ttlet address = std::ssize(_program._code);
+    emit(opcode, node, 0, condition);
+    return address;
+}
+
+void formula_compiler::patch_jump(ssize_t address) noexcept
+{
+    tt_axiom(address < std::ssize(_program._code));
+    _program._code[address].rhs = narrow_cast<uint16_t>(std::ssize(_program._code));
+}
+
+int formula_compiler::add_constant(datum const &value)
+{
+    _program._constants.push_back(value);
+    return narrow_cast<int>(std::ssize(_program._constants) - 1);
+}
+
+int formula_compiler::add_name(std::string const &name)
+{
+    ttlet it = std::find(_program._names.cbegin(), _program._names.cend(), name);
+    if (it != _program._names.cend()) {
+        return narrow_cast<int>(std::distance(_program._names.cbegin(), it));
+    }
+
+    _program._names.push_back(name);
+    return narrow_cast<int>(std::ssize(_program._names) - 1);
+}
+
+formula_program::formula_program(formula_node const &formula)
+{
+    auto compiler = formula_compiler{*this};
+    ttlet result = compiler.allocate_registers();
+    compiler.compile(formula, result);
+    compiler.free_registers();
+}
+
+namespace {
+
+/** A register of the virtual machine.
+ * Variables and constants are not copied into a register; the register
+ * refers to them until the value is needed, or the variable may be modified.
+ */
+struct formula_register {
+    datum value;
+    datum const *reference = nullptr;
+
+    [[nodiscard]] datum const &get() const noexcept
+    {
+        return reference != nullptr ? *reference : value;
+    }
+
+    [[nodiscard]] datum take() noexcept
+    {
+        return reference != nullptr ? *reference : std::move(value);
+    }
+
+    void set(datum &&new_value) noexcept
+    {
+        value = std::move(new_value);
+        reference = nullptr;
+    }
+
+    void refer(datum const &other) noexcept
+    {
+        reference = &other;
+    }
+
+    /** Copy the value that is referred to, before the variable is modified.
+     */
+    void materialize()
+    {
+        if (reference != nullptr) {
+            value = *reference;
+            reference = nullptr;
+        }
+    }
+};
+
+} // namespace
+
+datum formula_program::evaluate(formula_evaluation_context &context) const
+{
+    // Most formulas only need a few registers and slots, keep those on the stack.
+    constexpr ssize_t nr_stack_items = 16;
+
+    auto stack_registers = std::array<formula_register, nr_stack_items>{};
+    auto stack_slots = std::array<datum const *, nr_stack_items>{};
+    auto heap_registers = std::vector<formula_register>{};
+    auto heap_slots = std::vector<datum const *>{};
+
+    auto *r = stack_registers.data();
+    if (_nr_registers > nr_stack_items) {
+        heap_registers.resize(_nr_registers);
+        r = heap_registers.data();
+    }
+
+    // A slot points to the variable in the context that a name was resolved to.
+    auto **slots = stack_slots.data();
+    if (std::ssize(_names) > nr_stack_items) {
+        heap_slots.resize(_names.size());
+        slots = heap_slots.data();
+    }
+    std::fill_n(slots, _names.size(), nullptr);
+
+    // Before an instruction that may modify, create or destroy variables, copy the
+    // variables referred to by registers and forget what the names were resolved to.
+    ttlet prepare_for_modification = [&]() {
+        std::for_each(r, r + _nr_registers, [](auto &x) {
+            x.materialize();
+        });
+        std::fill_n(slots, _names.size(), nullptr);
+    };
+
+    ttlet take_list = [&](int first, int count) {
+        auto list = datum::vector{};
+        list.reserve(count);
+        for (int i = first; i != first + count; ++i) {
+            list.push_back(r[i].take());
+        }
+        return list;
+    };
+
+    ttlet code = _code.data();
+    ttlet code_end = code + _code.size();
+    auto pc = code;
+
+    try {
+        while (pc != code_end) {
+            auto &dst = r[pc->dst];
+            ttlet &lhs = r[pc->lhs];
+            ttlet &rhs = r[pc->rhs];
+
+            switch (pc->opcode) {
+            case formula_opcode::load_constant: dst.refer(_constants[pc->lhs]); break;
+
+            case formula_opcode::load_name: {
+                auto &slot = slots[pc->lhs];
+                if (slot == nullptr) {
+                    slot = &std::as_const(context).get(_names[pc->lhs]);
+                }
+                dst.refer(*slot);
+            } break;
+
+            case formula_opcode::store_name: {
+                prepare_for_modification();
+                auto value = rhs.get();
+                dst.set(datum{context.set(_names[pc->lhs], std::move(value))});
+            } break;
+
+            case formula_opcode::evaluate:
+                prepare_for_modification();
+                dst.set(pc->node->evaluate(context));
+                break;
+
+            case formula_opcode::call: {
+                prepare_for_modification();
+                ttlet arguments = take_list(pc->lhs, pc->rhs);
+                dst.set(pc->node->call(context, arguments));
+            } break;
+
+            case formula_opcode::make_vector: dst.set(datum{take_list(pc->lhs, pc->rhs)}); break;
+
+            case formula_opcode::member: {
+                ttlet &key = _constants[pc->rhs];
+                if (!lhs.get().contains(key)) {
+                    throw operation_error("Unknown attribute .{}", key);
+                }
+                dst.set(lhs.get()[key]);
+            } break;
+
+            case formula_opcode::index:
+                if (!lhs.get().contains(rhs.get())) {
+                    throw operation_error("Unknown key '{}'", rhs.get());
+                }
+                dst.set(lhs.get()[rhs.get()]);
+                break;
+
+            case formula_opcode::filter: {
+                ttlet &filter = static_cast<formula_filter_node const *>(pc->node)->filter;
+                dst.set(datum{filter(static_cast<std::string>(lhs.get()))});
+            } break;
+
+            case formula_opcode::jump: pc = code + pc->rhs; continue;
+
+            case formula_opcode::jump_if_false:
+                if (!static_cast<bool>(lhs.get())) {
+                    pc = code + pc->rhs;
+                    continue;
+                }
+                break;
+
+            case formula_opcode::jump_if_true:
+                if (static_cast<bool>(lhs.get())) {
+                    pc = code + pc->rhs;
+                    continue;
+                }
+                break;
+
+            case formula_opcode::add: dst.set(lhs.get() + rhs.get()); break;
+            case formula_opcode::sub: dst.set(lhs.get() - rhs.get()); break;
+            case formula_opcode::mul: dst.set(lhs.get() * rhs.get()); break;
+            case formula_opcode::div: dst.set(lhs.get() / rhs.get()); break;
+            case formula_opcode::mod: dst.set(lhs.get() % rhs.get()); break;
+            case formula_opcode::pow: dst.set(pow(lhs.get(), rhs.get())); break;
+            case formula_opcode::shl: dst.set(lhs.get() << rhs.get()); break;
+            case formula_opcode::shr: dst.set(lhs.get() >> rhs.get()); break;
+            case formula_opcode::bit_and: dst.set(lhs.get() & rhs.get()); break;
+            case formula_opcode::bit_or: dst.set(lhs.get() | rhs.get()); break;
+            case formula_opcode::bit_xor: dst.set(lhs.get() ^ rhs.get()); break;
+            case formula_opcode::eq: dst.set(datum{lhs.get() == rhs.get()}); break;
+            case formula_opcode::ne: dst.set(datum{lhs.get() != rhs.get()}); break;
+            case formula_opcode::lt: dst.set(datum{lhs.get() < rhs.get()}); break;
+            case formula_opcode::le: dst.set(datum{lhs.get() <= rhs.get()}); break;
+            case formula_opcode::gt: dst.set(datum{lhs.get() > rhs.get()}); break;
+            case formula_opcode::ge: dst.set(datum{lhs.get() >= rhs.get()}); break;
+            case formula_opcode::minus: dst.set(-lhs.get()); break;
+            case formula_opcode::plus: dst.set(+lhs.get()); break;
+            case formula_opcode::invert: dst.set(~lhs.get()); break;
+            case formula_opcode::logical_not: dst.set(datum{!lhs.get()}); break;
+            default: tt_no_default();
+            }
+            ++pc;
+        }
+
+    } catch (...) {
+        if (pc->opcode != formula_opcode::evaluate && pc->opcode != formula_opcode::call) {
+            // The tree and called functions add their own locations.
+            error_info(true).set<"parse_location">(pc->node->location);
+        }
+        throw;
+    }
+
+    return r[0].take();
+}
+
+} // namespace tt
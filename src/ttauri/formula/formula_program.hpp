@@ -0,0 +1,182 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "formula_evaluation_context.hpp"
+#include "../required.hpp"
+#include "../datum.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <memory>
+
+namespace tt {
+
+struct formula_node;
+
+enum class formula_opcode : uint8_t {
+    load_constant, ///< r[dst] = constants[lhs]
+    load_name, ///< r[dst] = value of names[lhs]
+    store_name, ///< r[dst] = names[lhs] = r[rhs]
+    evaluate, ///< r[dst] = node->evaluate(context), for formulas without a bytecode implementation.
+    call, ///< r[dst] = node->call(context, r[lhs] ... r[lhs + rhs - 1])
+    make_vector, ///< r[dst] = datum::vector{r[lhs] ... r[lhs + rhs - 1]}
+    member, ///< r[dst] = r[lhs][constants[rhs]]
+    index, ///< r[dst] = r[lhs][r[rhs]]
+    filter, ///< r[dst] = node->filter(r[lhs])
+    jump, ///< pc = rhs
+    jump_if_false, ///< if (!r[lhs]) pc = rhs
+    jump_if_true, ///< if (r[lhs]) pc = rhs
+    add,
+    sub,
+    mul,
+    div,
+    mod,
+    pow,
+    shl,
+    shr,
+    bit_and,
+    bit_or,
+    bit_xor,
+    eq,
+    ne,
+    lt,
+    le,
+    gt,
+    ge,
+    minus, ///< r[dst] = -r[lhs]
+    plus, ///< r[dst] = +r[lhs]
+    invert, ///< r[dst] = ~r[lhs]
+    logical_not ///< r[dst] = !r[lhs]
+};
+
+/** A single bytecode instruction.
+ * The operands are register indices, or indices into the constant, name or
+ * instruction tables depending on the opcode. The node is used for error
+ * locations and for opcodes that call back into the formula tree.
+ */
+struct formula_instruction {
+    formula_opcode opcode;
+    uint16_t dst;
+    uint16_t lhs;
+    uint16_t rhs;
+    formula_node const *node;
+};
+
+class formula_program;
+
+/** Compiles a formula tree into a `formula_program`.
+ * Nodes emit their instructions through `formula_node::compile()`.
+ */
+class formula_compiler {
+public:
+    formula_compiler(formula_program &program) noexcept : _program(program) {}
+
+    /** Compile a formula, leaving its result in register `dst`.
+     * A formula consisting only of constants is evaluated once and emitted as a constant.
+     */
+    void compile(formula_node const &node, int dst);
+
+    /** Allocate a consecutive range of temporary registers.
+     * Registers are allocated in stack order and must be freed in reverse order.
+     * @return The index of the first register.
+     */
+    [[nodiscard]] int allocate_registers(int count = 1);
+    void free_registers(int count = 1) noexcept;
+
+    void emit(formula_opcode opcode, formula_node const &node, int dst, int lhs = 0, int rhs = 0);
+    void emit_constant(formula_node const &node, datum const &value, int dst);
+    void emit_load(formula_node const &node, std::string const &name, int dst);
+    void emit_store(formula_node const &node, std::string const &name, int dst);
+    void emit_evaluate(formula_node const &node, int dst);
+
+    /** Compile `lhs` and `rhs`, then emit an instruction that combines them.
+     */
+    void emit_binary(formula_opcode opcode, formula_node const &node, formula_node const &lhs, formula_node const &rhs, int dst);
+
+    /** Compile `rhs`, then emit an instruction that operates on it.
+     */
+    void emit_unary(formula_opcode opcode, formula_node const &node, formula_node const &rhs, int dst);
+
+    /** Compile each argument in consecutive registers, then emit an instruction that uses them.
+     */
+    void emit_list(formula_opcode opcode, formula_node const &node, std::vector<std::unique_ptr<formula_node>> const &args, int dst);
+
+    /** Emit a jump with an unknown destination.
+     * @return The address of the jump, to be passed to `patch_jump()`.
+     */
+    [[nodiscard]] ssize_t emit_jump(formula_opcode opcode, formula_node const &node, int condition = 0);
+
+    /** Set the destination of a jump to the next instruction to be emitted.
+     */
+    void patch_jump(ssize_t address) noexcept;
+
+    /** Add a constant to the program.
+     * @return The index of the constant.
+     */
+    [[nodiscard]] int add_constant(datum const &value);
+
+    /** Add a name to the program, giving it a slot.
+     * @return The index of the slot.
+     */
+    [[nodiscard]] int add_name(std::string const &name);
+
+private:
+    formula_program &_program;
+    int _nr_allocated_registers = 0;
+};
+
+/** A formula compiled to bytecode.
+ *
+ * Names are resolved to slots when the formula is compiled. During evaluation
+ * each slot is bound to a variable in the evaluation context on first use,
+ * so that repeated accesses to a name do not search the scopes again.
+ * Sub-formulas of only literals are folded into constants.
+ *
+ * The program refers to the nodes of the formula for error locations and for
+ * function calls, so the formula must outlive the program.
+ */
+class formula_program {
+public:
+    /** Compile a formula.
+     * @param formula A post-processed formula.
+     */
+    explicit formula_program(formula_node const &formula);
+
+    formula_program(formula_program const &) = delete;
+    formula_program(formula_program &&) noexcept = default;
+    formula_program &operator=(formula_program const &) = delete;
+    formula_program &operator=(formula_program &&) noexcept = default;
+
+    /** Evaluate the formula.
+     * Produces the same result as `formula_node::evaluate()` on the formula it was compiled from.
+     */
+    [[nodiscard]] datum evaluate(formula_evaluation_context &context) const;
+
+    [[nodiscard]] datum evaluate_without_output(formula_evaluation_context &context) const
+    {
+        context.disable_output();
+        auto r = evaluate(context);
+        context.enable_output();
+        return r;
+    }
+
+    /** The number of instructions.
+     */
+    [[nodiscard]] ssize_t size() const noexcept
+    {
+        return std::ssize(_code);
+    }
+
+private:
+    std::vector<formula_instruction> _code;
+    std::vector<datum> _constants;
+    std::vector<std::string> _names;
+    int _nr_registers = 0;
+
+    friend class formula_compiler;
+};
+
+} // namespace tt
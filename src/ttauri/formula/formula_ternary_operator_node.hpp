@@ -40,6 +40,20 @@ struct formula_ternary_operator_node final : formula_node {
         }
     }
 
+    bool is_constant() const noexcept override {
+        return lhs->is_constant() && rhs_true->is_constant() && rhs_false->is_constant();
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.compile(*lhs, dst);
+        ttlet jump_to_false = compiler.emit_jump(formula_opcode::jump_if_false, *this, dst);
+        compiler.compile(*rhs_true, dst);
+        ttlet jump_to_end = compiler.emit_jump(formula_opcode::jump, *this);
+        compiler.patch_jump(jump_to_false);
+        compiler.compile(*rhs_false, dst);
+        compiler.patch_jump(jump_to_end);
+    }
+
     std::string string() const noexcept override {
         return fmt::format("({} ? {} : {})", *lhs, *rhs_true, *rhs_false);
     }
@@ -3,9 +3,13 @@
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "formula.hpp"
+#include "formula_program.hpp"
 #include <gtest/gtest.h>
+#include <fmt/format.h>
 #include <iostream>
 #include <string>
+#include <chrono>
+#include <array>
 
 using namespace std;
 using namespace std::literals;
@@ -462,3 +466,136 @@ TEST(Formula, Map) {
     ASSERT_NO_THROW(e = parse_formula("{1: 1.1, 2: 2.2, }"));
     ASSERT_EQ(e->string(), "{1: 1.1, 2: 2.2}");
 }
+
+[[nodiscard]] static formula_evaluation_context make_bytecode_test_context()
+{
+    auto context = formula_evaluation_context{};
+    context.set_global("a", 2);
+    context.set_global("b", 3.5);
+    context.set_global("s", "hello");
+    context.set_global("flag", true);
+    context.set_global("v", parse_formula("[1, 2, 3]")->evaluate(context));
+    context.set_global("m", parse_formula("{\"x\": 1, \"y\": [4, 5]}")->evaluate(context));
+    return context;
+}
+
+TEST(Formula, BytecodeMatchesTree) {
+    constexpr auto texts = std::array{
+        "1 + 2 * 3",
+        "a + b",
+        "a * a - a / 2 % 3",
+        "a ** 3",
+        "a << 3 | 1",
+        "a ^ 5 & 7",
+        "~a",
+        "-b",
+        "+a",
+        "!flag",
+        "a < b && b < 10",
+        "a > b || s",
+        "a == 2 && a != b && a <= 2 && b >= 3",
+        "flag ? a : b",
+        "!flag ? a : b",
+        "v[1]",
+        "m.x",
+        "m.y[0] + m.x",
+        "[a, b, 1 + 2]",
+        "{\"k\": a}",
+        "size(v) + size(s)",
+        "s + \" world\"",
+        "s ! id",
+        "c = a + 1",
+        "a = a * 2",
+        "a + (a = 5) + a",
+        "a += 1",
+        "v.append(a)",
+        "[x, y] = [a, b]"};
+
+    for (ttlet text : texts) {
+        ttlet e = parse_formula(text);
+        ttlet program = formula_program(*e);
+
+        auto tree_context = make_bytecode_test_context();
+        auto bytecode_context = make_bytecode_test_context();
+        ttlet tree_result = e->evaluate(tree_context);
+        ttlet bytecode_result = program.evaluate(bytecode_context);
+
+        ASSERT_EQ(tree_result, bytecode_result) << text;
+        ASSERT_EQ(tree_context.globals, bytecode_context.globals) << text;
+    }
+}
+
+TEST(Formula, BytecodeScopes) {
+    // An assignment inside a local scope creates a local variable which shadows the global.
+    ttlet e = parse_formula("a + (a = 5) + a");
+    ttlet program = formula_program(*e);
+
+    auto tree_context = make_bytecode_test_context();
+    auto bytecode_context = make_bytecode_test_context();
+    tree_context.push();
+    bytecode_context.push();
+    ASSERT_EQ(e->evaluate(tree_context), 12);
+    ASSERT_EQ(program.evaluate(bytecode_context), 12);
+    ASSERT_EQ(bytecode_context.locals(), tree_context.locals());
+    ASSERT_EQ(bytecode_context.get("a"), 5);
+    bytecode_context.pop();
+    ASSERT_EQ(bytecode_context.get("a"), 2);
+}
+
+[[nodiscard]] static std::string bytecode_error(std::string_view text)
+{
+    auto context = make_bytecode_test_context();
+    try {
+        [[maybe_unused]] ttlet r = formula_program(*parse_formula(text)).evaluate(context);
+    } catch (operation_error const &e) {
+        error_info::close();
+        return e.what();
+    }
+    return {};
+}
+
+TEST(Formula, BytecodeErrors) {
+    ASSERT_NE(bytecode_error("foo + 1").find("Could not find foo"), std::string::npos);
+    ASSERT_NE(bytecode_error("m.z").find("Unknown attribute .z"), std::string::npos);
+    ASSERT_NE(bytecode_error("v[10]").find("Unknown key '10'"), std::string::npos);
+}
+
+TEST(Formula, BytecodeConstantFolding) {
+    ASSERT_EQ(formula_program(*parse_formula("(1 + 2) * 3")).size(), 1);
+    ASSERT_EQ(formula_program(*parse_formula("[1, 2 * 3, -4]")).size(), 1);
+    // Load a, load the folded constant, add.
+    ASSERT_EQ(formula_program(*parse_formula("a + 2 * 3")).size(), 3);
+
+    auto context = make_bytecode_test_context();
+    ASSERT_EQ(formula_program(*parse_formula("(1 + 2) * 3")).evaluate(context), 9);
+}
+
+TEST(Formula, BytecodeBenchmark) {
+    ttlet e = parse_formula("(a + b * 2 - m.x) * 3 > 10 && flag ? v[1] : m.y[0]");
+    ttlet program = formula_program(*e);
+    auto context = make_bytecode_test_context();
+
+    constexpr int nr_iterations = 100'000;
+
+    auto tree_sum = datum{0};
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i != nr_iterations; ++i) {
+        tree_sum += e->evaluate(context);
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    auto bytecode_sum = datum{0};
+    for (int i = 0; i != nr_iterations; ++i) {
+        bytecode_sum += program.evaluate(context);
+    }
+    ttlet t2 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(tree_sum, bytecode_sum);
+
+    ttlet tree_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet bytecode_duration = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << fmt::format(
+        "tree: {:.1f} Mevaluations/s, bytecode: {:.1f} Mevaluations/s\n",
+        nr_iterations / tree_duration / 1e6,
+        nr_iterations / bytecode_duration / 1e6);
+}
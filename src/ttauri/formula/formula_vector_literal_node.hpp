@@ -5,6 +5,7 @@
 #pragma once
 
 #include "formula_node.hpp"
+#include <algorithm>
 
 namespace tt {
 
@@ -28,6 +29,16 @@ struct formula_vector_literal_node final : formula_node {
         return datum{std::move(r)};
     }
 
+    bool is_constant() const noexcept override {
+        return std::all_of(values.cbegin(), values.cend(), [](ttlet &value) {
+            return value->is_constant();
+        });
+    }
+
+    void compile(formula_compiler& compiler, int dst) const override {
+        compiler.emit_list(formula_opcode::make_vector, *this, values, dst);
+    }
+
     datum &assign(formula_evaluation_context& context, datum const &rhs) const override {
         if (!rhs.is_vector()) {
             tt_error_info().set<"parse_location">(location);
@@ -1,12 +1,17 @@
-// Copyright Take Vos 2020.
+// Copyright Take Vos 2020-2021.
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
+#pragma once
+
 #include "required.hpp"
 #include "bits.hpp"
 #include "cast.hpp"
 #include <span>
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <numeric>
 
 namespace tt {
 
@@ -157,6 +162,133 @@ public:
     }
 };
 
+/** Calculate the code lengths of a length-limited huffman code.
+ *
+ * A huffman tree is build from the frequencies, when the tree is deeper than
+ * `max_length` the lengths are redistributed so that the code remains complete.
+ *
+ * @param frequencies The number of occurrences of each symbol.
+ * @param max_length The maximum length of a code.
+ * @return The code length of each symbol, zero for symbols that do not occur.
+ */
+[[nodiscard]] inline std::vector<int> huffman_lengths_from_frequencies(std::span<int const> frequencies, int max_length) noexcept
+{
+    tt_axiom(max_length >= 1 && max_length <= 15);
+
+    auto r = std::vector<int>(std::size(frequencies), 0);
+
+    auto symbols = std::vector<int>{};
+    for (int symbol = 0; symbol != std::ssize(frequencies); ++symbol) {
+        if (frequencies[symbol] != 0) {
+            symbols.push_back(symbol);
+        }
+    }
+
+    if (symbols.size() <= 1) {
+        for (ttlet symbol : symbols) {
+            r[symbol] = 1;
+        }
+        return r;
+    }
+
+    // Leaves are sorted by frequency, so that nodes can be merged using two queues.
+    std::stable_sort(symbols.begin(), symbols.end(), [&frequencies](ttlet a, ttlet b) {
+        return frequencies[a] < frequencies[b];
+    });
+
+    ttlet nr_leaves = std::ssize(symbols);
+
+    // Node i < nr_leaves is a leaf, other nodes are internal nodes in order of creation.
+    auto node_frequencies = std::vector<int64_t>(nr_leaves * 2 - 1);
+    auto parents = std::vector<ssize_t>(nr_leaves * 2 - 1, 0);
+    for (ssize_t i = 0; i != nr_leaves; ++i) {
+        node_frequencies[i] = frequencies[symbols[i]];
+    }
+
+    ssize_t leaf_i = 0;
+    ssize_t node_i = nr_leaves;
+    for (ssize_t new_node = nr_leaves; new_node != std::ssize(node_frequencies); ++new_node) {
+        auto pop_smallest = [&]() {
+            if (leaf_i < nr_leaves && (node_i == new_node || node_frequencies[leaf_i] <= node_frequencies[node_i])) {
+                return leaf_i++;
+            } else {
+                return node_i++;
+            }
+        };
+
+        ttlet a = pop_smallest();
+        ttlet b = pop_smallest();
+        node_frequencies[new_node] = node_frequencies[a] + node_frequencies[b];
+        parents[a] = new_node;
+        parents[b] = new_node;
+    }
+
+    // Parents are always created after their children, so depths can be calculated from the root down.
+    auto depths = std::vector<int>(std::ssize(node_frequencies), 0);
+    for (auto i = std::ssize(node_frequencies) - 2; i >= 0; --i) {
+        depths[i] = depths[parents[i]] + 1;
+    }
+
+    auto count = std::array<int, 64>{};
+    for (ssize_t i = 0; i != nr_leaves; ++i) {
+        ++count[std::min(depths[i], max_length)];
+    }
+
+    // Clamping the depths makes the code over-subscribed; lengthen codes until it is complete again.
+    auto total = 0;
+    for (int length = 1; length <= max_length; ++length) {
+        total += count[length] << (max_length - length);
+    }
+    while (total > (1 << max_length)) {
+        --count[max_length];
+        for (int length = max_length - 1; length > 0; --length) {
+            if (count[length] != 0) {
+                --count[length];
+                count[length + 1] += 2;
+                break;
+            }
+        }
+        --total;
+    }
+
+    // The least frequent symbols get the longest codes.
+    ssize_t i = 0;
+    for (int length = max_length; length > 0; --length) {
+        for (int j = 0; j != count[length]; ++j) {
+            r[symbols[i++]] = length;
+        }
+    }
+    return r;
+}
 
+/** Calculate canonical huffman codes from code lengths.
+ *
+ * @param lengths The code length of each symbol, zero for unused symbols.
+ * @return The code of each symbol, the most significant bit of the code is sent first.
+ */
+[[nodiscard]] inline std::vector<int> huffman_codes_from_lengths(std::span<int const> lengths) noexcept
+{
+    auto count = std::array<int, 16>{};
+    for (ttlet length : lengths) {
+        tt_axiom(length >= 0 && length <= 15);
+        ++count[length];
+    }
+    count[0] = 0;
 
+    auto next_code = std::array<int, 16>{};
+    auto code = 0;
+    for (int length = 1; length <= 15; ++length) {
+        code = (code + count[length - 1]) << 1;
+        next_code[length] = code;
+    }
+
+    auto r = std::vector<int>(std::size(lengths), 0);
+    for (ssize_t symbol = 0; symbol != std::ssize(lengths); ++symbol) {
+        if (ttlet length = lengths[symbol]) {
+            r[symbol] = next_code[length]++;
+        }
+    }
+    return r;
 }
+
+} // namespace tt
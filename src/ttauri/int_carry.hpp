@@ -157,4 +157,40 @@ constexpr std::pair<T, T> multiply_carry(T a, T b, T carry = 0, T accumulator =
     }
 }
 
+/** Divide a double-wide number by a digit.
+ * @param hi The high digit of the dividend, must be less than the divisor.
+ * @param lo The low digit of the dividend.
+ * @param divisor The divisor.
+ * @return The quotient, followed by the remainder.
+ */
+template<typename T> requires (std::unsigned_integral<T>)
+constexpr std::pair<T, T> wide_divide(T hi, T lo, T divisor) noexcept
+{
+    if constexpr (sizeof(T) == 1) {
+        uint16_t dividend = (static_cast<uint16_t>(hi) << 8) | lo;
+        return { static_cast<uint8_t>(dividend / divisor), static_cast<uint8_t>(dividend % divisor) };
+
+    } else if constexpr (sizeof(T) == 2) {
+        uint32_t dividend = (static_cast<uint32_t>(hi) << 16) | lo;
+        return { static_cast<uint16_t>(dividend / divisor), static_cast<uint16_t>(dividend % divisor) };
+
+    } else if constexpr (sizeof(T) == 4) {
+        uint64_t dividend = (static_cast<uint64_t>(hi) << 32) | lo;
+        return { static_cast<uint32_t>(dividend / divisor), static_cast<uint32_t>(dividend % divisor) };
+
+    } else if constexpr (sizeof(T) == 8) {
+#if TT_COMPILER == TT_CC_MSVC
+        uint64_t remainder = 0;
+        uint64_t quotient = _udiv128(hi, lo, divisor, &remainder);
+        return { quotient, remainder };
+
+#elif TT_COMPILER == TT_CC_CLANG || TT_COMPILER == TT_CC_GCC
+        auto dividend = (static_cast<__uint128_t>(hi) << 64) | lo;
+        return { static_cast<uint64_t>(dividend / divisor), static_cast<uint64_t>(dividend % divisor) };
+#else
+#error "Not implemented"
+#endif
+    }
+}
+
 }
@@ -12,6 +12,7 @@
 #include "url_parser.hpp"
 #include "debugger.hpp"
 #include "timer.hpp"
+#include "file.hpp"
 #include <fmt/ostream.h>
 #include <fmt/format.h>
 #include <exception>
@@ -46,6 +47,57 @@ using namespace std::literals::chrono_literals;
     std::terminate();
 }
 
+logger_type::~logger_type() = default;
+
+void logger_type::start_binary_log(URL const &location) noexcept
+{
+    ttlet lock = std::scoped_lock(binary_log_mutex);
+
+    try {
+        binary_log_file = std::make_unique<file>(location, access_mode::truncate_or_create_for_write);
+        binary_log.emplace();
+    } catch (std::exception const &e) {
+        binary_log_file = {};
+        binary_log.reset();
+        writeToConsole(fmt::format("Could not open binary log {}: {}", location, e.what()));
+    }
+}
+
+void logger_type::stop_binary_log() noexcept
+{
+    ttlet lock = std::scoped_lock(binary_log_mutex);
+
+    write_binary_log();
+    binary_log.reset();
+    if (binary_log_file) {
+        try {
+            binary_log_file->close();
+        } catch (std::exception const &e) {
+            writeToConsole(fmt::format("Could not close binary log: {}", e.what()));
+        }
+        binary_log_file = {};
+    }
+}
+
+/** Write the records which were added to the binary log to its file.
+ * The binary_log_mutex must be held.
+ */
+void logger_type::write_binary_log() noexcept
+{
+    if (!binary_log || binary_log->bytes().empty()) {
+        return;
+    }
+
+    try {
+        binary_log_file->write(binary_log->bytes());
+        binary_log->clear();
+    } catch (std::exception const &e) {
+        binary_log.reset();
+        binary_log_file = {};
+        writeToConsole(fmt::format("Could not write binary log: {}", e.what()));
+    }
+}
+
 void logger_type::writeToConsole(std::string str) noexcept
 {
     if (debugger_is_present()) {
@@ -124,21 +176,81 @@ void logger_type::gather_tick(bool last) noexcept
     }
 }
 
+[[nodiscard]] std::shared_ptr<logger_type::thread_message_queue_type> logger_type::add_thread_message_queue() noexcept
+{
+    auto r = std::make_shared<thread_message_queue_type>();
+
+    ttlet lock = std::scoped_lock(thread_message_queues_mutex);
+    thread_message_queues.push_back(r);
+    return r;
+}
+
+void logger_type::write_message(log_message_base const &message) noexcept
+{
+    if (binary_log) {
+        message.serialize(*binary_log);
+    }
+
+    if (message.level() >= minimum_console_log_level) {
+        write(message.format());
+    }
+}
+
+void logger_type::write_thread_messages() noexcept
+{
+    auto queues = decltype(thread_message_queues){};
+    {
+        ttlet lock = std::scoped_lock(thread_message_queues_mutex);
+
+        // Remove the queues of threads that have exited, once all their messages have been written.
+        std::erase_if(thread_message_queues, [](ttlet &queue) {
+            return queue->closed.load(std::memory_order::acquire) && queue->queue.empty();
+        });
+        queues = thread_message_queues;
+    }
+
+    while (true) {
+        // Find the oldest message at the front of the queues.
+        decltype(thread_message_queue_type::queue) *oldest_queue = nullptr;
+        message_type *oldest_message = nullptr;
+        for (ttlet &queue : queues) {
+            if (auto message = queue->queue.front()) {
+                if (oldest_message == nullptr || (*message)->timestamp() < (*oldest_message)->timestamp()) {
+                    oldest_queue = &queue->queue;
+                    oldest_message = message;
+                }
+            }
+        }
+
+        if (oldest_message == nullptr) {
+            break;
+        }
+
+        write_message(**oldest_message);
+
+        oldest_message->reset();
+        oldest_queue->pop_front();
+    }
+}
+
 void logger_type::logger_tick() noexcept
 {
     ttlet t = trace<"logger_tick">{};
 
+    ttlet lock = std::scoped_lock(binary_log_mutex);
+
     while (!message_queue.empty()) {
         auto message = message_queue.read();
 
-        ttlet str = (*message)->format();
-
-        write(str);
+        write_message(**message);
 
         // Call the virtual-destructor of the `log_message_base`, so that it can skip this when
         // adding messages to the queue.
         message->reset();
     }
+
+    write_thread_messages();
+    write_binary_log();
 }
 
 } // namespace tt
@@ -9,6 +9,7 @@
 #include "hires_utc_clock.hpp"
 #include "polymorphic_optional.hpp"
 #include "wfree_message_queue.hpp"
+#include "wfree_spsc_queue.hpp"
 #include "atomic.hpp"
 #include "meta.hpp"
 #include "format.hpp"
@@ -16,6 +17,7 @@
 #include "os_detect.hpp"
 #include "delayed_format.hpp"
 #include "fixed_string.hpp"
+#include "binary_log.hpp"
 #include <date/tz.h>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
@@ -23,9 +25,16 @@
 #include <string_view>
 #include <tuple>
 #include <mutex>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <atomic>
 
 namespace tt {
 
+class file;
+class URL;
+
 std::string getLastErrorMessage();
 
 [[noreturn]] void terminateOnFatalError(std::string &&message) noexcept;
@@ -126,8 +135,16 @@ public:
     log_message_base &operator=(log_message_base const &) = delete;
     log_message_base &operator=(log_message_base &&) = delete;
 
+    [[nodiscard]] virtual log_level level() const noexcept = 0;
+
+    [[nodiscard]] virtual cpu_counter_clock::time_point timestamp() const noexcept = 0;
+
     virtual std::string format() const noexcept = 0;
 
+    /** Write the message as a binary record, without formatting it.
+     */
+    virtual void serialize(binary_log_writer &writer) const noexcept = 0;
+
     static std::string cpu_utc_clock_as_iso8601(cpu_counter_clock::time_point const timestamp) noexcept;
 };
 
@@ -143,6 +160,16 @@ public:
     {
     }
 
+    [[nodiscard]] log_level level() const noexcept override
+    {
+        return Level;
+    }
+
+    [[nodiscard]] cpu_counter_clock::time_point timestamp() const noexcept override
+    {
+        return _timestamp;
+    }
+
     std::string format() const noexcept override
     {
         ttlet local_timestring = log_message_base::cpu_utc_clock_as_iso8601(_timestamp);
@@ -155,6 +182,17 @@ public:
         }
     }
 
+    void serialize(binary_log_writer &writer) const noexcept override
+    {
+        static ttlet format_id = binary_log_writer::make_format_id();
+
+        std::apply(
+            [&](ttlet &...values) {
+                writer.write_message(format_id, Level, SourceFile, SourceLine, Fmt, _timestamp, values...);
+            },
+            _what.values());
+    }
+
 private:
     cpu_counter_clock::time_point _timestamp;
     delayed_format<Fmt, Values...> _what;
@@ -170,20 +208,70 @@ class logger_type {
     static constexpr size_t MAX_MESSAGE_SIZE = 224;
     static constexpr size_t MESSAGE_ALIGNMENT = 256;
     static constexpr size_t MAX_NR_MESSAGES = 4096;
+    static constexpr size_t MAX_NR_THREAD_MESSAGES = 1024;
 
     using message_type = polymorphic_optional<log_message_base, MAX_MESSAGE_SIZE>;
     using message_queue_type = wfree_message_queue<message_type, MAX_NR_MESSAGES>;
 
+    struct thread_message_queue_type {
+        wfree_spsc_queue<message_type, MAX_NR_THREAD_MESSAGES> queue;
+
+        /** Set when the thread has exited, the queue is removed after it has been drained.
+         */
+        std::atomic<bool> closed = false;
+    };
+
+    /** Owned by a thread_local, to close the queue of a thread when it exits.
+     */
+    struct thread_message_queue_holder {
+        std::shared_ptr<thread_message_queue_type> ptr;
+
+        ~thread_message_queue_holder()
+        {
+            if (ptr) {
+                ptr->closed.store(true, std::memory_order::release);
+            }
+        }
+    };
+
     //! the message queue must work correctly before main() is executed.
     message_queue_type message_queue;
 
+    std::mutex thread_message_queues_mutex;
+    std::vector<std::shared_ptr<thread_message_queue_type>> thread_message_queues;
+
     hires_utc_clock::time_point next_gather_time = {};
 
 public:
     logger_type() noexcept;
+    ~logger_type();
 
     log_level minimum_log_level = log_level::Debug;
 
+    /** Log through a queue per thread, instead of the single shared message queue.
+     *
+     * Each thread that logs gets its own single-producer queue, so that threads do not
+     * contend with each other. The logger thread merges the messages of all queues
+     * by timestamp.
+     */
+    std::atomic<bool> use_thread_message_queues = false;
+
+    /** Messages below this level are not formatted to the console.
+     * When a binary log is started, these messages are only written to the binary log.
+     */
+    log_level minimum_console_log_level = log_level::Debug;
+
+    /** Start writing all messages to a binary log.
+     * The binary log can be formatted to text with `decode_binary_log()`.
+     *
+     * @param location The location of the binary log file, which is overwritten.
+     */
+    void start_binary_log(URL const &location) noexcept;
+
+    /** Stop writing to the binary log and close the file.
+     */
+    void stop_binary_log() noexcept;
+
     void logger_tick() noexcept;
     void gather_tick(bool last) noexcept;
 
@@ -197,26 +285,63 @@ public:
             // * Simplifies logged_fatal_message logic.
             // * Will make sure everything gets logged.
             // * Blocking is bad in a real time thread, so maybe count the number of times it is blocked.
-            auto message = message_queue.write<"logger_blocked">();
+            if (use_thread_message_queues.load(std::memory_order::relaxed)) {
+                auto &queue = thread_message_queue();
+                emplace_message<Level, SourceFile, SourceLine, Fmt>(
+                    queue.write_start<"logger_blocked">(), timestamp, std::forward<Args>(args)...);
+                queue.write_finish();
+
+            } else {
+                auto message = message_queue.write<"logger_blocked">();
+                emplace_message<Level, SourceFile, SourceLine, Fmt>(*message, timestamp, std::forward<Args>(args)...);
+            }
+        }
+    }
+
+private:
+    std::mutex binary_log_mutex;
+    std::unique_ptr<file> binary_log_file;
+    std::optional<binary_log_writer> binary_log;
 
-            // dereference the message so that we get the polymorphic_optional, so this assignment will work correctly.
-            message->emplace<log_message<Level, SourceFile, SourceLine, Fmt, forward_value_t<Args>...>>(
-                timestamp, std::forward<Args>(args)...);
+    template<log_level Level, basic_fixed_string SourceFile, int SourceLine, basic_fixed_string Fmt, typename... Args>
+    void emplace_message(message_type &message, typename cpu_counter_clock::time_point timestamp, Args &&...args) noexcept
+    {
+        // use the polymorphic_optional directly, so this assignment will work correctly.
+        message.emplace<log_message<Level, SourceFile, SourceLine, Fmt, forward_value_t<Args>...>>(
+            timestamp, std::forward<Args>(args)...);
+
+        if constexpr (Level >= log_level::Fatal) {
+            // Make sure everything including this message and counters are logged.
+            terminateOnFatalError(message->format());
+
+        } else if constexpr (Level >= log_level::Error) {
+            // Actually logging of tracing will only work when we cleanly unwind the stack and destruct all trace objects
+            // this will not work on fatal messages.
+            trace_record();
+        }
+    }
 
-            if constexpr (Level >= log_level::Fatal) {
-                // Make sure everything including this message and counters are logged.
-                terminateOnFatalError((*message)->format());
+    /** The message queue of the current thread.
+     */
+    [[nodiscard]] decltype(thread_message_queue_type::queue) &thread_message_queue() noexcept
+    {
+        thread_local thread_message_queue_holder holder;
 
-            } else if constexpr (Level >= log_level::Error) {
-                // Actually logging of tracing will only work when we cleanly unwind the stack and destruct all trace objects
-                // this will not work on fatal messages.
-                trace_record();
-            }
+        if (!holder.ptr) {
+            [[unlikely]] holder.ptr = add_thread_message_queue();
         }
+        return holder.ptr->queue;
     }
 
-private:
+    [[nodiscard]] std::shared_ptr<thread_message_queue_type> add_thread_message_queue() noexcept;
+
+    /** Write the messages of all thread message queues, in order of their timestamp.
+     */
+    void write_thread_messages() noexcept;
+
+    void write_message(log_message_base const &message) noexcept;
     void write(std::string const &str) noexcept;
+    void write_binary_log() noexcept;
     void writeToFile(std::string str) noexcept;
     void writeToConsole(std::string str) noexcept;
     void display_time_calibration() noexcept;
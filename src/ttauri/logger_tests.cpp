@@ -0,0 +1,111 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/logger.hpp"
+#include "ttauri/wfree_spsc_queue.hpp"
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+using namespace tt;
+
+TEST(wfree_spsc_queue, write_read)
+{
+    auto queue = std::make_unique<wfree_spsc_queue<int, 16>>();
+    ASSERT_TRUE(queue->empty());
+    ASSERT_EQ(queue->front(), nullptr);
+
+    for (int i = 0; i != 16; ++i) {
+        queue->write_start() = i;
+        queue->write_finish();
+    }
+    ASSERT_FALSE(queue->empty());
+
+    for (int i = 0; i != 16; ++i) {
+        ttlet message = queue->front();
+        ASSERT_NE(message, nullptr);
+        ASSERT_EQ(*message, i);
+        queue->pop_front();
+    }
+    ASSERT_EQ(queue->front(), nullptr);
+}
+
+TEST(wfree_spsc_queue, threads)
+{
+    constexpr int nr_messages = 100000;
+    auto queue = std::make_unique<wfree_spsc_queue<int, 1024>>();
+
+    auto producer = std::thread([&queue]() {
+        for (int i = 0; i != nr_messages; ++i) {
+            queue->write_start() = i;
+            queue->write_finish();
+        }
+    });
+
+    for (int i = 0; i != nr_messages;) {
+        if (ttlet message = queue->front()) {
+            ASSERT_EQ(*message, i);
+            queue->pop_front();
+            ++i;
+        }
+    }
+    producer.join();
+}
+
+static void logger_benchmark(bool use_thread_message_queues)
+{
+    constexpr int nr_threads = 8;
+    constexpr int nr_messages = 100000;
+
+    ttlet previous_minimum_console_log_level = logger.minimum_console_log_level;
+    logger.minimum_console_log_level = log_level::Fatal;
+    logger.use_thread_message_queues = use_thread_message_queues;
+
+    ttlet blocked_before = read_counter<"logger_blocked">();
+    auto nr_finished = std::atomic<int>{0};
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    auto threads = std::vector<std::thread>{};
+    for (int thread_nr = 0; thread_nr != nr_threads; ++thread_nr) {
+        threads.emplace_back([thread_nr, &nr_finished]() {
+            for (int i = 0; i != nr_messages; ++i) {
+                tt_log_debug("benchmark thread {} message {}", thread_nr, i);
+            }
+            ++nr_finished;
+        });
+    }
+
+    // Act as the logger thread.
+    while (nr_finished.load() != nr_threads) {
+        logger.logger_tick();
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    logger.logger_tick();
+
+    logger.use_thread_message_queues = false;
+    logger.minimum_console_log_level = previous_minimum_console_log_level;
+
+    ttlet duration = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << fmt::format(
+        "{}: {} threads, {:.0f} messages/s, blocked {} times\n",
+        use_thread_message_queues ? "thread message queues" : "shared message queue",
+        nr_threads,
+        nr_threads * nr_messages / duration,
+        read_counter<"logger_blocked">() - blocked_before);
+}
+
+TEST(logger, benchmark)
+{
+    logger_benchmark(false);
+    logger_benchmark(true);
+}
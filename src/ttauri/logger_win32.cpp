@@ -7,6 +7,7 @@
 #include "cpu_utc_clock.hpp"
 #include "required.hpp"
 #include "URL.hpp"
+#include "file.hpp"
 #include "strings.hpp"
 #include "thread.hpp"
 #include <fmt/ostream.h>
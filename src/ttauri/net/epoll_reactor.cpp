@@ -0,0 +1,345 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "epoll_reactor.hpp"
+#include "../exception.hpp"
+#include "../cast.hpp"
+#include "../logger.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <array>
+
+namespace tt {
+
+[[nodiscard]] static sockaddr_in make_socket_address(std::string const &address, uint16_t port)
+{
+    auto r = sockaddr_in{};
+    r.sin_family = AF_INET;
+    r.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &r.sin_addr) != 1) {
+        throw io_error("Invalid IPv4 address '{}'", address);
+    }
+    return r;
+}
+
+static void set_no_delay(int fd) noexcept
+{
+    // Data is only written after the events of a socket have been handled, and then in
+    // a single gather-write; waiting for more data will only add latency.
+    int value = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+epoll_reactor::epoll_reactor()
+{
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        throw io_error("Could not create epoll: {}", std::strerror(errno));
+    }
+
+    wakeup_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd < 0) {
+        ::close(epoll_fd);
+        throw io_error("Could not create eventfd: {}", std::strerror(errno));
+    }
+
+    auto event = epoll_event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeup_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &event);
+}
+
+epoll_reactor::~epoll_reactor()
+{
+    for (ttlet &[fd, stream] : streams) {
+        ::close(fd);
+    }
+    for (ttlet &[fd, factory] : listeners) {
+        ::close(fd);
+    }
+    ::close(wakeup_fd);
+    ::close(epoll_fd);
+}
+
+uint16_t epoll_reactor::listen(std::string const &address, uint16_t port, stream_factory factory, bool reuse_port)
+{
+    auto socket_address = make_socket_address(address, port);
+
+    ttlet fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw io_error("Could not create socket: {}", std::strerror(errno));
+    }
+
+    int value = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value));
+    if (reuse_port) {
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value));
+    }
+
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&socket_address), sizeof(socket_address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        ttlet error = errno;
+        ::close(fd);
+        throw io_error("Could not listen on {}:{}: {}", address, port, std::strerror(error));
+    }
+
+    auto socket_address_size = socklen_t{sizeof(socket_address)};
+    ::getsockname(fd, reinterpret_cast<sockaddr *>(&socket_address), &socket_address_size);
+
+    auto event = epoll_event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+
+    listeners[fd] = std::move(factory);
+    return ntohs(socket_address.sin_port);
+}
+
+Socketstream &epoll_reactor::connect(std::string const &address, uint16_t port, std::unique_ptr<Socketstream> stream)
+{
+    auto socket_address = make_socket_address(address, port);
+
+    ttlet fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw io_error("Could not create socket: {}", std::strerror(errno));
+    }
+    set_no_delay(fd);
+
+    auto &r = *stream;
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&socket_address), sizeof(socket_address)) == 0) {
+        add(fd, std::move(stream));
+        r.handleConnect();
+        write(fd, r);
+
+    } else if (errno == EINPROGRESS) {
+        r.connecting = true;
+        add(fd, std::move(stream));
+
+    } else {
+        ttlet error = errno;
+        ::close(fd);
+        throw io_error("Could not connect to {}:{}: {}", address, port, std::strerror(error));
+    }
+    return r;
+}
+
+void epoll_reactor::add(int fd, std::unique_ptr<Socketstream> stream)
+{
+    auto event = epoll_event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = fd;
+    if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        ttlet error = errno;
+        ::close(fd);
+        throw io_error("Could not add socket to epoll: {}", std::strerror(error));
+    }
+
+    streams[fd] = std::move(stream);
+}
+
+void epoll_reactor::remove(int fd) noexcept
+{
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    streams.erase(fd);
+}
+
+void epoll_reactor::accept(int listen_fd, stream_factory const &factory)
+{
+    while (true) {
+        ttlet fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                tt_log_error("Could not accept connection: {}", std::strerror(errno));
+            }
+            return;
+        }
+        set_no_delay(fd);
+
+        auto stream = factory();
+        auto &stream_ = *stream;
+        add(fd, std::move(stream));
+        stream_.handleConnect();
+        write(fd, stream_);
+    }
+}
+
+ssize_t epoll_reactor::poll(std::chrono::milliseconds timeout)
+{
+    auto events = std::array<epoll_event, max_nr_events>{};
+
+    ttlet nr_events = ::epoll_wait(epoll_fd, events.data(), max_nr_events, narrow_cast<int>(timeout.count()));
+    if (nr_events < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        throw io_error("Could not wait for epoll events: {}", std::strerror(errno));
+    }
+
+    for (int i = 0; i != nr_events; ++i) {
+        ttlet fd = events[i].data.fd;
+
+        if (fd == wakeup_fd) {
+            uint64_t value;
+            [[maybe_unused]] ttlet r = ::read(wakeup_fd, &value, sizeof(value));
+
+        } else if (ttlet listener = listeners.find(fd); listener != listeners.end()) {
+            accept(fd, listener->second);
+
+        } else {
+            handle_events(fd, events[i].events);
+        }
+    }
+    return nr_events;
+}
+
+void epoll_reactor::run()
+{
+    while (!stop_requested.load(std::memory_order::relaxed)) {
+        poll(std::chrono::milliseconds{-1});
+    }
+    stop_requested.store(false, std::memory_order::relaxed);
+}
+
+void epoll_reactor::stop() noexcept
+{
+    stop_requested.store(true, std::memory_order::relaxed);
+
+    uint64_t value = 1;
+    [[maybe_unused]] ttlet r = ::write(wakeup_fd, &value, sizeof(value));
+}
+
+void epoll_reactor::handle_events(int fd, uint32_t events) noexcept
+{
+    ttlet i = streams.find(fd);
+    if (i == streams.end()) {
+        return;
+    }
+    auto &stream = *i->second;
+
+    try {
+        if (stream.connecting) {
+            if ((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) == 0) {
+                return;
+            }
+
+            int error = 0;
+            auto error_size = socklen_t{sizeof(error)};
+            ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_size);
+            if (error != 0) {
+                tt_log_error("Could not connect: {}", std::strerror(error));
+                remove(fd);
+                return;
+            }
+            stream.handleConnect();
+        }
+
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0 && read(fd, stream)) {
+            stream.handleReadyToReadEvent();
+        }
+
+        // Write the data that the handlers added to the write-buffer. When the socket
+        // accepted all data, let the stream add more.
+        auto written = write(fd, stream);
+        if (written && (events & EPOLLOUT) != 0 && !stream.writeBuffer.closed() && !stream.readBuffer.closed()) {
+            stream.handleReadyToWriteEvent();
+            written = write(fd, stream);
+        }
+
+        if (written && (stream.writeBuffer.closed() || stream.readBuffer.closed())) {
+            remove(fd);
+        }
+
+    } catch (std::exception const &e) {
+        tt_log_error("Socket stream failed: {}", e.what());
+        remove(fd);
+    }
+}
+
+bool epoll_reactor::read(int fd, Socketstream &stream) noexcept
+{
+    // The socket is edge-triggered, so it must be read until it would block.
+    auto r = false;
+    while (!stream.readBuffer.closed()) {
+        auto buffer = stream.readBuffer.getpacket(read_size);
+
+        ttlet nr_bytes = ::read(fd, buffer.data(), buffer.size());
+        if (nr_bytes > 0) {
+            stream.readBuffer.write(nr_bytes, false);
+            r = true;
+
+        } else if (nr_bytes == 0) {
+            stream.readBuffer.close();
+            r = true;
+
+        } else if (errno == EINTR) {
+            continue;
+
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+
+        } else {
+            stream.readBuffer.close();
+            r = true;
+        }
+    }
+    return r;
+}
+
+bool epoll_reactor::write(int fd, Socketstream &stream) noexcept
+{
+    auto spans = std::array<std::span<std::byte const>, max_nr_write_packets>{};
+    auto iov = std::array<iovec, max_nr_write_packets>{};
+
+    while (stream.writeBuffer.nrBytes() > 0) {
+        ttlet nr_packets = stream.writeBuffer.peekPackets(spans);
+
+        ssize_t nr_bytes = 0;
+        for (ssize_t i = 0; i != nr_packets; ++i) {
+            iov[i].iov_base = const_cast<std::byte *>(spans[i].data());
+            iov[i].iov_len = spans[i].size();
+            nr_bytes += std::ssize(spans[i]);
+        }
+
+        // sendmsg() is the same gather-write as writev(), but does not raise SIGPIPE
+        // when the other side has closed the connection.
+        auto message = msghdr{};
+        message.msg_iov = iov.data();
+        message.msg_iovlen = narrow_cast<size_t>(nr_packets);
+
+        ttlet nr_written = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (nr_written >= 0) {
+            stream.writeBuffer.read(nr_written);
+            if (nr_written < nr_bytes) {
+                // The socket is full, wait for the next ready-to-write event.
+                return false;
+            }
+
+        } else if (errno == EINTR) {
+            continue;
+
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return false;
+
+        } else {
+            // The connection is broken, drop the data and close the stream.
+            stream.writeBuffer.read(stream.writeBuffer.nrBytes());
+            stream.readBuffer.close();
+            return true;
+        }
+    }
+    return true;
+}
+
+} // namespace tt
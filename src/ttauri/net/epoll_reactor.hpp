@@ -0,0 +1,131 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "stream.hpp"
+#include "../required.hpp"
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+namespace tt {
+
+/** An event loop which drives many socket-streams on a single thread, using Linux epoll.
+ *
+ * Sockets are registered edge-triggered for both reading and writing, so that a socket
+ * never needs to be modified after it was added. On a ready-to-read event the socket is
+ * read until it would block, directly into the read-buffer of the stream. The packets in
+ * the write-buffer are written to the socket with a single gather-write.
+ *
+ * To use multiple cores, run a reactor on each thread, each listening on the same port
+ * with `reuse_port`; the kernel will then distribute new connections over the reactors.
+ *
+ * The reactor is not thread-safe, except for `stop()`.
+ */
+class epoll_reactor {
+public:
+    using stream_factory = std::function<std::unique_ptr<Socketstream>()>;
+
+    /** The number of bytes read from a socket at once.
+     */
+    static constexpr ssize_t read_size = 16384;
+
+    /** The maximum number of packets written to a socket at once.
+     */
+    static constexpr ssize_t max_nr_write_packets = 64;
+
+    /** The maximum number of events handled at once.
+     */
+    static constexpr int max_nr_events = 256;
+
+    epoll_reactor();
+    ~epoll_reactor();
+
+    epoll_reactor(epoll_reactor const &) = delete;
+    epoll_reactor(epoll_reactor &&) = delete;
+    epoll_reactor &operator=(epoll_reactor const &) = delete;
+    epoll_reactor &operator=(epoll_reactor &&) = delete;
+
+    /** The number of streams handled by this reactor.
+     */
+    [[nodiscard]] ssize_t size() const noexcept
+    {
+        return std::ssize(streams);
+    }
+
+    /** Listen for TCP connections.
+     *
+     * @param address The IPv4 address to listen on, such as "0.0.0.0" or "127.0.0.1".
+     * @param port The port to listen on, or zero to select any free port.
+     * @param factory A function to create a stream for each accepted connection.
+     * @param reuse_port Allow other sockets to listen on the same port, for a reactor per core.
+     * @return The port that is listened on.
+     * @throws io_error When the socket could not be created.
+     */
+    uint16_t listen(std::string const &address, uint16_t port, stream_factory factory, bool reuse_port = false);
+
+    /** Connect to a TCP server.
+     *
+     * The connection is made in the background, `handleConnect()` is called when the
+     * connection is established.
+     *
+     * @param address The IPv4 address to connect to.
+     * @param port The port to connect to.
+     * @param stream The stream to handle the connection.
+     * @return A reference to the stream, owned by the reactor.
+     * @throws io_error When the socket could not be created.
+     */
+    Socketstream &connect(std::string const &address, uint16_t port, std::unique_ptr<Socketstream> stream);
+
+    /** Wait for events and handle them.
+     *
+     * @param timeout The maximum time to wait for an event, or -1 to wait forever.
+     * @return The number of handled events.
+     */
+    ssize_t poll(std::chrono::milliseconds timeout);
+
+    /** Handle events until `stop()` is called.
+     */
+    void run();
+
+    /** Ask `run()` to return.
+     * May be called from any thread.
+     */
+    void stop() noexcept;
+
+private:
+    int epoll_fd = -1;
+
+    /** An eventfd to wake up the reactor from another thread.
+     */
+    int wakeup_fd = -1;
+
+    std::atomic<bool> stop_requested = false;
+
+    std::unordered_map<int, std::unique_ptr<Socketstream>> streams;
+    std::unordered_map<int, stream_factory> listeners;
+
+    void add(int fd, std::unique_ptr<Socketstream> stream);
+    void remove(int fd) noexcept;
+    void accept(int listen_fd, stream_factory const &factory);
+
+    void handle_events(int fd, uint32_t events) noexcept;
+
+    /** Read from the socket until it would block.
+     * @return true if any data was read, or the connection was closed.
+     */
+    bool read(int fd, Socketstream &stream) noexcept;
+
+    /** Write the write-buffer to the socket.
+     * @return true if the write-buffer was completely written.
+     */
+    bool write(int fd, Socketstream &stream) noexcept;
+};
+
+} // namespace tt
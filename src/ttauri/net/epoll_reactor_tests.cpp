@@ -0,0 +1,319 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/net/epoll_reactor.hpp"
+#include "ttauri/cast.hpp"
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <sys/resource.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+using namespace tt;
+
+namespace {
+
+/** Copy data from a buffer to another buffer.
+ */
+void copy_buffer(packet_buffer &from, packet_buffer &to, ssize_t nr_bytes)
+{
+    while (nr_bytes > 0) {
+        ttlet data = from.peek(1);
+        ttlet size = std::min(std::ssize(data), nr_bytes);
+
+        auto buffer = to.getpacket(size);
+        std::memcpy(buffer.data(), data.data(), size);
+        to.write(size, false);
+        from.read(size);
+        nr_bytes -= size;
+    }
+}
+
+class echo_stream : public Socketstream {
+public:
+    void handleReadyToReadEvent() override
+    {
+        copy_buffer(readBuffer, writeBuffer, readBuffer.nrBytes());
+        if (readBuffer.closed()) {
+            writeBuffer.close();
+        }
+    }
+};
+
+/** A set of reactors, each on its own thread, echoing on the same port.
+ */
+class echo_server {
+public:
+    uint16_t port = 0;
+
+    echo_server(ssize_t nr_reactors)
+    {
+        for (ssize_t i = 0; i != nr_reactors; ++i) {
+            auto &reactor = reactors.emplace_back(std::make_unique<epoll_reactor>());
+            port = reactor->listen(
+                "127.0.0.1",
+                port,
+                [] {
+                    return std::make_unique<echo_stream>();
+                },
+                true);
+        }
+
+        for (auto &reactor : reactors) {
+            threads.emplace_back([&reactor] {
+                reactor->run();
+            });
+        }
+    }
+
+    ~echo_server()
+    {
+        for (auto &reactor : reactors) {
+            reactor->stop();
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<epoll_reactor>> reactors;
+    std::vector<std::thread> threads;
+};
+
+[[nodiscard]] ssize_t nr_server_reactors() noexcept
+{
+    return std::clamp(narrow_cast<ssize_t>(std::thread::hardware_concurrency()) - 1, ssize_t{1}, ssize_t{4});
+}
+
+/** Raise the limit of open files, and return the number of connections that fit within the limit.
+ */
+[[nodiscard]] ssize_t max_nr_connections(ssize_t nr_connections) noexcept
+{
+    auto limit = rlimit{};
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+
+    // Both sides of each connection are in this process.
+    ttlet nr_files = std::min(limit.rlim_cur, rlim_t{1'000'000});
+    return std::min(nr_connections, narrow_cast<ssize_t>((nr_files - 64) / 2));
+}
+
+/** Run the reactor until all streams are closed.
+ */
+void run_until_closed(epoll_reactor &reactor)
+{
+    ttlet deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (reactor.size() > 0 && std::chrono::steady_clock::now() < deadline) {
+        reactor.poll(std::chrono::milliseconds(100));
+    }
+}
+
+struct ping_statistics {
+    ssize_t nr_round_trips = 0;
+    std::chrono::nanoseconds total_round_trip_time = {};
+    std::chrono::nanoseconds max_round_trip_time = {};
+};
+
+/** Send a small message, and send it again after it was echoed back.
+ */
+class ping_stream : public Socketstream {
+public:
+    ping_stream(ping_statistics &statistics, ssize_t message_size, ssize_t nr_rounds) noexcept :
+        statistics(statistics), message_size(message_size), nr_rounds(nr_rounds)
+    {
+    }
+
+    void handleConnect() override
+    {
+        Socketstream::handleConnect();
+        send();
+    }
+
+    void handleReadyToReadEvent() override
+    {
+        while (!writeBuffer.closed() && !readBuffer.peek(message_size).empty()) {
+            readBuffer.read(message_size);
+
+            ttlet round_trip_time = std::chrono::steady_clock::now() - send_time;
+            ++statistics.nr_round_trips;
+            statistics.total_round_trip_time += round_trip_time;
+            statistics.max_round_trip_time = std::max(statistics.max_round_trip_time, round_trip_time);
+
+            if (--nr_rounds == 0) {
+                writeBuffer.close();
+            } else {
+                send();
+            }
+        }
+    }
+
+private:
+    ping_statistics &statistics;
+    ssize_t message_size;
+    ssize_t nr_rounds;
+    std::chrono::steady_clock::time_point send_time;
+
+    void send()
+    {
+        auto buffer = writeBuffer.getNewpacket(message_size);
+        std::memset(buffer.data(), 'p', message_size);
+        writeBuffer.write(message_size);
+        send_time = std::chrono::steady_clock::now();
+    }
+};
+
+/** Send a large amount of data, while receiving the echo.
+ */
+class bulk_stream : public Socketstream {
+public:
+    bulk_stream(ssize_t &total_received, ssize_t nr_bytes) noexcept : total_received(total_received), nr_bytes(nr_bytes) {}
+
+    void handleConnect() override
+    {
+        Socketstream::handleConnect();
+        send();
+    }
+
+    void handleReadyToReadEvent() override
+    {
+        ttlet size = readBuffer.nrBytes();
+        readBuffer.read(size);
+        total_received += size;
+        nr_received += size;
+        if (nr_received == nr_bytes) {
+            writeBuffer.close();
+        }
+    }
+
+    void handleReadyToWriteEvent() override
+    {
+        send();
+    }
+
+private:
+    static constexpr ssize_t chunk_size = 65536;
+
+    ssize_t &total_received;
+    ssize_t nr_bytes;
+    ssize_t nr_sent = 0;
+    ssize_t nr_received = 0;
+
+    void send()
+    {
+        // Queue a limited amount of data, the rest is send when the socket is ready to write.
+        for (int i = 0; i != 4 && nr_sent < nr_bytes; ++i) {
+            ttlet size = std::min(chunk_size, nr_bytes - nr_sent);
+            auto buffer = writeBuffer.getNewpacket(size);
+            std::memset(buffer.data(), 'b', size);
+            writeBuffer.write(size, false);
+            nr_sent += size;
+        }
+    }
+};
+
+class line_stream : public Socketstream {
+public:
+    std::string &line;
+
+    line_stream(std::string &line) noexcept : line(line) {}
+
+    void handleConnect() override
+    {
+        Socketstream::handleConnect();
+        ttlet text = std::string_view{"Hello World\n"};
+        auto buffer = writeBuffer.getNewpacket(std::ssize(text));
+        std::memcpy(buffer.data(), text.data(), text.size());
+        writeBuffer.write(std::ssize(text));
+    }
+
+    void handleReadyToReadEvent() override
+    {
+        ttlet text = readBuffer.peekLine();
+        if (!text.empty()) {
+            line = text;
+            readBuffer.read(std::ssize(text));
+            writeBuffer.close();
+        }
+    }
+};
+
+} // namespace
+
+TEST(epoll_reactor, echo)
+{
+    auto server = echo_server(1);
+    auto client = epoll_reactor{};
+
+    auto line = std::string{};
+    client.connect("127.0.0.1", server.port, std::make_unique<line_stream>(line));
+    run_until_closed(client);
+
+    ASSERT_EQ(line, "Hello World\n");
+}
+
+TEST(epoll_reactor, latency_benchmark)
+{
+    constexpr ssize_t message_size = 64;
+    constexpr ssize_t nr_rounds = 100;
+    ttlet nr_connections = max_nr_connections(2000);
+    ttlet nr_reactors = nr_server_reactors();
+
+    auto server = echo_server(nr_reactors);
+    auto client = epoll_reactor{};
+
+    auto statistics = ping_statistics{};
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (ssize_t i = 0; i != nr_connections; ++i) {
+        client.connect("127.0.0.1", server.port, std::make_unique<ping_stream>(statistics, message_size, nr_rounds));
+    }
+    run_until_closed(client);
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(statistics.nr_round_trips, nr_connections * nr_rounds);
+
+    ttlet duration = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << fmt::format(
+        "epoll latency: {} connections, {} server threads, {:.0f} round-trips/s, mean {:.1f} us, max {:.1f} us\n",
+        nr_connections,
+        nr_reactors,
+        statistics.nr_round_trips / duration,
+        std::chrono::duration<double, std::micro>(statistics.total_round_trip_time).count() / statistics.nr_round_trips,
+        std::chrono::duration<double, std::micro>(statistics.max_round_trip_time).count());
+}
+
+TEST(epoll_reactor, throughput_benchmark)
+{
+    constexpr ssize_t nr_bytes = 4 * 1024 * 1024;
+    ttlet nr_connections = max_nr_connections(64);
+    ttlet nr_reactors = nr_server_reactors();
+
+    auto server = echo_server(nr_reactors);
+    auto client = epoll_reactor{};
+
+    ssize_t total_received = 0;
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (ssize_t i = 0; i != nr_connections; ++i) {
+        client.connect("127.0.0.1", server.port, std::make_unique<bulk_stream>(total_received, nr_bytes));
+    }
+    run_until_closed(client);
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(total_received, nr_connections * nr_bytes);
+
+    ttlet duration = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << fmt::format(
+        "epoll throughput: {} connections, {} server threads, {:.0f} MByte/s echoed\n",
+        nr_connections,
+        nr_reactors,
+        total_received / duration / 1'000'000.0);
+}
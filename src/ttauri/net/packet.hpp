@@ -6,9 +6,20 @@
 
 #pragma once
 
+#include "packet_pool.hpp"
+#include "../required.hpp"
+#include "../assert.hpp"
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <utility>
+
 namespace tt {
 
 /** A network message or stream buffer.
+ *
+ * Packets up to `packet_pool::block_size` use a block from the packet pool, and
+ * get the full block as capacity; larger packets are allocated on the heap.
  */
 class packet {
     std::byte *data;
@@ -21,24 +32,46 @@ public:
     /** Allocate an empty packet of a certain size.
      */
     packet(ssize_t nrBytes) noexcept {
-        data = new std::byte [nrBytes];
-        data_end = data + nrBytes;
+        if (nrBytes <= packet_pool::block_size) {
+            data = packet_pool::allocate();
+            data_end = data + packet_pool::block_size;
+        } else {
+            data = new std::byte [nrBytes];
+            data_end = data + nrBytes;
+        }
         first = data;
         last = data;
     }
 
     ~packet() noexcept {
-        delete [] data;
+        if (data == nullptr) {
+            return;
+        } else if (capacity() <= packet_pool::block_size) {
+            packet_pool::deallocate(data);
+        } else {
+            delete [] data;
+        }
     }
 
     packet(packet const &rhs) noexcept = delete;
-    packet operator=(packet const &rhs) noexcept = delete;
+    packet &operator=(packet const &rhs) noexcept = delete;
 
     packet(packet &&rhs) noexcept :
-        data(rhs.data), data_end(rhs.data_end), first(rhs.first), last(rhs.last) {
+        data(rhs.data), data_end(rhs.data_end), first(rhs.first), last(rhs.last), _pushed(rhs._pushed) {
         rhs.data = nullptr;
+        rhs.data_end = nullptr;
+        rhs.first = nullptr;
+        rhs.last = nullptr;
     }
 
+    packet &operator=(packet &&rhs) noexcept {
+        std::swap(data, rhs.data);
+        std::swap(data_end, rhs.data_end);
+        std::swap(first, rhs.first);
+        std::swap(last, rhs.last);
+        std::swap(_pushed, rhs._pushed);
+        return *this;
+    }
 
     [[nodiscard]] std::byte *begin() noexcept {
         return first;
@@ -48,6 +81,20 @@ public:
         return last;
     }
 
+    [[nodiscard]] std::byte const *begin() const noexcept {
+        return first;
+    }
+
+    [[nodiscard]] std::byte const *end() const noexcept {
+        return last;
+    }
+
+    /** The bytes that can be read from this buffer.
+     */
+    [[nodiscard]] std::span<std::byte const> readable() const noexcept {
+        return {first, last};
+    }
+
     /** How many bytes can be read from this buffer.
      */
     [[nodiscard]] ssize_t readSize() const noexcept {
@@ -60,6 +107,24 @@ public:
         return data_end - last;
     }
 
+    /** The total number of bytes this buffer can hold.
+     */
+    [[nodiscard]] ssize_t capacity() const noexcept {
+        return data_end - data;
+    }
+
+    /** Move the bytes that can be read to the start of the buffer.
+     * This makes the space of bytes that have already been read available for writing.
+     */
+    void compact() noexcept {
+        ttlet size = readSize();
+        if (first != data) {
+            std::memmove(data, first, size);
+            first = data;
+            last = data + size;
+        }
+    }
+
     /** Should this packet be pushed onto the network.
      */
     [[nodiscard]] bool pushed() const noexcept {
@@ -5,12 +5,28 @@
 
 #pragma once
 
+#include "packet.hpp"
+#include "../required.hpp"
+#include "../assert.hpp"
+#include "../check.hpp"
+#include <deque>
+#include <span>
+#include <string_view>
+#include <algorithm>
+#include <cstring>
+
 namespace tt {
 
+/** A buffer of packets.
+ *
+ * The packets are kept in a deque, and their data comes from the packet pool. `peek()`
+ * returns a view into the first packet; only when the requested data straddles packets
+ * are bytes moved, into the free space of the first packet when possible.
+ */
 class packet_buffer {
-    std::list<packet> packets;
-    ssize_t _totalNrBytes;
-    bool _closed;
+    std::deque<packet> packets;
+    ssize_t _totalNrBytes = 0;
+    bool _closed = false;
 
 public:
     /** Connection is closed.
@@ -32,7 +48,7 @@ public:
      * than zero when data is available.
      */
     ssize_t nrpackets() const noexcept {
-        return packets.size();
+        return std::ssize(packets);
     }
 
     /** Close the connection on this side.
@@ -47,9 +63,9 @@ public:
     std::span<std::byte> getNewpacket(ssize_t nrBytes) noexcept {
         tt_assert(!closed());
         packets.emplace_back(nrBytes);
-        return {packets.back().end(), nrBytes};
+        return {packets.back().end(), static_cast<size_t>(nrBytes)};
     }
-   
+
     /** Get a packet to write a stream of bytes into.
      * @return a pointer to an byte array with at least nrBytes of data available.
      */
@@ -58,9 +74,9 @@ public:
         if (packets.empty() || (packets.back().writeSize() < nrBytes)) {
             packets.emplace_back(nrBytes);
         }
-        return {packets.back().end(), nrBytes};
+        return {packets.back().end(), static_cast<size_t>(nrBytes)};
     }
-   
+
     /** Write the data added to the packet.
      * This function will write the data added into the buffers returned
      * by `getNewpacket()` and `getpacket()`.
@@ -83,21 +99,49 @@ public:
      *         The returned size may be larger than requested and
      *         this data may be consumed using `read()`.
      */
-    std::span<std::byte const> peek(ssize_t nrBytes) {
-        if (packets.empty() || size() < nrBytes) {
+    std::span<std::byte const> peek(ssize_t nrBytes) noexcept {
+        if (packets.empty() || nrBytes > _totalNrBytes) {
             return {};
         }
 
-        while (true) {
-            if (packets.front().readSize() >= nrBytes) {
-                return {packets.front().readSize(), std::ssize(packets)};
+        auto &front = packets.front();
+        if (front.readSize() >= nrBytes) {
+            // Common case, the data is already contiguous.
+            [[likely]] return front.readable();
+
+        } else if (front.capacity() >= nrBytes) {
+            // Move the missing bytes of the next packets behind the data of the first packet.
+            front.compact();
+            while (packets.front().readSize() < nrBytes) {
+                // Erasing the second packet may move the first packet, so it is looked up each time.
+                auto &first = packets[0];
+                auto &next = packets[1];
+                ttlet size = std::min(next.readSize(), nrBytes - first.readSize());
+                std::memcpy(first.end(), next.begin(), size);
+                first.write(size);
+                next.read(size);
+                if (next.readSize() == 0) {
+                    packets.erase(packets.begin() + 1);
+                }
             }
 
-            // Check if we can merge packets.
-            tt_assert(packets.front().size() >= nrBytes);
-
-            // Merge data from next packet.
+        } else {
+            // Merge the data of the first packets into a single large packet.
+            auto merged = packet{nrBytes};
+            while (merged.readSize() < nrBytes) {
+                auto &first = packets.front();
+                ttlet size = std::min(first.readSize(), nrBytes - merged.readSize());
+                std::memcpy(merged.end(), first.begin(), size);
+                merged.write(size);
+                first.read(size);
+                if (first.readSize() == 0) {
+                    packets.pop_front();
+                }
+            }
+            packets.push_front(std::move(merged));
         }
+
+        return packets.front().readable();
     }
 
     /** Peek into the data a single text-line without consuming.
@@ -108,30 +152,40 @@ public:
      *         The line-feed or nul is included at the end of the string.
      */
     std::string_view peekLine(ssize_t nrBytes=1024) {
-        ssize_t packetNr = 0;
         ssize_t byteNr = 0;
-        ssize_t i = 0;
-        while (packetNr < nrpackets()) {
-            tt_parse_check(byteNr < nrBytes, "New-line not found within {} bytes", nrBytes);
-
-            if (i == std::ssize(packets[packetNr])) {
-                // Advance to next packet.
-                ++packetNr;
-                i = 0;
+        for (ttlet &packet: packets) {
+            for (ttlet c: packet.readable()) {
+                tt_parse_check(byteNr < nrBytes, "New-line not found within {} bytes", nrBytes);
+
+                if (c == std::byte{'\n'} || c == std::byte{'\0'}) {
+                    // Found end-of-line
+                    ttlet bspan = peek(byteNr + 1);
+                    return {reinterpret_cast<char const *>(bspan.data()), static_cast<size_t>(byteNr + 1)};
+                }
+                ++byteNr;
             }
-
-            ttlet c = packets[packetNr][i]
-            if (c == '\n' || c == '\0') {
-                // Found end-of-line
-                ttlet bspan = peek(byteNr + 1);
-                return {reinterpret_cast<char *>(bspan.data(), byteNr + 1};
-            }
-            ++i;
-            ++byteNr;
         }
 
         // Not enough bytes read yet.
-        return {}
+        return {};
+    }
+
+    /** The data of the first packets, for writing to a socket with a single gather-write.
+     *
+     * @param spans The spans to fill in with the data of each packet.
+     * @return The number of spans filled in.
+     */
+    ssize_t peekPackets(std::span<std::span<std::byte const>> spans) const noexcept {
+        ssize_t i = 0;
+        for (ttlet &packet: packets) {
+            if (i == std::ssize(spans)) {
+                break;
+            }
+            if (packet.readSize() > 0) {
+                spans[i++] = packet.readable();
+            }
+        }
+        return i;
     }
 
     /** Consume the data from the buffer.
@@ -141,23 +195,26 @@ public:
      * @param nrBytes The number of bytes to consume.
      */
     void read(ssize_t nrBytes) noexcept {
-        peekBuffer.clear();
+        tt_axiom(nrBytes <= _totalNrBytes);
+        _totalNrBytes -= nrBytes;
 
         while (nrBytes) {
-            ttlet packet_size = std::ssize(packets.front());
-            if (nrBytes >= packet_size) {
-                packets.pop_front();
-            } else {
-                packets.front().read(nrBytes);
-                tt_axiom(std::ssize(packets.front()) > 0);
+            auto &front = packets.front();
+            ttlet size = std::min(front.readSize(), nrBytes);
+            front.read(size);
+            nrBytes -= size;
+
+            if (front.readSize() == 0) {
+                if (std::ssize(packets) > 1) {
+                    packets.pop_front();
+                } else {
+                    // Keep the last packet and reuse it from the start, so that a stream
+                    // which is read as fast as it is written cycles through a single packet.
+                    front.compact();
+                }
             }
-            nrBytes -= std::ssize(packets_size);
         }
     }
-
-
 };
 
-
 }
-
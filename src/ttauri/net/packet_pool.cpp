@@ -0,0 +1,68 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "packet_pool.hpp"
+#include "../counters.hpp"
+#include "../os_detect.hpp"
+#include <new>
+
+namespace tt {
+
+void packet_pool::refill(thread_cache_type &cache) noexcept
+{
+    {
+        ttlet lock = std::scoped_lock(mutex);
+        while (head != nullptr && cache.count != batch_size) {
+            auto block = head;
+            head = block->next;
+            block->next = cache.head;
+            cache.head = block;
+            ++cache.count;
+        }
+    }
+
+    if (cache.head == nullptr) {
+        // The slab is carved into blocks directly into the cache of this thread.
+        increment_counter<"packet_pool_slab">();
+        auto slab = static_cast<std::byte *>(
+            ::operator new(batch_size * block_size, std::align_val_t{hardware_destructive_interference_size}));
+
+        for (ssize_t i = 0; i != batch_size; ++i) {
+            cache.head = new (slab + i * block_size) free_block{cache.head};
+        }
+        cache.count = batch_size;
+    }
+}
+
+void packet_pool::flush(thread_cache_type &cache, ssize_t nr_blocks) noexcept
+{
+    if (nr_blocks == 0) {
+        return;
+    }
+
+    // Split off the least recently freed blocks as a chain, which can be linked in with a single lock.
+    auto first = cache.head;
+    free_block *previous = nullptr;
+    for (ssize_t i = nr_blocks; i != cache.count; ++i) {
+        previous = first;
+        first = first->next;
+    }
+    if (previous != nullptr) {
+        previous->next = nullptr;
+    } else {
+        cache.head = nullptr;
+    }
+    cache.count -= nr_blocks;
+
+    auto last = first;
+    while (last->next != nullptr) {
+        last = last->next;
+    }
+
+    ttlet lock = std::scoped_lock(mutex);
+    last->next = head;
+    head = first;
+}
+
+} // namespace tt
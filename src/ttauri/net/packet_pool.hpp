@@ -0,0 +1,103 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "../required.hpp"
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace tt {
+
+/** A pool of fixed-size blocks for the data of packets.
+ *
+ * Each thread has a small cache of free blocks, so that allocating and freeing
+ * a block normally does not need a lock. When a thread's cache is empty it takes
+ * a batch of blocks from the global free list, or carves a new slab; when the cache
+ * is full, because blocks are allocated on one thread and freed on another, a batch
+ * is returned to the global free list.
+ *
+ * Slabs are never returned to the operating system; the number of blocks is bounded
+ * by the maximum number of packets in flight.
+ */
+class packet_pool {
+public:
+    /** The size of each block.
+     * Packets which are larger are allocated on the heap.
+     */
+    static constexpr ssize_t block_size = 16384;
+
+    /** The number of blocks moved between a thread's cache and the global free list at once.
+     */
+    static constexpr ssize_t batch_size = 32;
+
+    /** The maximum number of free blocks in the cache of a thread.
+     */
+    static constexpr ssize_t max_nr_cached = 2 * batch_size;
+
+    /** Allocate a block of `block_size` bytes.
+     */
+    [[nodiscard]] static std::byte *allocate() noexcept
+    {
+        auto &cache = thread_cache();
+        if (cache.head == nullptr) {
+            [[unlikely]] refill(cache);
+        }
+
+        auto block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+        return reinterpret_cast<std::byte *>(block);
+    }
+
+    /** Return a block to the pool.
+     * The block may be freed on a different thread than where it was allocated.
+     */
+    static void deallocate(std::byte *ptr) noexcept
+    {
+        auto &cache = thread_cache();
+
+        auto block = new (ptr) free_block{cache.head};
+        cache.head = block;
+        if (++cache.count > max_nr_cached) {
+            [[unlikely]] flush(cache, batch_size);
+        }
+    }
+
+private:
+    struct free_block {
+        free_block *next;
+    };
+
+    struct thread_cache_type {
+        free_block *head = nullptr;
+        ssize_t count = 0;
+
+        ~thread_cache_type()
+        {
+            flush(*this, count);
+        }
+    };
+
+    inline static std::mutex mutex;
+    inline static free_block *head = nullptr;
+
+    [[nodiscard]] static thread_cache_type &thread_cache() noexcept
+    {
+        thread_local thread_cache_type cache;
+        return cache;
+    }
+
+    /** Move a batch of blocks from the global free list into the cache.
+     * A new slab is allocated when the global free list is empty.
+     */
+    static void refill(thread_cache_type &cache) noexcept;
+
+    /** Move blocks from the cache to the global free list.
+     */
+    static void flush(thread_cache_type &cache, ssize_t nr_blocks) noexcept;
+};
+
+} // namespace tt
@@ -0,0 +1,197 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/net/packet_pool.hpp"
+#include "ttauri/net/packet_buffer.hpp"
+#include "ttauri/wfree_spsc_queue.hpp"
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <set>
+#include <cstring>
+
+using namespace std;
+using namespace tt;
+
+TEST(packet_pool, allocate_deallocate)
+{
+    auto blocks = std::vector<std::byte *>{};
+    for (int i = 0; i != 1000; ++i) {
+        auto block = packet_pool::allocate();
+        std::memset(block, i & 0xff, packet_pool::block_size);
+        blocks.push_back(block);
+    }
+
+    // All blocks are distinct and do not overlap.
+    ttlet unique_blocks = std::set<std::byte *>(blocks.begin(), blocks.end());
+    ASSERT_EQ(std::ssize(unique_blocks), 1000);
+    for (int i = 0; i != 1000; ++i) {
+        ASSERT_EQ(blocks[i][0], static_cast<std::byte>(i & 0xff));
+        ASSERT_EQ(blocks[i][packet_pool::block_size - 1], static_cast<std::byte>(i & 0xff));
+    }
+
+    for (ttlet block : blocks) {
+        packet_pool::deallocate(block);
+    }
+
+    // A freed block is reused.
+    ttlet block = packet_pool::allocate();
+    ASSERT_EQ(block, blocks.back());
+    packet_pool::deallocate(block);
+}
+
+static void write_bytes(packet_buffer &buffer, ssize_t nr_bytes, char c)
+{
+    auto data = buffer.getNewpacket(nr_bytes);
+    std::memset(data.data(), c, nr_bytes);
+    buffer.write(nr_bytes);
+}
+
+TEST(packet_buffer, peek_in_place)
+{
+    auto buffer = packet_buffer{};
+    write_bytes(buffer, 100, 'a');
+    write_bytes(buffer, 100, 'b');
+    write_bytes(buffer, 100, 'c');
+    ASSERT_EQ(buffer.nrpackets(), 3);
+
+    // Within a packet, the data is returned without copying.
+    ttlet first = buffer.peek(10);
+    ASSERT_EQ(std::ssize(first), 100);
+
+    // Straddling packets, the data is moved into the free space of the first packet.
+    ttlet merged = buffer.peek(250);
+    ASSERT_EQ(merged.data(), first.data());
+    ASSERT_EQ(std::ssize(merged), 250);
+    ASSERT_EQ(merged[99], std::byte{'a'});
+    ASSERT_EQ(merged[100], std::byte{'b'});
+    ASSERT_EQ(merged[249], std::byte{'c'});
+    ASSERT_EQ(buffer.nrpackets(), 2);
+    ASSERT_EQ(buffer.nrBytes(), 300);
+
+    buffer.read(300);
+    ASSERT_EQ(buffer.nrBytes(), 0);
+    ASSERT_TRUE(buffer.peek(1).empty());
+
+    // The last packet is reused from the start.
+    ASSERT_EQ(buffer.nrpackets(), 1);
+    ttlet data = buffer.getpacket(packet_pool::block_size);
+    ASSERT_EQ(std::ssize(data), packet_pool::block_size);
+    ASSERT_EQ(buffer.nrpackets(), 1);
+}
+
+TEST(packet_buffer, peek_line)
+{
+    auto buffer = packet_buffer{};
+    auto text = std::string_view{"Hello World\nfoo"};
+    for (ttlet c : text) {
+        auto data = buffer.getNewpacket(1);
+        data[0] = static_cast<std::byte>(c);
+        buffer.write(1);
+    }
+
+    ASSERT_EQ(buffer.peekLine(), "Hello World\n");
+    buffer.read(12);
+    ASSERT_EQ(buffer.peekLine(), "");
+    ASSERT_EQ(buffer.nrBytes(), 3);
+}
+
+struct heap_allocator {
+    [[nodiscard]] static std::byte *allocate() noexcept
+    {
+        return new std::byte[packet_pool::block_size];
+    }
+
+    static void deallocate(std::byte *ptr) noexcept
+    {
+        delete[] ptr;
+    }
+};
+
+template<typename Allocator>
+static void allocate_benchmark(char const *name)
+{
+    constexpr int nr_iterations = 1000000;
+    constexpr int nr_in_flight = 64;
+
+    auto blocks = std::array<std::byte *, nr_in_flight>{};
+    for (auto &block : blocks) {
+        block = Allocator::allocate();
+    }
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i != nr_iterations; ++i) {
+        auto &block = blocks[i % nr_in_flight];
+        Allocator::deallocate(block);
+        block = Allocator::allocate();
+        block[0] = std::byte{1};
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    for (auto block : blocks) {
+        Allocator::deallocate(block);
+    }
+
+    ttlet duration = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    std::cout << fmt::format("{}: {:.1f} ns per allocate/deallocate\n", name, duration / nr_iterations);
+}
+
+/** Allocate blocks on producer threads, and free them on consumer threads.
+ */
+template<typename Allocator>
+static void producer_consumer_benchmark(char const *name)
+{
+    constexpr int nr_pairs = 2;
+    constexpr int nr_blocks = 500000;
+
+    using queue_type = wfree_spsc_queue<std::byte *, 1024>;
+    auto queues = std::vector<std::unique_ptr<queue_type>>{};
+    for (int i = 0; i != nr_pairs; ++i) {
+        queues.push_back(std::make_unique<queue_type>());
+    }
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    auto threads = std::vector<std::thread>{};
+    for (int i = 0; i != nr_pairs; ++i) {
+        threads.emplace_back([&queue = *queues[i]] {
+            for (int j = 0; j != nr_blocks; ++j) {
+                auto block = Allocator::allocate();
+                block[0] = std::byte{1};
+                queue.write_start() = block;
+                queue.write_finish();
+            }
+        });
+
+        threads.emplace_back([&queue = *queues[i]] {
+            for (int j = 0; j != nr_blocks;) {
+                if (ttlet block = queue.front()) {
+                    Allocator::deallocate(*block);
+                    queue.pop_front();
+                    ++j;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    ttlet duration = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << fmt::format(
+        "{}: {} producer/consumer pairs, {:.1f} M blocks/s\n", name, nr_pairs, nr_pairs * nr_blocks / duration / 1'000'000.0);
+}
+
+TEST(packet_pool, benchmark)
+{
+    allocate_benchmark<heap_allocator>("heap");
+    allocate_benchmark<packet_pool>("packet_pool");
+    producer_consumer_benchmark<heap_allocator>("heap");
+    producer_consumer_benchmark<packet_pool>("packet_pool");
+}
@@ -5,49 +5,73 @@
 
 #pragma once
 
+#include "packet_buffer.hpp"
+
 namespace tt {
 
+class epoll_reactor;
+
+/** A stream over a socket.
+ *
+ * The socket is driven by an event loop, which reads from the socket into `readBuffer` and
+ * writes `writeBuffer` to the socket. A protocol is implemented by overriding the
+ * event handlers, which consume the read-buffer and fill in the write-buffer.
+ */
 class Socketstream {
 
 protected:
     bool connecting = false;
 
     /** Buffer with data read from the socket.
+     * Closed when the other side closed the connection.
      */
     packet_buffer readBuffer;
 
     /** Buffer with data to write.
+     * Close to close the connection after all data has been written.
      */
     packet_buffer writeBuffer;
 
 public:
+    Socketstream() noexcept = default;
+    virtual ~Socketstream() = default;
+
+    Socketstream(Socketstream const &) = delete;
+    Socketstream(Socketstream &&) = delete;
+    Socketstream &operator=(Socketstream const &) = delete;
+    Socketstream &operator=(Socketstream &&) = delete;
 
     /** Handle connected event.
      */
-    void handleConnect();
+    virtual void handleConnect() {
+        connecting = false;
+    }
 
     /** Check if the socket-stream needs to read.
      */
-    virtual bool needToRead();
+    virtual bool needToRead() {
+        return !readBuffer.closed();
+    }
 
-    /** Check if the socket-stream needs to read.
+    /** Check if the socket-stream needs to write.
      */
-    virtual bool needToWrite();
+    virtual bool needToWrite() {
+        return writeBuffer.nrBytes() > 0;
+    }
 
     /** Handle ready-to-read event.
-     *
+     * Called after new data has been added to the read-buffer, or when the
+     * read-buffer was closed.
      */
-    [[nodiscard]] virtual void handleReadyToReadEvent();
+    virtual void handleReadyToReadEvent() = 0;
 
     /** Handle ready-to-write event.
-     *
+     * Called when all data in the write-buffer has been written and the socket
+     * is ready to accept more data.
      */
-    [[nodiscard]] virtual void handleReadyToWriteEvent();
+    virtual void handleReadyToWriteEvent() {}
 
+    friend epoll_reactor;
+};
 
 }
-
-
-
-}
-
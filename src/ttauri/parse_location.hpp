@@ -102,6 +102,10 @@ public:
         ++_column;
     }
 
+    void increment_column(int count) noexcept {
+        _column += count;
+    }
+
     void tab_column() noexcept {
         _column /= 8;
         _column += 1;
@@ -0,0 +1,121 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "unfair_mutex.hpp"
+#include "os_detect.hpp"
+#include <unordered_map>
+#include <array>
+#include <mutex>
+#include <utility>
+#include <bit>
+
+namespace tt {
+
+/** A thread-safe unordered map, used as a cache.
+ *
+ * The map is split in shards, each with its own mutex, so that threads
+ * looking up different keys seldom contend for the same lock.
+ * Values are returned by copy, since the item may be removed by `clear()`
+ * by another thread.
+ *
+ * @tparam Key The type of the key.
+ * @tparam T The type of the value.
+ * @tparam NrShards The number of shards, must be a power of two.
+ */
+template<typename Key, typename T, size_t NrShards = 16, typename Hash = std::hash<Key>>
+class sharded_unordered_map {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    static constexpr size_t nr_shards = NrShards;
+
+    static_assert(std::has_single_bit(nr_shards));
+
+    sharded_unordered_map() noexcept = default;
+    sharded_unordered_map(sharded_unordered_map const &) = delete;
+    sharded_unordered_map(sharded_unordered_map &&) = delete;
+    sharded_unordered_map &operator=(sharded_unordered_map const &) = delete;
+    sharded_unordered_map &operator=(sharded_unordered_map &&) = delete;
+
+    /** Find a value, or create and insert it.
+     *
+     * The function that creates the value is called without holding a lock,
+     * so that slow functions do not block other threads. When two threads
+     * create a value for the same key at the same time, the first value
+     * inserted is kept and returned to both.
+     *
+     * @param key The key to find.
+     * @param create A function returning the value for `key`, called when the key is not found.
+     * @return The value, and true if the value was found in the map.
+     */
+    template<typename Create>
+    [[nodiscard]] std::pair<mapped_type, bool> get_or_create(key_type const &key, Create &&create)
+    {
+        auto &shard = get_shard(key);
+        {
+            ttlet lock = std::scoped_lock(shard.mutex);
+            ttlet i = shard.items.find(key);
+            if (i != shard.items.end()) {
+                return {i->second, true};
+            }
+        }
+
+        auto value = std::forward<Create>(create)();
+
+        ttlet lock = std::scoped_lock(shard.mutex);
+        ttlet [i, inserted] = shard.items.try_emplace(key, std::move(value));
+        return {i->second, false};
+    }
+
+    /** Remove all items.
+     */
+    void clear() noexcept
+    {
+        for (auto &shard : shards) {
+            ttlet lock = std::scoped_lock(shard.mutex);
+            shard.items.clear();
+        }
+    }
+
+    /** The number of items in the map.
+     * The result may be outdated when other threads are inserting items.
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        size_t r = 0;
+        for (auto &shard : shards) {
+            ttlet lock = std::scoped_lock(shard.mutex);
+            r += shard.items.size();
+        }
+        return r;
+    }
+
+private:
+    // Each shard is on its own cache line to prevent false sharing of the mutexes.
+    struct alignas(hardware_destructive_interference_size) shard_type {
+        mutable unfair_mutex mutex;
+        std::unordered_map<key_type, mapped_type, Hash> items;
+    };
+
+    std::array<shard_type, nr_shards> shards;
+
+    [[nodiscard]] shard_type &get_shard(key_type const &key) noexcept
+    {
+        // The low bits of the hash select the bucket inside the std::unordered_map,
+        // mix the hash so that the shard is selected from different bits.
+        constexpr auto shard_shift = 64 - std::countr_zero(nr_shards);
+        ttlet hash = static_cast<uint64_t>(Hash{}(key)) * 0x9e37'79b9'7f4a'7c15ULL;
+
+        if constexpr (nr_shards == 1) {
+            return shards[0];
+        } else {
+            return shards[static_cast<size_t>(hash >> shard_shift)];
+        }
+    }
+};
+
+} // namespace tt
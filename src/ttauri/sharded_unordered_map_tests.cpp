@@ -0,0 +1,55 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/sharded_unordered_map.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+using namespace tt;
+
+TEST(sharded_unordered_map, get_or_create)
+{
+    sharded_unordered_map<int, int> map;
+
+    ASSERT_EQ(map.get_or_create(1, [] { return 10; }), std::pair(10, false));
+    ASSERT_EQ(map.get_or_create(2, [] { return 20; }), std::pair(20, false));
+    ASSERT_EQ(map.get_or_create(1, [] { return 30; }), std::pair(10, true));
+    ASSERT_EQ(map.size(), 2);
+
+    map.clear();
+    ASSERT_EQ(map.size(), 0);
+    ASSERT_EQ(map.get_or_create(1, [] { return 30; }), std::pair(30, false));
+}
+
+TEST(sharded_unordered_map, threads)
+{
+    constexpr int nr_keys = 1000;
+    constexpr int nr_threads = 4;
+
+    sharded_unordered_map<int, int> map;
+    std::atomic<int> nr_created = 0;
+
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t != nr_threads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i != nr_keys; ++i) {
+                ttlet [value, found] = map.get_or_create(i, [&] {
+                    ++nr_created;
+                    return i * 2;
+                });
+                ASSERT_EQ(value, i * 2);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(map.size(), nr_keys);
+    // A value may be created more than once when threads race on the same key.
+    ASSERT_GE(nr_created.load(), nr_keys);
+}
@@ -20,6 +20,8 @@
 #include "../formula/formula.hpp"
 #include "../strings.hpp"
 #include "../algorithm.hpp"
+#include <mutex>
+#include <unordered_map>
 
 namespace tt {
 
@@ -231,4 +233,24 @@ static void parse_skeleton_escape(skeleton_parse_context &context)
     return top;
 }
 
+static std::mutex skeleton_cache_mutex;
+static std::unordered_map<URL, std::shared_ptr<skeleton_node>> skeleton_cache;
+
+[[nodiscard]] std::shared_ptr<skeleton_node> load_skeleton(URL const &url)
+{
+    ttlet lock = std::scoped_lock(skeleton_cache_mutex);
+
+    auto &r = skeleton_cache[url];
+    if (!r) {
+        r = parse_skeleton(url);
+    }
+    return r;
+}
+
+void clear_skeleton_cache() noexcept
+{
+    ttlet lock = std::scoped_lock(skeleton_cache_mutex);
+    skeleton_cache.clear();
+}
+
 }
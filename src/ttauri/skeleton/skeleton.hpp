@@ -7,6 +7,7 @@
 #include "skeleton_node.hpp"
 #include "skeleton_parse_context.hpp"
 #include "../resource_view.hpp"
+#include <memory>
 
 namespace tt {
 
@@ -31,4 +32,18 @@ namespace tt {
     return parse_skeleton(std::move(url), sv.cbegin(), sv.cend());
 }
 
+/** Load and parse a skeleton template file, or get the previously parsed template.
+ * Each file is parsed only once, so that a template that is rendered repeatedly
+ * skips parsing and compiling of its expressions.
+ *
+ * @param url The location of the template file.
+ * @return The parsed template, shared with other users of the same template.
+ */
+[[nodiscard]] std::shared_ptr<skeleton_node> load_skeleton(URL const &url);
+
+/** Forget all templates loaded by `load_skeleton()`.
+ * Used when template files have been modified.
+ */
+void clear_skeleton_cache() noexcept;
+
 }
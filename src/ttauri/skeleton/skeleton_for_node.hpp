@@ -11,6 +11,7 @@ namespace tt {
 struct skeleton_for_node final: skeleton_node {
     std::unique_ptr<formula_node> name_expression;
     std::unique_ptr<formula_node> list_expression;
+    std::optional<formula_program> list_program;
     bool has_else = false;
     statement_vector children;
     statement_vector else_children;
@@ -48,6 +49,7 @@ struct skeleton_for_node final: skeleton_node {
 
         post_process_expression(context, *name_expression, location);
         post_process_expression(context, *list_expression, location);
+        list_program.emplace(*list_expression);
 
         for (ttlet &child: children) {
             child->post_process(context);
@@ -58,7 +60,7 @@ struct skeleton_for_node final: skeleton_node {
     }
 
     datum evaluate(formula_evaluation_context &context) override {
-        auto list_data = evaluate_formula_without_output(context, *list_expression, location);
+        auto list_data = evaluate_formula_without_output(context, *list_program, location);
 
         if (!list_data.is_vector()) {
             tt_error_info().set<"parse_location">(location);
@@ -72,7 +72,7 @@ struct skeleton_function_node final: skeleton_node {
             context.set(argument_names[i], arguments[i]);
         }
 
-        ttlet output_size = context.output_size();
+        ttlet hold = formula_evaluation_context::output_hold_guard{context};
         auto tmp = evaluate_children(context, children);
         context.pop();
 
@@ -89,7 +89,7 @@ struct skeleton_function_node final: skeleton_node {
 
         } else {
             // When a function returns, it should not have written data to the output.
-            context.set_output_size(output_size);
+            context.set_output_size(hold.output_size);
             return tmp;
         }
     }
@@ -11,6 +11,7 @@ namespace tt {
 struct skeleton_if_node final: skeleton_node {
     std::vector<statement_vector> children_groups;
     std::vector<std::unique_ptr<formula_node>> expressions;
+    std::vector<formula_program> programs;
     std::vector<parse_location> formula_locations;
 
     skeleton_if_node(parse_location location, std::unique_ptr<formula_node> expression) noexcept :
@@ -52,6 +53,7 @@ struct skeleton_if_node final: skeleton_node {
         tt_assert(std::ssize(expressions) == std::ssize(formula_locations));
         for (ssize_t i = 0; i != std::ssize(expressions); ++i) {
             post_process_expression(context, *expressions[i], formula_locations[i]);
+            programs.emplace_back(*expressions[i]);
         }
 
         for (ttlet &children: children_groups) {
@@ -66,9 +68,9 @@ struct skeleton_if_node final: skeleton_node {
     }
 
     datum evaluate(formula_evaluation_context &context) override {
-        tt_axiom(std::ssize(expressions) == std::ssize(formula_locations));
-        for (ssize_t i = 0; i != std::ssize(expressions); ++i) {
-            if (evaluate_formula_without_output(context, *expressions[i], formula_locations[i])) {
+        tt_axiom(std::ssize(programs) == std::ssize(formula_locations));
+        for (ssize_t i = 0; i != std::ssize(programs); ++i) {
+            if (evaluate_formula_without_output(context, programs[i], formula_locations[i])) {
                 return evaluate_children(context, children_groups[i]);
             }
         }
@@ -5,8 +5,10 @@
 #pragma once
 
 #include "../formula/formula.hpp"
+#include "../formula/formula_program.hpp"
 #include "../strings.hpp"
 #include "../algorithm.hpp"
+#include "../file.hpp"
 #include <memory>
 #include <string_view>
 #include <optional>
@@ -53,7 +55,30 @@ struct skeleton_node {
         tt_no_default();
     }
 
-    [[nodiscard]] std::string evaluate_output(formula_evaluation_context &context) {
+    /** Evaluate the template, writing the text to a sink.
+    * The text is passed to the sink in chunks while the template is evaluated,
+    * so that large output does not need to be buffered completely.
+    *
+    * @param context Data used by expressions inside the template statements.
+    * @param sink A function that is called with each chunk of text.
+    */
+    void evaluate_output(formula_evaluation_context &context, formula_evaluation_context::output_sink_type sink) {
+        // The sink may capture objects of the caller, so it must not outlive this call,
+        // not even when evaluation throws. Output that was not flushed is discarded.
+        struct output_sink_reset {
+            formula_evaluation_context &context;
+
+            ~output_sink_reset() {
+                context.output_sink = {};
+                context.output_hold_count = 0;
+                context.output.clear();
+            }
+        };
+
+        context.output_sink = std::move(sink);
+        context.output_hold_count = 0;
+        ttlet reset = output_sink_reset{context};
+
         auto tmp = evaluate(context);
         if (tmp.is_break()) {
             tt_error_info().set<"parse_location">(location);
@@ -63,13 +88,34 @@ struct skeleton_node {
             tt_error_info().set<"parse_location">(location);
             throw operation_error("Found #continue not inside a loop statement.");
 
-        } else if (tmp.is_undefined()) {
-            return std::move(context.output);
-
-        } else {
+        } else if (!tmp.is_undefined()) {
             tt_error_info().set<"parse_location">(location);
             throw operation_error("Found #return not inside a function.");
         }
+
+        context.flush_output();
+    }
+
+    /** Evaluate the template, appending the text to a buffer.
+    */
+    void evaluate_output(formula_evaluation_context &context, std::string &buffer) {
+        evaluate_output(context, [&buffer](std::string_view text) {
+            buffer += text;
+        });
+    }
+
+    /** Evaluate the template, writing the text to a file.
+    */
+    void evaluate_output(formula_evaluation_context &context, file &output_file) {
+        evaluate_output(context, [&output_file](std::string_view text) {
+            output_file.write(text.data(), std::ssize(text));
+        });
+    }
+
+    [[nodiscard]] std::string evaluate_output(formula_evaluation_context &context) {
+        auto r = std::string{};
+        evaluate_output(context, r);
+        return r;
     }
 
     [[nodiscard]] std::string evaluate_output() {
@@ -96,7 +142,10 @@ struct skeleton_node {
         children.push_back(std::move(new_child));
     }
 
-    [[nodiscard]] static datum evaluate_formula_without_output(formula_evaluation_context &context, formula_node const &expression, parse_location const &location) {
+    /** Evaluate a formula_node or formula_program, adding the location of the statement to errors.
+    */
+    template<typename Formula>
+    [[nodiscard]] static datum evaluate_formula_without_output(formula_evaluation_context &context, Formula const &expression, parse_location const &location) {
         try {
             return expression.evaluate_without_output(context);
 
@@ -110,7 +159,8 @@ struct skeleton_node {
         }
     }
 
-    [[nodiscard]] static datum evaluate_expression(formula_evaluation_context &context, formula_node const &expression, parse_location const &location) {
+    template<typename Formula>
+    [[nodiscard]] static datum evaluate_expression(formula_evaluation_context &context, Formula const &expression, parse_location const &location) {
         try {
             return expression.evaluate(context);
 
@@ -10,6 +10,7 @@ namespace tt {
 
 struct skeleton_placeholder_node final : skeleton_node {
     std::unique_ptr<formula_node> expression;
+    std::optional<formula_program> program;
 
     skeleton_placeholder_node(parse_location location, std::unique_ptr<formula_node> expression) :
         skeleton_node(std::move(location)), expression(std::move(expression))
@@ -25,6 +26,7 @@ struct skeleton_placeholder_node final : skeleton_node {
     {
         try {
             expression->post_process(context);
+            program.emplace(*expression);
 
         } catch (...) {
             auto error_location = location;
@@ -43,9 +45,9 @@ struct skeleton_placeholder_node final : skeleton_node {
 
     datum evaluate(formula_evaluation_context &context) override
     {
-        ttlet output_size = context.output_size();
+        ttlet hold = formula_evaluation_context::output_hold_guard{context};
+        ttlet tmp = evaluate_expression(context, *program, location);
 
-        ttlet tmp = evaluate_expression(context, *expression, location);
         if (tmp.is_break()) {
             tt_error_info().set<"parse_location">(location);
             throw operation_error("Found #break not inside a loop statement.");
@@ -59,7 +61,7 @@ struct skeleton_placeholder_node final : skeleton_node {
 
         } else {
             // When a function returns, it should not have written data to the output.
-            context.set_output_size(output_size);
+            context.set_output_size(hold.output_size);
             context.write(static_cast<std::string>(tmp));
             return {};
         }
@@ -6,6 +6,9 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <chrono>
+#include <fmt/format.h>
 
 using namespace std;
 using namespace tt;
@@ -447,3 +450,119 @@ TEST(skeleton, Include) {
         ">"
     );
 }
+
+/** A template that renders a table, with a function returning a value in each cell.
+ */
+constexpr auto table_skeleton = std::string_view{
+    "<table>\n"
+    "#function cell(x, y)\n"
+    "    ignored text\n"
+    "    #return x * 1000 + y\n"
+    "#end\n"
+    "#for row : rows\n"
+    "  <tr class=\"${$first ? \"first\" : \"other\"}\">\n"
+    "    #for column : columns\n"
+    "    <td>${row}.${column}: ${cell(row, column)}</td>\n"
+    "    #end\n"
+    "  </tr>\n"
+    "#end\n"
+    "</table>\n"};
+
+[[nodiscard]] static formula_evaluation_context make_table_context(int nr_rows, int nr_columns)
+{
+    auto rows = datum::vector{};
+    for (int i = 0; i != nr_rows; ++i) {
+        rows.emplace_back(i);
+    }
+    auto columns = datum::vector{};
+    for (int i = 0; i != nr_columns; ++i) {
+        columns.emplace_back(i);
+    }
+
+    auto context = formula_evaluation_context{};
+    context.set_global("rows", datum{std::move(rows)});
+    context.set_global("columns", datum{std::move(columns)});
+    return context;
+}
+
+TEST(skeleton, OutputSink) {
+    ttlet t = parse_skeleton(URL("none:"), table_skeleton);
+
+    auto context = make_table_context(1000, 10);
+    ttlet expected = t->evaluate_output(context);
+    ASSERT_GT(std::ssize(expected), formula_evaluation_context::output_flush_threshold * 3);
+    ASSERT_NE(expected.find("<td>999.9: 999009</td>"), std::string::npos);
+    ASSERT_EQ(expected.find("ignored"), std::string::npos);
+
+    // The output is passed to the sink in chunks, without being kept in the context.
+    auto chunks = std::vector<std::string>{};
+    context = make_table_context(1000, 10);
+    t->evaluate_output(context, [&chunks](std::string_view text) {
+        chunks.emplace_back(text);
+    });
+    ASSERT_GT(std::ssize(chunks), 1);
+    ASSERT_EQ(join(chunks), expected);
+    ASSERT_EQ(context.output, "");
+
+    // Append to an existing buffer.
+    auto buffer = std::string{"header\n"};
+    context = make_table_context(1000, 10);
+    t->evaluate_output(context, buffer);
+    ASSERT_EQ(buffer, "header\n" + expected);
+}
+
+TEST(skeleton, OutputSinkException) {
+    // The #break throws while the output is held by both the placeholder and the function.
+    ttlet t = parse_skeleton(URL("none:"),
+        "foo\n"
+        "#function fail()\n"
+        "#break\n"
+        "#end\n"
+        "${fail()}\n"
+    );
+
+    auto context = formula_evaluation_context{};
+    try {
+        static_cast<void>(t->evaluate(context));
+        FAIL();
+    } catch (operation_error const &) {
+        error_info::close();
+    }
+    ASSERT_EQ(context.output_hold_count, 0);
+
+    try {
+        auto buffer = std::string{};
+        t->evaluate_output(context, buffer);
+        FAIL();
+    } catch (operation_error const &) {
+        error_info::close();
+    }
+
+    // The sink captured the destroyed buffer, it must have been removed from the context.
+    ASSERT_FALSE(context.output_sink);
+    ASSERT_EQ(context.output_hold_count, 0);
+    ASSERT_EQ(context.output, "");
+}
+
+TEST(skeleton, Benchmark) {
+    constexpr int nr_renders = 10;
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    ttlet t = parse_skeleton(URL("none:"), table_skeleton);
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    ssize_t size = 0;
+    for (int i = 0; i != nr_renders; ++i) {
+        auto context = make_table_context(1000, 20);
+        t->evaluate_output(context, [&size](std::string_view text) {
+            size += std::ssize(text);
+        });
+    }
+    ttlet t2 = std::chrono::steady_clock::now();
+
+    ttlet parse_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet render_duration = std::chrono::duration<double>(t2 - t1).count();
+
+    std::cout << fmt::format(
+        "parse: {:.1f} us, render: {:.1f} MByte/s\n", parse_duration * 1e6, static_cast<double>(size) / render_duration / 1e6);
+}
@@ -30,27 +30,30 @@ attributed_glyph::attributed_glyph(attributed_grapheme const &attr_grapheme, att
     // then the language of the requested font.
     ttlet actual_font_id = glyphs.font_id();
 
-    // Load the metrics for this attributed glyph.
-    ttlet font = &(font_book::global->get_font(actual_font_id));
-    tt_axiom(font != nullptr);
-
     // Get the metrics of the main glyph.
     ttlet this_glyph = glyphs.front();
+    ttlet this_metrics = font_book::global->get_glyph_metrics(actual_font_id, this_glyph);
+
+    if (this_metrics) {
+        metrics = *this_metrics;
 
-    // If the next glyph is of the same font, then use it for kerning reasons.
-    ttlet next_glyph = (next_attr_glyph && next_attr_glyph->glyphs.font_id() == actual_font_id) ?
-        next_attr_glyph->glyphs.front() :
-        glyph_id{};
+        // If the next glyph is of the same font, then use it for kerning reasons.
+        if (next_attr_glyph && next_attr_glyph->glyphs.font_id() == actual_font_id) {
+            metrics.advance += font_book::global->get_kerning(actual_font_id, this_glyph, next_attr_glyph->glyphs.front());
+        }
 
-    if (!font->loadglyph_metrics(this_glyph, metrics, next_glyph)) {
-        tt_log_error("Could not load metrics for glyph {} in font {} - {}", static_cast<int>(this_glyph), font->description.family_name, font->description.sub_family_name);
+    } else {
+        ttlet &font = font_book::global->get_font(actual_font_id);
+        tt_log_error("Could not load metrics for glyph {} in font {} - {}", static_cast<int>(this_glyph), font.description.family_name, font.description.sub_family_name);
         // failed to load metrics. Switch to glyph zero and load again.
         glyphs.clear();
         glyphs.set_font_id(style_font_id);
         glyphs += glyph_id{0};
-        if (!font->loadglyph_metrics(glyphs.front(), metrics)) {
+        if (auto null_metrics = font_book::global->get_glyph_metrics(style_font_id, glyphs.front())) {
+            metrics = *null_metrics;
+        } else {
             // Using null-metrics when even the null-glyph can not be found.
-            tt_log_error("Could not load metrics for null-glyph in font {} - {}", font->description.family_name, font->description.sub_family_name);
+            tt_log_error("Could not load metrics for null-glyph in font {} - {}", font.description.family_name, font.description.sub_family_name);
         }
     }
 
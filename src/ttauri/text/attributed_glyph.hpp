@@ -18,6 +18,8 @@ struct attributed_glyph {
     font_glyph_ids glyphs;
 
     /** The logical index of the grapheme before bidi-algorithm.
+     * Once the glyph is part of an attributed_glyph_line the index is relative
+     * to the logical index of the line.
     */
     ssize_t logicalIndex;
 
@@ -25,15 +25,26 @@ struct attributed_glyph_line {
     float xHeight;
     float y;
 
+    /** The logical index of the first grapheme in the line.
+     * The logical index of each glyph is relative to this index, so that
+     * the lines after an edit can be moved without touching their glyphs.
+     */
+    ssize_t logicalIndex;
+
     /** This constructor will move the data from first to last.
+     * The logical index of the line becomes that of the first glyph.
     */
     attributed_glyph_line(iterator first, iterator last) noexcept :
-        line(), width(0.0f), ascender(0.0f), descender(0.0f), lineGap(0.0f), capHeight(0.0f), xHeight(0.0f)
+        line(), width(0.0f), ascender(0.0f), descender(0.0f), lineGap(0.0f), capHeight(0.0f), xHeight(0.0f),
+        logicalIndex(first->logicalIndex)
     {
         tt_axiom(std::distance(first, last) > 0);
 
         line.reserve(std::distance(first, last));
         std::move(first, last, std::back_inserter(line));
+        for (auto &g: line) {
+            g.logicalIndex -= logicalIndex;
+        }
         calculateLineMetrics();
     }
 
@@ -74,6 +85,7 @@ struct attributed_glyph_line {
             i + 1; // Include at least one character.
 
         auto reset_of_line = attributed_glyph_line(split_position, line.end());
+        reset_of_line.logicalIndex += logicalIndex;
         line.erase(split_position, line.cend());
         calculateLineMetrics();
         return reset_of_line;
@@ -7,6 +7,7 @@
 #include "attributed_grapheme.hpp"
 #include "shaped_text.hpp"
 #include "font.hpp"
+#include "../command.hpp"
 #include <string>
 #include <vector>
 
@@ -82,24 +83,37 @@ public:
     /** Update the shaped text after changed to text.
      */
     void updateshaped_text() noexcept {
-        auto text_ = text;
-
         // Make sure there is an end-paragraph marker in the text.
         // This allows the shapedText to figure out the style of the text of an empty paragraph.
-        if (std::ssize(text) == 0) {
-            text_.emplace_back(grapheme::PS(), currentStyle, 0);
-        } else {
-            text_.emplace_back(grapheme::PS(), text_.back().style, 0);
+        addParagraphSeparator();
+        _shapedText = shaped_text(text, width, alignment::top_left, false);
+        text.pop_back();
+    }
+
+    /** Update the shaped text after the graphemes [first, last) were replaced by [first, new_last).
+     * Only the paragraphs containing the change are shaped again.
+     */
+    void updateshaped_text(ssize_t first, ssize_t last, ssize_t new_last) noexcept {
+        if (_shapedText.empty()) {
+            return updateshaped_text();
         }
 
-        _shapedText = shaped_text(text_, width, alignment::top_left, false);
+        // The paragraph separator follows the style of the last grapheme, it is shaped
+        // again when the last paragraph changes.
+        addParagraphSeparator();
+        _shapedText.replace(text, first, last, new_last);
+        text.pop_back();
     }
 
-    [[nodiscard]] shaped_text shapedText() const noexcept {
+    [[nodiscard]] shaped_text const &shapedText() const noexcept {
         return _shapedText;
     }
 
     void setWidth(float _width) noexcept {
+        if (_width == width) {
+            return;
+        }
+
         width = _width;
         updateshaped_text();
     }
@@ -122,6 +136,16 @@ public:
         return text.size();
     }
 
+    /** Temporarily add the end-paragraph marker to the text for shaping.
+     */
+    void addParagraphSeparator() noexcept {
+        if (std::ssize(text) == 0) {
+            text.emplace_back(grapheme::PS(), currentStyle, 0);
+        } else {
+            text.emplace_back(grapheme::PS(), text.back().style, 0);
+        }
+    }
+
     /** Return the text iterator at index.
      */
     decltype(auto) it(ssize_t index) noexcept {
@@ -182,12 +206,12 @@ public:
     void deleteSelection() noexcept {
         if (selectionIndex < cursorIndex) {
             text.erase(cit(selectionIndex), cit(cursorIndex));
+            updateshaped_text(selectionIndex, cursorIndex, selectionIndex);
             cursorIndex = selectionIndex;
-            updateshaped_text();
         } else if (selectionIndex > cursorIndex) {
             text.erase(cit(cursorIndex), cit(selectionIndex));
+            updateshaped_text(cursorIndex, selectionIndex, cursorIndex);
             selectionIndex = cursorIndex;
-            updateshaped_text();
         }
     }
 
@@ -302,7 +326,7 @@ public:
             text.erase(cit(cursorIndex));
             hasPartialgrapheme = false;
 
-            updateshaped_text();
+            updateshaped_text(cursorIndex, cursorIndex + 1, cursorIndex);
         }
     }
 
@@ -316,6 +340,7 @@ public:
         deleteSelection();
 
         text.emplace(cit(cursorIndex), character, currentStyle);
+        updateshaped_text(cursorIndex, cursorIndex, cursorIndex + 1);
         selectionIndex = ++cursorIndex;
         tt_axiom(selectionIndex >= 0);
         tt_axiom(selectionIndex <= std::ssize(text));
@@ -323,7 +348,6 @@ public:
         tt_axiom(cursorIndex <= std::ssize(text));
 
         hasPartialgrapheme = true;
-        updateshaped_text();
     }
 
     /*! insert character at the cursor position.
@@ -337,13 +361,12 @@ public:
             handle_event(command::text_delete_char_next);
         }
         text.emplace(cit(cursorIndex), character, currentStyle);
+        updateshaped_text(cursorIndex, cursorIndex, cursorIndex + 1);
         selectionIndex = ++cursorIndex;
         tt_axiom(selectionIndex >= 0);
         tt_axiom(selectionIndex <= std::ssize(text));
         tt_axiom(cursorIndex >= 0);
         tt_axiom(cursorIndex <= std::ssize(text));
-
-        updateshaped_text();
     }
 
     void handlePaste(std::string str) noexcept {
@@ -359,13 +382,12 @@ public:
         }
 
         text.insert(cit(cursorIndex), str_attr.cbegin(), str_attr.cend());
+        updateshaped_text(cursorIndex, cursorIndex, cursorIndex + std::ssize(str_attr));
         selectionIndex = cursorIndex += std::ssize(str_attr);
         tt_axiom(selectionIndex >= 0);
         tt_axiom(selectionIndex <= std::ssize(text));
         tt_axiom(cursorIndex >= 0);
         tt_axiom(cursorIndex <= std::ssize(text));
-
-        updateshaped_text();
     }
 
     std::string handleCopy() noexcept {
@@ -500,7 +522,7 @@ public:
             } else if (cursorIndex >= 1) {
                 selectionIndex = --cursorIndex;
                 text.erase(cit(cursorIndex));
-                updateshaped_text();
+                updateshaped_text(cursorIndex, cursorIndex + 1, cursorIndex);
             }
             break;
 
@@ -512,7 +534,7 @@ public:
             } else if (cursorIndex < (std::ssize(text) - 1)) {
                 // Don't delete the trailing paragraph separator.
                 text.erase(cit(cursorIndex));
-                updateshaped_text();
+                updateshaped_text(cursorIndex, cursorIndex + 1, cursorIndex);
             }
         default:;
         }
@@ -68,6 +68,14 @@ public:
         glyph_metrics &metrics,
         tt::glyph_id lookahead_glyph_id = tt::glyph_id{})
         const noexcept = 0;
+
+    /** Get the kerning between two glyphs.
+     *
+     * @param current_glyph_id The glyph on the left.
+     * @param next_glyph_id The glyph on the right.
+     * @return The adjustment to the advance of the left glyph, in em units.
+     */
+    [[nodiscard]] virtual f32x4 get_kerning(tt::glyph_id current_glyph_id, tt::glyph_id next_glyph_id) const noexcept = 0;
 };
 
 }
@@ -5,6 +5,7 @@
 #include "font_book.hpp"
 #include "true_type_font.hpp"
 #include "../trace.hpp"
+#include "../counters.hpp"
 
 namespace tt {
 
@@ -151,7 +152,12 @@ void font_book::post_process() noexcept
 {
     // Reset caches.
     glyph_cache.clear();
-    family_name_cache = family_names;
+    glyph_metrics_cache.clear();
+    kerning_cache.clear();
+    {
+        ttlet lock = std::scoped_lock(mutex);
+        family_name_cache = family_names;
+    }
 
     // For each font, find fallback list.
     for (ssize_t i = 0; i != std::ssize(font_entries); ++i) {
@@ -190,6 +196,7 @@ void font_book::post_process() noexcept
         family_names[name] = family_id;
 
         // If a new family is added, then the cache which includes fallbacks is no longer valid.
+        ttlet lock = std::scoped_lock(mutex);
         family_name_cache.clear();
         return family_id;
     } else {
@@ -214,6 +221,7 @@ void font_book::post_process() noexcept
 {
     ttlet original_name = to_lower(family_name);
 
+    ttlet lock = std::scoped_lock(mutex);
     ttlet i = family_name_cache.find(original_name);
     if (i != family_name_cache.end()) {
         return i->second;
@@ -260,6 +268,7 @@ void font_book::post_process() noexcept
     tt_axiom(font_id < std::ssize(font_entries));
     ttlet &entry = font_entries[font_id];
 
+    ttlet lock = std::scoped_lock(mutex);
     if (!entry.font) {
         // This font was parsed once before, it must not give an error now.
         entry.font = std::make_unique<true_type_font>(entry.url);
@@ -280,37 +289,82 @@ void font_book::post_process() noexcept
 
 [[nodiscard]] font_glyph_ids font_book::find_glyph(font_id font_id, grapheme g) const noexcept
 {
-    auto i = glyph_cache.find({font_id, g});
-    if (i != glyph_cache.end()) {
-        return i->second;
-    }
+    ttlet [r, found] = glyph_cache.get_or_create({font_id, g}, [&] {
+        // First try the selected font.
+        auto glyph_ids = find_glyph_actual(font_id, g);
+        if (glyph_ids) {
+            return glyph_ids;
+        }
+
+        // Scan fonts which are fallback to this.
+        auto g_range = unicode_ranges(g);
+        for (ttlet fallback_id : font_entries[font_id].fallbacks) {
+            auto &fallback_description = font_entries[fallback_id].description;
+            if (fallback_description.unicode_ranges >= g_range) {
+                if ((glyph_ids = find_glyph_actual(fallback_id, g))) {
+                    return glyph_ids;
+                }
+            }
+        }
 
-    // First try the selected font.
-    auto glyph_ids = find_glyph_actual(font_id, g);
-    if (glyph_ids) {
-        glyph_cache[{font_id, g}] = glyph_ids;
+        // If all everything has failed, use the tofu block of the original font.
+        glyph_ids += glyph_id{0};
+        glyph_ids.set_font_id(font_id);
         return glyph_ids;
+    });
+
+    if (found) {
+        increment_counter<"glyph_cache_hit">();
+    } else {
+        increment_counter<"glyph_cache_miss">();
     }
+    return r;
+}
 
-    // Scan fonts which are fallback to this.
-    auto g_range = unicode_ranges(g);
-    for (ttlet fallback_id: font_entries[font_id].fallbacks) {
-        auto &fallback_description = font_entries[fallback_id].description;
-        if (fallback_description.unicode_ranges >= g_range) {
-            if ((glyph_ids = find_glyph_actual(fallback_id, g))) {
-                glyph_cache[{font_id, g}] = glyph_ids;
-                return glyph_ids;
-            }
+[[nodiscard]] std::optional<glyph_metrics> font_book::get_glyph_metrics(font_id font_id, glyph_id glyph_id) const noexcept
+{
+    ttlet [metrics, found] = glyph_metrics_cache.get_or_create({font_id, glyph_id}, [&] {
+        auto r = std::optional<glyph_metrics>{glyph_metrics{}};
+        if (!get_font(font_id).loadglyph_metrics(glyph_id, *r)) {
+            r.reset();
         }
-    }
+        return r;
+    });
 
-    // If all everything has failed, use the tofu block of the original font.
-    glyph_ids += glyph_id{0};
-    glyph_ids.set_font_id(font_id);
-    glyph_cache[{font_id, g}] = glyph_ids;
-    return glyph_ids;
+    if (found) {
+        increment_counter<"glyph_metrics_cache_hit">();
+    } else {
+        increment_counter<"glyph_metrics_cache_miss">();
+    }
+    return metrics;
 }
 
+[[nodiscard]] f32x4 font_book::get_kerning(font_id font_id, glyph_id current_glyph_id, glyph_id next_glyph_id) const noexcept
+{
+    if (!current_glyph_id || !next_glyph_id) {
+        return f32x4{0.0f, 0.0f};
+    }
+
+    ttlet [kerning, found] = kerning_cache.get_or_create({font_id, current_glyph_id, next_glyph_id}, [&] {
+        return get_font(font_id).get_kerning(current_glyph_id, next_glyph_id);
+    });
+
+    if (found) {
+        increment_counter<"kerning_cache_hit">();
+    } else {
+        increment_counter<"kerning_cache_miss">();
+    }
+    return kerning;
+}
 
+void font_book::prewarm(font_id font_id, std::u32string_view code_points) const noexcept
+{
+    for (ttlet c : code_points) {
+        ttlet glyph_ids = find_glyph(font_id, grapheme{c});
+        for (size_t i = 0; i != glyph_ids.size(); ++i) {
+            [[maybe_unused]] ttlet metrics = get_glyph_metrics(glyph_ids.font_id(), glyph_ids[i]);
+        }
+    }
+}
 
 };
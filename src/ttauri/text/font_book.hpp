@@ -11,8 +11,14 @@
 #include "ttauri/text/font_id.hpp"
 #include "ttauri/text/font_grapheme_id.hpp"
 #include "ttauri/text/font_glyph_ids.hpp"
+#include "ttauri/text/font_glyph_id.hpp"
+#include "ttauri/text/glyph_metrics.hpp"
 #include "ttauri/URL.hpp"
 #include "ttauri/alignment.hpp"
+#include "ttauri/unfair_mutex.hpp"
+#include "ttauri/sharded_unordered_map.hpp"
+#include <optional>
+#include <string_view>
 #include <limits>
 #include <array>
 #include <new>
@@ -24,7 +30,9 @@ namespace tt {
  * The font_book is instantiated during application startup
  * and is available through Foundation_globals->font_book.
  *
- * 
+ * After the fonts are registered and post processed, the const member functions
+ * may be called from multiple threads at the same time. This allows text to be
+ * shaped on worker threads while the GUI thread is rendering.
  */
 class font_book {
 public:
@@ -102,6 +110,34 @@ public:
      */
     [[nodiscard]] font_glyph_ids find_glyph(font_id font_id, grapheme grapheme) const noexcept;
 
+    /** Get the metrics of a glyph.
+     * The metrics are loaded from the font once and cached.
+     *
+     * @param font_id The font containing the glyph.
+     * @param glyph_id The glyph in the font.
+     * @return The metrics in em units, without kerning; or empty if the metrics could not be loaded.
+     */
+    [[nodiscard]] std::optional<glyph_metrics> get_glyph_metrics(font_id font_id, glyph_id glyph_id) const noexcept;
+
+    /** Get the kerning between two glyphs of the same font.
+     * The kerning is loaded from the font once and cached.
+     *
+     * @param font_id The font containing both glyphs.
+     * @param current_glyph_id The glyph on the left.
+     * @param next_glyph_id The glyph on the right.
+     * @return The adjustment to the advance of the left glyph, in em units.
+     */
+    [[nodiscard]] f32x4 get_kerning(font_id font_id, glyph_id current_glyph_id, glyph_id next_glyph_id) const noexcept;
+
+    /** Load the glyphs and metrics for a set of characters.
+     * This is used to fill the caches before text is shaped, for example
+     * with the characters of the user interface's language.
+     *
+     * @param font_id The font to find the characters in; fallback fonts are used for missing characters.
+     * @param code_points The characters to load.
+     */
+    void prewarm(font_id font_id, std::u32string_view code_points) const noexcept;
+
 private:
     struct fontEntry {
         URL url;
@@ -129,6 +165,10 @@ private:
 
     std::vector<fontEntry> font_entries;
 
+    /** Protects family_name_cache and the lazy loading of fonts.
+     */
+    mutable unfair_mutex mutex;
+
     /** Same as family_name, but will also have resolved font families from the fallback_chain.
      * Must be cleared when a new font family is registered.
      */
@@ -137,7 +177,16 @@ private:
     /**
      * Must be cleared when a new font is registered.
      */
-    mutable std::unordered_map<font_grapheme_id, font_glyph_ids> glyph_cache;
+    mutable sharded_unordered_map<font_grapheme_id, font_glyph_ids> glyph_cache;
+
+    /** Unscaled metrics of glyphs, without kerning.
+     */
+    mutable sharded_unordered_map<font_glyph_id, std::optional<glyph_metrics>> glyph_metrics_cache;
+
+    /** Kerning between pairs of glyphs.
+     */
+    mutable sharded_unordered_map<font_glyph_pair_id, f32x4> kerning_cache;
+
     void calculate_fallback_fonts(fontEntry &entry, std::function<bool(font_description const&,font_description const&)> predicate) noexcept;
 
     /** Find the glyph for this specific font.
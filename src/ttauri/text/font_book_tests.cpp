@@ -0,0 +1,103 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/text/font_book.hpp"
+#include "ttauri/counters.hpp"
+#include "ttauri/URL.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+class font_book_tests : public ::testing::Test {
+protected:
+    font_id sans_serif_id;
+
+    void SetUp() override
+    {
+        font_book::global = std::make_unique<font_book>(std::vector<URL>{URL::urlFromSystemfontDirectory()});
+        sans_serif_id = font_book::global->find_font("sans-serif", font_weight::Regular, false);
+    }
+
+    void TearDown() override
+    {
+        font_book::global = {};
+    }
+};
+
+TEST_F(font_book_tests, glyph_metrics)
+{
+    ttlet glyphs = font_book::global->find_glyph(sans_serif_id, grapheme{U'A'});
+    ASSERT_EQ(glyphs.size(), 1);
+
+    ttlet &font = font_book::global->get_font(glyphs.font_id());
+    auto expected = glyph_metrics{};
+    ASSERT_TRUE(font.loadglyph_metrics(glyphs.front(), expected));
+
+    ttlet misses = read_counter<"glyph_metrics_cache_miss">();
+    ttlet hits = read_counter<"glyph_metrics_cache_hit">();
+
+    ttlet metrics1 = font_book::global->get_glyph_metrics(glyphs.font_id(), glyphs.front());
+    ttlet metrics2 = font_book::global->get_glyph_metrics(glyphs.font_id(), glyphs.front());
+    ASSERT_TRUE(metrics1);
+    ASSERT_TRUE(metrics2);
+    ASSERT_EQ(metrics1->advance, expected.advance);
+    ASSERT_EQ(metrics1->boundingBox, expected.boundingBox);
+    ASSERT_EQ(metrics2->advance, expected.advance);
+
+    ASSERT_EQ(read_counter<"glyph_metrics_cache_miss">(), misses + 1);
+    ASSERT_EQ(read_counter<"glyph_metrics_cache_hit">(), hits + 1);
+}
+
+TEST_F(font_book_tests, kerning)
+{
+    ttlet A = font_book::global->find_glyph(sans_serif_id, grapheme{U'A'});
+    ttlet V = font_book::global->find_glyph(sans_serif_id, grapheme{U'V'});
+    ASSERT_EQ(A.font_id(), V.font_id());
+
+    ttlet &font = font_book::global->get_font(A.font_id());
+    auto expected = glyph_metrics{};
+    ASSERT_TRUE(font.loadglyph_metrics(A.front(), expected, V.front()));
+
+    auto metrics = *font_book::global->get_glyph_metrics(A.font_id(), A.front());
+    metrics.advance += font_book::global->get_kerning(A.font_id(), A.front(), V.front());
+    ASSERT_EQ(metrics.advance, expected.advance);
+}
+
+TEST_F(font_book_tests, threads)
+{
+    constexpr int nr_threads = 4;
+
+    auto text = std::u32string{};
+    for (char32_t c = 0x20; c != 0x250; ++c) {
+        text += c;
+    }
+
+    auto expected = std::vector<glyph_metrics>{};
+    {
+        // Load the metrics without using the cache.
+        for (ttlet c : text) {
+            ttlet glyphs = font_book::global->find_glyph(sans_serif_id, grapheme{c});
+            auto &metrics = expected.emplace_back();
+            font_book::global->get_font(glyphs.font_id()).loadglyph_metrics(glyphs.front(), metrics);
+        }
+    }
+
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t != nr_threads; ++t) {
+        threads.emplace_back([&] {
+            for (ssize_t i = 0; i != std::ssize(text); ++i) {
+                ttlet glyphs = font_book::global->find_glyph(sans_serif_id, grapheme{text[i]});
+                ttlet metrics = font_book::global->get_glyph_metrics(glyphs.font_id(), glyphs.front());
+                ASSERT_TRUE(metrics);
+                ASSERT_EQ(metrics->advance, expected[i].advance);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
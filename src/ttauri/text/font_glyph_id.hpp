@@ -0,0 +1,63 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "font_id.hpp"
+#include "glyph_id.hpp"
+#include "../hash.hpp"
+
+namespace tt {
+
+/** Combined font_id + glyph_id for use as a key in a std::unordered_map.
+ */
+struct font_glyph_id {
+    font_id font_id;
+    glyph_id glyph_id;
+
+    [[nodiscard]] size_t hash() const noexcept {
+        return hash_mix(font_id, glyph_id);
+    }
+
+    [[nodiscard]] friend bool operator==(font_glyph_id const &lhs, font_glyph_id const &rhs) noexcept {
+        return (lhs.font_id == rhs.font_id) && (lhs.glyph_id == rhs.glyph_id);
+    }
+};
+
+/** Combined font_id + a pair of glyph_ids for use as a key in a std::unordered_map.
+ * Used for looking up the kerning between two glyphs.
+ */
+struct font_glyph_pair_id {
+    font_id font_id;
+    glyph_id first;
+    glyph_id second;
+
+    [[nodiscard]] size_t hash() const noexcept {
+        return hash_mix(font_id, first, second);
+    }
+
+    [[nodiscard]] friend bool operator==(font_glyph_pair_id const &lhs, font_glyph_pair_id const &rhs) noexcept {
+        return (lhs.font_id == rhs.font_id) && (lhs.first == rhs.first) && (lhs.second == rhs.second);
+    }
+};
+
+}
+
+namespace std {
+
+template<>
+struct hash<tt::font_glyph_id> {
+    [[nodiscard]] size_t operator() (tt::font_glyph_id const &rhs) const noexcept {
+        return rhs.hash();
+    }
+};
+
+template<>
+struct hash<tt::font_glyph_pair_id> {
+    [[nodiscard]] size_t operator() (tt::font_glyph_pair_id const &rhs) const noexcept {
+        return rhs.hash();
+    }
+};
+
+}
@@ -24,15 +24,16 @@ namespace tt {
         }
         path += glyph_path;
 
-        glyph_metrics glyph_metrics;
-        if (!font.loadglyph_metrics(glyph_id, glyph_metrics)) {
+        auto glyph_metrics = font_book::global->get_glyph_metrics(font_id(), glyph_id);
+        if (!glyph_metrics) {
             tt_log_error("Could not load glyph-metrics {} in font {} - {}", static_cast<int>(glyph_id), font.description.family_name, font.description.sub_family_name);
+            glyph_metrics.emplace();
         }
 
         if (i == 0) {
-            boundingBox = glyph_metrics.boundingBox;
+            boundingBox = glyph_metrics->boundingBox;
         } else {
-            boundingBox |= glyph_metrics.boundingBox;
+            boundingBox |= glyph_metrics->boundingBox;
         }
     }
 
@@ -47,15 +48,16 @@ namespace tt {
     for (ssize_t i = 0; i < std::ssize(*this); i++) {
         ttlet glyph_id = (*this)[i];
 
-        glyph_metrics glyph_metrics;
-        if (!font.loadglyph_metrics(glyph_id, glyph_metrics)) {
+        auto glyph_metrics = font_book::global->get_glyph_metrics(font_id(), glyph_id);
+        if (!glyph_metrics) {
             tt_log_error("Could not load glyph-metrics {} in font {} - {}", static_cast<int>(glyph_id), font.description.family_name, font.description.sub_family_name);
+            glyph_metrics.emplace();
         }
 
         if (i == 0) {
-            boundingBox = glyph_metrics.boundingBox;
+            boundingBox = glyph_metrics->boundingBox;
         } else {
-            boundingBox |= glyph_metrics.boundingBox;
+            boundingBox |= glyph_metrics->boundingBox;
         }
     }
 
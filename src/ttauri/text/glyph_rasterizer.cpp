@@ -0,0 +1,211 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "glyph_rasterizer.hpp"
+#include "font_book.hpp"
+#include "shaped_text.hpp"
+#include "../graphic_path.hpp"
+#include "../geometry/scale.hpp"
+#include "../geometry/translate.hpp"
+#include "../logger.hpp"
+#include <algorithm>
+
+namespace tt {
+
+glyph_rasterizer::glyph_rasterizer(float draw_font_size, float draw_border, ssize_t nr_threads) :
+    _draw_font_size(draw_font_size), _draw_border(draw_border), _pool("glyph_raster", nr_threads)
+{
+}
+
+/** Draw a glyph into a signed distance field.
+ *
+ *  +---------------------+
+ *  |     draw border     |
+ *  |  +---------------+  |
+ *  |  | render border |  |
+ *  |  |  +---------+  |  |
+ *  |  |  |  glyph  |  |  |
+ *  |  |  | bounding|  |  |
+ *  |  |  |   box   |  |  |
+ *  |  |  +---------+  |  |
+ *  |  |               |  |
+ *  |  +---------------+  |
+ *  |                     |
+ *  O---------------------+
+ */
+[[nodiscard]] rasterized_glyph glyph_rasterizer::rasterize(font_glyph_ids const &glyphs) const noexcept
+{
+    ttlet[glyph_path, glyph_bounding_box] = glyphs.getPathAndBoundingBox();
+
+    ttlet draw_scale = scale2{_draw_font_size, _draw_font_size};
+    ttlet scaled_bounding_box = draw_scale * glyph_bounding_box;
+
+    // We will draw the font at a fixed size into the texture. And we need a border for the texture to
+    // allow proper bi-linear interpolation on the edges.
+
+    // Determine the size of the image in the atlas.
+    // This is the bounding box sized to the fixed font size and a border
+    ttlet draw_offset = f32x4{_draw_border, _draw_border} - scaled_bounding_box.offset();
+    ttlet draw_extent = scaled_bounding_box.extent() + 2.0f * f32x4{_draw_border, _draw_border};
+    ttlet draw_translate = translate2{draw_offset};
+
+    // Transform the path to the scale of the fixed font size and drawing the bounding box inside the image.
+    ttlet draw_path = (draw_translate * draw_scale) * glyph_path;
+
+    auto image = pixel_map<sdf_r8>{i32x4{ceil(draw_extent)}};
+    fill(image, draw_path);
+    return {glyphs, draw_extent, std::move(image)};
+}
+
+bool glyph_rasterizer::queue(font_glyph_ids const &glyphs) noexcept
+{
+    {
+        ttlet lock = std::scoped_lock(_mutex);
+        if (!_states.try_emplace(glyphs, state_type::queued).second) {
+            return false;
+        }
+        ++_nr_queued;
+    }
+
+    [[maybe_unused]] auto future = _pool.submit([this, glyphs]() {
+        rasterize_queued(glyphs);
+    });
+    return true;
+}
+
+ssize_t glyph_rasterizer::queue(font_id font_id, std::u32string_view code_points) noexcept
+{
+    ssize_t r = 0;
+    for (ttlet code_point : code_points) {
+        ttlet glyphs = font_book::global->find_glyph(font_id, grapheme{code_point});
+        if (glyphs && queue(glyphs)) {
+            ++r;
+        }
+    }
+    return r;
+}
+
+ssize_t glyph_rasterizer::queue(shaped_text const &text) noexcept
+{
+    ssize_t r = 0;
+    for (ttlet &attr_glyph : text) {
+        if (attr_glyph.isVisible() && queue(attr_glyph.glyphs)) {
+            ++r;
+        }
+    }
+    return r;
+}
+
+[[nodiscard]] rasterized_glyph glyph_rasterizer::take(font_glyph_ids const &glyphs) noexcept
+{
+    {
+        ttlet lock = std::scoped_lock(_mutex);
+
+        ttlet[state, inserted] = _states.try_emplace(glyphs, state_type::taken);
+        if (!inserted) {
+            if (state->second == state_type::finished) {
+                ttlet i = std::find_if(_finished.begin(), _finished.end(), [&glyphs](ttlet &item) {
+                    return item.glyphs == glyphs;
+                });
+                tt_axiom(i != _finished.end());
+
+                auto r = std::move(*i);
+                _finished.erase(i);
+                state->second = state_type::taken;
+                return r;
+            }
+
+            // When the glyph is still queued, the result of the worker thread is discarded.
+            state->second = state_type::taken;
+        }
+    }
+
+    return rasterize(glyphs);
+}
+
+void glyph_rasterizer::forget(font_glyph_ids const &glyphs) noexcept
+{
+    ttlet lock = std::scoped_lock(_mutex);
+
+    ttlet i = _states.find(glyphs);
+    if (i != _states.end() && i->second == state_type::taken) {
+        _states.erase(i);
+    }
+}
+
+[[nodiscard]] std::vector<glyph_tile> glyph_rasterizer::pack_finished(pixel_map<sdf_r8> &image) noexcept
+{
+    ttlet lock = std::scoped_lock(_mutex);
+
+    // Tallest glyphs first, so that the glyphs on each row have similar heights.
+    std::sort(_finished.begin(), _finished.end(), [](ttlet &lhs, ttlet &rhs) {
+        return lhs.image.height() > rhs.image.height();
+    });
+
+    auto r = std::vector<glyph_tile>{};
+
+    auto x = ssize_t{0};
+    auto y = ssize_t{0};
+    auto row_height = ssize_t{0};
+    auto i = _finished.begin();
+    for (; i != _finished.end(); ++i) {
+        ttlet width = i->image.width();
+        ttlet height = i->image.height();
+
+        if (width > image.width() || height > image.height()) {
+            tt_log_error("Rasterized glyph of {}x{} pixels does not fit in the upload image.", width, height);
+            _states[i->glyphs] = state_type::taken;
+            continue;
+        }
+
+        if (x + width > image.width()) {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+
+        if (y + height > image.height()) {
+            break;
+        }
+
+        auto tile_image = image.submap(x, y, width, height);
+        copy(i->image, tile_image);
+        r.push_back({i->glyphs, i->draw_extent, i32x4{narrow_cast<int>(x), narrow_cast<int>(y)}});
+        _states[i->glyphs] = state_type::taken;
+
+        x += width;
+        row_height = std::max(row_height, height);
+    }
+    _finished.erase(_finished.begin(), i);
+
+    return r;
+}
+
+void glyph_rasterizer::wait() const noexcept
+{
+    auto lock = std::unique_lock(_mutex);
+    _condition.wait(lock, [this]() {
+        return _nr_queued == 0;
+    });
+}
+
+void glyph_rasterizer::rasterize_queued(font_glyph_ids const &glyphs) noexcept
+{
+    auto glyph = rasterize(glyphs);
+
+    {
+        ttlet lock = std::scoped_lock(_mutex);
+
+        // The glyph may have been taken and forgotten in the meantime, then the work is dropped.
+        ttlet i = _states.find(glyphs);
+        if (i != _states.end() && i->second == state_type::queued) {
+            i->second = state_type::finished;
+            _finished.push_back(std::move(glyph));
+        }
+        --_nr_queued;
+    }
+    _condition.notify_all();
+}
+
+} // namespace tt
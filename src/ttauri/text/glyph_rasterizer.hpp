@@ -0,0 +1,145 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "font_glyph_ids.hpp"
+#include "font_id.hpp"
+#include "../pixel_map.hpp"
+#include "../color/sdf_r8.hpp"
+#include "../numeric_array.hpp"
+#include "../thread_pool.hpp"
+#include "../required.hpp"
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <vector>
+#include <string_view>
+
+namespace tt {
+class shaped_text;
+
+/** A glyph drawn as a signed distance field.
+ */
+struct rasterized_glyph {
+    font_glyph_ids glyphs;
+
+    /** The size of the drawing in pixels, including the draw border.
+     * The image is this size rounded up to whole pixels.
+     */
+    f32x4 draw_extent;
+
+    pixel_map<sdf_r8> image;
+};
+
+/** A rasterized glyph which was copied into an upload image.
+ */
+struct glyph_tile {
+    font_glyph_ids glyphs;
+
+    /** The size of the drawing in pixels, including the draw border.
+     */
+    f32x4 draw_extent;
+
+    /** The position of the left-bottom corner of the tile inside the upload image.
+     */
+    i32x4 position;
+};
+
+/** Rasterizes glyphs into signed distance fields on worker threads.
+ *
+ * Glyphs that are about to be shown are queued ahead of time, so that the render
+ * thread only needs to copy the finished images into the atlas. When a glyph is needed
+ * before it is finished, `take()` rasterizes it on the calling thread.
+ *
+ * Each glyph is only rasterized once, unless it is explicitly taken again.
+ */
+class glyph_rasterizer {
+public:
+    /** Create a glyph rasterizer.
+     *
+     * @param draw_font_size The size of 1 EM in pixels of the rasterized glyphs.
+     * @param draw_border The border in pixels around the bounding box of the glyph.
+     * @param nr_threads The number of worker threads, or zero to use one thread per CPU.
+     */
+    glyph_rasterizer(float draw_font_size, float draw_border, ssize_t nr_threads = 0);
+
+    glyph_rasterizer(glyph_rasterizer const &) = delete;
+    glyph_rasterizer(glyph_rasterizer &&) = delete;
+    glyph_rasterizer &operator=(glyph_rasterizer const &) = delete;
+    glyph_rasterizer &operator=(glyph_rasterizer &&) = delete;
+
+    /** Rasterize a glyph on the current thread.
+     */
+    [[nodiscard]] rasterized_glyph rasterize(font_glyph_ids const &glyphs) const noexcept;
+
+    /** Queue a glyph to be rasterized on a worker thread.
+     *
+     * @param glyphs The glyph to rasterize.
+     * @return True if the glyph was queued, false if it was already queued or rasterized.
+     */
+    bool queue(font_glyph_ids const &glyphs) noexcept;
+
+    /** Queue the glyphs for each code point.
+     *
+     * @param font_id The font to find the glyphs in, including its fallback fonts.
+     * @param code_points The code points to find the glyphs for.
+     * @return The number of glyphs that were queued.
+     */
+    ssize_t queue(font_id font_id, std::u32string_view code_points) noexcept;
+
+    /** Queue the visible glyphs of a shaped text.
+     *
+     * @return The number of glyphs that were queued.
+     */
+    ssize_t queue(shaped_text const &text) noexcept;
+
+    /** Get a rasterized glyph.
+     * If the glyph was already rasterized by a worker thread the result is returned,
+     * otherwise the glyph is rasterized on the current thread.
+     * The glyph will not be returned by `pack_finished()` afterwards.
+     */
+    [[nodiscard]] rasterized_glyph take(font_glyph_ids const &glyphs) noexcept;
+
+    /** Forget that a glyph was rasterized.
+     * This allows the glyph to be queued again, for example after it was evicted from an atlas.
+     * When the glyph is still queued, the result is kept.
+     */
+    void forget(font_glyph_ids const &glyphs) noexcept;
+
+    /** Copy finished glyphs into an upload image.
+     *
+     * The glyphs are packed in rows, tallest glyph first, until the image is full.
+     * The glyphs that do not fit are returned on the next call.
+     *
+     * @param image The image to copy the glyphs into.
+     * @return The glyphs and their position in the image.
+     */
+    [[nodiscard]] std::vector<glyph_tile> pack_finished(pixel_map<sdf_r8> &image) noexcept;
+
+    /** Wait until all queued glyphs are rasterized.
+     */
+    void wait() const noexcept;
+
+private:
+    enum class state_type { queued, finished, taken };
+
+    float _draw_font_size;
+    float _draw_border;
+
+    mutable std::mutex _mutex;
+    mutable std::condition_variable _condition;
+    std::unordered_map<font_glyph_ids, state_type> _states;
+    std::vector<rasterized_glyph> _finished;
+    ssize_t _nr_queued = 0;
+
+    /** The worker threads.
+     * This is the last member so that the threads finish before the state is destroyed.
+     */
+    thread_pool _pool;
+
+    void rasterize_queued(font_glyph_ids const &glyphs) noexcept;
+};
+
+} // namespace tt
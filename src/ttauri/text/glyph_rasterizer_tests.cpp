@@ -0,0 +1,174 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/text/glyph_rasterizer.hpp"
+#include "ttauri/text/font_book.hpp"
+#include "ttauri/URL.hpp"
+#include <gtest/gtest.h>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+using namespace tt;
+
+class glyph_rasterizer_tests : public ::testing::Test {
+protected:
+    font_id sans_serif_id;
+    std::u32string printable_ascii;
+
+    void SetUp() override
+    {
+        font_book::global = std::make_unique<font_book>(std::vector<URL>{URL::urlFromSystemfontDirectory()});
+        sans_serif_id = font_book::global->find_font("sans-serif", font_weight::Regular, false);
+
+        for (char32_t c = 0x21; c != 0x7f; ++c) {
+            printable_ascii += c;
+        }
+    }
+
+    void TearDown() override
+    {
+        font_book::global = {};
+    }
+
+    [[nodiscard]] static bool equal(pixel_map<sdf_r8> const &lhs, pixel_map<sdf_r8> const &rhs) noexcept
+    {
+        if (lhs.width() != rhs.width() || lhs.height() != rhs.height()) {
+            return false;
+        }
+        for (ssize_t y = 0; y != lhs.height(); ++y) {
+            for (ssize_t x = 0; x != lhs.width(); ++x) {
+                if (static_cast<float>(lhs[y][x]) != static_cast<float>(rhs[y][x])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+TEST_F(glyph_rasterizer_tests, queue_once)
+{
+    auto rasterizer = glyph_rasterizer(28.0f, 3.0f, 2);
+
+    ttlet A = font_book::global->find_glyph(sans_serif_id, grapheme{U'A'});
+    ASSERT_TRUE(rasterizer.queue(A));
+    ASSERT_FALSE(rasterizer.queue(A));
+    rasterizer.wait();
+    ASSERT_FALSE(rasterizer.queue(A));
+
+    auto image = pixel_map<sdf_r8>(256, 256);
+    ttlet tiles = rasterizer.pack_finished(image);
+    ASSERT_EQ(tiles.size(), 1);
+    ASSERT_EQ(tiles[0].glyphs, A);
+    ASSERT_TRUE(rasterizer.pack_finished(image).empty());
+}
+
+TEST_F(glyph_rasterizer_tests, take)
+{
+    auto rasterizer = glyph_rasterizer(28.0f, 3.0f, 2);
+
+    ttlet A = font_book::global->find_glyph(sans_serif_id, grapheme{U'A'});
+    ttlet B = font_book::global->find_glyph(sans_serif_id, grapheme{U'B'});
+    ttlet expected_A = rasterizer.rasterize(A);
+
+    ASSERT_TRUE(rasterizer.queue(A));
+    rasterizer.wait();
+
+    // A finished glyph is returned by take, and will no longer be packed.
+    ttlet taken_A = rasterizer.take(A);
+    ASSERT_EQ(taken_A.glyphs, A);
+    ASSERT_TRUE(equal(taken_A.image, expected_A.image));
+
+    // A glyph that was not queued is rasterized on this thread.
+    ttlet taken_B = rasterizer.take(B);
+    ASSERT_EQ(taken_B.glyphs, B);
+    ASSERT_FALSE(rasterizer.queue(B));
+
+    auto image = pixel_map<sdf_r8>(256, 256);
+    ASSERT_TRUE(rasterizer.pack_finished(image).empty());
+
+    // A glyph that was forgotten can be queued again.
+    rasterizer.forget(A);
+    ASSERT_TRUE(rasterizer.queue(A));
+    rasterizer.wait();
+    ASSERT_EQ(rasterizer.pack_finished(image).size(), 1);
+}
+
+TEST_F(glyph_rasterizer_tests, forget_queued)
+{
+    auto rasterizer = glyph_rasterizer(28.0f, 3.0f, 1);
+
+    // With a single worker thread the last glyph is most likely still queued when it is taken.
+    ASSERT_GT(rasterizer.queue(sans_serif_id, printable_ascii), 90);
+    ttlet tilde = font_book::global->find_glyph(sans_serif_id, grapheme{U'~'});
+    [[maybe_unused]] ttlet taken = rasterizer.take(tilde);
+    rasterizer.forget(tilde);
+    rasterizer.wait();
+
+    // The result of the worker thread for a forgotten glyph is not packed.
+    auto image = pixel_map<sdf_r8>(256, 256);
+    while (true) {
+        ttlet tiles = rasterizer.pack_finished(image);
+        if (tiles.empty()) {
+            break;
+        }
+        for (ttlet &tile : tiles) {
+            ASSERT_NE(tile.glyphs, tilde);
+        }
+    }
+
+    ASSERT_TRUE(rasterizer.queue(tilde));
+    rasterizer.wait();
+}
+
+TEST_F(glyph_rasterizer_tests, pack_finished)
+{
+    auto rasterizer = glyph_rasterizer(28.0f, 3.0f, 4);
+
+    ttlet nr_queued = rasterizer.queue(sans_serif_id, printable_ascii);
+    ASSERT_GT(nr_queued, 90);
+    rasterizer.wait();
+
+    // Use a small image so that multiple upload images are needed.
+    auto image = pixel_map<sdf_r8>(128, 128);
+
+    auto packed = std::unordered_set<font_glyph_ids>{};
+    auto nr_images = 0;
+    while (true) {
+        ttlet tiles = rasterizer.pack_finished(image);
+        if (tiles.empty()) {
+            break;
+        }
+        ++nr_images;
+
+        for (ssize_t i = 0; i != std::ssize(tiles); ++i) {
+            ttlet &tile = tiles[i];
+            ttlet extent = i32x4{ceil(tile.draw_extent)};
+            ttlet rectangle = iaarect{tile.position.x(), tile.position.y(), extent.x(), extent.y()};
+
+            // Each tile is inside the image and does not overlap with other tiles.
+            ASSERT_GE(rectangle.x(), 0);
+            ASSERT_GE(rectangle.y(), 0);
+            ASSERT_LE(rectangle.x() + rectangle.width(), image.width());
+            ASSERT_LE(rectangle.y() + rectangle.height(), image.height());
+            for (ssize_t j = 0; j != i; ++j) {
+                ttlet other_extent = i32x4{ceil(tiles[j].draw_extent)};
+                ttlet other = iaarect{tiles[j].position.x(), tiles[j].position.y(), other_extent.x(), other_extent.y()};
+                ttlet separate_x = rectangle.x() >= other.x() + other.width() || other.x() >= rectangle.x() + rectangle.width();
+                ttlet separate_y = rectangle.y() >= other.y() + other.height() || other.y() >= rectangle.y() + rectangle.height();
+                ASSERT_TRUE(separate_x || separate_y);
+            }
+
+            // The tile contains the rasterized glyph.
+            ttlet expected = rasterizer.rasterize(tile.glyphs);
+            ASSERT_TRUE(equal(image.submap(rectangle), expected.image));
+
+            ASSERT_TRUE(packed.insert(tile.glyphs).second);
+        }
+    }
+
+    ASSERT_EQ(std::ssize(packed), nr_queued);
+    ASSERT_GT(nr_images, 1);
+}
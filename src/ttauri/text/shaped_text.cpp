@@ -26,7 +26,12 @@ namespace tt {
     return r;
 }
 
-[[nodiscard]] static std::vector<attributed_glyph> graphemes_to_glyphs(std::vector<attributed_grapheme> const &text) noexcept
+/** Convert graphemes into glyphs.
+ * @param text The graphemes ending in a paragraph separator.
+ * @param next_glyph The glyph following the text, used for kerning.
+ */
+[[nodiscard]] static std::vector<attributed_glyph>
+graphemes_to_glyphs(std::vector<attributed_grapheme> const &text, attributed_glyph const *next_glyph) noexcept
 {
     // The end-of-paragraph must end text.
     tt_axiom(std::ssize(text) >= 1 && text.back().grapheme == grapheme::PS());
@@ -34,8 +39,6 @@ namespace tt {
     std::vector<attributed_glyph> glyphs;
     glyphs.reserve(size(text));
 
-    attributed_glyph const *next_glyph = nullptr;
-
     // Reverse through the text, since the metrics of a glyph depend on the next glyph.
     for (auto i = text.crbegin(); i != text.crend(); ++i) {
         next_glyph = &glyphs.emplace_back(*i, next_glyph);
@@ -66,48 +69,6 @@ namespace tt {
     return lines;
 }
 
-static void wrap_lines(std::vector<attributed_glyph_line> &lines, float width) noexcept
-{
-    for (auto i = lines.begin(); i != lines.end(); ++i) {
-        while (i->shouldWrap(width)) {
-            // Wrap will modify the current line to the maximum width and return
-            // the rest of that line, which we insert here after it.
-            i = lines.insert(i+1, i->wrap(width)); 
-        }
-    }
-}
-
-/** Calculate the size of the text.
- * @return The extent of the text and the base line position of the middle line.
- */
-[[nodiscard]] static f32x4 calculate_text_size(std::vector<attributed_glyph_line> const &lines) noexcept
-{
-    auto size = f32x4{0.0f, 0.0f};
-
-    if (std::ssize(lines) == 0) {
-        return size;
-    }
-
-    // Top of first line.
-    size = f32x4{
-        lines.front().width,
-        lines.front().lineGap + lines.front().ascender
-    };
-
-    auto nr_lines = std::ssize(lines);
-    for (ssize_t i = 1; i != nr_lines; ++i) {
-        size = f32x4{
-            std::max(size.width(), lines[i].width),
-            size.height() + lines[i-1].descender + std::max(lines[i-1].lineGap, lines[i].lineGap) + lines[i].ascender
-        };
-    }
-
-    // Bottom of last line.
-    size.height() = size.height() + lines.back().descender + lines.back().lineGap;
-
-    return size;
-}
-
 [[nodiscard]] static aarect calculate_bounding_box(std::vector<attributed_glyph_line> const &lines, float width) noexcept
 {
     ttlet min_y = lines.back().y - lines.back().descender;
@@ -223,79 +184,60 @@ static void position_glyphs(std::vector<attributed_glyph_line> &lines, alignment
     }
 }
 
-struct shape_text_result {
-    f32x4 preferred_extent;
-    aarect boundingBox;
-    std::vector<attributed_glyph_line> lines;
-};
-
-/** Shape the text.
-* The given text is in logical-order; the order in which humans write text.
-* The resulting glyphs are in left-to-right display order.
-*
-* The following operations are executed on the text by the `shape_text()` function:
-*  - Put graphemes in left-to-right display order using the unicode_data::global's bidi_algorithm.
-*  - Convert attributed-graphemes into attributes-glyphs using font_book's find_glyph algorithm.
-*  - Morph attributed-glyphs using the font's morph algorithm.
-*  - Calculate advance for each attributed-glyph using the font's advance and kern algorithms.
-*  - Add line-breaks to the text to fit within the maximum-width.
-*  - Calculate actual size of the text
-*  - Align the text within the given extent size.
-*
-* @param text The text to be shaped.
-* @param alignment How the text should be horizontally-aligned inside the maximum_width.
-* @param max_width Maximum width that the text should flow into.
-* @return preferred size of the text, size of the resulting text, shaped text.
-*/
-[[nodiscard]] static shape_text_result shape_text(
-    std::vector<attributed_grapheme> text,
-    float width,
-    alignment alignment,
-    float wrap) noexcept
+/** Prepare a grapheme for shaping.
+ * Put graphemes in left-to-right display order using the unicode_data::global's bidi_algorithm.
+ */
+[[nodiscard]] static attributed_grapheme prepare_grapheme(attributed_grapheme c, ssize_t logicalIndex) noexcept
+{
+    ttlet &description = unicode_description_find(c.grapheme[0]);
+    c.logicalIndex = logicalIndex;
+    c.bidi_class = description.bidi_class();
+    c.general_category = description.general_category();
+    return c;
+}
+
+/** Shape paragraphs of text into lines.
+ * The given text is in logical-order; the order in which humans write text.
+ * The resulting glyphs are in left-to-right display order.
+ *
+ * The following operations are executed on the text:
+ *  - Put graphemes in left-to-right display order using the unicode_data::global's bidi_algorithm.
+ *  - Convert attributed-graphemes into attributes-glyphs using font_book's find_glyph algorithm.
+ *  - Morph attributed-glyphs using the font's morph algorithm.
+ *  - Calculate advance for each attributed-glyph using the font's advance and kern algorithms.
+ *  - Split the text in a line for each paragraph.
+ *
+ * @param text The text to be shaped.
+ * @param first The index of the first grapheme of the first paragraph to shape.
+ * @param last The index one beyond the paragraph separator of the last paragraph to shape.
+ * @param next_glyph The glyph following the shaped paragraphs, used for kerning.
+ * @return The lines, one for each paragraph, which are not wrapped nor positioned.
+ */
+[[nodiscard]] static std::vector<attributed_glyph_line> shape_paragraphs(
+    std::vector<attributed_grapheme> const &text,
+    ssize_t first,
+    ssize_t last,
+    attributed_glyph const *next_glyph) noexcept
 {
-    std::vector<attributed_glyph> attributed_glyphs;
+    tt_axiom(first < last && last <= std::ssize(text));
 
-    // Put graphemes in left-to-right display order using the unicode_data::global's bidi_algorithm.
-    //bidi_algorithm(text);
-    ssize_t logicalIndex = 0;
-    for (auto &c: text) {
-        ttlet &description = unicode_description_find(c.grapheme[0]);
-        c.logicalIndex = logicalIndex++;
-        c.bidi_class = description.bidi_class();
-        c.general_category = description.general_category();
+    auto graphemes = std::vector<attributed_grapheme>{};
+    graphemes.reserve(last - first);
+    for (auto i = first; i != last; ++i) {
+        graphemes.push_back(prepare_grapheme(text[i], i));
     }
-    tt_axiom(text.back().general_category == unicode_general_category::Zp);
+    tt_axiom(graphemes.back().general_category == unicode_general_category::Zp);
 
     // Convert attributed-graphemes into attributes-glyphs using font_book's find_glyph algorithm.
-    auto glyphs = graphemes_to_glyphs(text);
-
-    // Split the text up in lines, based on line-feeds and line-wrapping.
-    auto lines = make_lines(std::move(glyphs));
-
-    // Calculate actual size of the box, no smaller than the minimum_size.
-    ttlet preferred_extent = ceil(calculate_text_size(lines));
-
-    if (wrap) {
-        wrap_lines(lines, width);
-    }
+    auto glyphs = graphemes_to_glyphs(graphemes, next_glyph);
 
     // Morph attributed-glyphs using the font's morph algorithm.
     //morph_glyphs(glyphs);
 
-    // Align the text within the actual box size.
-    position_glyphs(lines, alignment, width);
-
-    ttlet bounding_box = calculate_bounding_box(lines, width);
-
-
-    return {
-        preferred_extent,
-        bounding_box,
-        lines
-    };
+    // Split the text up in lines, based on line-feeds.
+    return make_lines(std::move(glyphs));
 }
 
-
 shaped_text::shaped_text(
     std::vector<attributed_grapheme> const &text,
     float width,
@@ -303,12 +245,23 @@ shaped_text::shaped_text(
     bool wrap
 ) noexcept :
     alignment(alignment),
-    width(width)
+    width(width),
+    wrap(wrap),
+    index_fixup_line(0),
+    index_fixup_delta(0)
 {
-    auto result = shape_text(text, width, alignment, wrap);
-    preferred_extent = result.preferred_extent;
-    boundingBox = result.boundingBox;
-    lines = std::move(result.lines);
+    lines = shape_paragraphs(text, 0, std::ssize(text), nullptr);
+    paragraphs = wrap_paragraphs(lines, wrap, width);
+
+    // Calculate actual size of the box, no smaller than the minimum_size.
+    ttlet text_size = paragraphs_extent(lines, paragraphs, 0.0f, 0.0f);
+    text_width = text_size.width();
+    text_height = text_size.height();
+    preferred_extent = ceil(text_size);
+
+    // Align the text within the actual box size.
+    position_glyphs(lines, alignment, width);
+    boundingBox = calculate_bounding_box(lines, width);
 }
 
 shaped_text::shaped_text(
@@ -329,12 +282,201 @@ shaped_text::shaped_text(
 ) noexcept :
     shaped_text(to_gstring(text), style, width, alignment, wrap) {}
 
+[[nodiscard]] std::vector<shaped_text::paragraph_metrics>
+shaped_text::wrap_paragraphs(std::vector<attributed_glyph_line> &lines, bool wrap, float width) noexcept
+{
+    auto r = std::vector<paragraph_metrics>{};
+    r.reserve(lines.size());
+
+    for (auto i = lines.begin(); i != lines.end(); ++i) {
+        ttlet metrics = paragraph_metrics{i->width, i->ascender, i->descender, i->lineGap};
+        r.push_back(metrics);
+
+        while (wrap && i->shouldWrap(width)) {
+            // Wrap will modify the current line to the maximum width and return
+            // the rest of that line, which we insert here after it.
+            i = lines.insert(i + 1, i->wrap(width));
+            r.push_back(metrics);
+        }
+    }
+    return r;
+}
+
+[[nodiscard]] f32x4 shaped_text::paragraphs_extent(
+    std::span<attributed_glyph_line const> lines,
+    std::span<paragraph_metrics const> paragraphs,
+    float prev_gap,
+    float next_gap) noexcept
+{
+    tt_axiom(lines.size() == paragraphs.size());
+
+    auto size = f32x4{0.0f, 0.0f};
+    auto gap = prev_gap;
+    for (size_t i = 0; i != lines.size(); ++i) {
+        // Only the last line of a wrapped paragraph is counted.
+        if (!lines[i].line.back().isParagraphSeparator()) {
+            continue;
+        }
+
+        ttlet &paragraph = paragraphs[i];
+        size = f32x4{
+            std::max(size.width(), paragraph.width),
+            size.height() + std::max(gap, paragraph.lineGap) + paragraph.ascender + paragraph.descender};
+        gap = paragraph.lineGap;
+    }
+
+    size.height() = size.height() + std::max(gap, next_gap);
+    return size;
+}
+
+void shaped_text::move_index_fixup(ssize_t line_nr) noexcept
+{
+    tt_axiom(line_nr >= 0 && line_nr <= std::ssize(lines));
+
+    for (auto i = index_fixup_line; i < line_nr; ++i) {
+        lines[i].logicalIndex += index_fixup_delta;
+    }
+    for (auto i = line_nr; i < index_fixup_line; ++i) {
+        lines[i].logicalIndex -= index_fixup_delta;
+    }
+    index_fixup_line = line_nr;
+}
+
+[[nodiscard]] ssize_t shaped_text::find_line(ssize_t index) const noexcept
+{
+    tt_axiom(!lines.empty());
+
+    // Search only the lines before, or the lines after the fixup, so that the
+    // logicalIndex of the lines can be compared directly.
+    auto first = lines.cbegin();
+    auto last = lines.cbegin() + index_fixup_line;
+    if (last != lines.cend() && index >= line_logical_index(index_fixup_line)) {
+        first = last;
+        last = lines.cend();
+        index -= index_fixup_delta;
+    }
+
+    ttlet it = std::upper_bound(first, last, index, [](ssize_t index, ttlet &line) {
+        return index < line.logicalIndex;
+    });
+    return it == lines.cbegin() ? 0 : std::distance(lines.cbegin(), it) - 1;
+}
+
+void shaped_text::replace(std::vector<attributed_grapheme> const &text, ssize_t first, ssize_t last, ssize_t new_last) noexcept
+{
+    tt_axiom(!lines.empty());
+    tt_axiom(first <= last && first <= new_last);
+    tt_axiom(std::ssize(text) >= 1 && text.back().grapheme == grapheme::PS());
+
+    ttlet &last_glyph = lines.back().line.back();
+    ttlet old_size = line_logical_index(std::ssize(lines) - 1) + last_glyph.logicalIndex + last_glyph.graphemeCount;
+    tt_axiom(last <= old_size);
+
+    // Find the lines of the paragraphs with the replaced graphemes. The paragraph
+    // that starts at `last` is included, as it will merge when a paragraph
+    // separator is removed.
+    auto first_line = find_line(first);
+    while (first_line > 0 && !lines[first_line - 1].line.back().isParagraphSeparator()) {
+        --first_line;
+    }
+    auto last_line = find_line(std::min(last, old_size - 1));
+    while (!lines[last_line].line.back().isParagraphSeparator()) {
+        ++last_line;
+        tt_axiom(last_line < std::ssize(lines));
+    }
+    ++last_line;
+
+    // Only the lines between the previous edit and this edit get an exact logicalIndex.
+    move_index_fixup(last_line);
+
+    ttlet delta = new_last - last;
+    ttlet &last_paragraph_glyph = lines[last_line - 1].line.back();
+    ttlet shape_first = lines[first_line].logicalIndex;
+    ttlet shape_last = lines[last_line - 1].logicalIndex + last_paragraph_glyph.logicalIndex + last_paragraph_glyph.graphemeCount + delta;
+    tt_axiom(shape_last <= std::ssize(text));
+
+    ttlet next_glyph = last_line != std::ssize(lines) ? &lines[last_line].line.front() : nullptr;
+    auto new_lines = shape_paragraphs(text, shape_first, shape_last, next_glyph);
+
+    if (first_line > 0) {
+        // The paragraph separator before the shaped paragraphs is kerned with the first new glyph.
+        auto &separator = lines[first_line - 1].line.back();
+        auto new_separator = attributed_glyph{prepare_grapheme(text[shape_first - 1], shape_first - 1), &new_lines.front().line.front()};
+        new_separator.logicalIndex = separator.logicalIndex;
+        new_separator.position = separator.position;
+        separator = std::move(new_separator);
+    }
+
+    auto new_paragraphs = wrap_paragraphs(new_lines, wrap, width);
+
+    // Update the size of the text with the difference between the old and new paragraphs.
+    ttlet prev_gap = first_line > 0 ? paragraphs[first_line - 1].lineGap : 0.0f;
+    ttlet next_gap = last_line != std::ssize(lines) ? paragraphs[last_line].lineGap : 0.0f;
+    ttlet old_extent = paragraphs_extent(
+        std::span(lines).subspan(first_line, last_line - first_line),
+        std::span(paragraphs).subspan(first_line, last_line - first_line),
+        prev_gap,
+        next_gap);
+    ttlet new_extent = paragraphs_extent(new_lines, new_paragraphs, prev_gap, next_gap);
+    text_height += new_extent.height() - old_extent.height();
+
+    // When the new lines have the same heights as the old lines, none of the other lines move.
+    ttlet same_heights = std::equal(
+        new_lines.cbegin(), new_lines.cend(), lines.cbegin() + first_line, lines.cbegin() + last_line, [](ttlet &a, ttlet &b) {
+            return a.ascender == b.ascender && a.descender == b.descender && a.lineGap == b.lineGap;
+        });
+    if (same_heights) {
+        for (ssize_t i = 0; i != std::ssize(new_lines); ++i) {
+            auto &line = new_lines[i];
+            line.positionGlyphs(f32x4::point(position_x(alignment, line.width, width), lines[first_line + i].y));
+        }
+    }
+
+    ttlet nr_common = std::min(std::ssize(new_lines), last_line - first_line);
+    std::move(new_lines.begin(), new_lines.begin() + nr_common, lines.begin() + first_line);
+    std::move(new_paragraphs.begin(), new_paragraphs.begin() + nr_common, paragraphs.begin() + first_line);
+    if (nr_common < std::ssize(new_lines)) {
+        lines.insert(lines.begin() + last_line, std::make_move_iterator(new_lines.begin() + nr_common), std::make_move_iterator(new_lines.end()));
+        paragraphs.insert(paragraphs.begin() + last_line, new_paragraphs.begin() + nr_common, new_paragraphs.end());
+    } else {
+        lines.erase(lines.begin() + first_line + nr_common, lines.begin() + last_line);
+        paragraphs.erase(paragraphs.begin() + first_line + nr_common, paragraphs.begin() + last_line);
+    }
+
+    // The lines following the new lines are off by the number of inserted graphemes.
+    index_fixup_line = first_line + std::ssize(new_lines);
+    index_fixup_delta += delta;
+
+    if (new_extent.width() >= text_width) {
+        text_width = new_extent.width();
+    } else if (old_extent.width() == text_width) {
+        // The widest paragraph became narrower, find the next widest paragraph.
+        text_width = std::max_element(paragraphs.cbegin(), paragraphs.cend(), [](ttlet &a, ttlet &b) {
+            return a.width < b.width;
+        })->width;
+    }
+    preferred_extent = ceil(f32x4{text_width, text_height});
+
+    if (!same_heights) {
+        position_glyphs(lines, alignment, width);
+    }
+    boundingBox = calculate_bounding_box(lines, width);
+}
+
 
 [[nodiscard]] shaped_text::const_iterator shaped_text::find(ssize_t index) const noexcept
 {
-    return std::find_if(cbegin(), cend(), [=](ttlet &x) {
-        return x.containsLogicalIndex(index);
+    if (lines.empty()) {
+        return cend();
+    }
+
+    ttlet line_nr = find_line(index);
+    ttlet line_it = lines.cbegin() + line_nr;
+    ttlet relative_index = index - line_logical_index(line_nr);
+    ttlet glyph_it = std::find_if(line_it->cbegin(), line_it->cend(), [=](ttlet &x) {
+        return x.containsLogicalIndex(relative_index);
     });
+    return glyph_it != line_it->cend() ? const_iterator{line_it, lines.cend(), glyph_it} : cend();
 }
 
 [[nodiscard]] aarect shaped_text::rectangleOfgrapheme(ssize_t index) const noexcept
@@ -353,7 +495,7 @@ shaped_text::shaped_text(
     // This is a ligature.
     // The position is inside a ligature.
     // Place the cursor proportional inside the ligature, based on the font-metrics.
-    ttlet ligature_index = narrow_cast<int>(i->logicalIndex - index);
+    ttlet ligature_index = narrow_cast<int>(logical_index(i) - index);
     ttlet ligature_advance_left = i->metrics.advanceForgrapheme(ligature_index);
     ttlet ligature_advance_right = i->metrics.advanceForgrapheme(ligature_index + 1);
 
@@ -396,25 +538,27 @@ shaped_text::shaped_text(
 
 [[nodiscard]] std::optional<ssize_t> shaped_text::indexOfCharAtCoordinate(f32x4 coordinate) const noexcept
 {
-    for (ttlet &line: lines) {
+    for (ssize_t line_nr = 0; line_nr != std::ssize(lines); ++line_nr) {
+        ttlet &line = lines[line_nr];
         auto i = line.find(coordinate);
         if (i == line.cend()) {
             continue;
         }
 
+        ttlet line_index = line_logical_index(line_nr);
         if ((i + 1) == line.cend()) {
             // This character is the end of line, or end of paragraph.
-            return i->logicalIndex;
+            return line_index + i->logicalIndex;
 
         } else {
             ttlet newLogicalIndex = i->relativeIndexAtCoordinate(coordinate);
             if (newLogicalIndex < 0) {
-                return i->logicalIndex;
+                return line_index + i->logicalIndex;
             } else if (newLogicalIndex >= i->graphemeCount) {
                 // Closer to the next glyph.
-                return (i+1)->logicalIndex;
+                return line_index + (i+1)->logicalIndex;
             } else {
-                return i->logicalIndex + newLogicalIndex;
+                return line_index + i->logicalIndex + newLogicalIndex;
             }
         }
     }
@@ -426,12 +570,12 @@ shaped_text::shaped_text(
     auto i = find(logicalIndex);
     if (i == cbegin()) {
         return {};
-    } else if (logicalIndex != i->logicalIndex) {
+    } else if (logicalIndex != logical_index(i)) {
         // Go left inside a ligature.
         return logicalIndex - 1;
     } else {
         --i;
-        return i->logicalIndex + i->graphemeCount - 1;
+        return logical_index(i) + i->graphemeCount - 1;
     }
 }
 
@@ -440,12 +584,12 @@ shaped_text::shaped_text(
     auto i = find(logicalIndex);
     if (i->isParagraphSeparator()) {
         return {};
-    } else if (logicalIndex < (i->logicalIndex + i->graphemeCount)) {
+    } else if (logicalIndex < (logical_index(i) + i->graphemeCount)) {
         // Go right inside a ligature.
         return logicalIndex + 1;
     } else {
         ++i;
-        return i->logicalIndex;
+        return logical_index(i);
     }
 }
 
@@ -482,7 +626,7 @@ shaped_text::shaped_text(
 
     tt_axiom(beginOfParagraph != endOfParagraph);
     auto lastCharacter = endOfParagraph - 1;
-    return {beginOfParagraph->logicalIndex, lastCharacter->logicalIndex + lastCharacter->graphemeCount};
+    return {logical_index(beginOfParagraph), logical_index(lastCharacter) + lastCharacter->graphemeCount};
 }
 
 /** Return the index at the left side of a word
@@ -520,7 +664,7 @@ shaped_text::shaped_text(
 
     tt_axiom(e != i);
     --e;
-    return {s->logicalIndex, e->logicalIndex + e->graphemeCount};
+    return {logical_index(s), logical_index(e) + e->graphemeCount};
 }
 
 [[nodiscard]] std::optional<ssize_t> shaped_text::indexOfWordOnTheLeft(ssize_t logicalIndex) const noexcept
@@ -13,6 +13,7 @@
 #include "../recursive_iterator.hpp"
 #include <string_view>
 #include <optional>
+#include <span>
 
 namespace tt {
 
@@ -28,14 +29,54 @@ public:
     alignment alignment;
     aarect boundingBox;
     float width;
+    bool wrap;
     f32x4 preferred_extent;
 
 private:
+    /** The metrics of a paragraph before it was wrapped.
+     * Used to calculate the preferred extent, without shaping all paragraphs again.
+     */
+    struct paragraph_metrics {
+        float width;
+        float ascender;
+        float descender;
+        float lineGap;
+    };
+
     std::vector<attributed_glyph_line> lines;
 
+    /** The metrics of the paragraph of each line.
+     * The lines of a wrapped paragraph each hold a copy of the metrics of that paragraph.
+     */
+    std::vector<paragraph_metrics> paragraphs;
+
+    /** The unwrapped width and the height of the text, before rounding up to the preferred extent.
+     */
+    float text_width;
+    float text_height;
+
+    /** The logicalIndex of the lines starting at this line is off by index_fixup_delta.
+     * An edit only makes the logicalIndex exact of the lines between the previous and the current edit,
+     * so that the lines following the edit do not need to be touched while typing.
+     */
+    ssize_t index_fixup_line;
+    ssize_t index_fixup_delta;
+
 public:
     shaped_text() noexcept :
-        alignment(alignment::middle_center), boundingBox(), width(0.0f), preferred_extent(), lines() {}
+        alignment(alignment::middle_center),
+        boundingBox(),
+        width(0.0f),
+        wrap(true),
+        preferred_extent(),
+        lines(),
+        paragraphs(),
+        text_width(0.0f),
+        text_height(0.0f),
+        index_fixup_line(0),
+        index_fixup_delta(0)
+    {
+    }
     shaped_text(shaped_text const &other) = default;
     shaped_text(shaped_text &&other) noexcept = default;
     shaped_text &operator=(shaped_text const &other) = default;
@@ -104,6 +145,28 @@ public:
         bool wrap=true
     ) noexcept;
 
+    /** Update the shaped text after a part of its text was replaced.
+     * Only the paragraphs containing the replaced graphemes are shaped again;
+     * the glyphs of the other paragraphs are reused. The other lines are only
+     * positioned again when the number or the height of the shaped lines changed.
+     *
+     * The preferred extent is updated from the metrics of the replaced paragraphs, the
+     * metrics of all paragraphs are only visited when the widest paragraph became narrower.
+     *
+     * The graphemes `[first, last)` of the original text were replaced by
+     * the graphemes `[first, new_last)` of `text`.
+     *
+     * @param text The complete text after the replacement, ending in a paragraph separator.
+     * @param first The index of the first replaced grapheme.
+     * @param last The index one beyond the last replaced grapheme, in the original text.
+     * @param new_last The index one beyond the last replacing grapheme, in `text`.
+     */
+    void replace(std::vector<attributed_grapheme> const &text, ssize_t first, ssize_t last, ssize_t new_last) noexcept;
+
+    [[nodiscard]] bool empty() const noexcept {
+        return lines.empty();
+    }
+
     [[nodiscard]] size_t size() const noexcept {
         ssize_t count = 0;
         for (ttlet &line: lines) {
@@ -184,7 +247,7 @@ public:
      * @param position x is the left position,
      *                 y is where the middle of the line should be.
      */
-    translate2 translate_base_line(f32x4 position) noexcept
+    translate2 translate_base_line(f32x4 position) const noexcept
     {
         return translate2{position.x(), middleOffset(position.y())};
     }
@@ -290,6 +353,55 @@ public:
      * @return indices of all the graphemes selected during a drag.
      */
     [[nodiscard]] std::vector<int> indicesFromCoordinates(f32x4 start, f32x4 current) const noexcept;
+
+private:
+    /** The logical index of the first grapheme of a line.
+     */
+    [[nodiscard]] ssize_t line_logical_index(ssize_t line_nr) const noexcept {
+        tt_axiom(line_nr >= 0 && line_nr < std::ssize(lines));
+        return lines[line_nr].logicalIndex + (line_nr >= index_fixup_line ? index_fixup_delta : 0);
+    }
+
+    /** The logical index of a glyph.
+     */
+    [[nodiscard]] ssize_t logical_index(const_iterator i) const noexcept {
+        return line_logical_index(std::distance(lines.cbegin(), i.parent())) + i->logicalIndex;
+    }
+
+    /** Make the logicalIndex of the lines before line_nr exact.
+     * After this call the lines starting at line_nr are off by index_fixup_delta.
+     */
+    void move_index_fixup(ssize_t line_nr) noexcept;
+
+    /** Wrap the lines of unwrapped paragraphs.
+     * @param lines The lines, one for each paragraph, which are wrapped in place.
+     * @param wrap True when the lines should be wrapped.
+     * @param width The maximum width of a line.
+     * @return The metrics of the paragraph of each line.
+     */
+    [[nodiscard]] static std::vector<paragraph_metrics>
+    wrap_paragraphs(std::vector<attributed_glyph_line> &lines, bool wrap, float width) noexcept;
+
+    /** Calculate the size of a run of paragraphs.
+     * The height includes the gaps to the neighbouring paragraphs, so that the height of the
+     * text can be updated when some of its paragraphs are replaced.
+     *
+     * @param lines The lines of the paragraphs.
+     * @param paragraphs The metrics of the paragraph of each line.
+     * @param prev_gap The line gap of the paragraph before the run, or zero at the start of the text.
+     * @param next_gap The line gap of the paragraph after the run, or zero at the end of the text.
+     * @return The width of the widest paragraph and the height of the paragraphs.
+     */
+    [[nodiscard]] static f32x4 paragraphs_extent(
+        std::span<attributed_glyph_line const> lines,
+        std::span<paragraph_metrics const> paragraphs,
+        float prev_gap,
+        float next_gap) noexcept;
+
+    /** Find the line containing the grapheme at a logical index.
+     * @return The index of the line, or the last line if the index is beyond the text.
+     */
+    [[nodiscard]] ssize_t find_line(ssize_t index) const noexcept;
 };
 
 
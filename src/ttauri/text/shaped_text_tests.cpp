@@ -0,0 +1,171 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/text/shaped_text.hpp"
+#include "ttauri/text/editable_text.hpp"
+#include "ttauri/text/font_book.hpp"
+#include "ttauri/URL.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <fmt/format.h>
+
+using namespace std;
+using namespace tt;
+
+class shaped_text_tests : public ::testing::Test {
+protected:
+    static void SetUpTestSuite()
+    {
+        font_book::global = std::make_unique<font_book>(std::vector<URL>{URL::urlFromSystemfontDirectory()});
+    }
+
+    static void TearDownTestSuite()
+    {
+        font_book::global = {};
+    }
+
+    /** Make a text with paragraphs of a few words.
+     */
+    [[nodiscard]] static std::vector<attributed_grapheme> make_text(ssize_t nr_paragraphs)
+    {
+        ttlet style = text_style("sans-serif", font_variant{}, 14.0f, color{}, text_decoration::None);
+
+        auto r = std::vector<attributed_grapheme>{};
+        for (ssize_t i = 0; i != nr_paragraphs; ++i) {
+            for (ttlet c : fmt::format("Paragraph {} with a few words of text.", i)) {
+                r.emplace_back(grapheme{static_cast<char32_t>(c)}, style);
+            }
+            r.emplace_back(grapheme::PS(), style);
+        }
+        return r;
+    }
+
+    /** Check that the incrementally updated shaped text is the same as newly shaped text.
+     */
+    static void check_equal(shaped_text const &lhs, shaped_text const &rhs)
+    {
+        ASSERT_EQ(lhs.size(), rhs.size());
+        ASSERT_EQ(lhs.preferred_extent, rhs.preferred_extent);
+        ASSERT_EQ(lhs.boundingBox, rhs.boundingBox);
+
+        for (auto i = lhs.begin(), j = rhs.begin(); i != lhs.end(); ++i, ++j) {
+            ASSERT_EQ(i->glyphs, j->glyphs);
+            ASSERT_EQ(i->position, j->position);
+        }
+
+        for (ssize_t i = 0; i != std::ssize(lhs); ++i) {
+            ASSERT_EQ(lhs.rectangleOfgrapheme(i), rhs.rectangleOfgrapheme(i));
+        }
+    }
+};
+
+TEST_F(shaped_text_tests, Replace)
+{
+    for (ttlet wrap : {false, true}) {
+        auto text = make_text(20);
+        auto shaped = shaped_text(text, 100.0f, alignment::middle_center, wrap);
+
+        ttlet style = text.front().style;
+
+        // Insert a character.
+        text.emplace(text.begin() + 50, grapheme{U'x'}, style);
+        shaped.replace(text, 50, 50, 51);
+        check_equal(shaped, shaped_text(text, 100.0f, alignment::middle_center, wrap));
+
+        // Split a paragraph.
+        text.emplace(text.begin() + 100, grapheme::PS(), style);
+        shaped.replace(text, 100, 100, 101);
+        check_equal(shaped, shaped_text(text, 100.0f, alignment::middle_center, wrap));
+
+        // Join two paragraphs by removing a paragraph separator.
+        ttlet separator = std::find_if(text.begin() + 200, text.end(), [](ttlet &c) {
+            return c.grapheme == grapheme::PS();
+        });
+        ttlet separator_index = std::distance(text.begin(), separator);
+        text.erase(separator);
+        shaped.replace(text, separator_index, separator_index + 1, separator_index);
+        check_equal(shaped, shaped_text(text, 100.0f, alignment::middle_center, wrap));
+
+        // Remove text spanning multiple paragraphs.
+        text.erase(text.begin() + 300, text.begin() + 450);
+        shaped.replace(text, 300, 450, 300);
+        check_equal(shaped, shaped_text(text, 100.0f, alignment::middle_center, wrap));
+
+        // Insert text at the end, before the last paragraph separator.
+        ttlet end_index = std::ssize(text) - 1;
+        text.emplace(text.begin() + end_index, grapheme{U'y'}, style);
+        shaped.replace(text, end_index, end_index, end_index + 1);
+        check_equal(shaped, shaped_text(text, 100.0f, alignment::middle_center, wrap));
+    }
+}
+
+TEST_F(shaped_text_tests, Benchmark)
+{
+    constexpr ssize_t nr_inserts = 100;
+
+    auto text = make_text(10'000);
+    ttlet style = text.front().style;
+    auto shaped = shaped_text(text, 500.0f, alignment::top_left, false);
+
+    // Type in the middle of the document.
+    ttlet index = std::ssize(text) / 2;
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (ssize_t i = 0; i != nr_inserts; ++i) {
+        text.emplace(text.begin() + index + i, grapheme{U'x'}, style);
+        shaped.replace(text, index + i, index + i, index + i + 1);
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+    for (ssize_t i = 0; i != nr_inserts; ++i) {
+        text.emplace(text.begin() + index + i, grapheme{U'x'}, style);
+        shaped = shaped_text(text, 500.0f, alignment::top_left, false);
+    }
+    ttlet t2 = std::chrono::steady_clock::now();
+
+    ttlet replace_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet shape_duration = std::chrono::duration<double>(t2 - t1).count();
+
+    std::cout << fmt::format(
+        "Insert into 10000 lines, replace: {:.3f} ms, shape: {:.3f} ms\n",
+        replace_duration / nr_inserts * 1e3,
+        shape_duration / nr_inserts * 1e3);
+}
+
+TEST_F(shaped_text_tests, EditableTextBenchmark)
+{
+    constexpr ssize_t nr_inserts = 100;
+
+    ttlet style = text_style("sans-serif", font_variant{}, 14.0f, color{}, text_decoration::None);
+
+    auto str = std::string{};
+    for (ssize_t i = 0; i != 10'000; ++i) {
+        str += fmt::format("Paragraph {} with a few words of text.\n", i);
+    }
+
+    auto field = editable_text(style);
+    field = str;
+    ttlet original = static_cast<std::string>(field);
+
+    // Type at the start of the text, before all the other paragraphs.
+    ttlet t0 = std::chrono::steady_clock::now();
+    for (ssize_t i = 0; i != nr_inserts; ++i) {
+        field.insertgrapheme(grapheme{U'x'});
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+    for (ssize_t i = 0; i != nr_inserts; ++i) {
+        field.handle_event(command::text_delete_char_prev);
+    }
+    ttlet t2 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(static_cast<std::string>(field), original);
+
+    ttlet insert_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet delete_duration = std::chrono::duration<double>(t2 - t1).count();
+
+    std::cout << fmt::format(
+        "Type into 10000 lines with editable_text, insert: {:.3f} ms, delete: {:.3f} ms\n",
+        insert_duration / nr_inserts * 1e3,
+        delete_duration / nr_inserts * 1e3);
+}
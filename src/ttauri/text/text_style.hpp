@@ -41,6 +41,11 @@ struct text_style {
     text_style &operator=(text_style const &) noexcept = default;
     text_style &operator=(text_style &&) noexcept = default;
 
+    [[nodiscard]] friend bool operator==(text_style const &lhs, text_style const &rhs) noexcept {
+        return lhs.family_id == rhs.family_id && lhs.variant == rhs.variant && lhs.size == rhs.size && lhs.color == rhs.color &&
+            lhs.decoration == rhs.decoration;
+    }
+
     float scaled_size() const noexcept {
         return size * dpi_scale;
     }
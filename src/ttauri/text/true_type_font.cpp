@@ -1303,6 +1303,15 @@ bool true_type_font::loadglyph_metrics(tt::glyph_id glyph_id, glyph_metrics &met
     return updateglyph_metrics(metricsGlyphIndex, metrics, glyph_id, lookahead_glyph_id);
 }
 
+[[nodiscard]] f32x4 true_type_font::get_kerning(tt::glyph_id current_glyph_id, tt::glyph_id next_glyph_id) const noexcept
+{
+    if (current_glyph_id && next_glyph_id) {
+        return getKerning(kernTableBytes, unitsPerEm, current_glyph_id, next_glyph_id);
+    } else {
+        return f32x4{0.0f, 0.0f};
+    }
+}
+
 struct SFNTHeader {
     big_uint32_buf_t scalerType;
     big_uint16_buf_t numTables;
@@ -130,6 +130,8 @@ public:
     bool loadglyph_metrics(tt::glyph_id glyph_id, glyph_metrics &metrics, tt::glyph_id lookahead_glyph_id = tt::glyph_id{})
         const noexcept override;
 
+    [[nodiscard]] f32x4 get_kerning(tt::glyph_id current_glyph_id, tt::glyph_id next_glyph_id) const noexcept override;
+
 private:
     /** Parses the directory table of the font file.
      * This function is called by the constructor to set up references
@@ -8,6 +8,7 @@
 #include "unicode_bidi_class.hpp"
 #include "unicode_bidi_bracket_type.hpp"
 #include "unicode_grapheme_cluster_break.hpp"
+#include "unicode_quick_check.hpp"
 #include "../required.hpp"
 
 namespace tt {
@@ -72,7 +73,11 @@ public:
         bool composition_canonical,
         uint8_t combining_class,
         uint8_t decomposition_length,
-        uint32_t decomposition_index
+        uint32_t decomposition_index,
+        unicode_quick_check NFC_quick_check = unicode_quick_check::yes,
+        unicode_quick_check NFD_quick_check = unicode_quick_check::yes,
+        unicode_quick_check NFKC_quick_check = unicode_quick_check::yes,
+        unicode_quick_check NFKD_quick_check = unicode_quick_check::yes
     ) noexcept :
         _general_info((static_cast<uint32_t>(code_point) << 10) | (static_cast<uint32_t>(general_category) << 5) | (static_cast<uint32_t>(grapheme_cluster_break) << 1)),
         _bidi_class(static_cast<uint32_t>(bidi_class)),
@@ -82,7 +87,11 @@ public:
         _composition_canonical(static_cast<uint32_t>(composition_canonical)),
         _combining_class(static_cast<uint32_t>(combining_class)),
         _decomposition_index(static_cast<uint32_t>(decomposition_index)),
-        _decomposition_length(static_cast<uint32_t>(decomposition_length))
+        _decomposition_length(static_cast<uint32_t>(decomposition_length)),
+        _NFC_quick_check(static_cast<uint32_t>(NFC_quick_check)),
+        _NFD_quick_check(static_cast<uint32_t>(NFD_quick_check)),
+        _NFKC_quick_check(static_cast<uint32_t>(NFKC_quick_check)),
+        _NFKD_quick_check(static_cast<uint32_t>(NFKD_quick_check))
     {
         tt_axiom(code_point <= 0x10ffff);
         tt_axiom(static_cast<uint32_t>(general_category) <= 0x1f);
@@ -217,6 +226,41 @@ public:
         return static_cast<size_t>(_decomposition_index);
     }
 
+    /** The NFC quick-check property of this code-point.
+     * @retval yes The code-point may occur in NFC text.
+     * @retval no The code-point never occurs in NFC text.
+     * @retval maybe The code-point may compose with a previous code-point.
+     */
+    [[nodiscard]] constexpr unicode_quick_check NFC_quick_check() const noexcept
+    {
+        return static_cast<unicode_quick_check>(_NFC_quick_check);
+    }
+
+    /** The NFD quick-check property of this code-point.
+     * @retval yes The code-point may occur in NFD text.
+     * @retval no The code-point has a canonical decomposition.
+     */
+    [[nodiscard]] constexpr unicode_quick_check NFD_quick_check() const noexcept
+    {
+        return static_cast<unicode_quick_check>(_NFD_quick_check);
+    }
+
+    /** The NFKC quick-check property of this code-point.
+     * @see NFC_quick_check
+     */
+    [[nodiscard]] constexpr unicode_quick_check NFKC_quick_check() const noexcept
+    {
+        return static_cast<unicode_quick_check>(_NFKC_quick_check);
+    }
+
+    /** The NFKD quick-check property of this code-point.
+     * @see NFD_quick_check
+     */
+    [[nodiscard]] constexpr unicode_quick_check NFKD_quick_check() const noexcept
+    {
+        return static_cast<unicode_quick_check>(_NFKD_quick_check);
+    }
+
     /** Get the canonical equivalent of this code-point.
      * The canonical equivalent is the code-point after NFC-normalization.
      * This is equal to canonical decomposition to a single code-point.
@@ -256,7 +300,11 @@ private:
 
     // 4th dword
     uint32_t _decomposition_length : 5;
-    uint32_t _decomposition_reserved2 : 27 = 0;
+    uint32_t _NFC_quick_check : 2;
+    uint32_t _NFD_quick_check : 2;
+    uint32_t _NFKC_quick_check : 2;
+    uint32_t _NFKD_quick_check : 2;
+    uint32_t _decomposition_reserved2 : 19 = 0;
 
 
     template<typename It>
@@ -0,0 +1,38 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/text/unicode_description.hpp"
+#include "ttauri/text/unicode_db.hpp"
+#include <gtest/gtest.h>
+#include <iostream>
+
+using namespace std;
+using namespace tt;
+
+TEST(unicode_description, Find)
+{
+    ttlet first = std::begin(detail::unicode_db_description_table);
+    ttlet last = std::end(detail::unicode_db_description_table);
+
+    for (char32_t code_point = 0; code_point <= 0x10'ffff; ++code_point) {
+        ttlet found = unicode_description_find(code_point).code_point();
+
+        if (unicode_description_find(first, last, code_point) != last) {
+            ASSERT_EQ(found, code_point);
+        } else {
+            // Code-points inside a range use the description at the start of the range,
+            // except for Hangul LVT syllables which use the description at the end.
+            ASSERT_TRUE(found < code_point || found == U'\ud7a3' || found == U'\ufffd') << static_cast<uint32_t>(code_point);
+        }
+    }
+
+    ASSERT_EQ(unicode_description_find(U'A').general_category(), unicode_general_category::Lu);
+    ASSERT_EQ(unicode_description_find(U'\u00e9').code_point(), U'\u00e9');
+    ASSERT_EQ(unicode_description_find(U'\u4e01').code_point(), U'\u4e00');
+    ASSERT_EQ(unicode_description_find(U'\u4e01').general_category(), unicode_general_category::Lo);
+    ASSERT_EQ(unicode_description_find(U'\uac1c').grapheme_cluster_break(), unicode_grapheme_cluster_break::LV);
+    ASSERT_EQ(unicode_description_find(U'\uac01').grapheme_cluster_break(), unicode_grapheme_cluster_break::LVT);
+    ASSERT_EQ(unicode_description_find(char32_t{0x0378}).code_point(), U'\ufffd');
+    ASSERT_EQ(unicode_description_find(char32_t{0x11'0000}).code_point(), U'\ufffd');
+}
@@ -8,6 +8,7 @@
 #include "ttauri/text/unicode_db.hpp"
 #include "../assert.hpp"
 #include "../required.hpp"
+#include "../algorithm.hpp"
 
 namespace tt {
 
@@ -35,7 +36,34 @@ static bool is_typographical_ligature(char32_t codePoint)
     }
 }
 
-static void unicode_decompose(char32_t code_point, bool compatible, bool ligature, bool paragraph, std::u32string &r) noexcept
+/** Writes code-points into a buffer supplied by the caller.
+ * Code-points that do not fit in the buffer are counted, but not written.
+ */
+class unicode_buffer_writer {
+public:
+    unicode_buffer_writer(std::span<char32_t> buffer) noexcept : _buffer(buffer) {}
+
+    unicode_buffer_writer &operator+=(char32_t code_point) noexcept
+    {
+        if (_size < _buffer.size()) {
+            _buffer[_size] = code_point;
+        }
+        ++_size;
+        return *this;
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _size;
+    }
+
+private:
+    std::span<char32_t> _buffer;
+    size_t _size = 0;
+};
+
+template<typename Output>
+static void unicode_decompose(char32_t code_point, bool compatible, bool ligature, bool paragraph, Output &r) noexcept
 {
     ttlet &description = unicode_description_find(code_point);
 
@@ -89,8 +117,8 @@ static void unicode_decompose(char32_t code_point, bool compatible, bool ligatur
     }
 }
 
-static void
-unicode_decompose(std::u32string_view text, bool compatible, bool ligature, bool paragraph, std::u32string &r) noexcept
+template<typename Output>
+static void unicode_decompose(std::u32string_view text, bool compatible, bool ligature, bool paragraph, Output &r) noexcept
 {
     for (ttlet c: text) {
         unicode_decompose(c, compatible, ligature, paragraph, r);
@@ -120,10 +148,13 @@ unicode_decompose(std::u32string_view text, bool compatible, bool ligature, bool
     }
 }
 
-static void unicode_compose(bool paragraph, bool composeCRLF, std::u32string &text) noexcept
+/** Compose the reordered text in place.
+ * @return The size of the composed text.
+ */
+[[nodiscard]] static size_t unicode_compose(bool paragraph, bool composeCRLF, std::span<char32_t> text) noexcept
 {
     if (text.size() <= 1) {
-        return;
+        return text.size();
     }
 
     size_t i = 0;
@@ -176,10 +207,10 @@ static void unicode_compose(bool paragraph, bool composeCRLF, std::u32string &te
         }
     }
 
-    text.resize(j);
+    return j;
 }
 
-static void unicode_reorder(std::u32string &text) noexcept
+static void unicode_reorder(std::span<char32_t> text) noexcept
 {
     for_each_cluster(
         text.begin(),
@@ -188,13 +219,19 @@ static void unicode_reorder(std::u32string &text) noexcept
             return (x >> 21) == 0;
         },
         [](auto s, auto e) {
-            std::stable_sort(s, e, [](auto a, auto b) {
-                return (a >> 21) < (b >> 21);
-            });
+            // A stable insertion sort, which does not allocate; clusters of combining characters are short.
+            for (auto it = s; it != e; ++it) {
+                ttlet code_unit = *it;
+                auto jt = it;
+                for (; jt != s && (*(jt - 1) >> 21) > (code_unit >> 21); --jt) {
+                    *jt = *(jt - 1);
+                }
+                *jt = code_unit;
+            }
         });
 }
 
-static void unicode_clean(std::u32string &text) noexcept
+static void unicode_clean(std::span<char32_t> text) noexcept
 {
     // clean up the text by removing the upper bits.
     for (auto &codePoint : text) {
@@ -202,43 +239,176 @@ static void unicode_clean(std::u32string &text) noexcept
     }
 }
 
-std::u32string unicode_NFD(std::u32string_view text, bool ligatures, bool paragraph) noexcept
+/** Reorder, optionally compose, and clean up the decomposed text in place.
+ * @return The size of the normalized text.
+ */
+[[nodiscard]] static size_t
+unicode_normalize_decomposed(std::span<char32_t> text, bool compose, bool paragraph, bool composeCRLF) noexcept
+{
+    unicode_reorder(text);
+    ttlet size = compose ? unicode_compose(paragraph, composeCRLF, text) : text.size();
+    unicode_clean(text.first(size));
+    return size;
+}
+
+[[nodiscard]] static std::u32string unicode_normalize(
+    std::u32string_view text,
+    unicode_quick_check check,
+    bool compatible,
+    bool compose,
+    bool ligatures,
+    bool paragraph,
+    bool composeCRLF) noexcept
 {
+    if (check == unicode_quick_check::yes) {
+        return std::u32string{text};
+    }
+
     auto r = std::u32string{};
-    unicode_decompose(text, false, ligatures, paragraph, r);
-    unicode_reorder(r);
-    unicode_clean(r);
+    r.reserve(text.size());
+    unicode_decompose(text, compatible, ligatures, paragraph, r);
+    r.resize(unicode_normalize_decomposed(r, compose, paragraph, composeCRLF));
     return r;
 }
 
+[[nodiscard]] static size_t unicode_normalize(
+    std::u32string_view text,
+    std::span<char32_t> r,
+    unicode_quick_check check,
+    bool compatible,
+    bool compose,
+    bool ligatures,
+    bool paragraph,
+    bool composeCRLF) noexcept
+{
+    if (check == unicode_quick_check::yes) {
+        if (text.size() <= r.size()) {
+            std::copy(text.begin(), text.end(), r.begin());
+        }
+        return text.size();
+    }
+
+    auto writer = unicode_buffer_writer{r};
+    unicode_decompose(text, compatible, ligatures, paragraph, writer);
+    if (writer.size() > r.size()) {
+        return writer.size();
+    }
+    return unicode_normalize_decomposed(r.first(writer.size()), compose, paragraph, composeCRLF);
+}
+
+/** Quick-check text for a normalization form.
+ * See UAX #15 Unicode Normalization Forms, section 9: Detecting Normalization Forms.
+ *
+ * @tparam QuickCheck The member function returning the quick-check property of a code-point.
+ */
+template<unicode_quick_check (unicode_description::*QuickCheck)() const noexcept>
+[[nodiscard]] static unicode_quick_check
+unicode_quick_check_text(std::u32string_view text, bool ligatures, bool paragraph, bool composeCRLF) noexcept
+{
+    auto r = unicode_quick_check::yes;
+    uint8_t previous_combining_class = 0;
+
+    for (ttlet code_point : text) {
+        if (code_point < 0x80) {
+            // ASCII code-points are starters which are normalized in each form.
+            if (paragraph && code_point == U'\n') {
+                return unicode_quick_check::no;
+            } else if (composeCRLF && code_point == U'\r') {
+                r = unicode_quick_check::maybe;
+            }
+            previous_combining_class = 0;
+            continue;
+        }
+
+        if (ligatures && is_typographical_ligature(code_point)) {
+            return unicode_quick_check::no;
+        }
+
+        ttlet &description = unicode_description_find(code_point);
+        ttlet combining_class = description.combining_class();
+        if (combining_class != 0 && previous_combining_class > combining_class) {
+            return unicode_quick_check::no;
+        }
+
+        ttlet check = (description.*QuickCheck)();
+        if (check == unicode_quick_check::no) {
+            return unicode_quick_check::no;
+        } else if (check == unicode_quick_check::maybe) {
+            r = unicode_quick_check::maybe;
+        }
+
+        previous_combining_class = combining_class;
+    }
+    return r;
+}
+
+unicode_quick_check unicode_NFD_quick_check(std::u32string_view text, bool ligatures, bool paragraph) noexcept
+{
+    return unicode_quick_check_text<&unicode_description::NFD_quick_check>(text, ligatures, paragraph, false);
+}
+
+unicode_quick_check unicode_NFC_quick_check(std::u32string_view text, bool ligatures, bool paragraph, bool composeCRLF) noexcept
+{
+    return unicode_quick_check_text<&unicode_description::NFC_quick_check>(text, ligatures, paragraph, composeCRLF);
+}
+
+unicode_quick_check unicode_NFKD_quick_check(std::u32string_view text, bool paragraph) noexcept
+{
+    return unicode_quick_check_text<&unicode_description::NFKD_quick_check>(text, false, paragraph, false);
+}
+
+unicode_quick_check unicode_NFKC_quick_check(std::u32string_view text, bool paragraph, bool composeCRLF) noexcept
+{
+    return unicode_quick_check_text<&unicode_description::NFKC_quick_check>(text, false, paragraph, composeCRLF);
+}
+
+std::u32string unicode_NFD(std::u32string_view text, bool ligatures, bool paragraph) noexcept
+{
+    ttlet check = unicode_NFD_quick_check(text, ligatures, paragraph);
+    return unicode_normalize(text, check, false, false, ligatures, paragraph, false);
+}
+
 [[nodiscard]] std::u32string
 unicode_NFC(std::u32string_view text, bool ligatures, bool paragraph, bool composeCRLF) noexcept
 {
-    auto r = std::u32string{};
-    unicode_decompose(text, false, ligatures, paragraph, r);
-    unicode_reorder(r);
-    unicode_compose(paragraph, composeCRLF, r);
-    unicode_clean(r);
-    return r;
+    ttlet check = unicode_NFC_quick_check(text, ligatures, paragraph, composeCRLF);
+    return unicode_normalize(text, check, false, true, ligatures, paragraph, composeCRLF);
 }
 
 std::u32string unicode_NFKD(std::u32string_view text, bool paragraph) noexcept
 {
-    auto r = std::u32string{};
-    unicode_decompose(text, true, false, paragraph, r);
-    unicode_reorder(r);
-    unicode_clean(r);
-    return r;
+    ttlet check = unicode_NFKD_quick_check(text, paragraph);
+    return unicode_normalize(text, check, true, false, false, paragraph, false);
 }
 
 std::u32string unicode_NFKC(std::u32string_view text, bool paragraph, bool composeCRLF) noexcept
 {
-    auto r = std::u32string{};
-    unicode_decompose(text, true, false, paragraph, r);
-    unicode_reorder(r);
-    unicode_compose(paragraph, composeCRLF, r);
-    unicode_clean(r);
-    return r;
+    ttlet check = unicode_NFKC_quick_check(text, paragraph, composeCRLF);
+    return unicode_normalize(text, check, true, true, false, paragraph, composeCRLF);
+}
+
+size_t unicode_NFD(std::u32string_view text, std::span<char32_t> r, bool ligatures, bool paragraph) noexcept
+{
+    ttlet check = unicode_NFD_quick_check(text, ligatures, paragraph);
+    return unicode_normalize(text, r, check, false, false, ligatures, paragraph, false);
+}
+
+size_t unicode_NFC(std::u32string_view text, std::span<char32_t> r, bool ligatures, bool paragraph, bool composeCRLF) noexcept
+{
+    ttlet check = unicode_NFC_quick_check(text, ligatures, paragraph, composeCRLF);
+    return unicode_normalize(text, r, check, false, true, ligatures, paragraph, composeCRLF);
+}
+
+size_t unicode_NFKD(std::u32string_view text, std::span<char32_t> r, bool paragraph) noexcept
+{
+    ttlet check = unicode_NFKD_quick_check(text, paragraph);
+    return unicode_normalize(text, r, check, true, false, false, paragraph, false);
+}
+
+size_t unicode_NFKC(std::u32string_view text, std::span<char32_t> r, bool paragraph, bool composeCRLF) noexcept
+{
+    ttlet check = unicode_NFKC_quick_check(text, paragraph, composeCRLF);
+    return unicode_normalize(text, r, check, true, true, false, paragraph, composeCRLF);
 }
 
 }
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include "unicode_quick_check.hpp"
 #include <string>
 #include <string_view>
+#include <span>
 
 namespace tt {
 
@@ -49,4 +51,70 @@ std::u32string unicode_NFKD(std::u32string_view text, bool paragraph = false) no
  */
 std::u32string unicode_NFKC(std::u32string_view text, bool paragraph = false, bool composeCRLF = false) noexcept;
 
+/** Convert text to Unicode-NFD normal form into a buffer.
+ *
+ * The buffer is also used for the intermediate decomposed text, which
+ * may be larger than the result.
+ *
+ * @param text to normalize.
+ * @param r The buffer to write the normalized text into.
+ * @param ligatures typographical-ligatures such as "fi" are decomposed.
+ * @param paragraph line-feed characters are converted to paragraph separators.
+ * @return The number of code-points written. When larger than the buffer, the size
+ *         of the buffer needed; the contents of the buffer are undefined.
+ */
+[[nodiscard]] size_t
+unicode_NFD(std::u32string_view text, std::span<char32_t> r, bool ligatures = false, bool paragraph = false) noexcept;
+
+/** Convert text to Unicode-NFC normal form into a buffer.
+ * @see unicode_NFD(std::u32string_view, std::span<char32_t>, bool, bool)
+ */
+[[nodiscard]] size_t unicode_NFC(
+    std::u32string_view text,
+    std::span<char32_t> r,
+    bool ligatures = false,
+    bool paragraph = false,
+    bool composeCRLF = false) noexcept;
+
+/** Convert text to Unicode-NFKD normal form into a buffer.
+ * @see unicode_NFD(std::u32string_view, std::span<char32_t>, bool, bool)
+ */
+[[nodiscard]] size_t unicode_NFKD(std::u32string_view text, std::span<char32_t> r, bool paragraph = false) noexcept;
+
+/** Convert text to Unicode-NFKC normal form into a buffer.
+ * @see unicode_NFD(std::u32string_view, std::span<char32_t>, bool, bool)
+ */
+[[nodiscard]] size_t
+unicode_NFKC(std::u32string_view text, std::span<char32_t> r, bool paragraph = false, bool composeCRLF = false) noexcept;
+
+/** Check if text is in Unicode-NFD normal form, without normalizing it.
+ * The arguments are the same as for `unicode_NFD()`, text that would be changed
+ * by the paragraph or ligature conversion is not normalized.
+ *
+ * @retval yes The text is normalized.
+ * @retval no The text is not normalized.
+ */
+[[nodiscard]] unicode_quick_check
+unicode_NFD_quick_check(std::u32string_view text, bool ligatures = false, bool paragraph = false) noexcept;
+
+/** Check if text is in Unicode-NFC normal form, without normalizing it.
+ * @retval yes The text is normalized.
+ * @retval no The text is not normalized.
+ * @retval maybe The text needs to be normalized to find out.
+ */
+[[nodiscard]] unicode_quick_check unicode_NFC_quick_check(
+    std::u32string_view text,
+    bool ligatures = false,
+    bool paragraph = false,
+    bool composeCRLF = false) noexcept;
+
+/** Check if text is in Unicode-NFKD normal form, without normalizing it.
+ */
+[[nodiscard]] unicode_quick_check unicode_NFKD_quick_check(std::u32string_view text, bool paragraph = false) noexcept;
+
+/** Check if text is in Unicode-NFKC normal form, without normalizing it.
+ */
+[[nodiscard]] unicode_quick_check
+unicode_NFKC_quick_check(std::u32string_view text, bool paragraph = false, bool composeCRLF = false) noexcept;
+
 }
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <string>
 #include <span>
+#include <chrono>
+#include <array>
 #include <fmt/format.h>
 
 using namespace std;
@@ -135,6 +137,58 @@ TEST_F(unicode_normalization, unicode_NFC_colon)
     ASSERT_EQ(unicode_NFD(tt::to_u32string("Audio device:")), tt::to_u32string("Audio device:"));
 }
 
+TEST_F(unicode_normalization, quick_check)
+{
+    for (ttlet &test : normalizationTests) {
+        ASSERT_NE(unicode_NFC_quick_check(test.c2), unicode_quick_check::no) << test.comment;
+        ASSERT_EQ(unicode_NFD_quick_check(test.c3), unicode_quick_check::yes) << test.comment;
+        ASSERT_NE(unicode_NFKC_quick_check(test.c4), unicode_quick_check::no) << test.comment;
+        ASSERT_EQ(unicode_NFKD_quick_check(test.c5), unicode_quick_check::yes) << test.comment;
+
+        if (unicode_NFC_quick_check(test.c1) == unicode_quick_check::yes) {
+            ASSERT_EQ(test.c1, test.c2) << test.comment;
+        }
+        if (unicode_NFD_quick_check(test.c1) == unicode_quick_check::yes) {
+            ASSERT_EQ(test.c1, test.c3) << test.comment;
+        }
+        if (unicode_NFKC_quick_check(test.c1) == unicode_quick_check::yes) {
+            ASSERT_EQ(test.c1, test.c4) << test.comment;
+        }
+        if (unicode_NFKD_quick_check(test.c1) == unicode_quick_check::yes) {
+            ASSERT_EQ(test.c1, test.c5) << test.comment;
+        }
+    }
+
+    ASSERT_EQ(unicode_NFC_quick_check(U"Audio device:"), unicode_quick_check::yes);
+    ASSERT_EQ(unicode_NFC_quick_check(U"line\n", false, true), unicode_quick_check::no);
+    ASSERT_EQ(unicode_NFC_quick_check(U"\ufb01", true), unicode_quick_check::no);
+    ASSERT_EQ(unicode_NFC_quick_check(U"\ufb01"), unicode_quick_check::yes);
+    ASSERT_EQ(unicode_NFKC_quick_check(U"\ufb01"), unicode_quick_check::no);
+}
+
+TEST_F(unicode_normalization, buffer)
+{
+    auto buffer = std::array<char32_t, 256>{};
+
+    for (ttlet &test : normalizationTests) {
+        auto size = unicode_NFC(test.c1, buffer);
+        ASSERT_EQ(std::u32string_view(buffer.data(), size), test.c2) << test.comment;
+        size = unicode_NFD(test.c1, buffer);
+        ASSERT_EQ(std::u32string_view(buffer.data(), size), test.c3) << test.comment;
+        size = unicode_NFKC(test.c1, buffer);
+        ASSERT_EQ(std::u32string_view(buffer.data(), size), test.c4) << test.comment;
+        size = unicode_NFKD(test.c1, buffer);
+        ASSERT_EQ(std::u32string_view(buffer.data(), size), test.c5) << test.comment;
+    }
+
+    // When the buffer is too small the size of the buffer needed is returned.
+    auto small_buffer = std::array<char32_t, 1>{};
+    ASSERT_EQ(unicode_NFD(U"\u00e9", small_buffer), 2);
+    ASSERT_EQ(unicode_NFC(U"e\u0301", small_buffer), 2);
+    ASSERT_EQ(unicode_NFC(U"e\u0301", buffer), 1);
+    ASSERT_EQ(buffer[0], U'\u00e9');
+}
+
 TEST_F(unicode_normalization, toNFC_c1)
 {
     for (ttlet &test : normalizationTests) {
@@ -317,3 +371,55 @@ TEST_F(unicode_normalization, Invariant)
     }
 }
 #endif
+
+/** Create a large text mixing scripts, precomposed and decomposed characters.
+ */
+[[nodiscard]] static std::u32string make_mixed_script_text()
+{
+    constexpr auto words = std::array<std::u32string_view, 11>{
+        U"The quick brown fox ",
+        U"café naïve Ångström ",
+        U"cafe\u0301 nai\u0308ve A\u030angstro\u0308m ",
+        U"Καλημέρα ",
+        U"Привет мир ",
+        U"مرحبا بالعالم ",
+        U"नमस्ते ",
+        U"你好世界 ",
+        U"안녕하세요 ",
+        U"각 ",
+        U"\U0001f600\U0001f44d\U0001f3fd\n"};
+
+    auto r = std::u32string{};
+    for (ssize_t i = 0; i != 50'000; ++i) {
+        r += words[(i * 7) % std::ssize(words)];
+    }
+    return r;
+}
+
+TEST(unicode_normalization_performance, Benchmark)
+{
+    ttlet text = make_mixed_script_text();
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    ttlet nfd = unicode_NFD(text);
+    ttlet t1 = std::chrono::steady_clock::now();
+    ttlet nfc = unicode_NFC(text);
+    ttlet t2 = std::chrono::steady_clock::now();
+    // Text which is already normalized is found by the quick-check.
+    ttlet nfc_nfc = unicode_NFC(nfc);
+    ttlet t3 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(unicode_NFC(nfd), nfc);
+    ASSERT_EQ(nfc_nfc, nfc);
+
+    ttlet size = static_cast<double>(std::ssize(text));
+    ttlet nfd_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet nfc_duration = std::chrono::duration<double>(t2 - t1).count();
+    ttlet nfc_nfc_duration = std::chrono::duration<double>(t3 - t2).count();
+
+    std::cout << fmt::format(
+        "unicode_NFD: {:.1f} Mcode-points/s, unicode_NFC: {:.1f} Mcode-points/s, unicode_NFC of NFC: {:.1f} Mcode-points/s\n",
+        size / nfd_duration / 1e6,
+        size / nfc_duration / 1e6,
+        static_cast<double>(std::ssize(nfc)) / nfc_nfc_duration / 1e6);
+}
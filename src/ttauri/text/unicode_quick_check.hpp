@@ -0,0 +1,20 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstdint>
+
+namespace tt {
+
+/** Result of a normalization quick-check.
+ * See UAX #15 Unicode Normalization Forms, section 9: Detecting Normalization Forms.
+ */
+enum class unicode_quick_check : uint8_t {
+    yes, ///< The text is normalized.
+    no, ///< The text is not normalized.
+    maybe ///< The text needs to be normalized to find out.
+};
+
+}
@@ -0,0 +1,75 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "thread_pool.hpp"
+#include "thread.hpp"
+#include <algorithm>
+
+namespace tt {
+
+thread_pool::thread_pool(std::string name, ssize_t nr_threads) : _name(std::move(name))
+{
+    if (nr_threads == 0) {
+        nr_threads = std::max(ssize_t{1}, narrow_cast<ssize_t>(std::thread::hardware_concurrency()));
+    }
+
+    _threads.reserve(nr_threads);
+    try {
+        for (ssize_t i = 0; i != nr_threads; ++i) {
+            _threads.emplace_back([this]() {
+                set_thread_name(_name);
+                loop();
+            });
+        }
+    } catch (...) {
+        // The destructor is not called when the constructor throws, the
+        // threads that did start must be joined before their std::thread is destroyed.
+        stop_and_join();
+        throw;
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    stop_and_join();
+}
+
+void thread_pool::stop_and_join() noexcept
+{
+    {
+        ttlet lock = std::scoped_lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+
+    for (auto &thread : _threads) {
+        thread.join();
+    }
+}
+
+void thread_pool::loop() noexcept
+{
+    while (true) {
+        auto task = std::function<void()>{};
+        {
+            auto lock = std::unique_lock(_mutex);
+            _condition.wait(lock, [this]() {
+                return _stop || !_tasks.empty();
+            });
+
+            if (_tasks.empty()) {
+                // _stop was set and all work is done.
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        // Exceptions are captured by the packaged_task into the future.
+        task();
+    }
+}
+
+} // namespace tt
@@ -0,0 +1,92 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <future>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace tt {
+
+/** A fixed set of worker threads executing tasks in the order they were submitted.
+ */
+class thread_pool {
+public:
+    /** Create a thread pool.
+     *
+     * @param name The name of the worker threads.
+     * @param nr_threads The number of worker threads, or zero to use one thread per CPU.
+     */
+    thread_pool(std::string name, ssize_t nr_threads = 0);
+
+    /** Destroy the thread pool.
+     * Tasks that were already submitted are executed before the worker threads exit.
+     */
+    ~thread_pool();
+
+    thread_pool(thread_pool const &) = delete;
+    thread_pool(thread_pool &&) = delete;
+    thread_pool &operator=(thread_pool const &) = delete;
+    thread_pool &operator=(thread_pool &&) = delete;
+
+    [[nodiscard]] ssize_t size() const noexcept
+    {
+        return std::ssize(_threads);
+    }
+
+    /** Submit a task to be executed on one of the worker threads.
+     *
+     * @param func The function to call without arguments.
+     * @return A future with the return value, or the exception thrown by the function.
+     */
+    template<typename Func>
+    [[nodiscard]] std::future<std::invoke_result_t<std::decay_t<Func>>> submit(Func &&func)
+    {
+        using result_type = std::invoke_result_t<std::decay_t<Func>>;
+
+        // std::function must be copyable, which a packaged_task is not.
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<Func>(func));
+        auto future = task->get_future();
+        {
+            ttlet lock = std::scoped_lock(_mutex);
+            tt_axiom(!_stop);
+            _tasks.emplace_back([task = std::move(task)]() {
+                (*task)();
+            });
+        }
+        _condition.notify_one();
+        return future;
+    }
+
+private:
+    std::string _name;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::function<void()>> _tasks;
+    std::vector<std::thread> _threads;
+
+    /** Set to true to ask the threads to exit once the task queue is empty.
+     */
+    bool _stop = false;
+
+    /** The thread procedure.
+     */
+    void loop() noexcept;
+
+    /** Let the threads finish the remaining tasks and wait for them to exit.
+     */
+    void stop_and_join() noexcept;
+};
+
+} // namespace tt
@@ -0,0 +1,50 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/thread_pool.hpp"
+#include "ttauri/exception.hpp"
+#include "ttauri/required.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+
+using namespace std;
+using namespace tt;
+
+TEST(ThreadPool, Submit) {
+    auto pool = thread_pool("test", 4);
+    ASSERT_EQ(pool.size(), 4);
+
+    auto futures = std::vector<std::future<int>>{};
+    for (int i = 0; i != 100; ++i) {
+        futures.push_back(pool.submit([i]() {
+            return i * i;
+        }));
+    }
+
+    for (int i = 0; i != 100; ++i) {
+        ASSERT_EQ(futures[i].get(), i * i);
+    }
+}
+
+TEST(ThreadPool, Exception) {
+    auto pool = thread_pool("test", 2);
+
+    auto future = pool.submit([]() -> int {
+        throw parse_error("test");
+    });
+    ASSERT_THROW(future.get(), parse_error);
+}
+
+TEST(ThreadPool, FinishOnDestruct) {
+    auto counter = std::atomic<int>{0};
+    {
+        auto pool = thread_pool("test", 3);
+        for (int i = 0; i != 50; ++i) {
+            [[maybe_unused]] auto future = pool.submit([&counter]() {
+                ++counter;
+            });
+        }
+    }
+    ASSERT_EQ(counter.load(), 50);
+}
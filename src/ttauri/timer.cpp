@@ -24,6 +24,32 @@ namespace tt {
     return next_wakeup;
 }
 
+[[nodiscard]] uint64_t timer::to_tick(timer::time_point time_point) noexcept
+{
+    return narrow_cast<uint64_t>(time_point.time_since_epoch() / tick_duration);
+}
+
+[[nodiscard]] timer::time_point timer::from_tick(uint64_t tick) noexcept
+{
+    return timer::time_point{tick_duration * narrow_cast<int64_t>(tick)};
+}
+
+void timer::insert_with_lock_held(timer::time_point current_time, callback_entry entry) noexcept
+{
+    if (wheel.empty()) {
+        // Start counting from the current time, instead from the last time the timer was in use.
+        wheel.reset(to_tick(current_time), [](auto...) {});
+    }
+
+    // Round up, so that the callback is never executed before its wakeup.
+    ttlet next_wakeup = calculate_next_wakeup(current_time, entry.interval);
+    ttlet expiry = to_tick(next_wakeup - timer::duration{1}) + 1;
+    ttlet tolerance = narrow_cast<uint64_t>(entry.tolerance / tick_duration);
+
+    ttlet key = entry.key;
+    wheel_ids[key] = wheel.insert(expiry, std::move(entry), tolerance);
+}
+
 timer::timer(std::string name) noexcept :
     name(std::move(name))
 {
@@ -32,7 +58,7 @@ timer::timer(std::string name) noexcept :
 timer::~timer()
 {
     stop();
-    tt_assert(std::ssize(callback_list) == 0);
+    tt_assert(wheel.empty());
 }
 
 void timer::start_with_lock_held() noexcept
@@ -77,34 +103,41 @@ void timer::stop() noexcept
     ttlet lock = std::scoped_lock(mutex);
 
     auto triggered_callbacks = std::vector<callback_ptr_type>{};
-    auto next_wakeup = timer::time_point::max();
-
-    auto i = callback_list.begin();
-    while (i != callback_list.end()) {
-        auto callback_ptr = i->callback_ptr.lock();
-
-        if (callback_ptr) {
-            if (i->next_wakeup <= current_time) {
-                triggered_callbacks.push_back(callback_ptr);
-                i->next_wakeup = calculate_next_wakeup(current_time, i->interval);
-            }
-
-            // Protection against clock_settime().
-            if (i->next_wakeup > current_time + i->interval) {
-                i->next_wakeup = calculate_next_wakeup(current_time, i->interval);
-            }
-
-            if (i->next_wakeup < next_wakeup) {
-                next_wakeup = i->next_wakeup;
-            }
-
-            ++i;
-        } else {
-            i = callback_list.erase(i);
+    auto rescheduled_entries = std::vector<callback_entry>{};
+
+    ttlet current_tick = to_tick(current_time);
+    if (current_tick < wheel.now()) {
+        // Protection against clock_settime(), reschedule all callbacks from the new current time.
+        wheel.reset(current_tick, [&rescheduled_entries](auto, callback_entry &&entry) {
+            rescheduled_entries.push_back(std::move(entry));
+        });
+
+        for (auto &entry : rescheduled_entries) {
+            insert_with_lock_held(current_time, std::move(entry));
         }
+        rescheduled_entries.clear();
+    }
+
+    // All callbacks that are due are expired from the wheel together, then the callbacks that
+    // are still alive are scheduled at their next wakeup.
+    auto triggered_entries = std::vector<std::pair<timer_wheel_id, callback_entry>>{};
+    wheel.advance(current_tick, [&triggered_entries](auto id, callback_entry &&entry) {
+        triggered_entries.emplace_back(id, std::move(entry));
+    });
+
+    for (auto &[id, entry] : triggered_entries) {
+        if (auto callback_ptr = entry.callback_ptr.lock()) {
+            triggered_callbacks.push_back(std::move(callback_ptr));
+            insert_with_lock_held(current_time, std::move(entry));
 
-        
+        } else if (ttlet i = wheel_ids.find(entry.key); i != wheel_ids.end() && i->second == id) {
+            // The address of a destroyed callback may have been reused by a new callback.
+            wheel_ids.erase(i);
+        }
     }
+
+    ttlet next_tick = wheel.next_tick();
+    ttlet next_wakeup = next_tick ? from_tick(*next_tick) : timer::time_point::max();
     return {triggered_callbacks, next_wakeup};
 }
 
@@ -128,7 +161,7 @@ void timer::loop() noexcept
         }
 
         ttlet lock = std::scoped_lock(mutex);
-        if (stop_thread || std::ssize(callback_list) == 0) {
+        if (stop_thread || wheel.empty()) {
             break;
         }
     }
@@ -137,12 +170,12 @@ void timer::loop() noexcept
     ttlet lock = std::scoped_lock(mutex);
     
     ttlet current_time = hires_utc_clock::now();
-    for (ttlet &item: callback_list) {
-        if (auto callback_ptr_ = item.callback_ptr.lock()) {
+    wheel.reset(to_tick(current_time), [current_time](auto, callback_entry &&entry) {
+        if (auto callback_ptr_ = entry.callback_ptr.lock()) {
             (*callback_ptr_)(current_time, true);
         }
-    }
-    callback_list.clear();
+    });
+    wheel_ids.clear();
 
     tt_log_info("Timer {}: finished", name);
 }
@@ -151,11 +184,11 @@ void timer::remove_callback(callback_ptr_type const &callback_ptr) noexcept
 {
     ttlet lock = std::scoped_lock(mutex);
 
-    ttlet i = std::remove_if(callback_list.begin(), callback_list.end(), [&callback_ptr](ttlet &item) {
-        auto callback_ptr_ = item.callback_ptr.lock();
-        return !callback_ptr_ || callback_ptr_ == callback_ptr;
-    });
-    callback_list.erase(i, callback_list.end());
+    ttlet i = wheel_ids.find(callback_ptr.get());
+    if (i != wheel_ids.end()) {
+        [[maybe_unused]] ttlet entry = wheel.cancel(i->second);
+        wheel_ids.erase(i);
+    }
 }
 
 }
@@ -6,11 +6,13 @@
 #pragma once
 
 #include "hires_utc_clock.hpp"
+#include "timer_wheel.hpp"
 #include <mutex>
 #include <vector>
 #include <functional>
 #include <tuple>
 #include <thread>
+#include <unordered_map>
 
 namespace tt {
 
@@ -55,26 +57,27 @@ public:
      *
      * Since there is only a single thread, please make sure the callback executes quickly.
      *
+     * Callbacks which are due within the tolerance of each other may be coalesced, so that
+     * they are executed together and the timer thread needs to wake up less often.
+     *
      * @param interval The interval to execute the callback at.
      * @param callback The callback function.
+     * @param tolerance The duration the callback may be executed late.
      * @return An shared_ptr to retain the callback function, when the shared_ptr is removed then
      *         the callback can no longer be called.
      */
     template<typename Callback>
-    [[nodiscard]] std::shared_ptr<callback_type> add_callback(duration interval, Callback callback) noexcept
+    [[nodiscard]] std::shared_ptr<callback_type>
+    add_callback(duration interval, Callback callback, duration tolerance = duration::zero()) noexcept
     {
         ttlet lock = std::scoped_lock(mutex);
         ttlet current_time = hires_utc_clock::now();
 
         auto callback_ptr = std::make_shared<callback_type>(std::forward<Callback>(callback));
 
-        callback_list.emplace_back(
-            interval,
-            calculate_next_wakeup(current_time, interval),
-            callback_ptr
-        );
+        insert_with_lock_held(current_time, callback_entry{interval, tolerance, callback_ptr.get(), callback_ptr});
 
-        if (std::ssize(callback_list) == 1) {
+        if (wheel.size() == 1) {
             start_with_lock_held();
         }
 
@@ -88,30 +91,41 @@ public:
 private:
     struct callback_entry {
         duration interval;
-        time_point next_wakeup;
-        std::weak_ptr<callback_type> callback_ptr;
+        duration tolerance;
 
-        callback_entry(duration interval, time_point next_wakeup, std::shared_ptr<callback_type> const &callback_ptr) noexcept :
-            interval(interval), next_wakeup(next_wakeup), callback_ptr(callback_ptr)
-        {
-        }
+        /** The callback function, used as the key to find the entry in the wheel.
+         * This pointer is never dereferenced, since the callback may have been destroyed.
+         */
+        callback_type const *key;
+
+        std::weak_ptr<callback_type> callback_ptr;
     };
 
+    /** The resolution of the timer wheel.
+     */
+    static constexpr duration tick_duration = std::chrono::milliseconds{1};
+
     /** Name of the timer.
      */
     std::string name;
 
     mutable std::mutex mutex;
     std::thread thread;
-    std::vector<callback_entry> callback_list;
-    size_t callback_count = 0;
+
+    /** The callbacks, scheduled at their next wakeup.
+     */
+    timer_wheel<callback_entry> wheel;
+
+    /** The identifier in the wheel of each callback.
+     */
+    std::unordered_map<callback_type const *, timer_wheel_id> wheel_ids;
 
     /** Set to true to ask the thread to exit.
      */
     bool stop_thread;
 
     /** Find the callbacks that have triggered.
-     * This function will also update the wakup times of triggered callbacks.
+     * Triggered callbacks are scheduled again at their next wakeup.
      *
      * @return List of triggered callbacks, Time to wakeup to trigger on the next callback.
      */
@@ -134,6 +148,13 @@ private:
      */
     void stop_with_lock_held() noexcept;
 
+    /** Schedule a callback at its next wakeup.
+     */
+    void insert_with_lock_held(time_point current_time, callback_entry entry) noexcept;
+
+    [[nodiscard]] static uint64_t to_tick(time_point time_point) noexcept;
+    [[nodiscard]] static time_point from_tick(uint64_t tick) noexcept;
+
     [[nodiscard]] static time_point calculate_next_wakeup(time_point current_time, duration interval) noexcept;
 };
 
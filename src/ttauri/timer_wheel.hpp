@@ -0,0 +1,418 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "assert.hpp"
+#include <vector>
+#include <array>
+#include <optional>
+#include <bit>
+#include <limits>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+namespace tt {
+
+/** The identifier of an item in a timer_wheel.
+ */
+struct timer_wheel_id {
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+
+    [[nodiscard]] friend bool operator==(timer_wheel_id const &lhs, timer_wheel_id const &rhs) noexcept = default;
+};
+
+/** A hierarchical timing wheel.
+ *
+ * Items are scheduled to expire at a tick. Inserting and cancelling an item is O(1).
+ * The wheel consists of `nr_levels` levels of 64 slots, each level counting 64 times
+ * slower than the level below it. An item is stored in the level of the highest digit
+ * in which its expiry differs from the current tick. When the current tick reaches the
+ * slot of an item on a higher level, the items of that slot are moved down to a lower
+ * level; on the lowest level all items in a slot expire together.
+ *
+ * Items that expire beyond the range of all levels are kept in an overflow list.
+ *
+ * The wheel does not know about time nor threads; the owner converts time to ticks
+ * and is responsible for locking.
+ *
+ * @tparam T The type of the value stored with each item.
+ */
+template<typename T>
+class timer_wheel {
+public:
+    using value_type = T;
+    using id_type = timer_wheel_id;
+
+    static constexpr int nr_levels = 6;
+    static constexpr int slot_bits = 6;
+    static constexpr int nr_slots = 1 << slot_bits;
+
+    /** Create a timer wheel.
+     *
+     * @param now The current tick.
+     */
+    timer_wheel(uint64_t now = 0) noexcept : _now(now)
+    {
+        _heads.fill(nil);
+    }
+
+    timer_wheel(timer_wheel const &) = delete;
+    timer_wheel(timer_wheel &&) = delete;
+    timer_wheel &operator=(timer_wheel const &) = delete;
+    timer_wheel &operator=(timer_wheel &&) = delete;
+
+    /** The current tick.
+     */
+    [[nodiscard]] uint64_t now() const noexcept
+    {
+        return _now;
+    }
+
+    /** The number of items in the wheel.
+     */
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    /** Insert an item.
+     *
+     * When a tolerance is given, the expiry is rounded up to a multiple of the largest
+     * power of two not above the tolerance. Items that are due around the same time then
+     * expire at the same tick, so that the owner needs to wake up less often.
+     *
+     * @param expiry The tick at which the item expires, items in the past expire on the next call to `advance()`.
+     * @param value The value to store with the item.
+     * @param tolerance The number of ticks the item may expire late.
+     * @return The identifier of the item, used to cancel it.
+     */
+    id_type insert(uint64_t expiry, value_type value, uint64_t tolerance = 0) noexcept
+    {
+        if (tolerance > 0) {
+            ttlet granularity = std::bit_floor(tolerance);
+            expiry = (expiry + (granularity - 1)) & ~(granularity - 1);
+        }
+
+        ttlet index = allocate_node();
+        auto &node = _nodes[index];
+        node.expiry = expiry;
+        node.value = std::move(value);
+        link(index);
+
+        ++_size;
+        return {index, node.generation};
+    }
+
+    /** Cancel an item.
+     *
+     * @param id The identifier returned by `insert()`.
+     * @return The value of the item, or empty if the item already expired or was cancelled.
+     */
+    std::optional<value_type> cancel(id_type id) noexcept
+    {
+        if (id.index >= _nodes.size() || _nodes[id.index].generation != id.generation || !_nodes[id.index].in_use) {
+            return {};
+        }
+
+        unlink(id.index);
+        auto r = std::move(_nodes[id.index].value);
+        free_node(id.index);
+        --_size;
+        return r;
+    }
+
+    /** Find the value of an item.
+     *
+     * @return A pointer to the value, or nullptr if the item already expired or was cancelled.
+     */
+    [[nodiscard]] value_type *find(id_type id) noexcept
+    {
+        if (id.index >= _nodes.size() || _nodes[id.index].generation != id.generation || !_nodes[id.index].in_use) {
+            return nullptr;
+        }
+        return &_nodes[id.index].value;
+    }
+
+    /** The next tick at which `advance()` has work to do.
+     *
+     * This is a lower bound of the expiry of the first item; at this tick items may only
+     * be moved to a lower level.
+     *
+     * @return The tick, or empty when the wheel is empty.
+     */
+    [[nodiscard]] std::optional<uint64_t> next_tick() const noexcept
+    {
+        if (ttlet event = next_event()) {
+            return event->tick;
+        } else {
+            return {};
+        }
+    }
+
+    /** Advance the wheel to a tick and expire the items that are due.
+     *
+     * The items of a slot are expired together; items in a slot are not ordered.
+     *
+     * @param to The new current tick, ticks before the current tick are ignored.
+     * @param on_expire A function called as `on_expire(id_type, value_type &&)` for each expired item.
+     * @return The number of expired items.
+     */
+    template<typename OnExpire>
+    size_t advance(uint64_t to, OnExpire &&on_expire) noexcept
+    {
+        size_t r = 0;
+
+        while (true) {
+            r += expire_list(due_list, on_expire);
+
+            ttlet event = next_event();
+            if (!event || event->tick > to) {
+                break;
+            }
+
+            _now = event->tick;
+            if (event->list < list_index(1, 0)) {
+                r += expire_list(event->list, on_expire);
+            } else {
+                relink_list(event->list);
+            }
+        }
+
+        _now = std::max(_now, to);
+        return r;
+    }
+
+    /** Remove all items and set the current tick.
+     *
+     * @param now The new current tick, which may be before the current tick.
+     * @param on_item A function called as `on_item(id_type, value_type &&)` for each removed item.
+     */
+    template<typename OnItem>
+    void reset(uint64_t now, OnItem &&on_item) noexcept
+    {
+        for (uint32_t list = 0; list != nr_lists; ++list) {
+            expire_list(list, on_item);
+        }
+        _now = now;
+    }
+
+private:
+    static constexpr uint32_t nil = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t overflow_list = nr_levels * nr_slots;
+    static constexpr uint32_t due_list = overflow_list + 1;
+    static constexpr uint32_t nr_lists = due_list + 1;
+
+    struct node_type {
+        uint64_t expiry = 0;
+        uint32_t prev = nil;
+        uint32_t next = nil;
+        uint32_t list = nil;
+        uint32_t generation = 0;
+        bool in_use = false;
+        value_type value = {};
+    };
+
+    uint64_t _now;
+    size_t _size = 0;
+    std::vector<node_type> _nodes;
+    uint32_t _free_head = nil;
+
+    /** The first node of each slot of each level, followed by the overflow and due lists.
+     */
+    std::array<uint32_t, nr_lists> _heads;
+
+    /** For each level a bit is set for each slot that is not empty.
+     */
+    std::array<uint64_t, nr_levels> _occupied = {};
+
+    struct event_type {
+        uint64_t tick;
+        uint32_t list;
+    };
+
+    /** The next tick at which a list needs to be expired or moved to a lower level.
+     */
+    [[nodiscard]] std::optional<event_type> next_event() const noexcept
+    {
+        if (_size == 0) {
+            return {};
+        }
+
+        if (_heads[due_list] != nil) {
+            return event_type{_now, due_list};
+        }
+
+        // The slots of a lower level are always reached before the slots of a higher level.
+        for (int level = 0; level != nr_levels; ++level) {
+            if (ttlet slot = next_slot(level)) {
+                return event_type{slot_tick(level, *slot), list_index(level, *slot)};
+            }
+        }
+
+        // Only items in the overflow list, which are moved down when the highest level wraps around.
+        return event_type{((_now >> (slot_bits * nr_levels)) + 1) << (slot_bits * nr_levels), overflow_list};
+    }
+
+    [[nodiscard]] static constexpr uint32_t list_index(int level, int slot) noexcept
+    {
+        return static_cast<uint32_t>(level * nr_slots + slot);
+    }
+
+    /** The first non-empty slot after the current slot of a level.
+     */
+    [[nodiscard]] std::optional<int> next_slot(int level) const noexcept
+    {
+        ttlet current = static_cast<int>((_now >> (slot_bits * level)) & (nr_slots - 1));
+
+        // Items are never stored in the current slot of a level above zero.
+        ttlet first = level == 0 ? current : current + 1;
+        if (first >= nr_slots) {
+            return {};
+        }
+
+        ttlet mask = _occupied[level] & (~uint64_t{0} << first);
+        if (mask == 0) {
+            return {};
+        }
+        return std::countr_zero(mask);
+    }
+
+    /** The tick at which a slot of a level is reached.
+     */
+    [[nodiscard]] uint64_t slot_tick(int level, int slot) const noexcept
+    {
+        ttlet shift = slot_bits * level;
+        ttlet base = (_now >> (shift + slot_bits)) << (shift + slot_bits);
+        return base | (static_cast<uint64_t>(slot) << shift);
+    }
+
+    [[nodiscard]] uint32_t allocate_node() noexcept
+    {
+        if (_free_head != nil) {
+            ttlet index = _free_head;
+            _free_head = _nodes[index].next;
+            _nodes[index].in_use = true;
+            return index;
+        }
+
+        tt_axiom(_nodes.size() < nil);
+        ttlet index = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back().in_use = true;
+        return index;
+    }
+
+    void free_node(uint32_t index) noexcept
+    {
+        auto &node = _nodes[index];
+        node.value = {};
+        node.in_use = false;
+        ++node.generation;
+        node.next = _free_head;
+        _free_head = index;
+    }
+
+    /** Add a node to the list for its expiry.
+     */
+    void link(uint32_t index) noexcept
+    {
+        auto &node = _nodes[index];
+
+        uint32_t list;
+        if (node.expiry <= _now) {
+            list = due_list;
+        } else {
+            ttlet level = (std::bit_width(node.expiry ^ _now) - 1) / slot_bits;
+            if (level >= nr_levels) {
+                list = overflow_list;
+            } else {
+                ttlet slot = static_cast<int>((node.expiry >> (slot_bits * level)) & (nr_slots - 1));
+                list = list_index(level, slot);
+                _occupied[level] |= uint64_t{1} << slot;
+            }
+        }
+
+        node.list = list;
+        node.prev = nil;
+        node.next = _heads[list];
+        if (node.next != nil) {
+            _nodes[node.next].prev = index;
+        }
+        _heads[list] = index;
+    }
+
+    /** Remove a node from its list.
+     */
+    void unlink(uint32_t index) noexcept
+    {
+        auto &node = _nodes[index];
+
+        if (node.prev != nil) {
+            _nodes[node.prev].next = node.next;
+        } else {
+            _heads[node.list] = node.next;
+            if (node.next == nil && node.list < overflow_list) {
+                _occupied[node.list / nr_slots] &= ~(uint64_t{1} << (node.list % nr_slots));
+            }
+        }
+        if (node.next != nil) {
+            _nodes[node.next].prev = node.prev;
+        }
+        node.list = nil;
+    }
+
+    /** Detach a complete list.
+     * @return The first node of the list.
+     */
+    [[nodiscard]] uint32_t detach_list(uint32_t list) noexcept
+    {
+        ttlet first = std::exchange(_heads[list], nil);
+        if (list < overflow_list) {
+            _occupied[list / nr_slots] &= ~(uint64_t{1} << (list % nr_slots));
+        }
+        return first;
+    }
+
+    /** Move all the nodes of a list to the list for their expiry relative to the current tick.
+     */
+    void relink_list(uint32_t list) noexcept
+    {
+        auto index = detach_list(list);
+        while (index != nil) {
+            ttlet next = _nodes[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+    template<typename OnExpire>
+    size_t expire_list(uint32_t list, OnExpire &on_expire) noexcept
+    {
+        size_t r = 0;
+        auto index = detach_list(list);
+        while (index != nil) {
+            auto &node = _nodes[index];
+            ttlet next = node.next;
+            ttlet id = id_type{index, node.generation};
+            auto value = std::move(node.value);
+            free_node(index);
+            --_size;
+            ++r;
+
+            on_expire(id, std::move(value));
+            index = next;
+        }
+        return r;
+    }
+};
+
+} // namespace tt
@@ -0,0 +1,187 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/timer_wheel.hpp"
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+using namespace std;
+using namespace tt;
+
+TEST(timer_wheel, expire)
+{
+    auto wheel = timer_wheel<int>(1000);
+
+    wheel.insert(1000, 0);
+    wheel.insert(1001, 1);
+    wheel.insert(1063, 2);
+    wheel.insert(1064, 3);
+    wheel.insert(5000, 4);
+    wheel.insert(1000 + (uint64_t{1} << 40), 5);
+    ASSERT_EQ(wheel.size(), 6);
+
+    auto expired = std::vector<int>{};
+    auto on_expire = [&expired](auto, int value) {
+        expired.push_back(value);
+    };
+
+    // Items which are due now expire on the next advance.
+    ASSERT_EQ(wheel.next_tick(), 1000);
+    ASSERT_EQ(wheel.advance(1000, on_expire), 1);
+    ASSERT_EQ(expired, std::vector<int>{0});
+
+    ASSERT_EQ(wheel.advance(1063, on_expire), 2);
+    ASSERT_EQ(expired, (std::vector<int>{0, 1, 2}));
+    ASSERT_EQ(wheel.now(), 1063);
+
+    ASSERT_EQ(wheel.advance(4999, on_expire), 1);
+    ASSERT_EQ(expired, (std::vector<int>{0, 1, 2, 3}));
+
+    ASSERT_EQ(wheel.advance(5000, on_expire), 1);
+    ASSERT_EQ(expired.back(), 4);
+
+    // The item beyond the range of the levels.
+    ASSERT_EQ(wheel.advance(1000 + (uint64_t{1} << 40) - 1, on_expire), 0);
+    ASSERT_EQ(wheel.advance(1000 + (uint64_t{1} << 40), on_expire), 1);
+    ASSERT_EQ(expired.back(), 5);
+    ASSERT_TRUE(wheel.empty());
+    ASSERT_FALSE(wheel.next_tick());
+}
+
+TEST(timer_wheel, cancel)
+{
+    auto wheel = timer_wheel<int>();
+
+    ttlet id1 = wheel.insert(10, 1);
+    ttlet id2 = wheel.insert(10, 2);
+    ttlet id3 = wheel.insert(100000, 3);
+
+    ASSERT_EQ(wheel.cancel(id1), 1);
+    ASSERT_EQ(wheel.cancel(id3), 3);
+    ASSERT_FALSE(wheel.cancel(id1));
+    ASSERT_EQ(wheel.size(), 1);
+
+    auto expired = std::vector<int>{};
+    wheel.advance(1000000, [&expired](auto, int value) {
+        expired.push_back(value);
+    });
+    ASSERT_EQ(expired, std::vector<int>{2});
+
+    // An identifier of an expired item does not match a new item in the same node.
+    ASSERT_FALSE(wheel.cancel(id2));
+    ttlet id4 = wheel.insert(2000000, 4);
+    ASSERT_FALSE(wheel.find(id2));
+    ASSERT_EQ(*wheel.find(id4), 4);
+}
+
+TEST(timer_wheel, coalesce)
+{
+    auto wheel = timer_wheel<int>();
+
+    // With a tolerance of 16 ticks, the expiry is rounded up to a multiple of 16 ticks.
+    for (int i = 0; i != 16; ++i) {
+        wheel.insert(1024 + i, i, 16);
+    }
+    ASSERT_EQ(wheel.next_tick(), 1024);
+
+    ASSERT_EQ(wheel.advance(1024, [](auto...) {}), 1);
+    ASSERT_EQ(wheel.next_tick(), 1040);
+    ASSERT_EQ(wheel.advance(1039, [](auto...) {}), 0);
+    ASSERT_EQ(wheel.advance(1040, [](auto...) {}), 15);
+}
+
+TEST(timer_wheel, random)
+{
+    auto wheel = timer_wheel<uint64_t>(12345);
+    auto engine = std::mt19937_64{42};
+
+    auto ids = std::vector<timer_wheel_id>{};
+    for (int i = 0; i != 10000; ++i) {
+        // Expiries spread over several levels of the wheel.
+        ttlet delay = engine() >> (engine() % 64);
+        ttlet expiry = wheel.now() + (delay % (uint64_t{1} << 40));
+        ids.push_back(wheel.insert(expiry, expiry));
+    }
+    for (size_t i = 0; i < ids.size(); i += 3) {
+        ASSERT_TRUE(wheel.cancel(ids[i]));
+    }
+
+    // Items expire in order of their expiry, and never early or late.
+    auto previous_expiry = uint64_t{0};
+    auto nr_expired = size_t{0};
+    while (ttlet next = wheel.next_tick()) {
+        wheel.advance(*next, [&](auto, uint64_t expiry) {
+            ASSERT_EQ(expiry, *next);
+            ASSERT_GE(expiry, previous_expiry);
+            previous_expiry = expiry;
+            ++nr_expired;
+        });
+    }
+    ASSERT_EQ(nr_expired, ids.size() - (ids.size() + 2) / 3);
+}
+
+TEST(timer_wheel, benchmark)
+{
+    constexpr int nr_timers = 100000;
+    constexpr uint64_t nr_ticks = 10000;
+    constexpr uint64_t step = 16;
+
+    auto engine = std::mt19937_64{42};
+    auto expiries = std::vector<uint64_t>{};
+    for (int i = 0; i != nr_timers; ++i) {
+        expiries.push_back(engine() % nr_ticks + 1);
+    }
+
+    // The reference is a list which is scanned for expired items, as the timer did before.
+    struct reference_item {
+        uint64_t expiry;
+        int value;
+    };
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    auto reference_list = std::vector<reference_item>{};
+    for (int i = 0; i != nr_timers; ++i) {
+        reference_list.push_back({expiries[i], i});
+    }
+    std::erase_if(reference_list, [](ttlet &item) {
+        return item.value % 2 == 0;
+    });
+    ssize_t reference_nr_expired = 0;
+    for (uint64_t now = 0; now <= nr_ticks; now += step) {
+        ttlet i = std::remove_if(reference_list.begin(), reference_list.end(), [now](ttlet &item) {
+            return item.expiry <= now;
+        });
+        reference_nr_expired += std::distance(i, reference_list.end());
+        reference_list.erase(i, reference_list.end());
+    }
+
+    ttlet t1 = std::chrono::steady_clock::now();
+    auto wheel = timer_wheel<int>();
+    auto ids = std::vector<timer_wheel_id>{};
+    for (int i = 0; i != nr_timers; ++i) {
+        ids.push_back(wheel.insert(expiries[i], i));
+    }
+    for (int i = 0; i < nr_timers; i += 2) {
+        [[maybe_unused]] ttlet value = wheel.cancel(ids[i]);
+    }
+    ssize_t nr_expired = 0;
+    for (uint64_t now = 0; now <= nr_ticks; now += step) {
+        nr_expired += wheel.advance(now, [](auto...) {});
+    }
+    ttlet t2 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(nr_expired, nr_timers / 2);
+    ASSERT_EQ(reference_nr_expired, nr_expired);
+
+    ttlet reference_duration = std::chrono::duration<double>(t1 - t0).count();
+    ttlet duration = std::chrono::duration<double>(t2 - t1).count();
+
+    std::cout << fmt::format(
+        "{} timers, linear list: {:.1f} ms, timer_wheel: {:.1f} ms\n", nr_timers, reference_duration * 1e3, duration * 1e3);
+}
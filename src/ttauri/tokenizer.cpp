@@ -3,6 +3,14 @@
 // (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "tokenizer.hpp"
+#include "os_detect.hpp"
+#include <bit>
+#include <memory>
+#include <algorithm>
+
+#if TT_PROCESSOR == TT_CPU_X64
+#include <immintrin.h>
+#endif
 
 namespace tt {
 
@@ -18,6 +26,7 @@ enum class tokenizer_state_t: uint8_t {
     DashAfterInteger,       // Integer followed by a operator starting with '-'
     ColonAfterInteger,      // Integer followed by a operator starting with ':'
     Float,
+    FloatExponent,          // After the 'e' of a floating point number, which may be followed by a sign.
     Date,
     Time,
     DQuote,                 // Could be the start of a string, an empty string, or block string.
@@ -49,6 +58,7 @@ enum class tokenizer_action_t: uint8_t {
     Found = 0x08, // Token Found.
     Tab = 0x10, // Move the location modulo 8 to the right.
     LineFeed = 0x20, // Move to the next line.
+    Skip = 0x40, // Start of a run of characters which are read without changing state, see skip_length().
     Poison = 0x80, // Cleared. 
 };
 
@@ -196,6 +206,9 @@ constexpr std::array<tokenizer_transition_t,256> calculateTransitionTable_Number
         } else if (c == '.') {
             transition.next = tokenizer_state_t::Float;
             transition.action = tokenizer_action_t::Read | tokenizer_action_t::Capture;
+        } else if (c == 'e' || c == 'E') {
+            transition.next = tokenizer_state_t::FloatExponent;
+            transition.action = tokenizer_action_t::Read | tokenizer_action_t::Capture;
         } else if (c == '-') {
             transition.next = tokenizer_state_t::DashAfterNumber;
             transition.action = tokenizer_action_t::Read;
@@ -336,12 +349,42 @@ constexpr std::array<tokenizer_transition_t,256> calculateTransitionTable_Float(
         ttlet c = static_cast<char>(i);
         tokenizer_transition_t transition = {c};
 
-        if (isDigit(c) || c == 'e' || c == 'E' || c == '-') {
+        if (isDigit(c)) {
             transition.next = tokenizer_state_t::Float;
             transition.action = tokenizer_action_t::Read | tokenizer_action_t::Capture;
+        } else if (c == 'e' || c == 'E') {
+            transition.next = tokenizer_state_t::FloatExponent;
+            transition.action = tokenizer_action_t::Read | tokenizer_action_t::Capture;
         } else if (c == '_' || c == '\'') {
             transition.next = tokenizer_state_t::Float;
             transition.action = tokenizer_action_t::Read;
+        } else if (c == '-') {
+            // The float is followed by an operator starting with '-'.
+            transition.next = tokenizer_state_t::DashAfterInteger;
+            transition.action = tokenizer_action_t::Read | tokenizer_action_t::Found;
+            transition.name = tokenizer_name_t::FloatLiteral;
+        } else {
+            transition.next = tokenizer_state_t::Initial;
+            transition.action = tokenizer_action_t::Found;
+            transition.name = tokenizer_name_t::FloatLiteral;
+        }
+
+        r[i] = transition;
+    }
+    return r;
+}
+
+constexpr std::array<tokenizer_transition_t,256> calculateTransitionTable_FloatExponent()
+{
+    std::array<tokenizer_transition_t,256> r{};
+
+    for (uint16_t i = 0; i < r.size(); i++) {
+        ttlet c = static_cast<char>(i);
+        tokenizer_transition_t transition = {c};
+
+        if (isDigit(c) || c == '+' || c == '-') {
+            transition.next = tokenizer_state_t::Float;
+            transition.action = tokenizer_action_t::Read | tokenizer_action_t::Capture;
         } else {
             transition.next = tokenizer_state_t::Initial;
             transition.action = tokenizer_action_t::Found;
@@ -889,6 +932,7 @@ constexpr transitionTable_t calculateTransitionTable()
     CALCULATE_SUB_TABLE(Date);
     CALCULATE_SUB_TABLE(Time);
     CALCULATE_SUB_TABLE(Float);
+    CALCULATE_SUB_TABLE(FloatExponent);
     CALCULATE_SUB_TABLE(DQuote);
     CALCULATE_SUB_TABLE(DoubleDQuote);
     CALCULATE_SUB_TABLE(String);
@@ -952,7 +996,148 @@ constexpr transitionTable_t buildTransitionTable()
     return optimizeTransitionTable(transitionTable);
 }
 
-constexpr transitionTable_t transitionTable = buildTransitionTable();
+/** Check if a transition can be part of a run of skipped characters.
+ * The transition must return to the same state and advance a single column.
+ * All characters in a run are either captured unmodified, or not captured at all.
+ */
+constexpr bool is_skippable(tokenizer_state_t state, char c, tokenizer_transition_t const &transition, bool capture) noexcept
+{
+    if (transition.next != state) {
+        return false;
+    } else if (capture) {
+        return transition.action == (tokenizer_action_t::Read | tokenizer_action_t::Capture) && transition.c == c;
+    } else {
+        return transition.action == tokenizer_action_t::Read;
+    }
+}
+
+/** Description of the characters that can be skipped in a state.
+ * To scan with SIMD compares only a few characters can be checked; either
+ * the characters that are skipped, or the characters that end the run.
+ */
+struct tokenizer_skip_t {
+    bool enabled = false;
+    bool capture = false;
+    bool skip_listed = false; // When true `chars` are skipped, otherwise `chars` end the run.
+    int nr_chars = 0;
+    std::array<char,8> chars = {};
+
+    /** Check if a character is skipped.
+     */
+    [[nodiscard]] constexpr bool skips(char c) const noexcept
+    {
+        ttlet listed = std::find(chars.cbegin(), chars.cbegin() + nr_chars, c) != chars.cbegin() + nr_chars;
+        return listed == skip_listed;
+    }
+};
+
+constexpr tokenizer_skip_t calculateSkip(transitionTable_t const &r, tokenizer_state_t state, bool capture)
+{
+    int nrSkippable = 0;
+    for (uint16_t i = 0; i < 256; i++) {
+        ttlet c = static_cast<char>(i);
+        if (is_skippable(state, c, r[get_offset(state, c)], capture)) {
+            ++nrSkippable;
+        }
+    }
+
+    if (nrSkippable == 0) {
+        return {};
+    }
+
+    tokenizer_skip_t skip;
+    skip.enabled = true;
+    skip.capture = capture;
+    skip.skip_listed = nrSkippable <= 128;
+    for (uint16_t i = 0; i < 256; i++) {
+        ttlet c = static_cast<char>(i);
+        if (is_skippable(state, c, r[get_offset(state, c)], capture) == skip.skip_listed) {
+            if (skip.nr_chars == std::ssize(skip.chars)) {
+                return {};
+            }
+            skip.chars[skip.nr_chars++] = c;
+        }
+    }
+    return skip;
+}
+
+constexpr tokenizer_skip_t calculateSkip(transitionTable_t const &r, tokenizer_state_t state)
+{
+    ttlet skip = calculateSkip(r, state, false);
+    return skip.enabled ? skip : calculateSkip(r, state, true);
+}
+
+using skipTable_t = std::array<tokenizer_skip_t,NR_TOKENIZER_STATES>;
+
+constexpr skipTable_t calculateSkipTable(transitionTable_t const &r)
+{
+    skipTable_t skipTable{};
+    for (size_t i = 0; i < NR_TOKENIZER_STATES; i++) {
+        skipTable[i] = calculateSkip(r, static_cast<tokenizer_state_t>(i));
+    }
+    return skipTable;
+}
+
+constexpr transitionTable_t markSkipTransitions(transitionTable_t r, skipTable_t const &skipTable)
+{
+    for (size_t i = 0; i < r.size(); i++) {
+        ttlet state = static_cast<tokenizer_state_t>(i >> 8);
+        ttlet &skip = skipTable[static_cast<size_t>(state)];
+        if (skip.enabled && is_skippable(state, static_cast<char>(i & 0xff), r[i], skip.capture)) {
+            r[i].action = r[i].action | tokenizer_action_t::Skip;
+        }
+    }
+    return r;
+}
+
+constexpr transitionTable_t unmarkedTransitionTable = buildTransitionTable();
+constexpr skipTable_t skipTable = calculateSkipTable(unmarkedTransitionTable);
+constexpr transitionTable_t transitionTable = markSkipTransitions(unmarkedTransitionTable, skipTable);
+
+static_assert(skipTable[static_cast<size_t>(tokenizer_state_t::Initial)].enabled);
+static_assert(skipTable[static_cast<size_t>(tokenizer_state_t::String)].enabled);
+static_assert(skipTable[static_cast<size_t>(tokenizer_state_t::BlockString)].enabled);
+static_assert(skipTable[static_cast<size_t>(tokenizer_state_t::LineComment)].enabled);
+static_assert(skipTable[static_cast<size_t>(tokenizer_state_t::BlockComment)].enabled);
+
+/** Count the number of characters that can be skipped in the current state.
+ * The first character must be a transition marked with `Skip`.
+ *
+ * Whitespace, strings and comments are scanned 16 characters at a time on x64,
+ * instead of running each character through the state machine.
+ */
+[[nodiscard]] ssize_t skip_length(tokenizer_state_t state, char const *first, char const *last) noexcept
+{
+    ttlet &skip = skipTable[static_cast<size_t>(state)];
+    tt_axiom(skip.enabled);
+
+    auto it = first;
+#if TT_PROCESSOR == TT_CPU_X64
+    while (last - it >= 16) {
+        ttlet chunk = _mm_loadu_si128(reinterpret_cast<__m128i const *>(it));
+
+        auto match = _mm_setzero_si128();
+        for (int i = 0; i != skip.nr_chars; ++i) {
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(skip.chars[i])));
+        }
+
+        auto end_of_run = static_cast<uint32_t>(_mm_movemask_epi8(match));
+        if (skip.skip_listed) {
+            end_of_run ^= 0xffff;
+        }
+
+        if (end_of_run != 0) {
+            return (it - first) + std::countr_zero(end_of_run);
+        }
+        it += 16;
+    }
+#endif
+
+    while (it != last && skip.skips(*it)) {
+        ++it;
+    }
+    return it - first;
+}
 
 
 struct tokenizer {
@@ -978,6 +1163,20 @@ struct tokenizer {
             state = transition.next;
 
             auto action = transition.action;
+            if (action >= tokenizer_action_t::Skip) {
+                // The state does not change during a run of skipped characters.
+                ttlet first = std::to_address(index);
+                ttlet count = skip_length(state, first, std::to_address(end));
+
+                if (action >= tokenizer_action_t::Capture) {
+                    token.value.append(first, count);
+                }
+
+                location.increment_column(narrow_cast<int>(count));
+                index += count;
+                continue;
+            }
+
             if (action >= tokenizer_action_t::Start) {
                 token.location = location;
                 token.value.clear();
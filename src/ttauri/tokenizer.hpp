@@ -132,7 +132,9 @@ struct token_t {
     explicit operator double() const
     {
         try {
-            return std::stod(value);
+            // A float token may start with a '+', which is not accepted by from_string().
+            ttlet str = std::string_view{value};
+            return tt::from_string<double>(str.starts_with('+') ? str.substr(1) : str);
 
         } catch (...) {
             throw parse_error("Could not convert token {} to double", *this);
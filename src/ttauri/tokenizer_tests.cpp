@@ -4,9 +4,11 @@
 
 #include "tokenizer.hpp"
 #include <gtest/gtest.h>
+#include <fmt/format.h>
 #include <iostream>
 #include <string>
 #include <array>
+#include <chrono>
 
 using namespace std;
 using namespace tt;
@@ -198,6 +200,23 @@ TEST(Tokenizer, ParseFloat8) {
     ASSERT_TOKEN_EQ(tokens[3], End, "");
 }
 
+TEST(Tokenizer, ParseFloatExponentSign) {
+    auto str = "1.3e+5 5e-324 1E5 1.5-2";
+    auto v = std::string_view(str);
+    auto tokens = parseTokens(v);
+    ASSERT_TOKEN_EQ(tokens[0], FloatLiteral, "1.3e+5");
+    ASSERT_TOKEN_EQ(tokens[1], FloatLiteral, "5e-324");
+    ASSERT_TOKEN_EQ(tokens[2], FloatLiteral, "1E5");
+    ASSERT_TOKEN_EQ(tokens[3], FloatLiteral, "1.5");
+    ASSERT_TOKEN_EQ(tokens[4], Operator, "-");
+    ASSERT_TOKEN_EQ(tokens[5], IntegerLiteral, "2");
+    ASSERT_TOKEN_EQ(tokens[6], End, "");
+
+    ASSERT_EQ(static_cast<double>(tokens[0]), 1.3e5);
+    ASSERT_EQ(static_cast<double>(tokens[1]), 5e-324);
+    ASSERT_EQ(static_cast<double>(parseTokens("+.345")[0]), 0.345);
+}
+
 TEST(Tokenizer, ParseFloat9) {
     auto str = "++1.e45++";
     auto v = std::string_view(str);
@@ -382,3 +401,44 @@ TEST(Tokenizer, ParseFQName) {
     ASSERT_TOKEN_EQ(tokens[3], End, "");
 }
 
+
+TEST(Tokenizer, ParseLongRuns) {
+    auto str = "  \"a string which is longer than sixteen characters\"\t/* a block comment which is also long */\r\n"
+               "foo # a line comment which is long enough to be skipped\n"
+               "                                bar";
+    auto v = std::string_view(str);
+    auto tokens = parseTokens(v);
+    ASSERT_TOKEN_EQ(tokens[0], StringLiteral, "a string which is longer than sixteen characters");
+    ASSERT_EQ(tokens[0].location.line(), 1);
+    ASSERT_EQ(tokens[0].location.column(), 3);
+    ASSERT_TOKEN_EQ(tokens[1], Name, "foo");
+    ASSERT_EQ(tokens[1].location.line(), 2);
+    ASSERT_EQ(tokens[1].location.column(), 1);
+    ASSERT_TOKEN_EQ(tokens[2], Name, "bar");
+    ASSERT_EQ(tokens[2].location.line(), 3);
+    ASSERT_EQ(tokens[2].location.column(), 33);
+    ASSERT_TOKEN_EQ(tokens[3], End, "");
+}
+
+TEST(Tokenizer, Benchmark) {
+    auto text = std::string{};
+    for (int i = 0; i != 20'000; ++i) {
+        text += fmt::format(
+            "    // Comment line {} with some descriptive text.\n"
+            "    name_{} = \"a string value of some length {}\";\n"
+            "    /* A block comment\n"
+            "       spanning multiple lines. */\n",
+            i,
+            i,
+            i);
+    }
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    ttlet tokens = parseTokens(text);
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(std::ssize(tokens), 20'000 * 4 + 1);
+
+    ttlet duration = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << fmt::format("parseTokens: {:.1f} MByte/s\n", static_cast<double>(std::ssize(text)) / duration / 1e6);
+}
@@ -0,0 +1,739 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "os_detect.hpp"
+#include "cast.hpp"
+#include <atomic>
+#include <optional>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <new>
+#include <climits>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+
+namespace tt {
+namespace detail {
+
+/** Epoch based reclamation of the tables of the wait-free maps.
+ *
+ * Each thread owns a record in which it publishes the global epoch while it is inside
+ * an operation. Entering and leaving an operation only writes to the thread's own record.
+ *
+ * The global epoch is advanced when every thread inside an operation has published the
+ * current epoch. A table that was unlinked during epoch `e` can be deleted when the global
+ * epoch has reached `e + 2`; by then every operation that could have seen the table has finished.
+ *
+ * The records are shared by all maps. When a thread exits its record is reused by a new thread.
+ */
+class wfree_epoch {
+    struct record_type;
+
+public:
+    static constexpr uint64_t inactive = std::numeric_limits<uint64_t>::max();
+
+    /** Marks the current thread as inside an operation for the lifetime of the guard.
+     * Operations may be nested, only the outer operation publishes the epoch.
+     */
+    class guard {
+    public:
+        guard() noexcept : record(local_record())
+        {
+            if (record.depth++ == 0) {
+                record.epoch.store(global_epoch.load(std::memory_order::acquire), std::memory_order::relaxed);
+                // The epoch must be visible to other threads before any table is loaded.
+                std::atomic_thread_fence(std::memory_order::seq_cst);
+            }
+        }
+
+        ~guard()
+        {
+            if (--record.depth == 0) {
+                record.epoch.store(inactive, std::memory_order::release);
+            }
+        }
+
+        guard(guard const &) = delete;
+        guard(guard &&) = delete;
+        guard &operator=(guard const &) = delete;
+        guard &operator=(guard &&) = delete;
+
+    private:
+        record_type &record;
+    };
+
+    /** The current global epoch.
+     */
+    [[nodiscard]] static uint64_t current() noexcept
+    {
+        return global_epoch.load();
+    }
+
+    /** Advance the global epoch if every thread inside an operation has published the current epoch.
+     * This walks the records of all threads, it should only be called when there is something to delete.
+     *
+     * @return The global epoch.
+     */
+    static uint64_t advance() noexcept
+    {
+        auto epoch = global_epoch.load(std::memory_order::acquire);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+
+        for (auto record = records.load(std::memory_order::acquire); record != nullptr; record = record->next) {
+            ttlet record_epoch = record->epoch.load(std::memory_order::acquire);
+            if (record_epoch != inactive && record_epoch != epoch) {
+                return epoch;
+            }
+        }
+
+        if (global_epoch.compare_exchange_strong(epoch, epoch + 1)) {
+            return epoch + 1;
+        } else {
+            return epoch;
+        }
+    }
+
+private:
+    struct alignas(hardware_destructive_interference_size) record_type {
+        /** The epoch published by the owning thread, or inactive when outside an operation.
+         */
+        std::atomic<uint64_t> epoch = inactive;
+
+        std::atomic<bool> in_use = true;
+
+        /** The nesting depth of operations, only used by the owning thread.
+         */
+        int depth = 0;
+
+        /** The next record, records are never removed from the list.
+         */
+        record_type *next = nullptr;
+    };
+
+    /** Owns the record of a thread, and releases it for reuse when the thread exits.
+     */
+    struct record_owner {
+        record_type *record;
+
+        record_owner() noexcept : record(acquire_record()) {}
+
+        ~record_owner()
+        {
+            record->in_use.store(false, std::memory_order::release);
+        }
+    };
+
+    alignas(hardware_destructive_interference_size) inline static std::atomic<uint64_t> global_epoch = 0;
+    inline static std::atomic<record_type *> records = nullptr;
+
+    [[nodiscard]] static record_type &local_record() noexcept
+    {
+        thread_local record_owner owner;
+        return *owner.record;
+    }
+
+    /** Reuse the record of an exited thread, or add a new record.
+     */
+    [[nodiscard]] static record_type *acquire_record() noexcept
+    {
+        for (auto record = records.load(std::memory_order::acquire); record != nullptr; record = record->next) {
+            auto expected = false;
+            if (!record->in_use.load(std::memory_order::relaxed) &&
+                record->in_use.compare_exchange_strong(expected, true, std::memory_order::acquire)) {
+                return record;
+            }
+        }
+
+        auto record = new record_type;
+        auto head = records.load(std::memory_order::relaxed);
+        do {
+            record->next = head;
+        } while (!records.compare_exchange_weak(head, record, std::memory_order::release, std::memory_order::relaxed));
+        return record;
+    }
+};
+
+} // namespace detail
+
+/** Unordered map with wait-free get, which grows when it fills up.
+ *
+ * Items are stored in an open-addressing table with linear probing. When half of the
+ * slots of a table are used, a table of double the size is allocated, and the items are
+ * migrated to the new table. There is no stop-the-world rehash; each write helps to
+ * migrate a chunk of the old table, and before writing a key to the new table, first
+ * migrates the slots of the old table where that key could be.
+ *
+ * A migrated slot is frozen by setting its moved-flag. The key and value of a frozen slot
+ * remain readable, and a reader only continues in the next table when the key has been
+ * copied there, or when it reaches a frozen empty slot. `get()` therefore never waits on,
+ * or retries because of, another thread. Writes may briefly wait for another thread that
+ * is claiming a slot, or copying the same key to the next table.
+ *
+ * Readers may still be searching through a table after the root has moved past it. Retired
+ * tables are deleted by writers using epoch based reclamation, see `detail::wfree_epoch`.
+ * An operation only writes to a record owned by its own thread. A retired table is kept
+ * only while an operation which started before it was retired is still running.
+ *
+ * This class can be instantiated as a global variable; the first table is allocated on
+ * the first insert.
+ *
+ * @tparam K The key type, it must be hashable and equality comparable.
+ * @tparam V The value type, it is stored in a lock-free `std::atomic`.
+ */
+template<typename K, typename V>
+class wfree_resizable_unordered_map {
+    static_assert(std::atomic<V>::is_always_lock_free, "The value must fit a lock-free atomic for get() to be wait-free");
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+
+    /** The number of slots of the first table.
+     */
+    static constexpr size_t initial_capacity = 64;
+
+    constexpr wfree_resizable_unordered_map() noexcept = default;
+    wfree_resizable_unordered_map(wfree_resizable_unordered_map const &) = delete;
+    wfree_resizable_unordered_map(wfree_resizable_unordered_map &&) = delete;
+    wfree_resizable_unordered_map &operator=(wfree_resizable_unordered_map const &) = delete;
+    wfree_resizable_unordered_map &operator=(wfree_resizable_unordered_map &&) = delete;
+
+    ~wfree_resizable_unordered_map()
+    {
+        auto table = oldest.load(std::memory_order::acquire);
+        while (table != nullptr) {
+            auto next = table->next.load(std::memory_order::acquire);
+            delete table;
+            table = next;
+        }
+    }
+
+    [[nodiscard]] static size_t make_hash(K const &key) noexcept
+    {
+        ttlet hash = std::hash<K>{}(key) & hash_mask;
+        return hash >= 2 ? hash : hash + 2;
+    }
+
+    /** The number of items in the map.
+     */
+    [[nodiscard]] ssize_t size() const noexcept
+    {
+        return nr_items.load(std::memory_order::relaxed);
+    }
+
+    /** The number of slots in the current table.
+     */
+    [[nodiscard]] ssize_t capacity() const noexcept
+    {
+        ttlet table = root.load(std::memory_order::acquire);
+        return table != nullptr ? narrow_cast<ssize_t>(table->capacity) : 0;
+    }
+
+    /** The number of allocated tables, including retired tables that have not been deleted yet.
+     */
+    [[nodiscard]] ssize_t nr_tables() const noexcept
+    {
+        return nr_allocated_tables.load(std::memory_order::relaxed);
+    }
+
+    /** Insert a value, or replace the value of an existing key.
+     */
+    void insert(K const &key, V value) noexcept
+    {
+        {
+            ttlet guard = operation_guard{};
+            insert(root_table(), make_hash(key), key, value, false);
+        }
+        reclaim();
+    }
+
+    /** Get the value of a key.
+     * This function is wait-free.
+     */
+    [[nodiscard]] std::optional<V> get(K const &key) const noexcept
+    {
+        ttlet guard = operation_guard{};
+        ttlet hash = make_hash(key);
+
+        auto table = root.load();
+        while (table != nullptr) {
+            auto index = hash & (table->capacity - 1);
+            for (size_t i = 0; i != table->capacity; ++i) {
+                auto &slot = table->slots[index];
+                ttlet slot_hash = slot.hash.load(std::memory_order::acquire);
+
+                if (slot_hash == empty_hash) {
+                    return {};
+
+                } else if ((slot_hash & hash_mask) == empty_hash) {
+                    // A frozen empty slot; a writer may have put the key in the next table.
+                    break;
+
+                } else if ((slot_hash & hash_mask) == hash && slot.key() == key) {
+                    if ((slot_hash & copied_flag) != 0) {
+                        // The next table has the latest value of the key.
+                        break;
+                    } else if ((slot_hash & deleted_flag) != 0) {
+                        return {};
+                    }
+                    // Writers of this key wait until it is copied, so this value is still current.
+                    return slot.value.load(std::memory_order::acquire);
+                }
+
+                index = (index + 1) & (table->capacity - 1);
+            }
+
+            table = table->next.load(std::memory_order::acquire);
+        }
+        return {};
+    }
+
+    V get(K const &key, V const &default_value) const noexcept
+    {
+        if (ttlet optional_value = get(key)) {
+            return *optional_value;
+        } else {
+            return default_value;
+        }
+    }
+
+    /** Erase a key.
+     * @return The value of the erased key, or empty if the key was not in the map.
+     */
+    std::optional<V> erase(K const &key) noexcept
+    {
+        auto r = std::optional<V>{};
+        {
+            ttlet guard = operation_guard{};
+            r = erase_impl(key);
+        }
+        reclaim();
+        return r;
+    }
+
+    /** Get a list of all the keys.
+     * This will first help to finish any migration to a new table.
+     */
+    [[nodiscard]] std::vector<K> keys() noexcept
+    {
+        ttlet guard = operation_guard{};
+
+        auto r = std::vector<K>{};
+        r.reserve(std::max(size(), ssize_t{0}));
+
+        auto table = root.load();
+        if (table == nullptr) {
+            return r;
+        }
+
+        while (auto next = table->next.load(std::memory_order::acquire)) {
+            while (table->migrate_index.load(std::memory_order::relaxed) < table->capacity) {
+                help_migrate(table);
+            }
+            while (table->nr_migrated.load(std::memory_order::acquire) != table->capacity) {
+                std::this_thread::yield();
+            }
+            table = next;
+        }
+
+        for (size_t i = 0; i != table->capacity; ++i) {
+            auto &slot = table->slots[i];
+            ttlet slot_hash = slot.hash.load(std::memory_order::acquire);
+            if ((slot_hash & hash_mask) >= 2 && (slot_hash & deleted_flag) == 0) {
+                r.push_back(slot.key());
+            }
+        }
+        return r;
+    }
+
+private:
+    /** The slot has been migrated to the next table; it is frozen.
+     */
+    static constexpr size_t moved_flag = size_t{1} << (sizeof(size_t) * CHAR_BIT - 1);
+
+    /** The key has been erased, the slot is a tombstone for that key.
+     */
+    static constexpr size_t deleted_flag = moved_flag >> 1;
+
+    /** The moved slot's item has been copied to the next table.
+     */
+    static constexpr size_t copied_flag = moved_flag >> 2;
+
+    static constexpr size_t hash_mask = copied_flag - 1;
+    static constexpr size_t empty_hash = 0;
+    static constexpr size_t busy_hash = 1;
+
+    /** The number of slots migrated at once by a writer.
+     */
+    static constexpr size_t migrate_chunk_size = 64;
+
+    /** The retired epoch of a table which is still in use.
+     */
+    static constexpr uint64_t no_epoch = std::numeric_limits<uint64_t>::max();
+
+    struct slot_type {
+        /** The hash of the key and the state of the slot.
+         * Special values:
+         *  * 0 = Empty
+         *  * 1 = Busy, the key is being written.
+         */
+        std::atomic<size_t> hash = empty_hash;
+        std::atomic<V> value;
+        alignas(K) std::byte key_buffer[sizeof(K)];
+
+        [[nodiscard]] K &key() noexcept
+        {
+            return *std::launder(reinterpret_cast<K *>(key_buffer));
+        }
+
+        [[nodiscard]] K const &key() const noexcept
+        {
+            return *std::launder(reinterpret_cast<K const *>(key_buffer));
+        }
+    };
+
+    struct table_type {
+        size_t capacity;
+        std::unique_ptr<slot_type[]> slots;
+        std::atomic<table_type *> next = nullptr;
+
+        /** The number of slots that have been claimed, including tombstones.
+         */
+        std::atomic<size_t> nr_used = 0;
+
+        /** The start of the next chunk to migrate.
+         */
+        std::atomic<size_t> migrate_index = 0;
+
+        /** The number of slots that have been migrated.
+         */
+        std::atomic<size_t> nr_migrated = 0;
+
+        /** The global epoch at the moment the root moved past this table.
+         */
+        std::atomic<uint64_t> retired_epoch = no_epoch;
+
+        table_type(size_t capacity) noexcept : capacity(capacity), slots(std::make_unique<slot_type[]>(capacity)) {}
+
+        ~table_type()
+        {
+            for (size_t i = 0; i != capacity; ++i) {
+                // A slot which was claimed always has a key, even when it was frozen while busy.
+                if ((slots[i].hash.load(std::memory_order::relaxed) & hash_mask) != empty_hash) {
+                    std::destroy_at(&slots[i].key());
+                }
+            }
+        }
+    };
+
+    std::atomic<table_type *> root = nullptr;
+    std::atomic<table_type *> oldest = nullptr;
+    std::atomic<ssize_t> nr_items = 0;
+    std::atomic<ssize_t> nr_allocated_tables = 0;
+    std::atomic<bool> reclaiming = false;
+
+    /** Registers an operation as active while it may hold a pointer to a table.
+     */
+    using operation_guard = detail::wfree_epoch::guard;
+
+    [[nodiscard]] table_type *root_table() noexcept
+    {
+        auto table = root.load();
+        if (table == nullptr) {
+            [[unlikely]] auto new_table = new table_type(initial_capacity);
+            if (root.compare_exchange_strong(table, new_table)) {
+                nr_allocated_tables.fetch_add(1, std::memory_order::relaxed);
+                oldest.store(new_table, std::memory_order::release);
+                table = new_table;
+            } else {
+                delete new_table;
+            }
+        }
+        return table;
+    }
+
+    [[nodiscard]] std::optional<V> erase_impl(K const &key) noexcept
+    {
+        auto table = root.load();
+        if (table == nullptr) {
+            return {};
+        }
+
+        ttlet hash = make_hash(key);
+        table = prepare_write(table, hash, key);
+
+        auto index = hash & (table->capacity - 1);
+        for (size_t i = 0; i != table->capacity;) {
+            auto &slot = table->slots[index];
+            auto slot_hash = slot.hash.load(std::memory_order::acquire);
+
+            if ((slot_hash & moved_flag) != 0) {
+                table = prepare_write(table, hash, key);
+                index = hash & (table->capacity - 1);
+                i = 0;
+
+            } else if (slot_hash == empty_hash) {
+                return {};
+
+            } else if (slot_hash == busy_hash) {
+                // Wait for the key of the slot to be written.
+                std::this_thread::yield();
+
+            } else if ((slot_hash & hash_mask) == hash && slot.key() == key) {
+                if ((slot_hash & deleted_flag) != 0) {
+                    return {};
+                }
+
+                // Leave the key in the slot as a tombstone; it is reused when the key is inserted again.
+                ttlet value = slot.value.load(std::memory_order::acquire);
+                if (slot.hash.compare_exchange_strong(slot_hash, slot_hash | deleted_flag, std::memory_order::acq_rel)) {
+                    nr_items.fetch_sub(1, std::memory_order::relaxed);
+                    return value;
+                }
+
+            } else {
+                index = (index + 1) & (table->capacity - 1);
+                ++i;
+            }
+        }
+        return {};
+    }
+
+    /** Get the newest table to write a key to.
+     * For each older table: help with the migration, and make sure the key is migrated.
+     */
+    [[nodiscard]] table_type *prepare_write(table_type *table, size_t hash, K const &key) noexcept
+    {
+        while (auto next = table->next.load(std::memory_order::acquire)) {
+            help_migrate(table);
+            migrate_key(table, hash, key);
+            table = next;
+        }
+        return table;
+    }
+
+    /** Insert a value into the table.
+     * @param if_absent Only insert when the key is not in the table; not even as a tombstone.
+     */
+    void insert(table_type *table, size_t hash, K const &key, V value, bool if_absent) noexcept
+    {
+        table = prepare_write(table, hash, key);
+
+        auto index = hash & (table->capacity - 1);
+        for (size_t i = 0; i != table->capacity;) {
+            auto &slot = table->slots[index];
+            auto slot_hash = slot.hash.load(std::memory_order::acquire);
+
+            if ((slot_hash & moved_flag) != 0) {
+                table = prepare_write(table, hash, key);
+                index = hash & (table->capacity - 1);
+                i = 0;
+
+            } else if (slot_hash == empty_hash) {
+                if (!slot.hash.compare_exchange_strong(slot_hash, busy_hash, std::memory_order::acquire)) {
+                    continue;
+                }
+
+                std::construct_at(&slot.key(), key);
+                slot.value.store(value, std::memory_order::relaxed);
+                ttlet nr_used = table->nr_used.fetch_add(1, std::memory_order::relaxed) + 1;
+
+                auto expected = busy_hash;
+                if (slot.hash.compare_exchange_strong(expected, hash, std::memory_order::release)) {
+                    if (!if_absent) {
+                        nr_items.fetch_add(1, std::memory_order::relaxed);
+                    }
+                    if (nr_used * 2 > table->capacity) {
+                        start_resize(table);
+                    }
+                    return;
+                }
+
+                // The slot was frozen before the key was published, retry on the next table.
+                table = prepare_write(table, hash, key);
+                index = hash & (table->capacity - 1);
+                i = 0;
+
+            } else if (slot_hash == busy_hash) {
+                // Wait for the key of the slot to be written; it may be the same key.
+                std::this_thread::yield();
+
+            } else if ((slot_hash & hash_mask) == hash && slot.key() == key) {
+                if (if_absent) {
+                    return;
+
+                } else if ((slot_hash & deleted_flag) != 0) {
+                    // Revive the tombstone.
+                    slot.value.store(value);
+                    if (slot.hash.compare_exchange_strong(slot_hash, slot_hash & ~deleted_flag, std::memory_order::acq_rel)) {
+                        nr_items.fetch_add(1, std::memory_order::relaxed);
+                        return;
+                    }
+
+                } else {
+                    // Replace the value; when the slot was frozen in the meantime the value may not
+                    // have been migrated, so write it again in the next table.
+                    slot.value.store(value);
+                    if ((slot.hash.load() & moved_flag) == 0) {
+                        return;
+                    }
+                }
+
+            } else {
+                index = (index + 1) & (table->capacity - 1);
+                ++i;
+            }
+        }
+
+        // The table is full.
+        start_resize(table);
+        insert(table, hash, key, value, if_absent);
+    }
+
+    void start_resize(table_type *table) noexcept
+    {
+        if (table->next.load(std::memory_order::acquire) != nullptr) {
+            return;
+        }
+
+        // When most slots are tombstones, migrating to a table of the same size is enough.
+        // The number of items is briefly negative when a key is erased during its insert.
+        ttlet nr_items = narrow_cast<size_t>(std::max(size(), ssize_t{0}));
+        ttlet new_capacity = nr_items * 4 > table->capacity ? table->capacity * 2 : table->capacity;
+
+        auto new_table = new table_type(new_capacity);
+        table_type *expected = nullptr;
+        if (table->next.compare_exchange_strong(expected, new_table, std::memory_order::acq_rel)) {
+            nr_allocated_tables.fetch_add(1, std::memory_order::relaxed);
+        } else {
+            delete new_table;
+        }
+    }
+
+    /** Freeze a slot, and copy its item to the next table.
+     * Only the thread which freezes the slot copies the item, so that a late copy can
+     * never resurrect a key that was erased in the next table.
+     *
+     * @return true if this thread froze the slot.
+     */
+    bool migrate_slot(table_type *table, slot_type &slot) noexcept
+    {
+        ttlet slot_hash = slot.hash.fetch_or(moved_flag);
+        if ((slot_hash & moved_flag) != 0) {
+            return false;
+        }
+
+        if ((slot_hash & hash_mask) >= 2 && (slot_hash & deleted_flag) == 0) {
+            insert(
+                table->next.load(std::memory_order::acquire),
+                slot_hash & hash_mask,
+                slot.key(),
+                slot.value.load(),
+                true);
+        }
+        slot.hash.fetch_or(copied_flag, std::memory_order::release);
+        return true;
+    }
+
+    /** Count the slots that have been migrated.
+     * When all slots of a table have been migrated, readers and writers start at the next table.
+     */
+    void count_migrated(table_type *table, size_t count) noexcept
+    {
+        if (count == 0 || table->nr_migrated.fetch_add(count, std::memory_order::acq_rel) + count != table->capacity) {
+            return;
+        }
+
+        // Tables may finish migrating out of order, so advance the root past each finished table.
+        auto root_table = root.load();
+        while (root_table->nr_migrated.load(std::memory_order::acquire) == root_table->capacity) {
+            ttlet next = root_table->next.load(std::memory_order::acquire);
+            if (root.compare_exchange_strong(root_table, next)) {
+                // Operations which started before this point may still use the retired table.
+                root_table->retired_epoch.store(detail::wfree_epoch::current(), std::memory_order::release);
+                root_table = next;
+            }
+        }
+    }
+
+    /** Delete the retired tables which are no longer used by any operation.
+     * Operations that start after the root moved past a table can not reach it, so a table
+     * can be deleted when the global epoch has advanced twice since it was retired.
+     */
+    void reclaim() noexcept
+    {
+        if (oldest.load(std::memory_order::acquire) == root.load(std::memory_order::acquire) ||
+            reclaiming.exchange(true, std::memory_order::acquire)) {
+            return;
+        }
+
+        ttlet epoch = detail::wfree_epoch::advance();
+
+        auto table = oldest.load(std::memory_order::acquire);
+        while (table != root.load()) {
+            ttlet retired_epoch = table->retired_epoch.load(std::memory_order::acquire);
+            if (retired_epoch == no_epoch || epoch < retired_epoch + 2) {
+                break;
+            }
+
+            ttlet next = table->next.load(std::memory_order::acquire);
+            oldest.store(next, std::memory_order::release);
+            delete table;
+            nr_allocated_tables.fetch_sub(1, std::memory_order::relaxed);
+            table = next;
+        }
+
+        reclaiming.store(false, std::memory_order::release);
+    }
+
+    /** Migrate the next chunk of the table.
+     */
+    void help_migrate(table_type *table) noexcept
+    {
+        ttlet first = table->migrate_index.fetch_add(migrate_chunk_size, std::memory_order::relaxed);
+        if (first >= table->capacity) {
+            return;
+        }
+
+        ttlet last = std::min(first + migrate_chunk_size, table->capacity);
+        size_t count = 0;
+        for (auto i = first; i != last; ++i) {
+            count += migrate_slot(table, table->slots[i]);
+        }
+        count_migrated(table, count);
+    }
+
+    /** Migrate the slots of a table where the key could be.
+     * When returning, the key, if it was in the table, has been copied to the next table.
+     */
+    void migrate_key(table_type *table, size_t hash, K const &key) noexcept
+    {
+        auto index = hash & (table->capacity - 1);
+        for (size_t i = 0; i != table->capacity; ++i) {
+            auto &slot = table->slots[index];
+            count_migrated(table, migrate_slot(table, slot));
+
+            ttlet slot_hash = slot.hash.load(std::memory_order::acquire);
+            if ((slot_hash & hash_mask) == empty_hash) {
+                return;
+
+            } else if ((slot_hash & hash_mask) == hash && slot.key() == key) {
+                // Another thread may have frozen this slot, and still be copying it.
+                while ((slot.hash.load(std::memory_order::acquire) & copied_flag) == 0) {
+                    std::this_thread::yield();
+                }
+                return;
+            }
+
+            index = (index + 1) & (table->capacity - 1);
+        }
+    }
+};
+
+} // namespace tt
@@ -0,0 +1,272 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "ttauri/wfree_resizable_unordered_map.hpp"
+#include "ttauri/wfree_unordered_map.hpp"
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+using namespace std;
+using namespace tt;
+
+TEST(wfree_resizable_unordered_map, insert_get)
+{
+    constexpr int nr_keys = 100000;
+
+    wfree_resizable_unordered_map<int, int> map;
+    ASSERT_EQ(map.capacity(), 0);
+    ASSERT_EQ(map.get(1), std::nullopt);
+
+    for (int i = 0; i != nr_keys; ++i) {
+        map.insert(i, i * 2);
+    }
+    ASSERT_EQ(map.size(), nr_keys);
+    ASSERT_GE(map.capacity(), nr_keys);
+
+    for (int i = 0; i != nr_keys; ++i) {
+        ASSERT_EQ(map.get(i), i * 2);
+    }
+    ASSERT_EQ(map.get(nr_keys), std::nullopt);
+    ASSERT_EQ(map.get(nr_keys, -1), -1);
+
+    // Replace values.
+    for (int i = 0; i != nr_keys; ++i) {
+        map.insert(i, i * 3);
+    }
+    ASSERT_EQ(map.size(), nr_keys);
+    for (int i = 0; i != nr_keys; ++i) {
+        ASSERT_EQ(map.get(i), i * 3);
+    }
+
+    auto keys = map.keys();
+    std::sort(keys.begin(), keys.end());
+    ASSERT_EQ(std::ssize(keys), nr_keys);
+    for (int i = 0; i != nr_keys; ++i) {
+        ASSERT_EQ(keys[i], i);
+    }
+}
+
+TEST(wfree_resizable_unordered_map, erase)
+{
+    wfree_resizable_unordered_map<std::string, int> map;
+
+    for (int i = 0; i != 1000; ++i) {
+        map.insert(std::to_string(i), i);
+    }
+    for (int i = 0; i != 1000; i += 2) {
+        ASSERT_EQ(map.erase(std::to_string(i)), i);
+    }
+    ASSERT_EQ(map.erase("0"), std::nullopt);
+    ASSERT_EQ(map.size(), 500);
+
+    for (int i = 0; i != 1000; ++i) {
+        ASSERT_EQ(map.get(std::to_string(i)), i % 2 == 0 ? std::nullopt : std::optional<int>{i});
+    }
+
+    // Insert the erased keys again, reusing their tombstones.
+    for (int i = 0; i != 1000; i += 2) {
+        map.insert(std::to_string(i), -i);
+    }
+    ASSERT_EQ(map.size(), 1000);
+    ASSERT_EQ(map.get("4"), -4);
+    ASSERT_EQ(map.get("5"), 5);
+    ASSERT_EQ(std::ssize(map.keys()), 1000);
+}
+
+static void churn_test(int nr_cycles)
+{
+    // Repeatedly inserting and erasing keys fills the table with tombstones, which must
+    // be cleaned up by migration without growing the table, and without keeping the old tables.
+    wfree_resizable_unordered_map<int, int> map;
+    for (int i = 0; i != nr_cycles; ++i) {
+        map.insert(i, i);
+        ASSERT_EQ(map.erase(i), i);
+        ASSERT_LE(map.nr_tables(), 2);
+    }
+    ASSERT_EQ(map.size(), 0);
+    ASSERT_LE(map.capacity(), 1024);
+}
+
+TEST(wfree_resizable_unordered_map, churn)
+{
+    churn_test(20'000);
+}
+
+// Run with --gtest_also_run_disabled_tests.
+TEST(wfree_resizable_unordered_map, DISABLED_churn_long)
+{
+    churn_test(1'000'000);
+}
+
+TEST(wfree_resizable_unordered_map, overlapping_readers)
+{
+    // Retired tables must be deleted while other threads are continuously reading.
+    wfree_resizable_unordered_map<int, int> map;
+    std::atomic<bool> stop = false;
+
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t != 4; ++t) {
+        threads.emplace_back([&map, &stop, t] {
+            while (!stop.load(std::memory_order::relaxed)) {
+                [[maybe_unused]] volatile auto value = map.get(t);
+            }
+        });
+    }
+
+    ssize_t max_nr_tables = 0;
+    for (int i = 0; i != 100'000; ++i) {
+        map.insert(i, i);
+        map.erase(i);
+        max_nr_tables = std::max(max_nr_tables, map.nr_tables());
+    }
+
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Without reclamation during the reads, about 3000 tables would be retired.
+    ASSERT_LE(max_nr_tables, 100);
+}
+
+TEST(wfree_resizable_unordered_map, threads)
+{
+    constexpr int nr_threads = 8;
+    constexpr int nr_keys = 20000;
+
+    wfree_resizable_unordered_map<int, int> map;
+    std::atomic<int> nr_errors = 0;
+
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t != nr_threads; ++t) {
+        // Writers insert and erase their own keys, while reading the keys of the other threads.
+        threads.emplace_back([&map, &nr_errors, t] {
+            for (int i = 0; i != nr_keys; ++i) {
+                ttlet key = i * nr_threads + t;
+                map.insert(key, key + 1);
+                if (map.get(key) != key + 1) {
+                    ++nr_errors;
+                }
+
+                if (i % 3 == 0) {
+                    if (map.erase(key) != key + 1 || map.get(key) != std::nullopt) {
+                        ++nr_errors;
+                    }
+                }
+
+                ttlet other_key = (i / 2) * nr_threads + (t + 1) % nr_threads;
+                ttlet value = map.get(other_key);
+                if (value && *value != other_key + 1) {
+                    ++nr_errors;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(nr_errors.load(), 0);
+
+    ssize_t nr_items = 0;
+    for (int i = 0; i != nr_keys; ++i) {
+        for (int t = 0; t != nr_threads; ++t) {
+            ttlet key = i * nr_threads + t;
+            if (i % 3 == 0) {
+                ASSERT_EQ(map.get(key), std::nullopt);
+            } else {
+                ASSERT_EQ(map.get(key), key + 1);
+                ++nr_items;
+            }
+        }
+    }
+    ASSERT_EQ(map.size(), nr_items);
+    ASSERT_EQ(std::ssize(map.keys()), nr_items);
+
+    // Once no other thread uses the map, a write deletes the retired tables.
+    map.erase(-1);
+    ASSERT_LE(map.nr_tables(), 2);
+}
+
+namespace {
+
+constexpr int benchmark_nr_keys = 16384;
+
+/** A small fast pseudo random generator, so that the benchmark measures the map.
+ */
+struct xorshift {
+    uint32_t state;
+
+    uint32_t operator()() noexcept
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+template<typename Map>
+double map_benchmark(Map &map, int nr_threads, int write_percentage)
+{
+    constexpr int nr_operations = 2'000'000;
+    ttlet nr_operations_per_thread = nr_operations / nr_threads;
+
+    ttlet t0 = std::chrono::steady_clock::now();
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t != nr_threads; ++t) {
+        threads.emplace_back([&map, t, write_percentage, nr_operations_per_thread] {
+            auto random = xorshift{narrow_cast<uint32_t>(t * 7919 + 1)};
+            int sum = 0;
+            for (int i = 0; i != nr_operations_per_thread; ++i) {
+                ttlet r = random();
+                ttlet key = narrow_cast<int>(r % benchmark_nr_keys);
+                if (narrow_cast<int>((r >> 16) % 100) < write_percentage) {
+                    map.insert(key, i);
+                } else {
+                    sum += map.get(key, 0);
+                }
+            }
+            // Keep the reads from being optimized away.
+            [[maybe_unused]] volatile int sink = sum;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ttlet t1 = std::chrono::steady_clock::now();
+
+    return nr_operations / std::chrono::duration<double>(t1 - t0).count() / 1'000'000.0;
+}
+
+} // namespace
+
+// Run with --gtest_also_run_disabled_tests.
+TEST(wfree_resizable_unordered_map, DISABLED_benchmark)
+{
+    using fixed_map_type = wfree_unordered_map<int, int, benchmark_nr_keys>;
+
+    for (ttlet write_percentage : {10, 50}) {
+        for (ttlet nr_threads : {1, 2, 4, 8, 16, 32, 64}) {
+            // Both maps start empty; the resizable map grows during the benchmark.
+            auto fixed_map = std::make_unique<fixed_map_type>();
+            auto resizable_map = std::make_unique<wfree_resizable_unordered_map<int, int>>();
+
+            ttlet fixed_speed = map_benchmark(*fixed_map, nr_threads, write_percentage);
+            ttlet resizable_speed = map_benchmark(*resizable_map, nr_threads, write_percentage);
+
+            std::cout << fmt::format(
+                "{}% writes, {} threads: fixed {:.1f} Mops/s, resizable {:.1f} Mops/s\n",
+                write_percentage,
+                nr_threads,
+                fixed_speed,
+                resizable_speed);
+        }
+    }
+}
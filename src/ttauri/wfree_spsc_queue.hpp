@@ -0,0 +1,142 @@
+// Copyright Take Vos 2021.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "required.hpp"
+#include "counters.hpp"
+#include "fixed_string.hpp"
+#include <array>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+namespace tt {
+
+/** A wait-free single-producer, single-consumer queue.
+ *
+ * The producer and consumer each own one of the indices, so that writing and reading
+ * does not contend on a shared atomic. Each side caches the index of the other side,
+ * so that the other side's cache-line is only read when the cached index says the
+ * queue is full or empty.
+ *
+ * Messages are not destructed when they are read, a message is overwritten when the
+ * ring buffer wraps around.
+ *
+ * @tparam T The type of a message.
+ * @tparam Capacity The maximum number of messages in the queue.
+ */
+template<typename T, size_t Capacity>
+class wfree_spsc_queue {
+public:
+    using value_type = T;
+    using index_type = size_t;
+
+    static constexpr index_type capacity = Capacity;
+
+    wfree_spsc_queue() = default;
+    wfree_spsc_queue(wfree_spsc_queue const &) = delete;
+    wfree_spsc_queue(wfree_spsc_queue &&) = delete;
+    wfree_spsc_queue &operator=(wfree_spsc_queue const &) = delete;
+    wfree_spsc_queue &operator=(wfree_spsc_queue &&) = delete;
+    ~wfree_spsc_queue() = default;
+
+    /** Check if the queue is empty.
+     * May be called from any thread, but is only exact when called from the consumer.
+     */
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _head.load(std::memory_order::acquire) == _tail.load(std::memory_order::relaxed);
+    }
+
+    /** Start writing a message.
+     * This function is wait-free when the queue is not full, when it is full it blocks
+     * until the consumer has read a message. Must only be called by the producer.
+     * Every write_start() must be accompanied by a write_finish().
+     *
+     * @tparam BlockCounterTag The counter to increment when the queue was full.
+     * @return The message to write into.
+     */
+    template<basic_fixed_string BlockCounterTag = "">
+    [[nodiscard]] value_type &write_start() noexcept
+    {
+        ttlet head = _head.load(std::memory_order::relaxed);
+        if (head - _tail_cache >= capacity) {
+            _tail_cache = _tail.load(std::memory_order::acquire);
+            if (head - _tail_cache >= capacity) {
+                [[unlikely]] contended_wait_until_not_full<BlockCounterTag>(head);
+            }
+        }
+        return _messages[head % capacity];
+    }
+
+    /** Finish writing a message and make it available to the consumer.
+     * Must only be called by the producer.
+     */
+    void write_finish() noexcept
+    {
+        _head.store(_head.load(std::memory_order::relaxed) + 1, std::memory_order::release);
+    }
+
+    /** The oldest message in the queue.
+     * Must only be called by the consumer.
+     *
+     * @return The message, or nullptr when the queue is empty.
+     */
+    [[nodiscard]] value_type *front() noexcept
+    {
+        ttlet tail = _tail.load(std::memory_order::relaxed);
+        if (tail == _head_cache) {
+            _head_cache = _head.load(std::memory_order::acquire);
+            if (tail == _head_cache) {
+                return nullptr;
+            }
+        }
+        return &_messages[tail % capacity];
+    }
+
+    /** Remove the oldest message from the queue.
+     * Must only be called by the consumer, after `front()` returned a message.
+     */
+    void pop_front() noexcept
+    {
+        _tail.store(_tail.load(std::memory_order::relaxed) + 1, std::memory_order::release);
+    }
+
+private:
+    std::array<value_type, capacity> _messages;
+
+    /** The index of the next message to write, and the producer's copy of the tail.
+     */
+    alignas(hardware_destructive_interference_size) std::atomic<index_type> _head = 0;
+    index_type _tail_cache = 0;
+
+    /** The index of the next message to read, and the consumer's copy of the head.
+     */
+    alignas(hardware_destructive_interference_size) std::atomic<index_type> _tail = 0;
+    index_type _head_cache = 0;
+
+    template<basic_fixed_string BlockCounterTag>
+    tt_no_inline void contended_wait_until_not_full(index_type head) noexcept
+    {
+        using namespace std::literals::chrono_literals;
+
+        increment_counter<BlockCounterTag>();
+
+        auto backoff = 1ms;
+        while (true) {
+            std::this_thread::sleep_for(backoff);
+            _tail_cache = _tail.load(std::memory_order::acquire);
+            if (head - _tail_cache < capacity) {
+                return;
+            }
+
+            if ((backoff *= 2) > 100ms) {
+                backoff = 100ms;
+            }
+        }
+    }
+};
+
+} // namespace tt
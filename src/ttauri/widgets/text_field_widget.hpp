@@ -68,9 +68,12 @@ public:
         super(window, parent),
         value(std::forward<Value>(value)),
         _delegate(delegate),
-        _field(theme::global->labelStyle),
-        _shaped_text()
+        _field_style(theme::global->labelStyle),
+        _field(_field_style),
+        _shaped_text(_field.shapedText())
     {
+        _field.setWidth(std::numeric_limits<float>::infinity());
+
         _value_callback = this->value.subscribe([this](auto...) {
             ttlet lock = std::scoped_lock(gui_system_mutex);
             _request_relayout = true;
@@ -168,7 +171,10 @@ public:
 
                 } else {
                     // When field is not focused, simply follow the observed_value.
-                    _field = delegate->to_string(*this, *value);
+                    // Only shape the text again when the value's string changed.
+                    if (ttlet value_str = delegate->to_string(*this, *value); value_str != field_str) {
+                        _field = value_str;
+                    }
                     _error = {};
                 }
 
@@ -177,9 +183,11 @@ public:
                 _error = l10n("system error: delegate missing");
             }
 
-            _field.setStyleOfAll(theme::global->labelStyle);
-            _field.setWidth(std::numeric_limits<float>::infinity());
-            _shaped_text = _field.shapedText();
+            // Edits already updated the shaped text, only shape all the text again when the theme changed.
+            if (_field_style != theme::global->labelStyle) {
+                _field_style = theme::global->labelStyle;
+                _field.setStyleOfAll(_field_style);
+            }
 
             // Record the last time the text is modified, so that the caret remains lit.
             _last_update_time_point = display_time_point;
@@ -396,8 +404,15 @@ private:
     aarect _text_field_rectangle;
     aarect _text_field_clipping_rectangle;
 
+    /** The text style with which _field was shaped.
+     */
+    text_style _field_style;
+
     editable_text _field;
-    shaped_text _shaped_text;
+
+    /** The shaped text of _field, which is updated by each edit.
+     */
+    shaped_text const &_shaped_text;
     aarect _left_to_right_caret = {};
 
     /** Scroll speed in points per second.
@@ -68,6 +68,10 @@ class UnicodeDescription (object):
         self.compositionIsCanonical = False
         self.decompositionOrder = decompositionOrder
         self.decompositionIndex = None
+        self.NFCQuickCheck = "yes"
+        self.NFDQuickCheck = "yes"
+        self.NFKCQuickCheck = "yes"
+        self.NFKDQuickCheck = "yes"
 
     def serialize(self):
         s = "TTXD{"
@@ -104,6 +108,11 @@ class UnicodeDescription (object):
         else:
             s += ", {}".format(self.decompositionIndex)
 
+        # Normalization quick-check, omitted when the code-point is normalized in every form.
+        quickChecks = [self.NFCQuickCheck, self.NFDQuickCheck, self.NFKCQuickCheck, self.NFKDQuickCheck]
+        if any(x != "yes" for x in quickChecks):
+            s += "".join(", TTXQC::{}".format(x) for x in quickChecks)
+
         s += "}"
         return s
             
@@ -182,6 +191,8 @@ def parseBidiMirroring(filename, descriptions):
 
 def parseUnicodeData(filename):
     descriptions = {}
+    ranges = []
+    rangeFirst = None
     for line in open(filename, encoding="utf-8"):
         line = line.rstrip()
         line = line.split("#", 1)[0]
@@ -214,7 +225,13 @@ def parseUnicodeData(filename):
 
         descriptions[description.codePoint] = description
 
-    return descriptions
+        # Large blocks of code-points with the same properties are described by a first and last entry.
+        if columns[1].endswith(", First>"):
+            rangeFirst = description.codePoint
+        elif columns[1].endswith(", Last>"):
+            ranges.append((rangeFirst, description.codePoint))
+
+    return descriptions, ranges
 
 def isCanonicalComposition(description, composition_exclusions):
     return (
@@ -252,6 +269,42 @@ def extractOtherDecompositions(descriptions, composition_exclusions):
 
     return decompositions
 
+def setQuickChecks(descriptions, compositions):
+    """Derive the normalization quick-check properties as described in UAX #15.
+
+    Characters that may compose with a previous character are "maybe" for NFC and NFKC.
+    The descriptions of the first (LV) and last (LVT) Hangul syllable are used
+    for all syllables, which all decompose.
+    """
+    composeWithPrevious = set(composition.secondCodePoint for composition in compositions)
+    composeWithPrevious.update(range(0x1161, 0x1176)) # Hangul V
+    composeWithPrevious.update(range(0x11a8, 0x11c3)) # Hangul T
+
+    descriptionsByCodePoint = {description.codePoint: description for description in descriptions}
+
+    def hasCompatibleDecomposition(description):
+        if len(description.decomposition) > 0 and not description.decompositionIsCanonical:
+            return True
+        return any(
+            hasCompatibleDecomposition(descriptionsByCodePoint[x])
+            for x in description.decomposition if x in descriptionsByCodePoint
+        )
+
+    for description in descriptions:
+        hangulSyllable = description.codePoint in (0xac00, 0xd7a3)
+        canonical = len(description.decomposition) > 0 and description.decompositionIsCanonical
+        compatible = len(description.decomposition) > 0 and not description.decompositionIsCanonical
+
+        description.NFDQuickCheck = "no" if canonical or hangulSyllable else "yes"
+        description.NFKDQuickCheck = "no" if canonical or compatible or hangulSyllable else "yes"
+
+        if canonical and not description.compositionIsCanonical:
+            description.NFCQuickCheck = "no"
+        elif description.codePoint in composeWithPrevious:
+            description.NFCQuickCheck = "maybe"
+
+        description.NFKCQuickCheck = "no" if hasCompatibleDecomposition(description) else description.NFCQuickCheck
+
 def setDecompositionIndices(descriptions, compositions, decompositions):
     for index, composition in enumerate(compositions):
         composition.description.decompositionIndex = index
@@ -261,7 +314,7 @@ def setDecompositionIndices(descriptions, compositions, decompositions):
         decomposition.description.decompositionIndex = index
         index += len(decomposition)
 
-def writeUnicodeData(filename, descriptions, compositions, decompositions):
+def writeUnicodeData(filename, descriptions, descriptionIndices, compositions, decompositions):
     fd = open(filename, "w")
     fd.write('// This file is generated by unicode_data_generator.py\n\n')
 
@@ -271,7 +324,8 @@ def writeUnicodeData(filename, descriptions, compositions, decompositions):
     fd.write('#include "ttauri/text/unicode_grapheme_cluster_break.hpp"\n')
     fd.write('#include "ttauri/text/unicode_composition.hpp"\n')
     fd.write('#include "ttauri/text/unicode_description.hpp"\n')
-    fd.write('#include <array>\n\n')
+    fd.write('#include <array>\n')
+    fd.write('#include <cstdint>\n\n')
 
     fd.write('namespace tt::detail {\n\n')
 
@@ -280,6 +334,7 @@ def writeUnicodeData(filename, descriptions, compositions, decompositions):
     fd.write('#define TTXBC unicode_bidi_class\n')
     fd.write('#define TTXBB unicode_bidi_bracket_type\n')
     fd.write('#define TTXGU unicode_grapheme_cluster_break\n')
+    fd.write('#define TTXQC unicode_quick_check\n')
     fd.write('constexpr auto unicode_db_description_table = std::array{')
     for i, description in enumerate(descriptions):
         if i != 0:
@@ -292,6 +347,14 @@ def writeUnicodeData(filename, descriptions, compositions, decompositions):
     fd.write('#undef TTXBC\n')
     fd.write('#undef TTXBB\n')
     fd.write('#undef TTXGU\n')
+    fd.write('#undef TTXQC\n')
+
+    trieShift = 7
+    trieIndexTable, trieBlockTable = makeTrie(descriptionIndices, trieShift)
+    assert len(descriptions) <= 0x10000 and len(trieBlockTable) >> trieShift <= 0x10000
+    fd.write('constexpr int unicode_db_description_trie_shift = {};\n'.format(trieShift))
+    writeIntegerTable(fd, 'unicode_db_description_trie_index', 'uint16_t', trieIndexTable)
+    writeIntegerTable(fd, 'unicode_db_description_trie', 'uint16_t', trieBlockTable)
 
     fd.write('#define TTXC unicode_composition\n')
     fd.write('constexpr auto unicode_db_composition_table = std::array{')
@@ -319,6 +382,56 @@ def writeUnicodeData(filename, descriptions, compositions, decompositions):
     fd.write('}\n')
     fd.close()
 
+def makeDescriptionIndices(descriptions, ranges):
+    """Create a list with an index into the description table for each code-point.
+
+    Code-points without a description of their own use the description at the
+    start of their range, or the replacement character when outside of a range.
+    Hangul syllables use the description of the first (LV) or last (LVT) syllable.
+    """
+    indices = {description.codePoint: i for i, description in enumerate(descriptions)}
+    r = [indices[0xfffd]] * 0x110000
+
+    for first, last in ranges:
+        for codePoint in range(first, last + 1):
+            if first == 0xac00:
+                r[codePoint] = indices[first] if (codePoint - first) % 28 == 0 else indices[last]
+            else:
+                r[codePoint] = indices[first]
+
+    for codePoint, index in indices.items():
+        r[codePoint] = index
+
+    return r
+
+def makeTrie(values, shift):
+    """Compress a list of values in a two-stage trie.
+
+    Blocks of (1 << shift) values are deduplicated; the index table contains
+    for each block its offset in the block table, in units of blocks.
+    """
+    blockSize = 1 << shift
+    blockIndices = {}
+    indexTable = []
+    blockTable = []
+    for i in range(0, len(values), blockSize):
+        block = tuple(values[i:i + blockSize])
+        if block not in blockIndices:
+            blockIndices[block] = len(blockIndices)
+            blockTable.extend(block)
+        indexTable.append(blockIndices[block])
+
+    return indexTable, blockTable
+
+def writeIntegerTable(fd, name, type, values):
+    fd.write('constexpr auto {} = std::array<{}, {}>{{'.format(name, type, len(values)))
+    for i in range(0, len(values), 16):
+        if i != 0:
+            fd.write(",")
+        fd.write("\n    ")
+        fd.write(", ".join(str(x) for x in values[i:i + 16]))
+    fd.write('};\n\n')
+
 def checkDecompositionsForStartWithStart(descriptions):
     for description in descriptions.values():
         if len(description.decomposition) >= 1:
@@ -331,7 +444,7 @@ def checkDecompositionsForStartWithStart(descriptions):
                 description.decompositionStartsWithStart = True
 
 def main():
-    descriptions = parseUnicodeData(options.unicode_data_path)
+    descriptions, ranges = parseUnicodeData(options.unicode_data_path)
     composition_exclusions = parseCompositionExclusions(options.composition_exclusions_path)
     parseGraphemeBreakProperty(options.grapheme_break_property_path, descriptions)
     parseEmojiData(options.emoji_data_path, descriptions)
@@ -343,10 +456,12 @@ def main():
 
     compositions = extractCompositions(descriptions, composition_exclusions)
     decompositions = extractOtherDecompositions(descriptions, composition_exclusions)
+    setQuickChecks(descriptions, compositions)
 
     setDecompositionIndices(descriptions, compositions, decompositions)
+    descriptionIndices = makeDescriptionIndices(descriptions, ranges)
 
-    writeUnicodeData(options.output_path, descriptions, compositions, decompositions)
+    writeUnicodeData(options.output_path, descriptions, descriptionIndices, compositions, decompositions)
 
 if __name__ == "__main__":
     main()